@@ -1,8 +1,10 @@
 #include "operation.hpp"
 
+#include <algorithm>
 #include <string>
 #include <vector>
 
+#include <QThread>
 #include <QTimer>
 
 #include "../world/universalid.hpp"
@@ -10,6 +12,72 @@
 #include "state.hpp"
 #include "stage.hpp"
 
+namespace CSMDoc
+{
+    /// Performs all steps of one stage on a pool thread.
+    class StageTask : public QRunnable
+    {
+            Stage& mStage;
+            int mSteps;
+            Messages mMessages;
+            std::atomic<int>& mStepsDone;
+            const std::atomic<bool>& mAbort;
+            std::atomic<bool> mDone;
+            std::string mError;
+
+        public:
+
+            StageTask (Stage& stage, int steps, Message::Severity severity,
+                std::atomic<int>& stepsDone, const std::atomic<bool>& abort)
+            : mStage (stage), mSteps (steps), mMessages (severity), mStepsDone (stepsDone),
+              mAbort (abort), mDone (false)
+            {
+                setAutoDelete (false);
+            }
+
+            virtual void run()
+            {
+                try
+                {
+                    for (int i=0; i<mSteps && !mAbort; ++i)
+                    {
+                        mStage.perform (i, mMessages);
+                        ++mStepsDone;
+                    }
+                }
+                catch (const std::exception& e)
+                {
+                    mError = e.what();
+                    if (mError.empty())
+                        mError = "Unknown error";
+                }
+
+                mDone = true;
+            }
+
+            int getSteps() const
+            {
+                return mSteps;
+            }
+
+            bool isDone() const
+            {
+                return mDone;
+            }
+
+            const Messages& getMessages() const
+            {
+                return mMessages;
+            }
+
+            /// Empty if the stage was performed successfully.
+            const std::string& getError() const
+            {
+                return mError;
+            }
+    };
+}
+
 void CSMDoc::Operation::prepareStages()
 {
     mCurrentStage = mStages.begin();
@@ -29,13 +97,18 @@ CSMDoc::Operation::Operation (int type, bool ordered, bool finalAlways)
 : mType (type), mStages(std::vector<std::pair<Stage *, int> >()), mCurrentStage(mStages.begin()),
   mCurrentStep(0), mCurrentStepTotal(0), mTotalSteps(0), mOrdered (ordered),
   mFinalAlways (finalAlways), mError(false), mConnected (false), mPrepared (false),
-  mDefaultSeverity (Message::Severity_Error)
+  mDefaultSeverity (Message::Severity_Error), mThreads (1), mNextTask (0), mStepsDone (0),
+  mAbortTasks (false)
 {
     mTimer = new QTimer (this);
 }
 
 CSMDoc::Operation::~Operation()
 {
+    mAbortTasks = true;
+    mThreadPool.waitForDone();
+    mTasks.clear();
+
     for (std::vector<std::pair<Stage *, int> >::iterator iter (mStages.begin()); iter!=mStages.end(); ++iter)
         delete iter->first;
 }
@@ -65,6 +138,14 @@ void CSMDoc::Operation::setDefaultSeverity (Message::Severity severity)
     mDefaultSeverity = severity;
 }
 
+void CSMDoc::Operation::setThreads (int threads)
+{
+    mThreads = threads>0 ? threads : QThread::idealThreadCount();
+
+    if (mThreads>1)
+        mThreadPool.setMaxThreadCount (mThreads);
+}
+
 bool CSMDoc::Operation::hasError() const
 {
     return mError;
@@ -77,6 +158,13 @@ void CSMDoc::Operation::abort()
 
     mError = true;
 
+    if (!mTasks.empty())
+    {
+        // the running tasks are collected by the next call to executeStage
+        mAbortTasks = true;
+        return;
+    }
+
     if (mFinalAlways)
     {
         if (mStages.begin()!=mStages.end() && mCurrentStage!=--mStages.end())
@@ -95,6 +183,19 @@ void CSMDoc::Operation::executeStage()
     {
         prepareStages();
         mPrepared = true;
+
+        if (!mOrdered && !mFinalAlways && mThreads>1 && mStages.size()>1)
+        {
+            startTasks();
+            emit progress (0, mTotalSteps ? mTotalSteps : 1, mType);
+            return;
+        }
+    }
+
+    if (!mTasks.empty())
+    {
+        executeTasks();
+        return;
     }
 
     Messages messages (mDefaultSeverity);
@@ -132,6 +233,77 @@ void CSMDoc::Operation::executeStage()
         operationDone();
 }
 
+void CSMDoc::Operation::startTasks()
+{
+    mNextTask = 0;
+    mStepsDone = 0;
+    mAbortTasks = false;
+
+    for (std::vector<std::pair<Stage *, int> >::iterator iter (mStages.begin()); iter!=mStages.end(); ++iter)
+        if (iter->second>0)
+            mTasks.push_back (std::unique_ptr<StageTask> (new StageTask (
+                *iter->first, iter->second, mDefaultSeverity, mStepsDone, mAbortTasks)));
+
+    // stages with the most work are started first to keep the threads busy until the end
+    std::vector<StageTask *> tasks;
+
+    for (std::size_t i=0; i<mTasks.size(); ++i)
+        tasks.push_back (mTasks[i].get());
+
+    std::stable_sort (tasks.begin(), tasks.end(),
+        [] (const StageTask *left, const StageTask *right)
+        { return left->getSteps()>right->getSteps(); });
+
+    for (std::vector<StageTask *>::iterator iter (tasks.begin()); iter!=tasks.end(); ++iter)
+        mThreadPool.start (*iter);
+
+    mCurrentStage = mStages.end();
+}
+
+void CSMDoc::Operation::executeTasks()
+{
+    // avoid spinning the event loop while the pool is busy, but keep it responsive to aborts
+    mThreadPool.waitForDone (50);
+
+    if (mAbortTasks)
+    {
+        finishTasks();
+        return;
+    }
+
+    emit progress (mStepsDone, mTotalSteps ? mTotalSteps : 1, mType);
+
+    // report in stage order, so that the output does not depend on thread scheduling
+    for (; mNextTask<mTasks.size() && mTasks[mNextTask]->isDone(); ++mNextTask)
+    {
+        const StageTask& task = *mTasks[mNextTask];
+
+        for (Messages::Iterator iter (task.getMessages().begin()); iter!=task.getMessages().end(); ++iter)
+            emit reportMessage (*iter, mType);
+
+        if (!task.getError().empty())
+        {
+            emit reportMessage (Message (CSMWorld::UniversalId(), task.getError(), "", Message::Severity_SeriousError), mType);
+            abort();
+            finishTasks();
+            return;
+        }
+    }
+
+    if (mNextTask>=mTasks.size())
+        finishTasks();
+}
+
+void CSMDoc::Operation::finishTasks()
+{
+    mAbortTasks = true;
+    mThreadPool.waitForDone();
+    mTasks.clear();
+    mNextTask = 0;
+    mCurrentStepTotal = mStepsDone;
+    operationDone();
+}
+
 void CSMDoc::Operation::operationDone()
 {
     mTimer->stop();
@@ -1,12 +1,15 @@
 #ifndef CSM_DOC_OPERATION_H
 #define CSM_DOC_OPERATION_H
 
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <map>
 
 #include <QObject>
 #include <QTimer>
 #include <QStringList>
+#include <QThreadPool>
 
 #include "messages.hpp"
 
@@ -18,6 +21,7 @@ namespace CSMWorld
 namespace CSMDoc
 {
     class Stage;
+    class StageTask;
 
     class Operation : public QObject
     {
@@ -36,9 +40,21 @@ namespace CSMDoc
             QTimer *mTimer;
             bool mPrepared;
             Message::Severity mDefaultSeverity;
+            int mThreads;
+            QThreadPool mThreadPool;
+            std::vector<std::unique_ptr<StageTask> > mTasks;
+            std::size_t mNextTask;
+            std::atomic<int> mStepsDone;
+            std::atomic<bool> mAbortTasks;
 
             void prepareStages();
 
+            void startTasks();
+
+            void executeTasks();
+
+            void finishTasks();
+
         public:
 
             Operation (int type, bool ordered, bool finalAlways = false);
@@ -55,6 +71,15 @@ namespace CSMDoc
             /// \attention Do no call this function while this Operation is running.
             void setDefaultSeverity (Message::Severity severity);
 
+            /// Run the stages of an unordered operation concurrently, each stage on its own
+            /// thread from a pool of up to \a threads threads (0: one per CPU core). Messages
+            /// are still reported in stage order. The default is 1, i.e. no concurrency.
+            ///
+            /// \note Stages must only read data shared with other stages.
+            ///
+            /// \attention Do no call this function while this Operation is running.
+            void setThreads (int threads);
+
             bool hasError() const;
 
         signals:
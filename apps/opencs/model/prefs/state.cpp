@@ -124,6 +124,9 @@ void CSMPrefs::State::declare()
     declareEnum ("double-c", "Control Double Click", actionEditAndRemove).addValues (reportValues);
     declareEnum ("double-sc", "Shift Control Double Click", actionNone).addValues (reportValues);
     declareBool("ignore-base-records", "Ignore base records in verifier", false);
+    declareInt ("verifier-threads", "Verifier threads", 0).
+        setTooltip ("Number of threads used to run the verifier checks concurrently (0: one per CPU core, 1: no concurrency)").
+        setRange (0, 64);
 
     declareCategory ("Search & Replace");
     declareInt ("char-before", "Characters before search string", 10).
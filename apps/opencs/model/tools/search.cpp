@@ -199,6 +199,21 @@ void CSMTools::Search::configure (const CSMWorld::IdTableBase *model)
     mTypeColumn = model->findColumnIndex (CSMWorld::Columns::ColumnId_RecordType);
 }
 
+CSMTools::Search::Type CSMTools::Search::getType() const
+{
+    return mType;
+}
+
+const std::string& CSMTools::Search::getText() const
+{
+    return mText;
+}
+
+const std::set<int>& CSMTools::Search::getColumns() const
+{
+    return mColumns;
+}
+
 void CSMTools::Search::searchRow (const CSMWorld::IdTableBase *model, int row,
     CSMDoc::Messages& messages) const
 {
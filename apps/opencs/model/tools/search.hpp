@@ -77,6 +77,16 @@ namespace CSMTools
             // Configure search for the specified model.
             void configure (const CSMWorld::IdTableBase *model);
 
+            Type getType() const;
+
+            // Only valid for Type_Text and Type_Id.
+            const std::string& getText() const;
+
+            // Columns considered by this search.
+            //
+            // \attention *this needs to be configured for a model first.
+            const std::set<int>& getColumns() const;
+
             // Search row in \a model and store results in \a messages.
             //
             // \attention *this needs to be configured for \a model.
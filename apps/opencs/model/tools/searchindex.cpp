@@ -0,0 +1,202 @@
+#include "searchindex.hpp"
+
+#include <algorithm>
+
+#include <QMutexLocker>
+
+#include "../world/idtablebase.hpp"
+
+void CSMTools::SearchIndex::getTrigrams (const QString& text, std::vector<Trigram>& trigrams)
+{
+    QString folded = text.toCaseFolded();
+
+    TrigramIndex::getTrigrams (
+        std::u16string (reinterpret_cast<const char16_t *> (folded.utf16()), folded.size()), trigrams);
+}
+
+void CSMTools::SearchIndex::markDirty (int first, int last)
+{
+    QMutexLocker lock (&mMutex);
+
+    for (int row=first; row<=last; ++row)
+        mDirty.insert (
+            mModel->data (mModel->index (row, mIdColumn)).toString().toUtf8().constData());
+}
+
+int CSMTools::SearchIndex::getRecord (const std::string& id)
+{
+    std::unordered_map<std::string, int>::const_iterator iter = mRecords.find (id);
+
+    if (iter!=mRecords.end())
+        return iter->second;
+
+    int record = static_cast<int> (mRecordIds.size());
+    mRecordIds.push_back (id);
+    mRecords.insert (std::make_pair (id, record));
+    return record;
+}
+
+void CSMTools::SearchIndex::addRecord (Index& index, int record, int row)
+{
+    std::vector<Trigram> trigrams;
+
+    for (std::set<int>::const_iterator iter (index.mColumns.begin()); iter!=index.mColumns.end();
+        ++iter)
+        getTrigrams (mModel->data (mModel->index (row, *iter)).toString(), trigrams);
+
+    index.mTrigrams.add (record, trigrams);
+}
+
+void CSMTools::SearchIndex::build()
+{
+    Search text (Search::Type_Text, false, std::string());
+    text.configure (mModel);
+    mText = Index();
+    mText.mColumns = text.getColumns();
+
+    Search id (Search::Type_Id, false, std::string());
+    id.configure (mModel);
+    mId = Index();
+    mId.mColumns = id.getColumns();
+
+    mRecordIds.clear();
+    mRecords.clear();
+
+    int rows = mModel->rowCount();
+
+    for (int row=0; row<rows; ++row)
+    {
+        int record = getRecord (
+            mModel->data (mModel->index (row, mIdColumn)).toString().toUtf8().constData());
+
+        addRecord (mText, record, row);
+        addRecord (mId, record, row);
+    }
+
+    mBuilt = true;
+}
+
+CSMTools::SearchIndex::SearchIndex (const CSMWorld::IdTableBase *model)
+: mModel (model), mIdColumn (model->findColumnIndex (CSMWorld::Columns::ColumnId_Id)),
+  mBuilt (false), mReset (false)
+{
+    connect (model, SIGNAL (dataChanged (const QModelIndex&, const QModelIndex&)),
+        this, SLOT (dataChanged (const QModelIndex&, const QModelIndex&)));
+    connect (model, SIGNAL (rowsInserted (const QModelIndex&, int, int)),
+        this, SLOT (rowsInserted (const QModelIndex&, int, int)));
+    connect (model, SIGNAL (rowsAboutToBeRemoved (const QModelIndex&, int, int)),
+        this, SLOT (rowsAboutToBeRemoved (const QModelIndex&, int, int)));
+    connect (model, SIGNAL (modelReset()), this, SLOT (modelReset()));
+}
+
+void CSMTools::SearchIndex::update()
+{
+    std::set<std::string> dirty;
+    bool reset = false;
+
+    {
+        QMutexLocker lock (&mMutex);
+        dirty.swap (mDirty);
+        std::swap (reset, mReset);
+    }
+
+    if (reset || !mBuilt)
+    {
+        build();
+        return;
+    }
+
+    for (std::set<std::string>::const_iterator iter (dirty.begin()); iter!=dirty.end(); ++iter)
+    {
+        int record = getRecord (*iter);
+
+        // Record may have been removed
+        QModelIndex index = mModel->getModelIndex (*iter, mIdColumn);
+
+        if (index.isValid())
+        {
+            addRecord (mText, record, index.row());
+            addRecord (mId, record, index.row());
+        }
+        else
+        {
+            mText.mTrigrams.remove (record);
+            mId.mTrigrams.remove (record);
+        }
+    }
+}
+
+bool CSMTools::SearchIndex::find (Search::Type type, const std::string& text,
+    std::vector<int>& rows)
+{
+    if (type!=Search::Type_Text && type!=Search::Type_Id)
+        return false;
+
+    std::vector<Trigram> trigrams;
+    getTrigrams (QString::fromUtf8 (text.c_str()), trigrams);
+
+    // Too short to be indexed
+    if (trigrams.empty())
+        return false;
+
+    update();
+
+    const Index& index = type==Search::Type_Text ? mText : mId;
+
+    std::vector<int> records;
+    index.mTrigrams.find (trigrams, records);
+
+    rows.clear();
+
+    for (std::vector<int>::const_iterator iter (records.begin()); iter!=records.end(); ++iter)
+    {
+        QModelIndex modelIndex = mModel->getModelIndex (mRecordIds[*iter], mIdColumn);
+
+        if (modelIndex.isValid())
+            rows.push_back (modelIndex.row());
+    }
+
+    std::sort (rows.begin(), rows.end());
+
+    return true;
+}
+
+void CSMTools::SearchIndex::dataChanged (const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+    QModelIndex top = topLeft;
+    while (top.parent().isValid())
+        top = top.parent();
+
+    QModelIndex bottom = bottomRight;
+    while (bottom.parent().isValid())
+        bottom = bottom.parent();
+
+    markDirty (top.row(), bottom.row());
+}
+
+void CSMTools::SearchIndex::rowsInserted (const QModelIndex& parent, int first, int last)
+{
+    if (parent.isValid())
+    {
+        // nested rows
+        QModelIndex top = parent;
+        while (top.parent().isValid())
+            top = top.parent();
+
+        markDirty (top.row(), top.row());
+    }
+    else
+        markDirty (first, last);
+}
+
+void CSMTools::SearchIndex::rowsAboutToBeRemoved (const QModelIndex& parent, int first, int last)
+{
+    rowsInserted (parent, first, last);
+}
+
+void CSMTools::SearchIndex::modelReset()
+{
+    QMutexLocker lock (&mMutex);
+    mReset = true;
+    mDirty.clear();
+}
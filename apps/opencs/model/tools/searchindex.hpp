@@ -0,0 +1,94 @@
+#ifndef CSM_TOOLS_SEARCHINDEX_H
+#define CSM_TOOLS_SEARCHINDEX_H
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <QObject>
+#include <QMutex>
+
+#include "search.hpp"
+#include "trigramindex.hpp"
+
+class QModelIndex;
+class QString;
+
+namespace CSMWorld
+{
+    class IdTableBase;
+}
+
+namespace CSMTools
+{
+    /// \brief Inverted index over the text and ID columns of a table
+    ///
+    /// Maps case-folded character trigrams to the records containing them, so that plain text
+    /// and ID searches only need to look at records that can possibly match. Record IDs are
+    /// stored once and referred to by index.
+    ///
+    /// Changes to the model only flag the affected records. They are re-indexed the next time
+    /// the index is updated, which may happen in the thread performing the search.
+    class SearchIndex : public QObject
+    {
+            Q_OBJECT
+
+            typedef TrigramIndex::Trigram Trigram;
+
+            struct Index
+            {
+                std::set<int> mColumns;
+                TrigramIndex mTrigrams;
+            };
+
+            const CSMWorld::IdTableBase *mModel;
+            int mIdColumn;
+            Index mText;
+            Index mId;
+            std::vector<std::string> mRecordIds;
+            std::unordered_map<std::string, int> mRecords;
+            bool mBuilt;
+
+            QMutex mMutex;
+            std::set<std::string> mDirty;
+            bool mReset;
+
+            static void getTrigrams (const QString& text, std::vector<Trigram>& trigrams);
+
+            void markDirty (int first, int last);
+
+            /// \return Index of the record \a id, which is added if required.
+            int getRecord (const std::string& id);
+
+            void addRecord (Index& index, int record, int row);
+
+            void build();
+
+        public:
+
+            SearchIndex (const CSMWorld::IdTableBase *model);
+
+            /// Bring the index up to date with the model.
+            void update();
+
+            /// Store the rows of all records that may match \a text in \a rows, in ascending
+            /// order. Updates the index if required.
+            ///
+            /// \return Can the index be used for this search? If not, \a rows is left unchanged
+            /// and all rows must be searched.
+            bool find (Search::Type type, const std::string& text, std::vector<int>& rows);
+
+        private slots:
+
+            void dataChanged (const QModelIndex& topLeft, const QModelIndex& bottomRight);
+
+            void rowsInserted (const QModelIndex& parent, int first, int last);
+
+            void rowsAboutToBeRemoved (const QModelIndex& parent, int first, int last);
+
+            void modelReset();
+    };
+}
+
+#endif
@@ -5,7 +5,7 @@
 #include "searchoperation.hpp"
 
 CSMTools::SearchStage::SearchStage (const CSMWorld::IdTableBase *model)
-: mModel (model), mOperation (0)
+: mModel (model), mOperation (0), mIndex (new SearchIndex (model)), mIndexed (false)
 {}
 
 int CSMTools::SearchStage::setup()
@@ -14,13 +14,17 @@ int CSMTools::SearchStage::setup()
         mSearch = mOperation->getSearch();
 
     mSearch.configure (mModel);
-        
-    return mModel->rowCount();
+
+    // Plain text searches only need to look at rows found by the index. Everything else
+    // falls back to searching all rows.
+    mIndexed = mIndex->find (mSearch.getType(), mSearch.getText(), mRows);
+
+    return mIndexed ? static_cast<int> (mRows.size()) : mModel->rowCount();
 }
 
 void CSMTools::SearchStage::perform (int stage, CSMDoc::Messages& messages)
 {
-    mSearch.searchRow (mModel, stage, messages);
+    mSearch.searchRow (mModel, mIndexed ? mRows[stage] : stage, messages);
 }
 
 void CSMTools::SearchStage::setOperation (const SearchOperation *operation)
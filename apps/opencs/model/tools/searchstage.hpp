@@ -1,9 +1,13 @@
 #ifndef CSM_TOOLS_SEARCHSTAGE_H
 #define CSM_TOOLS_SEARCHSTAGE_H
 
+#include <memory>
+#include <vector>
+
 #include "../doc/stage.hpp"
 
 #include "search.hpp"
+#include "searchindex.hpp"
 
 namespace CSMWorld
 {
@@ -19,6 +23,9 @@ namespace CSMTools
             const CSMWorld::IdTableBase *mModel;
             Search mSearch;
             const SearchOperation *mOperation;
+            std::unique_ptr<SearchIndex> mIndex;
+            bool mIndexed;
+            std::vector<int> mRows;
 
         public:
 
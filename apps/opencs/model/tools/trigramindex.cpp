@@ -0,0 +1,106 @@
+#include "trigramindex.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+void CSMTools::TrigramIndex::getTrigrams (const std::u16string& text, std::vector<Trigram>& trigrams)
+{
+    for (std::size_t i=0; i+2<text.size(); ++i)
+        trigrams.push_back (
+            (static_cast<Trigram> (text[i])<<32) |
+            (static_cast<Trigram> (text[i+1])<<16) |
+            static_cast<Trigram> (text[i+2]));
+
+    std::sort (trigrams.begin(), trigrams.end());
+    trigrams.erase (std::unique (trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+void CSMTools::TrigramIndex::add (int record, std::vector<Trigram> trigrams)
+{
+    remove (record);
+
+    std::sort (trigrams.begin(), trigrams.end());
+    trigrams.erase (std::unique (trigrams.begin(), trigrams.end()), trigrams.end());
+
+    for (std::vector<Trigram>::const_iterator iter (trigrams.begin()); iter!=trigrams.end(); ++iter)
+    {
+        std::vector<int>& records = mRecords[*iter];
+        records.insert (std::lower_bound (records.begin(), records.end(), record), record);
+    }
+
+    if (static_cast<std::size_t> (record)>=mTrigrams.size())
+        mTrigrams.resize (record+1);
+
+    mTrigrams[record].swap (trigrams);
+}
+
+void CSMTools::TrigramIndex::remove (int record)
+{
+    if (static_cast<std::size_t> (record)>=mTrigrams.size())
+        return;
+
+    std::vector<Trigram>& trigrams = mTrigrams[record];
+
+    for (std::vector<Trigram>::const_iterator iter (trigrams.begin()); iter!=trigrams.end(); ++iter)
+    {
+        std::unordered_map<Trigram, std::vector<int> >::iterator records = mRecords.find (*iter);
+
+        if (records!=mRecords.end())
+        {
+            std::vector<int>::iterator found =
+                std::lower_bound (records->second.begin(), records->second.end(), record);
+
+            if (found!=records->second.end() && *found==record)
+                records->second.erase (found);
+
+            if (records->second.empty())
+                mRecords.erase (records);
+        }
+    }
+
+    std::vector<Trigram>().swap (trigrams);
+}
+
+void CSMTools::TrigramIndex::clear()
+{
+    mRecords.clear();
+    mTrigrams.clear();
+}
+
+void CSMTools::TrigramIndex::find (const std::vector<Trigram>& trigrams,
+    std::vector<int>& records) const
+{
+    records.clear();
+
+    std::vector<const std::vector<int> *> lists;
+
+    for (std::vector<Trigram>::const_iterator iter (trigrams.begin()); iter!=trigrams.end(); ++iter)
+    {
+        std::unordered_map<Trigram, std::vector<int> >::const_iterator found = mRecords.find (*iter);
+
+        if (found==mRecords.end())
+            return;
+
+        lists.push_back (&found->second);
+    }
+
+    if (lists.empty())
+        return;
+
+    // Start with the rarest trigram, so that the intermediate results stay small.
+    std::sort (lists.begin(), lists.end(),
+        [] (const std::vector<int> *left, const std::vector<int> *right)
+        { return left->size()<right->size(); });
+
+    records = *lists.front();
+
+    std::vector<int> intersection;
+
+    for (std::size_t i=1; i<lists.size() && !records.empty(); ++i)
+    {
+        intersection.clear();
+        std::set_intersection (records.begin(), records.end(), lists[i]->begin(), lists[i]->end(),
+            std::back_inserter (intersection));
+        records.swap (intersection);
+    }
+}
@@ -0,0 +1,44 @@
+#ifndef CSM_TOOLS_TRIGRAMINDEX_H
+#define CSM_TOOLS_TRIGRAMINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace CSMTools
+{
+    /// \brief Maps character trigrams to the records containing them
+    ///
+    /// Records are identified by small integer indices. Posting lists are kept as sorted
+    /// vectors, so that candidates can be found by intersecting them.
+    class TrigramIndex
+    {
+        public:
+
+            typedef std::uint64_t Trigram;
+
+        private:
+
+            std::unordered_map<Trigram, std::vector<int> > mRecords;
+            std::vector<std::vector<Trigram> > mTrigrams;
+
+        public:
+
+            /// Store the sorted and unique trigrams of \a text in \a trigrams. \a text must be
+            /// case-folded already.
+            static void getTrigrams (const std::u16string& text, std::vector<Trigram>& trigrams);
+
+            /// Replace the trigrams of \a record.
+            void add (int record, std::vector<Trigram> trigrams);
+
+            void remove (int record);
+
+            void clear();
+
+            /// Store the records containing all of \a trigrams in \a records, in ascending order.
+            void find (const std::vector<Trigram>& trigrams, std::vector<int>& records) const;
+    };
+}
+
+#endif
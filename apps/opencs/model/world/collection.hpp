@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <algorithm>
 #include <cctype>
 #include <stdexcept>
@@ -84,8 +85,31 @@ namespace CSMWorld
 
         private:
 
+            typedef std::map<std::string, int> IdMap;
+
+            /// Hashes and compares the IDs pointed to, ignoring case.
+            struct IdHash
+            {
+                std::size_t operator() (const std::string *id) const
+                {
+                    return Misc::StringUtils::ciHash (*id);
+                }
+            };
+
+            struct IdEqual
+            {
+                bool operator() (const std::string *left, const std::string *right) const
+                {
+                    return Misc::StringUtils::ciEqual (*left, *right);
+                }
+            };
+
+            typedef std::unordered_map<const std::string *, IdMap::iterator, IdHash, IdEqual> IdHashMap;
+
             std::vector<Record<ESXRecordT> > mRecords;
-            std::map<std::string, int> mIndex;
+            IdMap mIndex; // lower-case ID -> row
+            IdHashMap mHashIndex; // keys point into mIndex
+            std::vector<IdMap::iterator> mRowIndex; // row -> mIndex entry (mIndex.end() for duplicates)
             std::vector<Column<ESXRecordT> *> mColumns;
 
             // not implemented
@@ -111,6 +135,12 @@ namespace CSMWorld
             int touchRecordImp (const std::string& id);
             ///< Returns the index of the record on success, -1 on failure.
 
+            void updateIndex (int begin, int end);
+            ///< Write row numbers [begin, end) back into the ID index.
+
+            void removeFromIndex (int begin, int end);
+            ///< Drop the IDs of rows [begin, end) from the ID index (the rows are left in place).
+
         public:
 
             Collection();
@@ -139,6 +169,8 @@ namespace CSMWorld
 
             virtual void purge();
             ///< Remove records that are flagged as erased.
+            ///
+            /// \note All erased records are removed in a single pass.
 
             virtual void removeRows (int index, int count) ;
 
@@ -242,15 +274,39 @@ namespace CSMWorld
             std::copy (buffer.begin(), buffer.end(), mRecords.begin()+baseIndex);
 
             // adjust index
-            for (std::map<std::string, int>::iterator iter (mIndex.begin()); iter!=mIndex.end();
-                 ++iter)
-                if (iter->second>=baseIndex && iter->second<baseIndex+size)
-                    iter->second = newOrder.at (iter->second-baseIndex)+baseIndex;
+            std::vector<IdMap::iterator> rowBuffer (size);
+
+            for (int i=0; i<size; ++i)
+                rowBuffer[newOrder[i]] = mRowIndex[baseIndex+i];
+
+            std::copy (rowBuffer.begin(), rowBuffer.end(), mRowIndex.begin()+baseIndex);
+
+            updateIndex (baseIndex, baseIndex+size);
         }
 
         return true;
     }
 
+    template<typename ESXRecordT, typename IdAccessorT>
+    void Collection<ESXRecordT, IdAccessorT>::updateIndex (int begin, int end)
+    {
+        for (int i=begin; i<end; ++i)
+            if (mRowIndex[i]!=mIndex.end())
+                mRowIndex[i]->second = i;
+    }
+
+    template<typename ESXRecordT, typename IdAccessorT>
+    void Collection<ESXRecordT, IdAccessorT>::removeFromIndex (int begin, int end)
+    {
+        for (int i=begin; i<end; ++i)
+            if (mRowIndex[i]!=mIndex.end())
+            {
+                mHashIndex.erase (&mRowIndex[i]->first);
+                mIndex.erase (mRowIndex[i]);
+                mRowIndex[i] = mIndex.end();
+            }
+    }
+
     template<typename ESXRecordT, typename IdAccessorT>
     int Collection<ESXRecordT, IdAccessorT>::cloneRecordImp(const std::string& origin,
         const std::string& destination, UniversalId::Type type)
@@ -338,11 +394,11 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     void Collection<ESXRecordT, IdAccessorT>::add (const ESXRecordT& record)
     {
-        std::string id = Misc::StringUtils::lowerCase (IdAccessorT().getId (record));
+        std::string id = IdAccessorT().getId (record);
 
-        std::map<std::string, int>::iterator iter = mIndex.find (id);
+        int index = searchId (id);
 
-        if (iter==mIndex.end())
+        if (index==-1)
         {
             Record<ESXRecordT> record2;
             record2.mState = Record<ESXRecordT>::State_ModifiedOnly;
@@ -352,7 +408,7 @@ namespace CSMWorld
         }
         else
         {
-            mRecords[iter->second].setModified (record);
+            mRecords[index].setModified (record);
         }
     }
 
@@ -430,41 +486,44 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     void  Collection<ESXRecordT, IdAccessorT>::purge()
     {
-        int i = 0;
+        int size = static_cast<int> (mRecords.size());
+        int target = 0;
 
-        while (i<static_cast<int> (mRecords.size()))
+        for (int i=0; i<size; ++i)
         {
             if (mRecords[i].isErased())
-                removeRows (i, 1);
+            {
+                removeFromIndex (i, i+1);
+            }
             else
-                ++i;
+            {
+                if (target!=i)
+                {
+                    mRecords[target] = mRecords[i];
+                    mRowIndex[target] = mRowIndex[i];
+                }
+
+                ++target;
+            }
+        }
+
+        if (target<size)
+        {
+            mRecords.erase (mRecords.begin()+target, mRecords.end());
+            mRowIndex.erase (mRowIndex.begin()+target, mRowIndex.end());
+            updateIndex (0, target);
         }
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
     void Collection<ESXRecordT, IdAccessorT>::removeRows (int index, int count)
     {
-        mRecords.erase (mRecords.begin()+index, mRecords.begin()+index+count);
+        removeFromIndex (index, index+count);
 
-        typename std::map<std::string, int>::iterator iter = mIndex.begin();
+        mRecords.erase (mRecords.begin()+index, mRecords.begin()+index+count);
+        mRowIndex.erase (mRowIndex.begin()+index, mRowIndex.begin()+index+count);
 
-        while (iter!=mIndex.end())
-        {
-            if (iter->second>=index)
-            {
-                if (iter->second>=index+count)
-                {
-                    iter->second -= count;
-                    ++iter;
-                }
-                else
-                {
-                    mIndex.erase (iter++);
-                }
-            }
-            else
-                ++iter;
-        }
+        updateIndex (index, static_cast<int> (mRowIndex.size()));
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -485,14 +544,12 @@ namespace CSMWorld
     template<typename ESXRecordT, typename IdAccessorT>
     int Collection<ESXRecordT, IdAccessorT>::searchId (const std::string& id) const
     {
-        std::string id2 = Misc::StringUtils::lowerCase(id);
-
-        std::map<std::string, int>::const_iterator iter = mIndex.find (id2);
+        typename IdHashMap::const_iterator iter = mHashIndex.find (&id);
 
-        if (iter==mIndex.end())
+        if (iter==mHashIndex.end())
             return -1;
 
-        return iter->second;
+        return iter->second->second;
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
@@ -554,18 +611,17 @@ namespace CSMWorld
 
         const Record<ESXRecordT>& record2 = dynamic_cast<const Record<ESXRecordT>&> (record);
 
-        mRecords.insert (mRecords.begin()+index, record2);
+        std::pair<IdMap::iterator, bool> result = mIndex.insert (std::make_pair (
+            Misc::StringUtils::lowerCase (IdAccessorT().getId (record2.get())), index));
 
-        if (index<static_cast<int> (mRecords.size())-1)
-        {
-            for (std::map<std::string, int>::iterator iter (mIndex.begin()); iter!=mIndex.end();
-                ++iter)
-                 if (iter->second>=index)
-                     ++(iter->second);
-        }
+        if (result.second)
+            mHashIndex.insert (std::make_pair (&result.first->first, result.first));
+
+        mRecords.insert (mRecords.begin()+index, record2);
+        mRowIndex.insert (mRowIndex.begin()+index, result.second ? result.first : mIndex.end());
 
-        mIndex.insert (std::make_pair (Misc::StringUtils::lowerCase (IdAccessorT().getId (
-            record2.get())), index));
+        // only the rows behind the new record need to be renumbered
+        updateIndex (index, static_cast<int> (mRowIndex.size()));
     }
 
     template<typename ESXRecordT, typename IdAccessorT>
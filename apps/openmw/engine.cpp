@@ -1,5 +1,6 @@
 #include "engine.hpp"
 
+#include <algorithm>
 #include <iomanip>
 
 #include <boost/filesystem/fstream.hpp>
@@ -44,6 +45,7 @@
 #include "mwsound/soundmanagerimp.hpp"
 
 #include "mwworld/class.hpp"
+#include "mwworld/localscripts.hpp"
 #include "mwworld/player.hpp"
 #include "mwworld/worldimp.hpp"
 
@@ -71,15 +73,55 @@ namespace
 void OMW::Engine::executeLocalScripts()
 {
     MWWorld::LocalScripts& localScripts = mEnvironment.getWorld()->getLocalScripts();
+    MWBase::ScriptManager* scriptManager = mEnvironment.getScriptManager();
+
+    // a single run taking longer than this is reported
+    const double slowScriptTime = 0.002;
+
+    osg::Timer* timer = osg::Timer::instance();
+    const osg::Timer_t startTick = timer->tick();
+    osg::Timer_t lastTick = startTick;
 
     localScripts.startIteration();
-    std::pair<std::string, MWWorld::Ptr> script;
-    while (localScripts.getNext(script))
+    while (MWWorld::LocalScripts::Script* script = localScripts.getNext())
     {
-        MWScript::InterpreterContext interpreterContext (
-            &script.second.getRefData().getLocals(), script.second);
-        mEnvironment.getScriptManager()->run (script.first, interpreterContext);
+        if (!script->mCompiled)
+            script->mCompiled = &scriptManager->getCompiledScript (script->mName);
+
+        // the entry may move while the script runs, if new local scripts are added
+        MWScript::CompiledScript& compiled = *script->mCompiled;
+        MWWorld::Ptr ptr = script->mPtr;
+
+        MWScript::InterpreterContext interpreterContext (&ptr.getRefData().getLocals(), ptr);
+        scriptManager->run (compiled, interpreterContext);
+
+        const osg::Timer_t tick = timer->tick();
+        const double cost = timer->delta_s (lastTick, tick);
+        lastTick = tick;
+        ++mLocalScriptsRun;
+
+        if (cost>slowScriptTime)
+            ++mLocalScriptsSlow;
+
+        if ((script = localScripts.getCurrent()))
+        {
+            script->mCost = cost;
+
+            if (cost>slowScriptTime && !script->mSlow)
+            {
+                script->mSlow = true;
+                Log(Debug::Warning) << "Warning: local script " << script->mName << " on "
+                    << ptr.getCellRef().getRefId() << " took " << cost*1000 << " ms";
+            }
+        }
+
+        // scripts that did not fit into the budget are run first in the next frame
+        if (mLocalScriptsBudget>0 && timer->delta_s (startTick, tick)>=mLocalScriptsBudget)
+            break;
     }
+
+    const std::size_t size = localScripts.getSize();
+    mLocalScriptsDeferred = size>mLocalScriptsRun ? size-mLocalScriptsRun : 0;
 }
 
 bool OMW::Engine::frame(float frametime)
@@ -111,6 +153,10 @@ bool OMW::Engine::frame(float frametime)
 
         bool guiActive = mEnvironment.getWindowManager()->isGuiMode();
 
+        mLocalScriptsRun = 0;
+        mLocalScriptsDeferred = 0;
+        mLocalScriptsSlow = 0;
+
         osg::Timer_t beforeScriptTick = osg::Timer::instance()->tick();
         if (mEnvironment.getStateManager()->getState()==
             MWBase::StateManager::State_Running)
@@ -201,6 +247,10 @@ bool OMW::Engine::frame(float frametime)
             stats->setAttribute(frameNumber, "WorkQueue", mWorkQueue->getNumItems());
             stats->setAttribute(frameNumber, "WorkThread", mWorkQueue->getNumActiveThreads());
 
+            stats->setAttribute(frameNumber, "Local Scripts", mLocalScriptsRun);
+            stats->setAttribute(frameNumber, "Deferred Scripts", mLocalScriptsDeferred);
+            stats->setAttribute(frameNumber, "Slow Scripts", mLocalScriptsSlow);
+
             mEnvironment.getWorld()->getNavigator()->reportStats(frameNumber, *stats);
         }
 
@@ -231,6 +281,10 @@ OMW::Engine::Engine(Files::ConfigurationManager& configurationManager)
   , mFSStrict (false)
   , mScriptBlacklistUse (true)
   , mNewGame (false)
+  , mLocalScriptsBudget (0)
+  , mLocalScriptsRun (0)
+  , mLocalScriptsDeferred (0)
+  , mLocalScriptsSlow (0)
   , mCfgMgr(configurationManager)
 {
     MWClass::registerClasses();
@@ -561,7 +615,7 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     // Create the world
     mEnvironment.setWorld( new MWWorld::World (mViewer, rootNode, mResourceSystem.get(), mWorkQueue.get(),
         mFileCollections, mContentFiles, mEncoder, mActivationDistanceOverride, mCellName,
-        mStartupScript, mResDir.string(), mCfgMgr.getUserDataPath().string()));
+        mStartupScript, mResDir.string(), mCfgMgr.getUserDataPath().string(), mCfgMgr.getCachePath().string()));
     mEnvironment.getWorld()->setupPlayer();
     input->setPlayer(&mEnvironment.getWorld()->getPlayer());
 
@@ -698,6 +752,8 @@ void OMW::Engine::go()
 
     mEnvironment.setFrameRateLimit(Settings::Manager::getFloat("framerate limit", "Video"));
 
+    mLocalScriptsBudget = std::max(0.f, Settings::Manager::getFloat("local scripts time budget", "Game")) / 1000.0;
+
     prepareEngine (settings);
 
     // Setup profiler
@@ -111,6 +111,11 @@ namespace OMW
             bool mScriptBlacklistUse;
             bool mNewGame;
 
+            double mLocalScriptsBudget; // seconds per frame, 0 for no limit
+            std::size_t mLocalScriptsRun;
+            std::size_t mLocalScriptsDeferred;
+            std::size_t mLocalScriptsSlow;
+
             osg::Timer_t mStartTick;
 
             // not implemented
@@ -16,6 +16,7 @@ namespace Compiler
 namespace MWScript
 {
     class GlobalScripts;
+    struct CompiledScript;
 }
 
 namespace MWBase
@@ -38,6 +39,15 @@ namespace MWBase
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext) = 0;
             ///< Run the script with the given name (compile first, if not compiled yet)
 
+            virtual MWScript::CompiledScript& getCompiledScript (const std::string& name) = 0;
+            ///< Return the script with the given name (compile first, if not compiled yet).
+            ///
+            /// The returned reference stays valid for the lifetime of the script manager and can be
+            /// used to run the script repeatedly without looking it up again.
+
+            virtual void run (MWScript::CompiledScript& script, Interpreter::Context& interpreterContext) = 0;
+            ///< Run a script returned by getCompiledScript.
+
             virtual bool compile (const std::string& name) = 0;
             ///< Compile script with the given namen
             /// \return Success?
@@ -110,6 +110,9 @@ namespace MWBase
             virtual void readRecord (ESM::ESMReader& reader, uint32_t type,
                 const std::map<int, int>& contentFileMap) = 0;
 
+            virtual void readRecordsDone() = 0;
+            ///< Called after all records of a saved game have been read.
+
             virtual MWWorld::CellStore *getExterior (int x, int y) = 0;
 
             virtual MWWorld::CellStore *getInterior (const std::string& name) = 0;
@@ -445,7 +445,8 @@ namespace MWClass
 
         if(stats.isDead())
         {
-            bool canLoot = Settings::Manager::getBool ("can loot during death animation", "Game");
+            static const Settings::SettingValue<bool> canLootDuringDeathAnimation("can loot during death animation", "Game");
+            bool canLoot = canLootDuringDeathAnimation.get();
 
             // by default user can loot friendly actors during death animation
             if (canLoot && !stats.getAiSequence().isInCombat())
@@ -87,7 +87,8 @@ namespace MWClass
             if (creature)
             {
                 int soul = creature->mData.mSoul;
-                if (Settings::Manager::getBool("rebalance soul gem values", "Game"))
+                static const Settings::SettingValue<bool> rebalanceSoulGemValues("rebalance soul gem values", "Game");
+                if (rebalanceSoulGemValues.get())
                 {
                     // use the 'soul gem value rebalance' formula from the Morrowind Code Patch 
                     float soulValue = 0.0001 * pow(soul, 3) + 2 * soul;
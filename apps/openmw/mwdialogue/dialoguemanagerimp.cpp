@@ -54,6 +54,7 @@ namespace MWDialogue
       , mTalkedTo(false)
       , mTemporaryDispositionChange(0.f)
       , mPermanentDispositionChange(0.f)
+      , mTopicKeywordsLoaded(false)
     {
         mChoice = -1;
         mIsInChoice = false;
@@ -67,6 +68,8 @@ namespace MWDialogue
         mTalkedTo = false;
         mTemporaryDispositionChange = 0;
         mPermanentDispositionChange = 0;
+        mTopicKeywords.clear();
+        mTopicKeywordsLoaded = false;
     }
 
     void DialogueManager::addTopic (const std::string& topic)
@@ -77,7 +80,17 @@ namespace MWDialogue
     void DialogueManager::parseText (const std::string& text)
     {
         updateActorKnownTopics();
-        std::vector<HyperTextParser::Token> hypertext = HyperTextParser::parseHyperText(text);
+
+        if (!mTopicKeywordsLoaded)
+        {
+            const MWWorld::Store<ESM::Dialogue>& dialogs =
+                MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
+            for (MWWorld::Store<ESM::Dialogue>::iterator it = dialogs.begin(); it != dialogs.end(); ++it)
+                mTopicKeywords.seed(Misc::StringUtils::lowerCase(it->mId), 0 /*unused*/);
+            mTopicKeywordsLoaded = true;
+        }
+
+        std::vector<HyperTextParser::Token> hypertext = HyperTextParser::parseHyperText(text, mTopicKeywords);
 
         for (std::vector<HyperTextParser::Token>::iterator tok = hypertext.begin(); tok != hypertext.end(); ++tok)
         {
@@ -126,7 +139,7 @@ namespace MWDialogue
         const MWWorld::Store<ESM::Dialogue> &dialogs =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
-        Filter filter (actor, mChoice, mTalkedTo);
+        Filter filter (actor, mChoice, mTalkedTo, &mInfoIndices);
 
         for (MWWorld::Store<ESM::Dialogue>::iterator it = dialogs.begin(); it != dialogs.end(); ++it)
         {
@@ -230,7 +243,7 @@ namespace MWDialogue
 
     void DialogueManager::executeTopic (const std::string& topic, ResponseCallback* callback)
     {
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, &mInfoIndices);
 
         const MWWorld::Store<ESM::Dialogue> &dialogues =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
@@ -303,7 +316,7 @@ namespace MWDialogue
         const MWWorld::Store<ESM::Dialogue> &dialogs =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
-        Filter filter (mActor, -1, mTalkedTo);
+        Filter filter (mActor, -1, mTalkedTo, &mInfoIndices);
 
         for (MWWorld::Store<ESM::Dialogue>::iterator iter = dialogs.begin(); iter != dialogs.end(); ++iter)
         {
@@ -377,7 +390,7 @@ namespace MWDialogue
         const ESM::Dialogue* dialogue = searchDialogue(mLastTopic);
         if (dialogue)
         {
-            Filter filter (mActor, mChoice, mTalkedTo);
+            Filter filter (mActor, mChoice, mTalkedTo, &mInfoIndices);
 
             if (dialogue->mType == ESM::Dialogue::Topic || dialogue->mType == ESM::Dialogue::Greeting)
             {
@@ -510,7 +523,7 @@ namespace MWDialogue
 
     bool DialogueManager::checkServiceRefused(ResponseCallback* callback)
     {
-        Filter filter (mActor, mChoice, mTalkedTo);
+        Filter filter (mActor, mChoice, mTalkedTo, &mInfoIndices);
 
         const MWWorld::Store<ESM::Dialogue> &dialogues =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
@@ -562,7 +575,7 @@ namespace MWDialogue
         const ESM::Dialogue *dial = store.get<ESM::Dialogue>().find(topic);
 
         const MWMechanics::CreatureStats& creatureStats = actor.getClass().getCreatureStats(actor);
-        Filter filter(actor, 0, creatureStats.hasTalkedToPlayer());
+        Filter filter(actor, 0, creatureStats.hasTalkedToPlayer(), &mInfoIndices);
         const ESM::DialInfo *info = filter.search(*dial, false);
         if(info != nullptr)
         {
@@ -14,6 +14,9 @@
 
 #include "../mwscript/compilercontext.hpp"
 
+#include "infoindex.hpp"
+#include "hypertextparser.hpp"
+
 namespace ESM
 {
     struct Dialogue;
@@ -48,6 +51,12 @@ namespace MWDialogue
             float mTemporaryDispositionChange;
             float mPermanentDispositionChange;
 
+            InfoIndexCache mInfoIndices;
+
+            // built on first use from the dialogue store, dropped by clear()
+            HyperTextParser::TopicKeywords mTopicKeywords;
+            bool mTopicKeywordsLoaded;
+
             void parseText (const std::string& text);
 
             void updateActorKnownTopics();
@@ -23,83 +23,24 @@
 
 bool MWDialogue::Filter::testActor (const ESM::DialInfo& info) const
 {
-    bool isCreature = (mActor.getTypeName() != typeid (ESM::NPC).name());
-
-    // actor id
-    if (!info.mActor.empty())
-    {
-        if ( !Misc::StringUtils::ciEqual(info.mActor, mActor.getCellRef().getRefId()))
-            return false;
-    }
-    else if (isCreature)
-    {
-        // Creatures must not have topics aside of those specific to their id
+    // actor id, race, class and faction
+    if (!InfoIndex::matchesSpeaker (info, mSpeaker))
         return false;
-    }
-
-    // NPC race
-    if (!info.mRace.empty())
-    {
-        if (isCreature)
-            return true;
-
-        MWWorld::LiveCellRef<ESM::NPC> *cellRef = mActor.get<ESM::NPC>();
-
-        if (!Misc::StringUtils::ciEqual(info.mRace, cellRef->mBase->mRace))
-            return false;
-    }
-
-    // NPC class
-    if (!info.mClass.empty())
-    {
-        if (isCreature)
-            return true;
-
-        MWWorld::LiveCellRef<ESM::NPC> *cellRef = mActor.get<ESM::NPC>();
-
-        if ( !Misc::StringUtils::ciEqual(info.mClass, cellRef->mBase->mClass))
-            return false;
-    }
 
-    // NPC faction
-    if (info.mFactionLess)
-    {
-        if (isCreature)
-            return true;
-
-        if (!mActor.getClass().getPrimaryFaction(mActor).empty())
-            return false;
-    }
-    else if (!info.mFaction.empty())
-    {
-        if (isCreature)
-            return true;
-
-        if (!Misc::StringUtils::ciEqual(mActor.getClass().getPrimaryFaction(mActor), info.mFaction))
-            return false;
+    if (mSpeaker.mCreature)
+        return true;
 
-        // check rank
-        if (mActor.getClass().getPrimaryFactionRank(mActor) < info.mData.mRank)
-            return false;
-    }
-    else if (info.mData.mRank != -1)
+    // NPC faction rank. Without a faction given, use the actor's faction, if there is one.
+    if (!info.mFactionLess && (!info.mFaction.empty() || info.mData.mRank != -1))
     {
-        if (isCreature)
-            return true;
-
-        // Rank requirement, but no faction given. Use the actor's faction, if there is one.
-        // check rank
         if (mActor.getClass().getPrimaryFactionRank(mActor) < info.mData.mRank)
             return false;
     }
 
     // Gender
-    if (!isCreature)
-    {
-        MWWorld::LiveCellRef<ESM::NPC>* npc = mActor.get<ESM::NPC>();
-        if (info.mData.mGender==(npc->mBase->mFlags & npc->mBase->Female ? 0 : 1))
-            return false;
-    }
+    MWWorld::LiveCellRef<ESM::NPC>* npc = mActor.get<ESM::NPC>();
+    if (info.mData.mGender==(npc->mBase->mFlags & npc->mBase->Female ? 0 : 1))
+        return false;
 
     return true;
 }
@@ -148,16 +89,26 @@ bool MWDialogue::Filter::testPlayer (const ESM::DialInfo& info) const
     return true;
 }
 
-bool MWDialogue::Filter::testSelectStructs (const ESM::DialInfo& info) const
+bool MWDialogue::Filter::testSelectStructs (const SelectWrapper *begin, const SelectWrapper *end) const
 {
-    for (std::vector<ESM::DialInfo::SelectStruct>::const_iterator iter (info.mSelects.begin());
-        iter != info.mSelects.end(); ++iter)
+    for (const SelectWrapper *iter = begin; iter!=end; ++iter)
         if (!testSelectStruct (*iter))
             return false;
 
     return true;
 }
 
+bool MWDialogue::Filter::testInfo (const InfoIndex& index, std::size_t info) const
+{
+    return testActor (index.getInfo (info)) && testPlayer (index.getInfo (info)) &&
+        testSelectStructs (index.getSelectsBegin (info), index.getSelectsEnd (info));
+}
+
+const MWDialogue::InfoIndex& MWDialogue::Filter::getIndex (const ESM::Dialogue& dialogue) const
+{
+    return (mIndices ? *mIndices : mLocalIndices).get (dialogue);
+}
+
 bool MWDialogue::Filter::testDisposition (const ESM::DialInfo& info, bool invert) const
 {
     bool isCreature = (mActor.getTypeName() != typeid (ESM::NPC).name());
@@ -612,9 +563,25 @@ bool MWDialogue::Filter::hasFactionRankReputationRequirements (const MWWorld::Pt
     return stats.getFactionReputation (factionId)>=faction.mData.mRankData[rank].mFactReaction;
 }
 
-MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer)
-: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer)
-{}
+MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer, InfoIndexCache *indices)
+: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer), mIndices (indices)
+{
+    mSpeaker.mCreature = true;
+
+    if (!mActor.isEmpty())
+    {
+        mSpeaker.mId = Misc::StringUtils::lowerCase (mActor.getCellRef().getRefId());
+        mSpeaker.mCreature = mActor.getTypeName() != typeid (ESM::NPC).name();
+
+        if (!mSpeaker.mCreature)
+        {
+            MWWorld::LiveCellRef<ESM::NPC> *cellRef = mActor.get<ESM::NPC>();
+            mSpeaker.mRace = Misc::StringUtils::lowerCase (cellRef->mBase->mRace);
+            mSpeaker.mClass = Misc::StringUtils::lowerCase (cellRef->mBase->mClass);
+            mSpeaker.mFaction = Misc::StringUtils::lowerCase (mActor.getClass().getPrimaryFaction (mActor));
+        }
+    }
+}
 
 const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue, const bool fallbackToInfoRefusal) const
 {
@@ -628,11 +595,15 @@ const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue,
 
 std::vector<const ESM::DialInfo *> MWDialogue::Filter::listAll (const ESM::Dialogue& dialogue) const
 {
+    const InfoIndex& index = getIndex (dialogue);
+    std::vector<std::size_t> candidates;
+    index.getCandidates (mSpeaker, candidates);
+
     std::vector<const ESM::DialInfo *> infos;
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin(); iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<std::size_t>::const_iterator iter = candidates.begin(); iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter))
-            infos.push_back(&*iter);
+        if (testActor (index.getInfo (*iter)))
+            infos.push_back(&index.getInfo (*iter));
     }
     return infos;
 }
@@ -644,14 +615,17 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
     bool infoRefusal = false;
 
+    const InfoIndex& index = getIndex (dialogue);
+    std::vector<std::size_t> candidates;
+    index.getCandidates (mSpeaker, candidates);
+
     // Iterate over topic responses to find a matching one
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<std::size_t>::const_iterator iter = candidates.begin(); iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        if (testInfo (index, *iter))
         {
-            if (testDisposition (*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+            if (testDisposition (index.getInfo (*iter), invertDisposition)) {
+                infos.push_back(&index.getInfo (*iter));
                 if (!searchAll)
                     break;
             }
@@ -668,12 +642,12 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
         const MWWorld::Store<ESM::Dialogue> &dialogues =
             MWBase::Environment::get().getWorld()->getStore().get<ESM::Dialogue>();
 
-        const ESM::Dialogue& infoRefusalDialogue = *dialogues.find ("Info Refusal");
+        const InfoIndex& infoRefusalIndex = getIndex (*dialogues.find ("Info Refusal"));
+        infoRefusalIndex.getCandidates (mSpeaker, candidates);
 
-        for (ESM::Dialogue::InfoContainer::const_iterator iter = infoRefusalDialogue.mInfo.begin();
-            iter!=infoRefusalDialogue.mInfo.end(); ++iter)
-            if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter) && testDisposition(*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+        for (std::vector<std::size_t>::const_iterator iter = candidates.begin(); iter!=candidates.end(); ++iter)
+            if (testInfo (infoRefusalIndex, *iter) && testDisposition(infoRefusalIndex.getInfo (*iter), invertDisposition)) {
+                infos.push_back(&infoRefusalIndex.getInfo (*iter));
                 if (!searchAll)
                     break;
             }
@@ -684,10 +658,13 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
 bool MWDialogue::Filter::responseAvailable (const ESM::Dialogue& dialogue) const
 {
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    const InfoIndex& index = getIndex (dialogue);
+    std::vector<std::size_t> candidates;
+    index.getCandidates (mSpeaker, candidates);
+
+    for (std::vector<std::size_t>::const_iterator iter = candidates.begin(); iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        if (testInfo (index, *iter))
             return true;
     }
 
@@ -5,6 +5,8 @@
 
 #include "../mwworld/ptr.hpp"
 
+#include "infoindex.hpp"
+
 namespace ESM
 {
     struct DialInfo;
@@ -13,13 +15,16 @@ namespace ESM
 
 namespace MWDialogue
 {
-    class SelectWrapper;
-
     class Filter
     {
             MWWorld::Ptr mActor;
             int mChoice;
             bool mTalkedToPlayer;
+            InfoIndexCache *mIndices;
+            mutable InfoIndexCache mLocalIndices; // used, if no cache has been passed to the constructor
+            InfoIndex::Speaker mSpeaker;
+
+            const InfoIndex& getIndex (const ESM::Dialogue& dialogue) const;
 
             bool testActor (const ESM::DialInfo& info) const;
             ///< Is this the right actor for this \a info?
@@ -27,9 +32,12 @@ namespace MWDialogue
             bool testPlayer (const ESM::DialInfo& info) const;
             ///< Do the player and the cell the player is currently in match \a info?
 
-            bool testSelectStructs (const ESM::DialInfo& info) const;
+            bool testSelectStructs (const SelectWrapper *begin, const SelectWrapper *end) const;
             ///< Are all select structs matching?
 
+            bool testInfo (const InfoIndex& index, std::size_t info) const;
+            ///< Do actor, player and select structs match? (disposition is ignored for this check)
+
             bool testDisposition (const ESM::DialInfo& info, bool invert=false) const;
             ///< Is the actor disposition toward the player high enough (or low enough, if \a invert is true)?
 
@@ -53,7 +61,8 @@ namespace MWDialogue
 
         public:
 
-            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer);
+            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer, InfoIndexCache *indices = nullptr);
+            ///< \param indices Cache for the indexed infos, shared between filters (optional).
 
             std::vector<const ESM::DialInfo *> list (const ESM::Dialogue& dialogue,
                 bool fallbackToInfoRefusal, bool searchAll, bool invertDisposition=false) const;
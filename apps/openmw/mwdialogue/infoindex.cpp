@@ -0,0 +1,133 @@
+#include "infoindex.hpp"
+
+#include <algorithm>
+
+#include <components/esm/loaddial.hpp>
+#include <components/misc/stringops.hpp>
+
+void MWDialogue::InfoIndex::append (const Buckets& buckets, const std::string& key,
+    std::vector<std::size_t>& candidates)
+{
+    if (key.empty())
+        return;
+
+    Buckets::const_iterator iter = buckets.find (key);
+
+    if (iter!=buckets.end())
+        candidates.insert (candidates.end(), iter->second.begin(), iter->second.end());
+}
+
+bool MWDialogue::InfoIndex::matchesSpeaker (const ESM::DialInfo& info, const Speaker& speaker)
+{
+    // actor id
+    if (!info.mActor.empty())
+    {
+        if (!Misc::StringUtils::ciEqual (info.mActor, speaker.mId))
+            return false;
+    }
+    else if (speaker.mCreature)
+    {
+        // Creatures must not have topics aside of those specific to their id
+        return false;
+    }
+
+    // the remaining conditions are ignored for creatures
+    if (speaker.mCreature)
+        return true;
+
+    // NPC race
+    if (!info.mRace.empty() && !Misc::StringUtils::ciEqual (info.mRace, speaker.mRace))
+        return false;
+
+    // NPC class
+    if (!info.mClass.empty() && !Misc::StringUtils::ciEqual (info.mClass, speaker.mClass))
+        return false;
+
+    // NPC faction
+    if (info.mFactionLess)
+        return speaker.mFaction.empty();
+
+    return info.mFaction.empty() || Misc::StringUtils::ciEqual (info.mFaction, speaker.mFaction);
+}
+
+MWDialogue::InfoIndex::InfoIndex (const ESM::Dialogue& dialogue)
+{
+    mInfos.reserve (dialogue.mInfo.size());
+    mFirstSelect.reserve (dialogue.mInfo.size()+1);
+
+    for (ESM::Dialogue::InfoContainer::const_iterator iter (dialogue.mInfo.begin());
+        iter!=dialogue.mInfo.end(); ++iter)
+    {
+        const ESM::DialInfo& info = *iter;
+        std::size_t index = mInfos.size();
+
+        mInfos.push_back (&info);
+        mFirstSelect.push_back (mSelects.size());
+
+        for (std::vector<ESM::DialInfo::SelectStruct>::const_iterator select (info.mSelects.begin());
+            select!=info.mSelects.end(); ++select)
+            mSelects.push_back (SelectWrapper (*select));
+
+        // same order as the checks in Filter::testActor
+        if (!info.mActor.empty())
+            mActors[Misc::StringUtils::lowerCase (info.mActor)].push_back (index);
+        else if (!info.mRace.empty())
+            mRaces[Misc::StringUtils::lowerCase (info.mRace)].push_back (index);
+        else if (!info.mClass.empty())
+            mClasses[Misc::StringUtils::lowerCase (info.mClass)].push_back (index);
+        else if (!info.mFactionLess && !info.mFaction.empty())
+            mFactions[Misc::StringUtils::lowerCase (info.mFaction)].push_back (index);
+        else
+            mAny.push_back (index);
+    }
+
+    mFirstSelect.push_back (mSelects.size());
+}
+
+void MWDialogue::InfoIndex::getCandidates (const Speaker& speaker, std::vector<std::size_t>& candidates) const
+{
+    candidates.clear();
+
+    append (mActors, speaker.mId, candidates);
+
+    // creatures only use infos specific to their ID
+    if (speaker.mCreature)
+        return;
+
+    append (mRaces, speaker.mRace, candidates);
+    append (mClasses, speaker.mClass, candidates);
+    append (mFactions, speaker.mFaction, candidates);
+    candidates.insert (candidates.end(), mAny.begin(), mAny.end());
+
+    std::sort (candidates.begin(), candidates.end());
+}
+
+std::size_t MWDialogue::InfoIndex::getSize() const
+{
+    return mInfos.size();
+}
+
+const ESM::DialInfo& MWDialogue::InfoIndex::getInfo (std::size_t index) const
+{
+    return *mInfos[index];
+}
+
+const MWDialogue::SelectWrapper *MWDialogue::InfoIndex::getSelectsBegin (std::size_t index) const
+{
+    return mSelects.data()+mFirstSelect[index];
+}
+
+const MWDialogue::SelectWrapper *MWDialogue::InfoIndex::getSelectsEnd (std::size_t index) const
+{
+    return mSelects.data()+mFirstSelect[index+1];
+}
+
+const MWDialogue::InfoIndex& MWDialogue::InfoIndexCache::get (const ESM::Dialogue& dialogue)
+{
+    std::unique_ptr<InfoIndex>& index = mIndices[&dialogue];
+
+    if (!index)
+        index.reset (new InfoIndex (dialogue));
+
+    return *index;
+}
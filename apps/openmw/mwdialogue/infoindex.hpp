@@ -0,0 +1,87 @@
+#ifndef GAME_MWDIALOGUE_INFOINDEX_H
+#define GAME_MWDIALOGUE_INFOINDEX_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "selectwrapper.hpp"
+
+namespace ESM
+{
+    struct DialInfo;
+    struct Dialogue;
+}
+
+namespace MWDialogue
+{
+    /// \brief Infos of a dialogue, bucketed by their speaker conditions
+    ///
+    /// Each info is put into exactly one bucket, chosen by the first of its speaker ID, race, class
+    /// and faction conditions that is set. All of these are necessary conditions, so only the
+    /// buckets matching the speaker can contain infos usable by it.
+    class InfoIndex
+    {
+        public:
+
+            struct Speaker
+            {
+                std::string mId; // all lower case
+                std::string mRace;
+                std::string mClass;
+                std::string mFaction; ///< primary faction
+                bool mCreature;
+            };
+
+        private:
+
+            typedef std::unordered_map<std::string, std::vector<std::size_t> > Buckets;
+
+            std::vector<const ESM::DialInfo *> mInfos;
+            std::vector<std::size_t> mFirstSelect; // one more than mInfos
+            std::vector<SelectWrapper> mSelects;
+            Buckets mActors;
+            Buckets mRaces;
+            Buckets mClasses;
+            Buckets mFactions;
+            std::vector<std::size_t> mAny;
+
+            static void append (const Buckets& buckets, const std::string& key,
+                std::vector<std::size_t>& candidates);
+
+        public:
+
+            InfoIndex (const ESM::Dialogue& dialogue);
+
+            static bool matchesSpeaker (const ESM::DialInfo& info, const Speaker& speaker);
+            ///< Do the speaker ID, race, class and faction conditions of \a info match? Used by
+            /// Filter::testActor, which additionally checks faction rank and gender.
+
+            void getCandidates (const Speaker& speaker, std::vector<std::size_t>& candidates) const;
+            ///< Replace \a candidates with the positions of the infos \a speaker could use, in
+            /// dialogue order. The remaining conditions of these infos still need to be tested.
+
+            std::size_t getSize() const;
+
+            const ESM::DialInfo& getInfo (std::size_t index) const;
+
+            const SelectWrapper *getSelectsBegin (std::size_t index) const;
+            ///< Decoded select structs of the info at \a index.
+
+            const SelectWrapper *getSelectsEnd (std::size_t index) const;
+    };
+
+    /// \brief InfoIndex for each dialogue, built on first use
+    class InfoIndexCache
+    {
+            std::map<const ESM::Dialogue *, std::unique_ptr<InfoIndex> > mIndices;
+
+        public:
+
+            const InfoIndex& get (const ESM::Dialogue& dialogue);
+    };
+}
+
+#endif
@@ -4,14 +4,20 @@
 #include <map>
 #include <cctype>
 #include <stdexcept>
+#include <utility>
 #include <vector>
-#include <algorithm>    // std::reverse
+#include <algorithm>
 
 #include <components/misc/stringops.hpp>
 
 namespace MWDialogue
 {
 
+/// \brief Finds keywords in a text (case-insensitive, ASCII only)
+///
+/// Seeded keywords are collected in a trie. It is compiled into an Aho-Corasick automaton with flat
+/// transition tables when the first search after a change of the keyword set is performed, so that a
+/// text is scanned in a single pass regardless of the number of keywords.
 template <typename string_t, typename value_t>
 class KeywordSearch
 {
@@ -26,46 +32,62 @@ public:
         value_t mValue;
     };
 
+    KeywordSearch() : mDirty (false) {}
+
     void seed (string_t keyword, value_t value)
     {
         if (keyword.empty())
             return;
-        seed_impl  (/*std::move*/ (keyword), /*std::move*/ (value), 0, mRoot);
+
+        Node* node = &mRoot;
+
+        for (Point i = keyword.begin(); i != keyword.end(); ++i)
+            node = &node->mChildren[static_cast<unsigned char> (Misc::StringUtils::toLower (*i))];
+
+        if (node->mKeyword >= 0)
+        {
+            if (mKeywords[node->mKeyword].first == keyword)
+                throw std::runtime_error ("duplicate keyword inserted");
+
+            return; // differs only in case, keep the first one
+        }
+
+        node->mKeyword = static_cast<int> (mKeywords.size());
+        mKeywords.push_back (std::make_pair (keyword, value));
+        mDirty = true;
     }
 
     void clear ()
     {
-        mRoot.mChildren.clear ();
-        mRoot.mKeyword.clear ();
+        mKeywords.clear ();
+        mRoot = Node();
+        mStates.clear ();
+        mEdges.clear ();
+        mDirty = false;
     }
 
     bool containsKeyword (string_t keyword, value_t& value)
     {
-        typename Entry::childen_t::iterator current;
-        typename Entry::childen_t::iterator next;
+        build ();
 
-        current = mRoot.mChildren.find (Misc::StringUtils::toLower (*keyword.begin()));
-        if (current == mRoot.mChildren.end())
+        if (mStates.empty() || keyword.empty())
             return false;
-        else if (current->second.mKeyword.size() && Misc::StringUtils::ciEqual(current->second.mKeyword, keyword))
-        {
-            value = current->second.mValue;
-            return true;
-        }
 
-        for (Point i = ++keyword.begin(); i != keyword.end(); ++i)
+        int state = 0;
+
+        for (Point i = keyword.begin(); i != keyword.end(); ++i)
         {
-            next = current->second.mChildren.find(Misc::StringUtils::toLower (*i));
-            if (next == current->second.mChildren.end())
+            state = findEdge (state, Misc::StringUtils::toLower (*i));
+            if (state < 0)
                 return false;
-            if (Misc::StringUtils::ciEqual(next->second.mKeyword, keyword))
-            {
-                value = next->second.mValue;
-                return true;
-            }
-            current = next;
         }
-        return false;
+
+        int index = mStates[state].mKeyword;
+        if (index < 0 || !Misc::StringUtils::ciEqual (mKeywords[index].first, keyword))
+            return false;
+
+        value = mKeywords[index].second;
+        return true;
     }
 
     static bool sortMatches(const Match& left, const Match& right)
@@ -75,87 +97,47 @@ public:
 
     void highlightKeywords (Point beg, Point end, std::vector<Match>& out)
     {
-        std::vector<Match> matches;
-        for (Point i = beg; i != end; ++i)
-        {
-            // check if previous character marked start of new word
-            if (i != beg)
-            {
-                Point prev = i;
-                --prev;
-                if(isalpha(*prev))
-                    continue;
-            }
+        build ();
 
+        std::vector<Match> matches;
 
-            // check first character
-            typename Entry::childen_t::iterator candidate = mRoot.mChildren.find (Misc::StringUtils::toLower (*i));
+        if (mStates.empty() || beg == end)
+            return;
 
-            // no match, on to next character
-            if (candidate == mRoot.mChildren.end ())
-                continue;
+        // index of the longest keyword starting at each position
+        std::vector<int> longest (end - beg, -1);
 
-            // see how far the match goes
-            Point j = i;
+        int state = 0;
+        for (Point i = beg; i != end; ++i)
+        {
+            state = advance (state, Misc::StringUtils::toLower (*i));
 
-            // some keywords might be longer variations of other keywords, so we definitely need a list of candidates
-            // the first element in the pair is length of the match, i.e. depth from the first character on
-            std::vector< typename std::pair<int, typename Entry::childen_t::iterator> > candidates;
+            int match = mStates[state].mKeyword >= 0 ? state : mStates[state].mOutput;
 
-            while ((j + 1) != end)
+            for (; match >= 0; match = mStates[match].mOutput)
             {
-                typename Entry::childen_t::iterator next = candidate->second.mChildren.find (Misc::StringUtils::toLower (*++j));
+                std::size_t start = (i - beg) + 1 - mStates[match].mDepth;
 
-                if (next == candidate->second.mChildren.end ())
-                {
-                    if (candidate->second.mKeyword.size() > 0)
-                        candidates.push_back(std::make_pair((j-i), candidate));
-                    break;
-                }
-
-                candidate = next;
+                // keywords need to start at the beginning of a word
+                if (start > 0 && isalpha (*(beg + (start - 1))))
+                    continue;
 
-                if (candidate->second.mKeyword.size() > 0)
-                    candidates.push_back(std::make_pair((j-i), candidate));
+                if (longest[start] < 0 || mStates[longest[start]].mDepth < mStates[match].mDepth)
+                    longest[start] = match;
             }
+        }
 
-            if (candidates.empty())
-                continue; // didn't match enough to disambiguate, on to next character
-
-            // shorter candidates will be added to the vector first. however, we want to check against longer candidates first
-            std::reverse(candidates.begin(), candidates.end());
-
-            for (typename std::vector< std::pair<int, typename Entry::childen_t::iterator> >::iterator it = candidates.begin();
-                 it != candidates.end(); ++it)
+        for (std::size_t i = 0; i < longest.size(); ++i)
+            if (longest[i] >= 0)
             {
-                candidate = it->second;
-                // try to match the rest of the keyword
-                Point k = i + it->first;
-                typename string_t::const_iterator t = candidate->second.mKeyword.begin () + (k - i);
-
-
-                while (k != end && t != candidate->second.mKeyword.end ())
-                {
-                    if (Misc::StringUtils::toLower (*k) != Misc::StringUtils::toLower (*t))
-                        break;
-
-                    ++k, ++t;
-                }
-
-                // didn't match full keyword, try the next candidate
-                if (t != candidate->second.mKeyword.end ())
-                    continue;
-
                 // found a keyword, but there might still be longer keywords that start somewhere _within_ this keyword
                 // we will resolve these overlapping keywords later, choosing the longest one in case of conflict
                 Match match;
-                match.mValue = candidate->second.mValue;
-                match.mBeg = i;
-                match.mEnd = k;
+                match.mValue = mKeywords[mStates[longest[i]].mKeyword].second;
+                match.mBeg = beg + i;
+                match.mEnd = beg + i + mStates[longest[i]].mDepth;
                 matches.push_back(match);
-                break;
             }
-        }
 
         // resolve overlapping keywords
         while (!matches.empty())
@@ -201,54 +183,113 @@ public:
 
 private:
 
-    struct Entry
+    struct State
     {
-        typedef std::map <wchar_t, Entry> childen_t;
+        int mFirstEdge; // edges are sorted by character
+        int mEdgeCount;
+        int mFail; // state of the longest proper suffix
+        int mOutput; // closest state in the fail chain that completes a keyword, -1 for none
+        int mKeyword; // index in mKeywords, -1 for none
+        int mDepth;
+    };
 
-        string_t mKeyword;
-        value_t mValue;
-        childen_t mChildren;
+    struct Edge
+    {
+        unsigned char mChar;
+        int mTarget;
     };
 
-    void seed_impl (string_t keyword, value_t value, size_t depth, Entry  & entry)
+    struct Node
     {
-        int ch = Misc::StringUtils::toLower (keyword.at (depth));
+        std::map<unsigned char, Node> mChildren;
+        int mKeyword;
 
-        typename Entry::childen_t::iterator j = entry.mChildren.find (ch);
+        Node() : mKeyword (-1) {}
+    };
 
-        if (j == entry.mChildren.end ())
+    int findEdge (int state, char ch) const
+    {
+        const unsigned char key = static_cast<unsigned char> (ch);
+        const Edge* begin = mEdges.data() + mStates[state].mFirstEdge;
+        const Edge* end = begin + mStates[state].mEdgeCount;
+
+        const Edge* edge = std::lower_bound (begin, end, key,
+            [] (const Edge& left, unsigned char right) { return left.mChar < right; });
+
+        return edge != end && edge->mChar == key ? edge->mTarget : -1;
+    }
+
+    int advance (int state, char ch) const
+    {
+        while (true)
         {
-            entry.mChildren [ch].mValue = /*std::move*/ (value);
-            entry.mChildren [ch].mKeyword = /*std::move*/ (keyword);
+            int next = findEdge (state, ch);
+
+            if (next >= 0)
+                return next;
+
+            if (state == 0)
+                return 0;
+
+            state = mStates[state].mFail;
         }
-        else
+    }
+
+    void build ()
+    {
+        if (!mDirty)
+            return;
+
+        mDirty = false;
+        mStates.clear ();
+        mEdges.clear ();
+
+        // number the states breadth first, so that fail links always point to states that are done already
+        std::vector<const Node*> nodes (1, &mRoot);
+
+        State rootState = { 0, 0, 0, -1, -1, 0 };
+        mStates.push_back (rootState);
+
+        for (std::size_t i = 0; i < nodes.size(); ++i)
         {
-            if (j->second.mKeyword.size () > 0)
-            {
-                if (keyword == j->second.mKeyword)
-                    throw std::runtime_error ("duplicate keyword inserted");
+            const Node& node = *nodes[i];
 
-                value_t pushValue = /*std::move*/ (j->second.mValue);
-                string_t pushKeyword = /*std::move*/ (j->second.mKeyword);
+            mStates[i].mFirstEdge = static_cast<int> (mEdges.size());
+            mStates[i].mEdgeCount = static_cast<int> (node.mChildren.size());
 
-                if (depth >= pushKeyword.size ())
-                    throw std::runtime_error ("unexpected");
+            for (typename std::map<unsigned char, Node>::const_iterator iter = node.mChildren.begin();
+                iter != node.mChildren.end(); ++iter)
+            {
+                Edge edge = { iter->first, static_cast<int> (nodes.size()) };
+                mEdges.push_back (edge);
 
-                if (depth+1 < pushKeyword.size())
-                {
-                    seed_impl (/*std::move*/ (pushKeyword), /*std::move*/ (pushValue), depth+1, j->second);
-                    j->second.mKeyword.clear ();
-                }
+                State state = { 0, 0, 0, -1, iter->second.mKeyword, mStates[i].mDepth + 1 };
+                mStates.push_back (state);
+                nodes.push_back (&iter->second);
             }
-            if (depth+1 == keyword.size())
-                j->second.mKeyword = value;
-            else // depth+1 < keyword.size()
-                seed_impl (/*std::move*/ (keyword), /*std::move*/ (value), depth+1, j->second);
         }
 
+        for (std::size_t i = 0; i < mStates.size(); ++i)
+        {
+            const State& state = mStates[i];
+
+            for (int j = state.mFirstEdge; j < state.mFirstEdge + state.mEdgeCount; ++j)
+            {
+                State& child = mStates[mEdges[j].mTarget];
+
+                child.mFail = i == 0 ? 0 : advance (state.mFail, static_cast<char> (mEdges[j].mChar));
+
+                const State& fail = mStates[child.mFail];
+                child.mOutput = fail.mKeyword >= 0 ? child.mFail : fail.mOutput;
+            }
+        }
     }
 
-    Entry mRoot;
+    std::vector<std::pair<string_t, value_t> > mKeywords;
+    Node mRoot;
+    std::vector<State> mStates;
+    std::vector<Edge> mEdges;
+    bool mDirty;
 };
 
 }
@@ -1,7 +1,7 @@
 #include "selectwrapper.hpp"
 
+#include <cstdlib>
 #include <stdexcept>
-#include <sstream>
 #include <iterator>
 
 #include <components/misc/stringops.hpp>
@@ -43,11 +43,7 @@ namespace
 
 MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunction() const
 {
-    int index = 0;
-
-    std::istringstream (mSelect.mSelectRule.substr(2,2)) >> index;
-
-    switch (index)
+    switch (mIndex)
     {
         case  0: return Function_RankLow;
         case  1: return Function_RankHigh;
@@ -94,41 +90,43 @@ MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunction()
     return Function_False;
 }
 
-MWDialogue::SelectWrapper::SelectWrapper (const ESM::DialInfo::SelectStruct& select) : mSelect (select) {}
-
-MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::getFunction() const
+MWDialogue::SelectWrapper::SelectWrapper (const ESM::DialInfo::SelectStruct& select)
+: mSelect (&select), mIndex (0), mFunction (Function_None)
 {
-    char type = mSelect.mSelectRule[1];
-
-    switch (type)
+    // decode once, the filter queries the function several times per test
+    switch (select.mSelectRule[1])
     {
-        case '1': return decodeFunction();
-        case '2': return Function_Global;
-        case '3': return Function_Local;
-        case '4': return Function_Journal;
-        case '5': return Function_Item;
-        case '6': return Function_Dead;
-        case '7': return Function_NotId;
-        case '8': return Function_NotFaction;
-        case '9': return Function_NotClass;
-        case 'A': return Function_NotRace;
-        case 'B': return Function_NotCell;
-        case 'C': return Function_NotLocal;
+        case '1':
+
+            mIndex = std::atoi (select.mSelectRule.substr (2, 2).c_str());
+            mFunction = decodeFunction();
+            break;
+
+        case '2': mFunction = Function_Global; break;
+        case '3': mFunction = Function_Local; break;
+        case '4': mFunction = Function_Journal; break;
+        case '5': mFunction = Function_Item; break;
+        case '6': mFunction = Function_Dead; break;
+        case '7': mFunction = Function_NotId; break;
+        case '8': mFunction = Function_NotFaction; break;
+        case '9': mFunction = Function_NotClass; break;
+        case 'A': mFunction = Function_NotRace; break;
+        case 'B': mFunction = Function_NotCell; break;
+        case 'C': mFunction = Function_NotLocal; break;
     }
+}
 
-    return Function_None;
+MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::getFunction() const
+{
+    return mFunction;
 }
 
 int MWDialogue::SelectWrapper::getArgument() const
 {
-    if (mSelect.mSelectRule[1]!='1')
+    if (mSelect->mSelectRule[1]!='1')
         return 0;
 
-    int index = 0;
-
-    std::istringstream (mSelect.mSelectRule.substr(2,2)) >> index;
-
-    switch (index)
+    switch (mIndex)
     {
         // AI settings
         case 67: return 1;
@@ -278,20 +276,20 @@ bool MWDialogue::SelectWrapper::isNpcOnly() const
 
 bool MWDialogue::SelectWrapper::selectCompare (int value) const
 {
-    return selectCompareImp (mSelect, value);
+    return selectCompareImp (*mSelect, value);
 }
 
 bool MWDialogue::SelectWrapper::selectCompare (float value) const
 {
-    return selectCompareImp (mSelect, value);
+    return selectCompareImp (*mSelect, value);
 }
 
 bool MWDialogue::SelectWrapper::selectCompare (bool value) const
 {
-    return selectCompareImp (mSelect, static_cast<int> (value));
+    return selectCompareImp (*mSelect, static_cast<int> (value));
 }
 
 std::string MWDialogue::SelectWrapper::getName() const
 {
-    return Misc::StringUtils::lowerCase (mSelect.mSelectRule.substr (5));
+    return Misc::StringUtils::lowerCase (mSelect->mSelectRule.substr (5));
 }
@@ -7,8 +7,6 @@ namespace MWDialogue
 {
     class SelectWrapper
     {
-            const ESM::DialInfo::SelectStruct& mSelect;
-
         public:
 
             enum Function
@@ -57,6 +55,10 @@ namespace MWDialogue
 
         private:
 
+            const ESM::DialInfo::SelectStruct* mSelect;
+            int mIndex;
+            Function mFunction;
+
             Function decodeFunction() const;
 
         public:
@@ -390,6 +390,11 @@ struct TypesetBookImpl::Typesetter : BookTypesetter
 
         add_partial_text();
 
+        // The typesetter may be continued after completing the book (see JournalBooks::createJournalBook),
+        // so the pages are always computed from scratch. Laying out the sections themselves is the
+        // expensive part and is not repeated.
+        mBook->mPages.clear ();
+
         std::vector <Alignment>::iterator sa = mSectionAlignment.begin ();
         for (Sections::iterator i = mBook->mSections.begin (); i != mBook->mSections.end (); ++i, ++sa)
         {
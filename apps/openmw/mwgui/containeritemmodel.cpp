@@ -1,6 +1,9 @@
 #include "containeritemmodel.hpp"
 
 #include <algorithm>
+#include <unordered_map>
+
+#include <components/misc/stringops.hpp>
 
 #include "../mwmechanics/creaturestats.hpp"
 #include "../mwmechanics/actorutil.hpp"
@@ -138,56 +141,44 @@ void ContainerItemModel::removeItem (const ItemStack& item, size_t count)
 void ContainerItemModel::update()
 {
     mItems.clear();
-    for (MWWorld::Ptr& source : mItemSources)
-    {
-        MWWorld::ContainerStore& store = source.getClass().getContainerStore(source);
-
-        for (MWWorld::ContainerStoreIterator it = store.begin(); it != store.end(); ++it)
-        {
-            if (!(*it).getClass().showsInInventory(*it))
-                continue;
 
-            bool found = false;
-            for (ItemStack& itemStack : mItems)
-            {
-                if (stacks(*it, itemStack.mBase))
-                {
-                    // we already have an item stack of this kind, add to it
-                    itemStack.mCount += it->getRefData().getCount();
-                    found = true;
-                    break;
-                }
-            }
+    // Items only stack with items of the same ID, so only those need to be checked. Without this, opening a
+    // container with thousands of items would compare every item with every other one.
+    std::unordered_map<std::string, std::vector<size_t> > stacksById;
 
-            if (!found)
-            {
-                // no stack yet, create one
-                ItemStack newItem (*it, this, it->getRefData().getCount());
-                mItems.push_back(newItem);
-            }
-        }
-    }
-    for (MWWorld::Ptr& source : mWorldItems)
+    auto addItem = [&] (const MWWorld::Ptr& item)
     {
-        bool found = false;
-        for (ItemStack& itemStack : mItems)
+        std::vector<size_t>& candidates = stacksById[Misc::StringUtils::lowerCase(item.getCellRef().getRefId())];
+        for (size_t index : candidates)
         {
-            if (stacks(source, itemStack.mBase))
+            ItemStack& itemStack = mItems[index];
+            if (stacks(item, itemStack.mBase))
             {
                 // we already have an item stack of this kind, add to it
-                itemStack.mCount += source.getRefData().getCount();
-                found = true;
-                break;
+                itemStack.mCount += item.getRefData().getCount();
+                return;
             }
         }
 
-        if (!found)
+        // no stack yet, create one
+        candidates.push_back(mItems.size());
+        mItems.push_back(ItemStack(item, this, item.getRefData().getCount()));
+    };
+
+    for (MWWorld::Ptr& source : mItemSources)
+    {
+        MWWorld::ContainerStore& store = source.getClass().getContainerStore(source);
+
+        for (MWWorld::ContainerStoreIterator it = store.begin(); it != store.end(); ++it)
         {
-            // no stack yet, create one
-            ItemStack newItem (source, this, source.getRefData().getCount());
-            mItems.push_back(newItem);
+            if (!(*it).getClass().showsInInventory(*it))
+                continue;
+
+            addItem(*it);
         }
     }
+    for (MWWorld::Ptr& source : mWorldItems)
+        addItem(source);
 }
 bool ContainerItemModel::onDropItem(const MWWorld::Ptr &item, int count)
 {
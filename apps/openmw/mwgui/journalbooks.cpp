@@ -155,7 +155,7 @@ MWGui::BookTypesetter::Utf8Span to_utf8_span (char const * text)
 typedef TypesetBook::Ptr book;
 
 JournalBooks::JournalBooks (JournalViewModel::Ptr model, ToUTF8::FromType encoding) :
-    mModel (model), mEncoding(encoding), mIndexPagesCount(0)
+    mModel (model), mEncoding(encoding), mIndexPagesCount(0), mJournalEntryCount(0), mJournalTopicCount(0)
 {
 }
 
@@ -175,14 +175,36 @@ book JournalBooks::createEmptyJournalBook ()
 
 book JournalBooks::createJournalBook ()
 {
-    BookTypesetter::Ptr typesetter = createTypesetter ();
+    size_t entryCount = mModel->getJournalEntryCount ();
+    size_t topicCount = mModel->getTopicCount ();
 
-    BookTypesetter::Style* header = typesetter->createStyle ("", MyGUI::Colour (0.60f, 0.00f, 0.00f));
-    BookTypesetter::Style* body   = typesetter->createStyle ("", MyGUI::Colour::Black);
+    if (!mJournalTypesetter || topicCount != mJournalTopicCount || entryCount < mJournalEntryCount)
+    {
+        mJournalTypesetter = createTypesetter ();
+        mJournalEntryCount = 0;
+        mJournalTopicCount = topicCount;
+        mJournalBook.reset ();
+    }
+    else if (entryCount == mJournalEntryCount && mJournalBook)
+        return mJournalBook;
 
-    mModel->visitJournalEntries ("", AddJournalEntry (typesetter, body, header, true));
+    BookTypesetter::Style* header = mJournalTypesetter->createStyle ("", MyGUI::Colour (0.60f, 0.00f, 0.00f));
+    BookTypesetter::Style* body   = mJournalTypesetter->createStyle ("", MyGUI::Colour::Black);
 
-    return typesetter->complete ();
+    mModel->visitJournalEntriesFrom (mJournalEntryCount, AddJournalEntry (mJournalTypesetter, body, header, true));
+
+    mJournalEntryCount = entryCount;
+    mJournalBook = mJournalTypesetter->complete ();
+
+    return mJournalBook;
+}
+
+void JournalBooks::clearJournalBook ()
+{
+    mJournalTypesetter.reset ();
+    mJournalBook.reset ();
+    mJournalEntryCount = 0;
+    mJournalTopicCount = 0;
 }
 
 book JournalBooks::createTopicBook (uintptr_t topicId)
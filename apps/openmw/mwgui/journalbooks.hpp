@@ -24,10 +24,21 @@ namespace MWGui
         Book createQuestBook (const std::string& questName);
         Book createTopicIndexBook ();
 
+        /// Discard the cached layout of the journal book (e.g. when a game is loaded).
+        void clearJournalBook ();
+
         ToUTF8::FromType mEncoding;
         int mIndexPagesCount;
 
     private:
+        // The journal book is kept between calls of createJournalBook, so that only entries added
+        // since the last call need to be laid out. It is rebuilt when the set of topics (and with it
+        // the highlighted keywords) changes.
+        BookTypesetter::Ptr mJournalTypesetter;
+        size_t mJournalEntryCount;
+        size_t mJournalTopicCount;
+        Book mJournalBook;
+
         BookTypesetter::Ptr createTypesetter ();
         BookTypesetter::Ptr createLatinJournalIndex ();
         BookTypesetter::Ptr createCyrillicJournalIndex ();
@@ -1,5 +1,6 @@
 #include "journalviewmodel.hpp"
 
+#include <iterator>
 #include <map>
 #include <sstream>
 
@@ -300,6 +301,32 @@ struct JournalViewModelImpl : JournalViewModel
         }
     }
 
+    void visitJournalEntriesFrom (size_t first, std::function <void (JournalEntry const &)> visitor) const
+    {
+        MWBase::Journal * journal = MWBase::Environment::get().getJournal();
+
+        MWBase::Journal::TEntryIter i = journal->begin();
+        for (size_t skipped = 0; skipped < first && i != journal->end (); ++skipped)
+            ++i;
+
+        for (; i != journal->end (); ++i)
+            visitor (JournalEntryImpl <MWBase::Journal::TEntryIter> (this, i));
+    }
+
+    size_t getJournalEntryCount () const
+    {
+        MWBase::Journal * journal = MWBase::Environment::get().getJournal();
+
+        return std::distance (journal->begin (), journal->end ());
+    }
+
+    size_t getTopicCount () const
+    {
+        MWBase::Journal * journal = MWBase::Environment::get().getJournal();
+
+        return std::distance (journal->topicBegin (), journal->topicEnd ());
+    }
+
     void visitTopicName (TopicId topicId, std::function <void (Utf8Span)> visitor) const
     {
         MWDialogue::Topic const & topic = * reinterpret_cast <MWDialogue::Topic const *> (topicId);
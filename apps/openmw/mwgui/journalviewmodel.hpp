@@ -74,6 +74,15 @@ namespace MWGui
         /// If \a questName is empty, simply visits all journal entries
         virtual void visitJournalEntries (const std::string& questName, std::function <void (JournalEntry const &)> visitor) const = 0;
 
+        /// walks over all journal entries, skipping the first \a first ones
+        virtual void visitJournalEntriesFrom (size_t first, std::function <void (JournalEntry const &)> visitor) const = 0;
+
+        /// returns the number of journal entries
+        virtual size_t getJournalEntryCount () const = 0;
+
+        /// returns the number of topics, which are highlighted as keywords in the journal entries
+        virtual size_t getTopicCount () const = 0;
+
         /// provides the name of the topic specified by its id
         virtual void visitTopicName (TopicId topicId, std::function <void (Utf8Span)> visitor) const = 0;
 
@@ -270,6 +270,12 @@ namespace
             mTopicIndexBook.reset ();
         }
 
+        void clear()
+        {
+            // a new game has been started or a saved game has been loaded
+            clearJournalBook ();
+        }
+
         void setVisible (bool newValue)
         {
             WindowBase::setVisible (newValue);
@@ -25,121 +25,121 @@
 
 namespace
 {
-    bool compareType(const std::string& type1, const std::string& type2)
+    int getTypeOrder(const std::string& type)
     {
         // this defines the sorting order of types. types that are first in the vector appear before other types.
-        std::vector<std::string> mapping;
-        mapping.push_back( typeid(ESM::Weapon).name() );
-        mapping.push_back( typeid(ESM::Armor).name() );
-        mapping.push_back( typeid(ESM::Clothing).name() );
-        mapping.push_back( typeid(ESM::Potion).name() );
-        mapping.push_back( typeid(ESM::Ingredient).name() );
-        mapping.push_back( typeid(ESM::Apparatus).name() );
-        mapping.push_back( typeid(ESM::Book).name() );
-        mapping.push_back( typeid(ESM::Light).name() );
-        mapping.push_back( typeid(ESM::Miscellaneous).name() );
-        mapping.push_back( typeid(ESM::Lockpick).name() );
-        mapping.push_back( typeid(ESM::Repair).name() );
-        mapping.push_back( typeid(ESM::Probe).name() );
-
-        assert( std::find(mapping.begin(), mapping.end(), type1) != mapping.end() );
-        assert( std::find(mapping.begin(), mapping.end(), type2) != mapping.end() );
-
-        return std::find(mapping.begin(), mapping.end(), type1) < std::find(mapping.begin(), mapping.end(), type2);
+        static const std::vector<std::string> mapping = {
+            typeid(ESM::Weapon).name(),
+            typeid(ESM::Armor).name(),
+            typeid(ESM::Clothing).name(),
+            typeid(ESM::Potion).name(),
+            typeid(ESM::Ingredient).name(),
+            typeid(ESM::Apparatus).name(),
+            typeid(ESM::Book).name(),
+            typeid(ESM::Light).name(),
+            typeid(ESM::Miscellaneous).name(),
+            typeid(ESM::Lockpick).name(),
+            typeid(ESM::Repair).name(),
+            typeid(ESM::Probe).name()
+        };
+
+        std::vector<std::string>::const_iterator found = std::find(mapping.begin(), mapping.end(), type);
+        assert(found != mapping.end());
+
+        return static_cast<int>(found - mapping.begin());
     }
 
-    struct Compare
+    /// Everything the items are sorted by, looked up once per item instead of once per comparison
+    struct SortKey
     {
-        bool mSortByType;
-        Compare() : mSortByType(true) {}
-        bool operator() (const MWGui::ItemStack& left, const MWGui::ItemStack& right)
+        int mType;
+        int mTypeOrder;
+        std::string mName;
+        int mChargePercent;
+        bool mHasItemHealth;
+        int mItemHealth;
+        float mRemainingUsageTime;
+        int mValue;
+        float mWeight;
+        std::string mRefId;
+        size_t mIndex;
+
+        SortKey(const MWGui::ItemStack& item, size_t index)
         {
-            if (mSortByType && left.mType != right.mType)
-                return left.mType < right.mType;
-
-            float result = 0;
-
-            // compare items by type
-            std::string leftName = left.mBase.getTypeName();
-            std::string rightName = right.mBase.getTypeName();
-
-            if (leftName != rightName)
-                return compareType(leftName, rightName);
-
-            // compare items by name
-            leftName = Misc::StringUtils::lowerCase(left.mBase.getClass().getName(left.mBase));
-            rightName = Misc::StringUtils::lowerCase(right.mBase.getClass().getName(right.mBase));
+            const MWWorld::Ptr& base = item.mBase;
+            const MWWorld::Class& cls = base.getClass();
 
-            result = leftName.compare(rightName);
-            if (result != 0)
-                return result < 0;
+            mType = item.mType;
+            mTypeOrder = getTypeOrder(base.getTypeName());
+            mName = Misc::StringUtils::lowerCase(cls.getName(base));
 
-            // compare items by enchantment:
             // 1. enchanted items showed before non-enchanted
             // 2. item with lesser charge percent comes after items with more charge percent
             // 3. item with constant effect comes before items with non-constant effects
-            int leftChargePercent = -1;
-            int rightChargePercent = -1;
-            leftName = left.mBase.getClass().getEnchantment(left.mBase);
-            rightName = right.mBase.getClass().getEnchantment(right.mBase);
-
-            if (!leftName.empty())
+            mChargePercent = -1;
+            std::string enchantment = cls.getEnchantment(base);
+            if (!enchantment.empty())
             {
-                const ESM::Enchantment* ench = MWBase::Environment::get().getWorld()->getStore().get<ESM::Enchantment>().search(leftName);
+                const ESM::Enchantment* ench = MWBase::Environment::get().getWorld()->getStore().get<ESM::Enchantment>().search(enchantment);
                 if (ench)
                 {
                     if (ench->mData.mType == ESM::Enchantment::ConstantEffect)
-                        leftChargePercent = 101;
+                        mChargePercent = 101;
                     else
-                        leftChargePercent = static_cast<int>(left.mBase.getCellRef().getNormalizedEnchantmentCharge(ench->mData.mCharge) * 100);
+                        mChargePercent = static_cast<int>(base.getCellRef().getNormalizedEnchantmentCharge(ench->mData.mCharge) * 100);
                 }
             }
 
-            if (!rightName.empty())
-            {
-                const ESM::Enchantment* ench = MWBase::Environment::get().getWorld()->getStore().get<ESM::Enchantment>().search(rightName);
-                if (ench)
-                {
-                    if (ench->mData.mType == ESM::Enchantment::ConstantEffect)
-                        rightChargePercent = 101;
-                    else
-                        rightChargePercent = static_cast<int>(right.mBase.getCellRef().getNormalizedEnchantmentCharge(ench->mData.mCharge) * 100);
-                }
-            }
+            mHasItemHealth = cls.hasItemHealth(base);
+            mItemHealth = mHasItemHealth ? cls.getItemHealth(base) : 0;
+            mRemainingUsageTime = cls.getRemainingUsageTime(base);
+            mValue = cls.getValue(base);
+            mWeight = cls.getWeight(base);
+            mRefId = base.getCellRef().getRefId();
+            mIndex = index;
+        }
+    };
+
+    struct Compare
+    {
+        bool mSortByType;
+        Compare() : mSortByType(true) {}
+        bool operator() (const SortKey& left, const SortKey& right) const
+        {
+            if (mSortByType && left.mType != right.mType)
+                return left.mType < right.mType;
+
+            // compare items by type
+            if (left.mTypeOrder != right.mTypeOrder)
+                return left.mTypeOrder < right.mTypeOrder;
 
-            result = leftChargePercent - rightChargePercent;
+            // compare items by name
+            int result = left.mName.compare(right.mName);
             if (result != 0)
-                return result > 0;
+                return result < 0;
+
+            // compare items by enchantment
+            if (left.mChargePercent != right.mChargePercent)
+                return left.mChargePercent > right.mChargePercent;
 
             // compare items by condition
-            if (left.mBase.getClass().hasItemHealth(left.mBase) && right.mBase.getClass().hasItemHealth(right.mBase))
-            {
-                result = left.mBase.getClass().getItemHealth(left.mBase) - right.mBase.getClass().getItemHealth(right.mBase);
-                if (result != 0)
-                    return result > 0;
-            }
+            if (left.mHasItemHealth && right.mHasItemHealth && left.mItemHealth != right.mItemHealth)
+                return left.mItemHealth > right.mItemHealth;
 
             // compare items by remaining usage time
-            result = left.mBase.getClass().getRemainingUsageTime(left.mBase) - right.mBase.getClass().getRemainingUsageTime(right.mBase);
-            if (result != 0)
-                return result > 0;
+            if (left.mRemainingUsageTime != right.mRemainingUsageTime)
+                return left.mRemainingUsageTime > right.mRemainingUsageTime;
 
             // compare items by value
-            result = left.mBase.getClass().getValue(left.mBase) - right.mBase.getClass().getValue(right.mBase);
-            if (result != 0)
-                return result > 0;
+            if (left.mValue != right.mValue)
+                return left.mValue > right.mValue;
 
             // compare items by weight
-            result = left.mBase.getClass().getWeight(left.mBase) - right.mBase.getClass().getWeight(right.mBase);
-            if (result != 0)
-                return result > 0;
+            if (left.mWeight != right.mWeight)
+                return left.mWeight > right.mWeight;
 
             // compare items by Id
-            leftName = left.mBase.getCellRef().getRefId();
-            rightName = right.mBase.getCellRef().getRefId();
-
-            result = leftName.compare(rightName);
-            return result < 0;
+            return left.mRefId.compare(right.mRefId) < 0;
         }
     };
 }
@@ -302,9 +302,20 @@ namespace MWGui
                 mItems.push_back(item);
         }
 
+        std::vector<SortKey> keys;
+        keys.reserve(mItems.size());
+        for (size_t i=0; i<mItems.size(); ++i)
+            keys.push_back(SortKey(mItems[i], i));
+
         Compare cmp;
         cmp.mSortByType = mSortByType;
-        std::sort(mItems.begin(), mItems.end(), cmp);
+        std::sort(keys.begin(), keys.end(), cmp);
+
+        std::vector<ItemStack> sorted;
+        sorted.reserve(mItems.size());
+        for (std::vector<SortKey>::const_iterator it = keys.begin(); it != keys.end(); ++it)
+            sorted.push_back(mItems[it->mIndex]);
+        mItems.swap(sorted);
     }
 
     void SortFilterItemModel::onClose()
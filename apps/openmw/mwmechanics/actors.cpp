@@ -133,7 +133,7 @@ void getRestorationPerHourOfSleep (const MWWorld::Ptr& ptr, float& health, float
     int endurance = stats.getAttribute (ESM::Attribute::Endurance).getModified ();
     health = 0.1f * endurance;
 
-    float fRestMagicMult = settings.find("fRestMagicMult")->mValue.getFloat ();
+    static const float fRestMagicMult = settings.find("fRestMagicMult")->mValue.getFloat ();
     magicka = fRestMagicMult * stats.getAttribute(ESM::Attribute::Intelligence).getModified();
 }
 
@@ -573,11 +573,10 @@ namespace MWMechanics
 
         int intelligence = creatureStats.getAttribute(ESM::Attribute::Intelligence).getModified();
 
-        float base = 1.f;
-        if (ptr == getPlayer())
-            base = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fPCbaseMagickaMult")->mValue.getFloat();
-        else
-            base = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fNPCbaseMagickaMult")->mValue.getFloat();
+        static const float fPCbaseMagickaMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fPCbaseMagickaMult")->mValue.getFloat();
+        static const float fNPCbaseMagickaMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fNPCbaseMagickaMult")->mValue.getFloat();
+
+        float base = ptr == getPlayer() ? fPCbaseMagickaMult : fNPCbaseMagickaMult;
 
         double magickaFactor = base +
             creatureStats.getMagicEffects().get (EffectKey (ESM::MagicEffect::FortifyMaximumMagicka)).getMagnitude() * 0.1;
@@ -643,9 +642,9 @@ namespace MWMechanics
             return;
 
         // Restore fatigue
-        float fFatigueReturnBase = settings.find("fFatigueReturnBase")->mValue.getFloat ();
-        float fFatigueReturnMult = settings.find("fFatigueReturnMult")->mValue.getFloat ();
-        float fEndFatigueMult = settings.find("fEndFatigueMult")->mValue.getFloat ();
+        static const float fFatigueReturnBase = settings.find("fFatigueReturnBase")->mValue.getFloat ();
+        static const float fFatigueReturnMult = settings.find("fFatigueReturnMult")->mValue.getFloat ();
+        static const float fEndFatigueMult = settings.find("fEndFatigueMult")->mValue.getFloat ();
 
         int endurance = stats.getAttribute (ESM::Attribute::Endurance).getModified ();
 
@@ -1226,7 +1225,8 @@ namespace MWMechanics
         static const float maxProcessingRange = 7168.f;
         static const float minProcessingRange = maxProcessingRange / 2.f;
 
-        float actorsProcessingRange = Settings::Manager::getFloat("actors processing range", "Game");
+        static const Settings::SettingValue<float> actorsProcessingRangeSetting("actors processing range", "Game");
+        float actorsProcessingRange = actorsProcessingRangeSetting.get();
         actorsProcessingRange = std::min(actorsProcessingRange, maxProcessingRange);
         actorsProcessingRange = std::max(actorsProcessingRange, minProcessingRange);
         mActorsProcessingRange = actorsProcessingRange;
@@ -550,14 +550,16 @@ namespace MWMechanics
 
                 const MWWorld::ESMStore &store = MWBase::Environment::get().getWorld()->getStore();
 
-                float baseDelay = store.get<ESM::GameSetting>().find("fCombatDelayCreature")->mValue.getFloat();
+                static const float fCombatDelayCreature = store.get<ESM::GameSetting>().find("fCombatDelayCreature")->mValue.getFloat();
+                static const float fCombatDelayNPC = store.get<ESM::GameSetting>().find("fCombatDelayNPC")->mValue.getFloat();
+                float baseDelay = fCombatDelayCreature;
                 if (actor.getClass().isNpc())
                 {
-                    baseDelay = store.get<ESM::GameSetting>().find("fCombatDelayNPC")->mValue.getFloat();
+                    baseDelay = fCombatDelayNPC;
                 }
 
                 // Say a provoking combat phrase
-                const int iVoiceAttackOdds = store.get<ESM::GameSetting>().find("iVoiceAttackOdds")->mValue.getInteger();
+                static const int iVoiceAttackOdds = store.get<ESM::GameSetting>().find("iVoiceAttackOdds")->mValue.getInteger();
                 if (Misc::Rng::roll0to99() < iVoiceAttackOdds)
                 {
                     MWBase::Environment::get().getDialogueManager()->say(actor, "attack");
@@ -660,7 +662,9 @@ osg::Vec3f AimDirToMovingTarget(const MWWorld::Ptr& actor, const MWWorld::Ptr& t
     }
     else // weapType is 0 ==> it's a target spell projectile
     {
-        projSpeed = gmst.find("fTargetSpellMaxSpeed")->mValue.getFloat();
+        static float fTargetSpellMaxSpeed = gmst.find("fTargetSpellMaxSpeed")->mValue.getFloat();
+
+        projSpeed = fTargetSpellMaxSpeed;
     }
 
     // idea: perpendicular to dir to target speed components of target move vector and projectile vector should be the same
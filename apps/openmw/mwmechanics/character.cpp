@@ -117,16 +117,16 @@ float getFallDamage(const MWWorld::Ptr& ptr, float fallHeight)
     MWBase::World *world = MWBase::Environment::get().getWorld();
     const MWWorld::Store<ESM::GameSetting> &store = world->getStore().get<ESM::GameSetting>();
 
-    const float fallDistanceMin = store.find("fFallDamageDistanceMin")->mValue.getFloat();
+    static const float fallDistanceMin = store.find("fFallDamageDistanceMin")->mValue.getFloat();
 
     if (fallHeight >= fallDistanceMin)
     {
         const float acrobaticsSkill = static_cast<float>(ptr.getClass().getSkill(ptr, ESM::Skill::Acrobatics));
         const float jumpSpellBonus = ptr.getClass().getCreatureStats(ptr).getMagicEffects().get(ESM::MagicEffect::Jump).getMagnitude();
-        const float fallAcroBase = store.find("fFallAcroBase")->mValue.getFloat();
-        const float fallAcroMult = store.find("fFallAcroMult")->mValue.getFloat();
-        const float fallDistanceBase = store.find("fFallDistanceBase")->mValue.getFloat();
-        const float fallDistanceMult = store.find("fFallDistanceMult")->mValue.getFloat();
+        static const float fallAcroBase = store.find("fFallAcroBase")->mValue.getFloat();
+        static const float fallAcroMult = store.find("fFallAcroMult")->mValue.getFloat();
+        static const float fallDistanceBase = store.find("fFallDistanceBase")->mValue.getFloat();
+        static const float fallDistanceMult = store.find("fFallDistanceMult")->mValue.getFloat();
 
         float x = fallHeight - fallDistanceMin;
         x -= (1.5f * acrobaticsSkill) + jumpSpellBonus;
@@ -1580,7 +1580,8 @@ bool CharacterController::updateWeaponState(CharacterState& idle)
                 {
                     if(mPtr == getPlayer())
                     {
-                        if (Settings::Manager::getBool("best attack", "Game"))
+                        static const Settings::SettingValue<bool> bestAttack("best attack", "Game");
+                        if (bestAttack.get())
                         {
                             if (isWeapon)
                             {
@@ -82,9 +82,11 @@ namespace MWMechanics
                     osg::Vec3f(0,0,1)));
 
         const MWWorld::Store<ESM::GameSetting>& gmst = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        if (angleDegrees < gmst.find("fCombatBlockLeftAngle")->mValue.getFloat())
+        static const float fCombatBlockLeftAngle = gmst.find("fCombatBlockLeftAngle")->mValue.getFloat();
+        static const float fCombatBlockRightAngle = gmst.find("fCombatBlockRightAngle")->mValue.getFloat();
+        if (angleDegrees < fCombatBlockLeftAngle)
             return false;
-        if (angleDegrees > gmst.find("fCombatBlockRightAngle")->mValue.getFloat())
+        if (angleDegrees > fCombatBlockRightAngle)
             return false;
 
         MWMechanics::CreatureStats& attackerStats = attacker.getClass().getCreatureStats(attacker);
@@ -92,11 +94,14 @@ namespace MWMechanics
         float blockTerm = blocker.getClass().getSkill(blocker, ESM::Skill::Block) + 0.2f * blockerStats.getAttribute(ESM::Attribute::Agility).getModified()
             + 0.1f * blockerStats.getAttribute(ESM::Attribute::Luck).getModified();
         float enemySwing = attackStrength;
-        float swingTerm = enemySwing * gmst.find("fSwingBlockMult")->mValue.getFloat() + gmst.find("fSwingBlockBase")->mValue.getFloat();
+        static const float fSwingBlockMult = gmst.find("fSwingBlockMult")->mValue.getFloat();
+        static const float fSwingBlockBase = gmst.find("fSwingBlockBase")->mValue.getFloat();
+        float swingTerm = enemySwing * fSwingBlockMult + fSwingBlockBase;
 
         float blockerTerm = blockTerm * swingTerm;
+        static const float fBlockStillBonus = gmst.find("fBlockStillBonus")->mValue.getFloat();
         if (blocker.getClass().getMovementSettings(blocker).mPosition[1] <= 0)
-            blockerTerm *= gmst.find("fBlockStillBonus")->mValue.getFloat();
+            blockerTerm *= fBlockStillBonus;
         blockerTerm *= blockerStats.getFatigueTerm();
 
         int attackerSkill = 0;
@@ -109,8 +114,8 @@ namespace MWMechanics
         attackerTerm *= attackerStats.getFatigueTerm();
 
         int x = int(blockerTerm - attackerTerm);
-        int iBlockMaxChance = gmst.find("iBlockMaxChance")->mValue.getInteger();
-        int iBlockMinChance = gmst.find("iBlockMinChance")->mValue.getInteger();
+        static const int iBlockMaxChance = gmst.find("iBlockMaxChance")->mValue.getInteger();
+        static const int iBlockMinChance = gmst.find("iBlockMinChance")->mValue.getInteger();
         x = std::min(iBlockMaxChance, std::max(iBlockMinChance, x));
 
         if (Misc::Rng::roll0to99() < x)
@@ -123,9 +128,9 @@ namespace MWMechanics
             if (shieldhealth == 0)
                 inv.unequipItem(*shield, blocker);
             // Reduce blocker fatigue
-            const float fFatigueBlockBase = gmst.find("fFatigueBlockBase")->mValue.getFloat();
-            const float fFatigueBlockMult = gmst.find("fFatigueBlockMult")->mValue.getFloat();
-            const float fWeaponFatigueBlockMult = gmst.find("fWeaponFatigueBlockMult")->mValue.getFloat();
+            static const float fFatigueBlockBase = gmst.find("fFatigueBlockBase")->mValue.getFloat();
+            static const float fFatigueBlockMult = gmst.find("fFatigueBlockMult")->mValue.getFloat();
+            static const float fWeaponFatigueBlockMult = gmst.find("fWeaponFatigueBlockMult")->mValue.getFloat();
             MWMechanics::DynamicStat<float> fatigue = blockerStats.getFatigue();
             float normalizedEncumbrance = blocker.getClass().getNormalizedEncumbrance(blocker);
             normalizedEncumbrance = std::min(1.f, normalizedEncumbrance);
@@ -155,7 +160,8 @@ namespace MWMechanics
         bool isMagical = flags & ESM::Weapon::Magical;
         bool isEnchanted = !weapon.getClass().getEnchantment(weapon).empty();
 
-        return !isSilver && !isMagical && (!isEnchanted || !Settings::Manager::getBool("enchanted weapons are magical", "Game"));
+        static const Settings::SettingValue<bool> enchantedWeaponsMagical("enchanted weapons are magical", "Game");
+        return !isSilver && !isMagical && (!isEnchanted || !enchantedWeaponsMagical.get());
     }
 
     void resistNormalWeapon(const MWWorld::Ptr &actor, const MWWorld::Ptr& attacker, const MWWorld::Ptr &weapon, float &damage)
@@ -183,8 +189,9 @@ namespace MWMechanics
 
         if (isSilver && actor.getClass().getNpcStats(actor).isWerewolf())
         {
-            const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
-            damage *= store.get<ESM::GameSetting>().find("fWereWolfSilverWeaponDamageMult")->mValue.getFloat();
+            static const float fWereWolfSilverWeaponDamageMult = MWBase::Environment::get().getWorld()->getStore()
+                    .get<ESM::GameSetting>().find("fWereWolfSilverWeaponDamageMult")->mValue.getFloat();
+            damage *= fWereWolfSilverWeaponDamageMult;
         }
     }
 
@@ -224,7 +231,8 @@ namespace MWMechanics
             damage += attack[0] + ((attack[1] - attack[0]) * attackStrength);
 
             adjustWeaponDamage(damage, weapon, attacker);
-            if (weapon == projectile || Settings::Manager::getBool("only appropriate ammunition bypasses resistance", "Game") || isNormalWeapon(weapon))
+            static const Settings::SettingValue<bool> appropriateAmmunition("only appropriate ammunition bypasses resistance", "Game");
+            if (weapon == projectile || appropriateAmmunition.get() || isNormalWeapon(weapon))
                 resistNormalWeapon(victim, attacker, projectile, damage);
             applyWerewolfDamageMult(victim, projectile, damage);
 
@@ -237,7 +245,8 @@ namespace MWMechanics
             bool knockedDown = victim.getClass().getCreatureStats(victim).getKnockedDown();
             if (knockedDown || unaware)
             {
-                damage *= gmst.find("fCombatKODamageMult")->mValue.getFloat();
+                static const float fCombatKODamageMult = gmst.find("fCombatKODamageMult")->mValue.getFloat();
+                damage *= fCombatKODamageMult;
                 if (!knockedDown)
                     MWBase::Environment::get().getSoundManager()->playSound3D(victim, "critical damage", 1.0f, 1.0f);
             }
@@ -255,7 +264,7 @@ namespace MWMechanics
             // Non-enchanted arrows shot at enemies have a chance to turn up in their inventory
             if (victim != getPlayer() && !appliedEnchantment)
             {
-                float fProjectileThrownStoreChance = gmst.find("fProjectileThrownStoreChance")->mValue.getFloat();
+                static const float fProjectileThrownStoreChance = gmst.find("fProjectileThrownStoreChance")->mValue.getFloat();
                 if (Misc::Rng::rollProbability() < fProjectileThrownStoreChance / 100.f)
                     victim.getClass().getContainerStore(victim).add(projectile, 1, victim);
             }
@@ -286,11 +295,12 @@ namespace MWMechanics
             {
                 defenseTerm = victimStats.getEvasion();
             }
+            static const float fCombatInvisoMult = gmst.find("fCombatInvisoMult")->mValue.getFloat();
             defenseTerm += std::min(100.f,
-                                    gmst.find("fCombatInvisoMult")->mValue.getFloat() *
+                                    fCombatInvisoMult *
                                     victimStats.getMagicEffects().get(ESM::MagicEffect::Chameleon).getMagnitude());
             defenseTerm += std::min(100.f,
-                                    gmst.find("fCombatInvisoMult")->mValue.getFloat() *
+                                    fCombatInvisoMult *
                                     victimStats.getMagicEffects().get(ESM::MagicEffect::Invisibility).getMagnitude());
         }
         float attackTerm = skillValue +
@@ -366,7 +376,7 @@ namespace MWMechanics
             // weapon condition does not degrade when godmode is on
             if (!godmode)
             {
-                const float fWeaponDamageMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fWeaponDamageMult")->mValue.getFloat();
+                static const float fWeaponDamageMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>().find("fWeaponDamageMult")->mValue.getFloat();
                 float x = std::max(1.f, fWeaponDamageMult * damage);
 
                 weaphealth -= std::min(int(x), weaphealth);
@@ -401,8 +411,8 @@ namespace MWMechanics
     void getHandToHandDamage(const MWWorld::Ptr &attacker, const MWWorld::Ptr &victim, float &damage, bool &healthdmg, float attackStrength)
     {
         const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
-        float minstrike = store.get<ESM::GameSetting>().find("fMinHandToHandMult")->mValue.getFloat();
-        float maxstrike = store.get<ESM::GameSetting>().find("fMaxHandToHandMult")->mValue.getFloat();
+        static const float minstrike = store.get<ESM::GameSetting>().find("fMinHandToHandMult")->mValue.getFloat();
+        static const float maxstrike = store.get<ESM::GameSetting>().find("fMaxHandToHandMult")->mValue.getFloat();
         damage  = static_cast<float>(attacker.getClass().getSkill(attacker, ESM::Skill::HandToHand));
         damage *= minstrike + ((maxstrike-minstrike)*attackStrength);
 
@@ -415,7 +425,8 @@ namespace MWMechanics
         // 0 = Do not factor strength into hand-to-hand combat.
         // 1 = Factor into werewolf hand-to-hand combat.
         // 2 = Ignore werewolves.
-        int factorStrength = Settings::Manager::getInt("strength influences hand to hand", "Game");
+        static const Settings::SettingValue<int> strengthInfluencesHandToHand("strength influences hand to hand", "Game");
+        int factorStrength = strengthInfluencesHandToHand.get();
         if (factorStrength == 1 || (factorStrength == 2 && !isWerewolf)) {
             damage *= attacker.getClass().getCreatureStats(attacker).getAttribute(ESM::Attribute::Strength).getModified() / 40.0f;
         }
@@ -426,8 +437,9 @@ namespace MWMechanics
             // GLOB instead of GMST because it gets updated during a quest
             damage *= MWBase::Environment::get().getWorld()->getGlobalFloat("werewolfclawmult");
         }
+        static const float fHandtoHandHealthPer = store.get<ESM::GameSetting>().find("fHandtoHandHealthPer")->mValue.getFloat();
         if(healthdmg)
-            damage *= store.get<ESM::GameSetting>().find("fHandtoHandHealthPer")->mValue.getFloat();
+            damage *= fHandtoHandHealthPer;
 
         MWBase::SoundManager *sndMgr = MWBase::Environment::get().getSoundManager();
         if(isWerewolf)
@@ -444,9 +456,9 @@ namespace MWMechanics
     {
         // somewhat of a guess, but using the weapon weight makes sense
         const MWWorld::Store<ESM::GameSetting>& store = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>();
-        const float fFatigueAttackBase = store.find("fFatigueAttackBase")->mValue.getFloat();
-        const float fFatigueAttackMult = store.find("fFatigueAttackMult")->mValue.getFloat();
-        const float fWeaponFatigueMult = store.find("fWeaponFatigueMult")->mValue.getFloat();
+        static const float fFatigueAttackBase = store.find("fFatigueAttackBase")->mValue.getFloat();
+        static const float fFatigueAttackMult = store.find("fFatigueAttackMult")->mValue.getFloat();
+        static const float fWeaponFatigueMult = store.find("fWeaponFatigueMult")->mValue.getFloat();
         CreatureStats& stats = attacker.getClass().getCreatureStats(attacker);
         MWMechanics::DynamicStat<float> fatigue = stats.getFatigue();
         const float normalizedEncumbrance = attacker.getClass().getNormalizedEncumbrance(attacker);
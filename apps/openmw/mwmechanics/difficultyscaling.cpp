@@ -13,7 +13,8 @@ float scaleDamage(float damage, const MWWorld::Ptr& attacker, const MWWorld::Ptr
     const MWWorld::Ptr& player = MWMechanics::getPlayer();
 
     // [-500, 500]
-    int difficultySetting = Settings::Manager::getInt("difficulty", "Game");
+    static const Settings::SettingValue<int> difficulty("difficulty", "Game");
+    int difficultySetting = difficulty.get();
     difficultySetting = std::min(difficultySetting, 500);
     difficultySetting = std::max(difficultySetting, -500);
 
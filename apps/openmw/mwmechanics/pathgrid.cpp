@@ -1,5 +1,7 @@
 #include "pathgrid.hpp"
 
+#include <list>
+
 #include "../mwbase/world.hpp"
 #include "../mwbase/environment.hpp"
 
@@ -0,0 +1,184 @@
+#include "geometrymerger.hpp"
+
+#include <typeinfo>
+
+#include <osg/Geometry>
+#include <osg/LOD>
+#include <osg/LightSource>
+#include <osg/Sequence>
+#include <osg/Switch>
+
+#include <components/sceneutil/optimizer.hpp>
+
+#include "vismask.hpp"
+
+namespace
+{
+
+    class MergeableVisitor : public osg::NodeVisitor
+    {
+    public:
+        MergeableVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mMergeable(true)
+        {
+        }
+
+        void apply(osg::Node& node) override
+        {
+            if (node.getUpdateCallback() || node.getCullCallback()
+                    || (node.getStateSet() && node.getStateSet()->getUpdateCallback()))
+                mMergeable = false;
+
+            if (mMergeable)
+                traverse(node);
+        }
+
+        void apply(osg::Drawable& drawable) override
+        {
+            // rejects RigGeometry, MorphGeometry, particle systems and any other drawable with custom behaviour
+            if (typeid(drawable) != typeid(osg::Geometry)
+                    || drawable.getUpdateCallback() || drawable.getCullCallback() || drawable.getDrawCallback()
+                    || (drawable.getStateSet() && drawable.getStateSet()->getUpdateCallback()))
+                mMergeable = false;
+        }
+
+        void apply(osg::Switch& node) override { mMergeable = false; }
+        void apply(osg::Sequence& node) override { mMergeable = false; }
+        void apply(osg::LOD& node) override { mMergeable = false; }
+        void apply(osg::LightSource& node) override { mMergeable = false; }
+
+        bool mMergeable;
+    };
+
+    /// Copies the geometry of a model template into a GeometryMerger, transformed into the space of the merged geometry.
+    class CopyGeometryVisitor : public osg::NodeVisitor
+    {
+    public:
+        CopyGeometryVisitor(const osg::Matrix& transform, MWRender::GeometryMerger& merger)
+            : osg::NodeVisitor(TRAVERSE_ACTIVE_CHILDREN)
+            , mMerger(merger)
+        {
+            // skip hidden nodes, e.g. collision shapes
+            setTraversalMask(~MWRender::Mask_UpdateVisitor);
+            mMatrices.push_back(transform);
+        }
+
+        void apply(osg::Node& node) override
+        {
+            if (node.getStateSet())
+                mStateSets.push_back(node.getStateSet());
+
+            traverse(node);
+
+            if (node.getStateSet())
+                mStateSets.pop_back();
+        }
+
+        void apply(osg::Transform& transform) override
+        {
+            osg::Matrix matrix = mMatrices.back();
+            transform.computeLocalToWorldMatrix(matrix, this);
+            mMatrices.push_back(matrix);
+
+            apply(static_cast<osg::Node&>(transform));
+
+            mMatrices.pop_back();
+        }
+
+        void apply(osg::Drawable& drawable) override
+        {
+            osg::Geometry* geometry = drawable.asGeometry();
+            if (!geometry || !dynamic_cast<const osg::Vec3Array*>(geometry->getVertexArray()))
+                return;
+
+            osg::ref_ptr<osg::Geometry> copy (new osg::Geometry(*geometry, osg::CopyOp::DEEP_COPY_ARRAYS|osg::CopyOp::DEEP_COPY_PRIMITIVES));
+
+            const osg::Matrix& matrix = mMatrices.back();
+            osg::Vec3Array* vertices = static_cast<osg::Vec3Array*>(copy->getVertexArray());
+            for (osg::Vec3Array::iterator it = vertices->begin(); it != vertices->end(); ++it)
+                *it = *it * matrix;
+            vertices->dirty();
+
+            if (osg::Vec3Array* normals = dynamic_cast<osg::Vec3Array*>(copy->getNormalArray()))
+            {
+                osg::Matrix inverse = osg::Matrix::inverse(matrix);
+                for (osg::Vec3Array::iterator it = normals->begin(); it != normals->end(); ++it)
+                {
+                    *it = osg::Matrix::transform3x3(inverse, *it);
+                    it->normalize();
+                }
+                normals->dirty();
+            }
+
+            copy->dirtyBound();
+
+            mMerger.getBucket(mStateSets)->addChild(copy);
+        }
+
+    private:
+        MWRender::GeometryMerger& mMerger;
+        std::vector<osg::Matrix> mMatrices;
+        std::vector<const osg::StateSet*> mStateSets;
+    };
+
+}
+
+namespace MWRender
+{
+
+bool isMergeable(const osg::Node& node)
+{
+    MergeableVisitor visitor;
+    const_cast<osg::Node&>(node).accept(visitor);
+    return visitor.mMergeable;
+}
+
+GeometryMerger::GeometryMerger()
+    : mRoot(new osg::Group)
+{
+}
+
+void GeometryMerger::add(const osg::Node& node, const osg::Matrix& transform)
+{
+    CopyGeometryVisitor visitor(transform, *this);
+    const_cast<osg::Node&>(node).accept(visitor);
+}
+
+osg::ref_ptr<osg::Group> GeometryMerger::merge()
+{
+    SceneUtil::Optimizer optimizer;
+    optimizer.optimize(mRoot, SceneUtil::Optimizer::MERGE_GEOMETRY);
+
+    mBuckets.clear();
+    return mRoot;
+}
+
+osg::Group* GeometryMerger::getBucket(const std::vector<const osg::StateSet*>& stateSets)
+{
+    osg::ref_ptr<osg::Group>& bucket = mBuckets[stateSets];
+    if (!bucket)
+    {
+        // nest the state sets the same way the original scene graph does, so that their inheritance is preserved
+        osg::Group* parent = mRoot;
+        for (std::vector<const osg::StateSet*>::const_iterator it = stateSets.begin(); it != stateSets.end(); ++it)
+        {
+            osg::ref_ptr<osg::Group> group (new osg::Group);
+            group->setStateSet(const_cast<osg::StateSet*>(*it));
+            parent->addChild(group);
+            parent = group;
+        }
+
+        if (parent == mRoot)
+        {
+            osg::ref_ptr<osg::Group> group (new osg::Group);
+            parent->addChild(group);
+            parent = group;
+        }
+
+        bucket = parent;
+    }
+    return bucket;
+}
+
+}
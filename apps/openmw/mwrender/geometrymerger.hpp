@@ -0,0 +1,49 @@
+#ifndef OPENMW_MWRENDER_GEOMETRYMERGER_H
+#define OPENMW_MWRENDER_GEOMETRYMERGER_H
+
+#include <map>
+#include <vector>
+
+#include <osg/Group>
+#include <osg/Matrix>
+#include <osg/ref_ptr>
+
+namespace osg
+{
+    class Node;
+    class StateSet;
+}
+
+namespace MWRender
+{
+
+    /// @return Can the model be baked into merged geometry without losing anything but its individuality,
+    /// i.e. does it have no animations, particles, lights or skinning?
+    bool isMergeable(const osg::Node& node);
+
+    /// @brief Merges the geometry of many model instances into as few drawables as possible.
+    /// @par The geometry is bucketed by the state sets inherited from the original scene graphs, so that only
+    /// geometry sharing the same state ends up in the same drawable.
+    class GeometryMerger
+    {
+    public:
+        GeometryMerger();
+
+        /// Copy the visible geometry of @a node, transformed by @a transform.
+        void add(const osg::Node& node, const osg::Matrix& transform);
+
+        /// Merge the geometry added so far.
+        /// @note The GeometryMerger must not be used afterwards.
+        osg::ref_ptr<osg::Group> merge();
+
+        /// Get the group collecting the geometry that inherits the given state sets.
+        osg::Group* getBucket(const std::vector<const osg::StateSet*>& stateSets);
+
+    private:
+        osg::ref_ptr<osg::Group> mRoot;
+        std::map<std::vector<const osg::StateSet*>, osg::ref_ptr<osg::Group> > mBuckets;
+    };
+
+}
+
+#endif
@@ -0,0 +1,102 @@
+#include "instancebatch.hpp"
+
+#include <osg/NodeCallback>
+
+#include <osgUtil/IncrementalCompileOperation>
+#include <osgUtil/IntersectionVisitor>
+
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/positionattitudetransform.hpp>
+
+#include "../mwworld/refdata.hpp"
+
+#include "geometrymerger.hpp"
+#include "vismask.hpp"
+
+namespace
+{
+
+    /// Stops CullVisitors from traversing a batched instance, it is rendered by its batch instead.
+    class HideFromCullCallback : public osg::NodeCallback
+    {
+    public:
+        void operator()(osg::Node* node, osg::NodeVisitor* nv) override
+        {
+        }
+    };
+
+}
+
+namespace MWRender
+{
+
+InstanceBatch::InstanceBatch(const osg::Vec3f& origin)
+    : mOrigin(origin)
+{
+    setNodeMask(Mask_Static);
+}
+
+void InstanceBatch::addInstance(const MWWorld::Ptr& ptr)
+{
+    osg::Matrix matrix;
+    ptr.getRefData().getBaseNode()->computeLocalToWorldMatrix(matrix, nullptr);
+    matrix.postMultTranslate(-mOrigin);
+
+    mInstances.push_back(ptr);
+    mTransforms.push_back(matrix);
+}
+
+void InstanceBatch::build(const osg::Node& templateNode, Resource::SceneManager* sceneManager)
+{
+    GeometryMerger merger;
+    for (std::vector<osg::Matrixf>::const_iterator it = mTransforms.begin(); it != mTransforms.end(); ++it)
+        merger.add(templateNode, *it);
+
+    osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform (new SceneUtil::PositionAttitudeTransform);
+    transform->setPosition(mOrigin);
+    transform->addChild(merger.merge());
+    addChild(transform);
+
+    addCullCallback(new SceneUtil::LightListCallback);
+
+    if (sceneManager->getIncrementalCompileOperation())
+        sceneManager->getIncrementalCompileOperation()->add(transform);
+
+    for (std::vector<MWWorld::Ptr>::const_iterator it = mInstances.begin(); it != mInstances.end(); ++it)
+        it->getRefData().getBaseNode()->addCullCallback(new HideFromCullCallback);
+}
+
+void InstanceBatch::dissolve()
+{
+    for (std::vector<MWWorld::Ptr>::const_iterator it = mInstances.begin(); it != mInstances.end(); ++it)
+    {
+        osg::Node* baseNode = it->getRefData().getBaseNode();
+        if (!baseNode)
+            continue;
+
+        // the callback may be nested in other cull callbacks of the node
+        for (osg::Callback* callback = baseNode->getCullCallback(); callback; callback = callback->getNestedCallback())
+        {
+            if (dynamic_cast<HideFromCullCallback*>(callback))
+            {
+                baseNode->removeCullCallback(callback);
+                break;
+            }
+        }
+    }
+
+    while (getNumParents())
+        getParent(0)->removeChild(this);
+}
+
+void InstanceBatch::traverse(osg::NodeVisitor& nv)
+{
+    // intersection tests have to resolve to the individual instances
+    if (dynamic_cast<osgUtil::IntersectionVisitor*>(&nv))
+        return;
+
+    osg::Group::traverse(nv);
+}
+
+}
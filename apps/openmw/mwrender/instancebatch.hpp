@@ -0,0 +1,52 @@
+#ifndef OPENMW_MWRENDER_INSTANCEBATCH_H
+#define OPENMW_MWRENDER_INSTANCEBATCH_H
+
+#include <vector>
+
+#include <osg/Group>
+#include <osg/Matrixf>
+
+#include "../mwworld/ptr.hpp"
+
+namespace Resource
+{
+    class SceneManager;
+}
+
+namespace MWRender
+{
+
+    /// @brief Renders many instances of the same static model as a single batch.
+    /// @par The instances keep their own nodes, so that intersection tests (i.e. picking) and the rest of the game
+    /// logic still see the individual objects, but the nodes are hidden from CullVisitors while batched.
+    /// The batch in turn is only visible to CullVisitors.
+    /// @par The per-instance transforms are kept, so that the batch could be drawn with hardware instancing.
+    /// As long as the object shaders are optional, it is drawn as merged geometry instead.
+    class InstanceBatch : public osg::Group
+    {
+    public:
+        /// @param origin Position of the batch in world space, should be close to the instances to keep the precision of the merged vertices.
+        InstanceBatch(const osg::Vec3f& origin);
+
+        /// Add an instance, the transform of its base node is taken over as is.
+        void addInstance(const MWWorld::Ptr& ptr);
+
+        /// Merge the instances added so far and hide them from rendering.
+        void build(const osg::Node& templateNode, Resource::SceneManager* sceneManager);
+
+        /// Give the instances their own rendering back and remove the batch from the scene graph.
+        void dissolve();
+
+        const std::vector<MWWorld::Ptr>& getInstances() const { return mInstances; }
+
+        void traverse(osg::NodeVisitor& nv) override;
+
+    private:
+        osg::Vec3f mOrigin;
+        std::vector<MWWorld::Ptr> mInstances;
+        std::vector<osg::Matrixf> mTransforms; // relative to the origin
+    };
+
+}
+
+#endif
@@ -0,0 +1,269 @@
+#include "objectpaging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+#include <osg/Stats>
+
+#include <osgUtil/IncrementalCompileOperation>
+
+#include <components/debug/debuglog.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/esm/loadcell.hpp>
+#include <components/esm/loadstat.hpp>
+#include <components/misc/constants.hpp>
+#include <components/misc/stringops.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/to_utf8/to_utf8.hpp>
+
+#include "../mwbase/environment.hpp"
+#include "../mwbase/world.hpp"
+#include "../mwworld/esmstore.hpp"
+
+#include "geometrymerger.hpp"
+#include "pagedrefs.hpp"
+#include "vismask.hpp"
+
+namespace
+{
+
+    bool isInGrid(int x, int y, const osg::Vec4i& grid)
+    {
+        return x >= grid.x() && x < grid.z() && y >= grid.y() && y < grid.w();
+    }
+
+    bool chunkContainsCell(const MWRender::ChunkId& id, const osg::Vec2i& cell)
+    {
+        const osg::Vec2f& center = std::get<0>(id);
+        float halfSize = std::get<1>(id)/2.f;
+        return center.x() - halfSize < cell.x() + 1 && center.x() + halfSize > cell.x()
+            && center.y() - halfSize < cell.y() + 1 && center.y() + halfSize > cell.y();
+    }
+
+    osg::Quat makeObjectOsgQuat(const ESM::Position& position)
+    {
+        return osg::Quat(position.rot[2], osg::Vec3(0, 0, -1))
+            * osg::Quat(position.rot[1], osg::Vec3(0, -1, 0))
+            * osg::Quat(position.rot[0], osg::Vec3(-1, 0, 0));
+    }
+
+}
+
+namespace MWRender
+{
+
+ObjectPaging::ObjectPaging(Resource::SceneManager* sceneManager, float minSize, const ToUTF8::Utf8Encoder* encoder)
+    : GenericResourceManager<ChunkId>(nullptr)
+    , mSceneManager(sceneManager)
+    , mMinSize(minSize)
+    , mEncoder(encoder ? new ToUTF8::Utf8Encoder(*encoder) : nullptr)
+{
+}
+
+ObjectPaging::~ObjectPaging()
+{
+}
+
+osg::ref_ptr<osg::Node> ObjectPaging::getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags, const osg::Vec4i& activeGrid)
+{
+    // the active grid is rendered by the scene, chunks inside of it would always be empty
+    if (activeGrid.z() > activeGrid.x()
+            && center.x() - size/2.f >= activeGrid.x() && center.x() + size/2.f <= activeGrid.z()
+            && center.y() - size/2.f >= activeGrid.y() && center.y() + size/2.f <= activeGrid.w())
+        return nullptr;
+
+    ChunkId id = std::make_tuple(center, size, activeGrid);
+    osg::ref_ptr<osg::Object> obj = mCache->getRefFromObjectCache(id);
+    if (obj)
+        return obj->asNode();
+    else
+    {
+        osg::ref_ptr<osg::Node> node = createChunk(size, center, activeGrid);
+        mCache->addEntryToObjectCache(id, node.get());
+        return node;
+    }
+}
+
+ObjectPaging::ModelInfo ObjectPaging::getModelInfo(const std::string& model)
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mModelInfoMutex);
+        std::map<std::string, ModelInfo>::const_iterator found = mModelInfo.find(model);
+        if (found != mModelInfo.end())
+            return found->second;
+    }
+
+    ModelInfo info;
+    info.mPageable = false;
+    info.mRadius = 0.f;
+
+    try
+    {
+        osg::ref_ptr<const osg::Node> node = mSceneManager->getTemplate(model);
+
+        info.mPageable = isMergeable(*node);
+        info.mRadius = node->getBound().radius();
+    }
+    catch (std::exception& e)
+    {
+        Log(Debug::Warning) << "Failed to page model '" << model << "': " << e.what();
+    }
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mModelInfoMutex);
+    mModelInfo[model] = info;
+    return info;
+}
+
+osg::ref_ptr<osg::Node> ObjectPaging::createChunk(float size, const osg::Vec2f& center, const osg::Vec4i& activeGrid)
+{
+    osg::Vec2f minBound = center - osg::Vec2f(size/2.f, size/2.f);
+    osg::Vec2f maxBound = center + osg::Vec2f(size/2.f, size/2.f);
+
+    const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
+
+    const std::vector<ESM::ESMReader>& sources = MWBase::Environment::get().getWorld()->getEsmReader();
+
+    // the encoder of the game's readers is in use on the main thread
+    std::unique_ptr<ToUTF8::Utf8Encoder> encoder;
+    if (mEncoder)
+        encoder.reset(new ToUTF8::Utf8Encoder(*mEncoder));
+
+    std::vector<ESM::CellRef> refs;
+    std::vector<ESM::ESMReader> esm;
+
+    int startX = static_cast<int>(std::floor(minBound.x()));
+    int startY = static_cast<int>(std::floor(minBound.y()));
+    int endX = static_cast<int>(std::ceil(maxBound.x()));
+    int endY = static_cast<int>(std::ceil(maxBound.y()));
+
+    for (int cellX = startX; cellX < endX; ++cellX)
+    {
+        for (int cellY = startY; cellY < endY; ++cellY)
+        {
+            if (isInGrid(cellX, cellY, activeGrid))
+                continue;
+
+            const ESM::Cell* cell = store.get<ESM::Cell>().search(cellX, cellY);
+            if (!cell)
+                continue;
+
+            std::map<ESM::RefNum, ESM::CellRef> cellRefs;
+            readCellRefs(*cell, sources, esm, encoder.get(), cellRefs);
+
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mRefTrackerMutex);
+            for (std::map<ESM::RefNum, ESM::CellRef>::const_iterator it = cellRefs.begin(); it != cellRefs.end(); ++it)
+            {
+                if (mDisabled.count(it->first) || mBlacklist.count(it->first))
+                    continue;
+
+                // assign each reference to exactly one chunk per level, even if it sticks out of its cell
+                const float* pos = it->second.mPos.pos;
+                float x = std::min(std::max(pos[0] / Constants::CellSizeInUnits, static_cast<float>(cellX)), cellX + 0.999f);
+                float y = std::min(std::max(pos[1] / Constants::CellSizeInUnits, static_cast<float>(cellY)), cellY + 0.999f);
+                if (x < minBound.x() || x >= maxBound.x() || y < minBound.y() || y >= maxBound.y())
+                    continue;
+
+                refs.push_back(it->second);
+            }
+        }
+    }
+
+    osg::Vec3f worldCenter (center.x()*Constants::CellSizeInUnits, center.y()*Constants::CellSizeInUnits, 0.f);
+    float minRadius = mMinSize * size * Constants::CellSizeInUnits;
+
+    GeometryMerger merger;
+    for (std::vector<ESM::CellRef>::const_iterator it = refs.begin(); it != refs.end(); ++it)
+    {
+        std::string id = Misc::StringUtils::lowerCase(it->mRefID);
+        if (store.find(id) != ESM::REC_STAT)
+            continue;
+
+        // marker objects that have a hardcoded function in the game logic, see Scene
+        if (id == "prisonmarker" || id == "divinemarker" || id == "templemarker" || id == "northmarker")
+            continue;
+
+        const ESM::Static* stat = store.get<ESM::Static>().search(id);
+        if (!stat || stat->mModel.empty())
+            continue;
+
+        std::string model = "meshes\\" + stat->mModel;
+        ModelInfo info = getModelInfo(model);
+        if (!info.mPageable || info.mRadius * it->mScale < minRadius)
+            continue;
+
+        osg::Matrix matrix = osg::Matrix::scale(it->mScale, it->mScale, it->mScale)
+                * osg::Matrix::rotate(makeObjectOsgQuat(it->mPos))
+                * osg::Matrix::translate(it->mPos.asVec3() - worldCenter);
+
+        merger.add(*mSceneManager->getTemplate(model), matrix);
+    }
+
+    osg::ref_ptr<SceneUtil::PositionAttitudeTransform> transform (new SceneUtil::PositionAttitudeTransform);
+    transform->setPosition(worldCenter);
+    transform->setNodeMask(Mask_Static);
+    transform->addChild(merger.merge());
+
+    if (size <= 1.f)
+        transform->addCullCallback(new SceneUtil::LightListCallback);
+
+    transform->getBound();
+
+    if (mSceneManager->getIncrementalCompileOperation())
+        mSceneManager->getIncrementalCompileOperation()->add(transform);
+
+    return transform;
+}
+
+bool ObjectPaging::clearCachedChunks(const osg::Vec2i& cell)
+{
+    return mCache->removeFromObjectCacheIf([&cell] (const ChunkId& id) { return chunkContainsCell(id, cell); }) > 0;
+}
+
+bool ObjectPaging::enableObject(const ESM::RefNum& refNum, const osg::Vec2i& cell, bool enabled)
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mRefTrackerMutex);
+        if (enabled ? !mDisabled.erase(refNum) : !mDisabled.insert(refNum).second)
+            return false;
+    }
+    return clearCachedChunks(cell);
+}
+
+bool ObjectPaging::blacklistObject(const ESM::RefNum& refNum, const osg::Vec2i& cell)
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mRefTrackerMutex);
+        if (!mBlacklist.insert(refNum).second)
+            return false;
+    }
+    return clearCachedChunks(cell);
+}
+
+void ObjectPaging::clear()
+{
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mRefTrackerMutex);
+        mDisabled.clear();
+        mBlacklist.clear();
+    }
+    mCache->clear();
+}
+
+void ObjectPaging::clearCache()
+{
+    GenericResourceManager<ChunkId>::clearCache();
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mModelInfoMutex);
+    mModelInfo.clear();
+}
+
+void ObjectPaging::reportStats(unsigned int frameNumber, osg::Stats *stats) const
+{
+    stats->setAttribute(frameNumber, "Object Chunk", mCache->getCacheSize());
+}
+
+}
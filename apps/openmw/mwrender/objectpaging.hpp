@@ -0,0 +1,95 @@
+#ifndef OPENMW_MWRENDER_OBJECTPAGING_H
+#define OPENMW_MWRENDER_OBJECTPAGING_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <tuple>
+
+#include <osg/Vec2f>
+#include <osg/Vec2i>
+#include <osg/Vec4i>
+
+#include <OpenThreads/Mutex>
+
+#include <components/esm/cellref.hpp>
+#include <components/resource/resourcemanager.hpp>
+#include <components/terrain/quadtreeworld.hpp>
+
+namespace Resource
+{
+    class SceneManager;
+}
+
+namespace ToUTF8
+{
+    class Utf8Encoder;
+}
+
+namespace MWRender
+{
+
+    typedef std::tuple<osg::Vec2f, float, osg::Vec4i> ChunkId; // Center, Size, Active grid
+
+    /// @brief Renders the static references outside of the active grid as merged geometry, one chunk per terrain quad tree node.
+    /// @par References are read directly from the content files, so a chunk does not depend on the cells being loaded.
+    /// Changes the game makes to paged references have to be reported through enableObject() and blacklistObject().
+    class ObjectPaging : public Resource::GenericResourceManager<ChunkId>, public Terrain::QuadTreeWorld::ChunkManager
+    {
+    public:
+        /// @param encoder Encoder of the game's content file readers, is copied for the threads building chunks.
+        ObjectPaging(Resource::SceneManager* sceneManager, float minSize, const ToUTF8::Utf8Encoder* encoder);
+        ~ObjectPaging();
+
+        osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags, const osg::Vec4i& activeGrid) override;
+
+        /// Hide or show a paged reference again.
+        /// @return Have any cached chunks been discarded, i.e. do the terrain views need to be rebuilt.
+        /// @note Thread safe.
+        bool enableObject(const ESM::RefNum& refNum, const osg::Vec2i& cell, bool enabled);
+
+        /// Stop paging a reference, e.g. because it was moved or deleted.
+        /// @return Have any cached chunks been discarded, i.e. do the terrain views need to be rebuilt.
+        /// @note Thread safe.
+        bool blacklistObject(const ESM::RefNum& refNum, const osg::Vec2i& cell);
+
+        /// Forget all changes reported for the current game and clear the cache.
+        /// @note Thread safe.
+        void clear();
+
+        void clearCache() override;
+
+        void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
+
+    private:
+        osg::ref_ptr<osg::Node> createChunk(float size, const osg::Vec2f& center, const osg::Vec4i& activeGrid);
+
+        struct ModelInfo
+        {
+            bool mPageable;
+            float mRadius;
+        };
+
+        /// Find out whether a model can be merged, i.e. has no animations, particles, lights or skinning.
+        /// @note Thread safe.
+        ModelInfo getModelInfo(const std::string& model);
+
+        /// Discard the cached chunks containing the given cell.
+        bool clearCachedChunks(const osg::Vec2i& cell);
+
+        Resource::SceneManager* mSceneManager;
+        float mMinSize;
+        std::unique_ptr<const ToUTF8::Utf8Encoder> mEncoder;
+
+        OpenThreads::Mutex mRefTrackerMutex;
+        std::set<ESM::RefNum> mDisabled;
+        std::set<ESM::RefNum> mBlacklist;
+
+        OpenThreads::Mutex mModelInfoMutex;
+        std::map<std::string, ModelInfo> mModelInfo;
+    };
+
+}
+
+#endif
@@ -1,8 +1,18 @@
 #include "objects.hpp"
 
+#include <cmath>
+#include <tuple>
+#include <typeinfo>
+#include <vector>
+
 #include <osg/Group>
 #include <osg/UserDataContainer>
 
+#include <components/esm/loadstat.hpp>
+#include <components/misc/constants.hpp>
+#include <components/misc/stringops.hpp>
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenemanager.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
 
@@ -12,8 +22,20 @@
 #include "animation.hpp"
 #include "npcanimation.hpp"
 #include "creatureanimation.hpp"
+#include "geometrymerger.hpp"
+#include "instancebatch.hpp"
+#include "occlusionculling.hpp"
 #include "vismask.hpp"
 
+namespace
+{
+    /// Batching fewer instances does not pay off the memory of the merged geometry.
+    const std::size_t sMinBatchInstances = 4;
+
+    /// A batch only covers one block of a cell, so that its light list stays meaningful.
+    const float sBatchBlockSize = Constants::CellSizeInUnits / 2.f;
+}
+
 
 namespace MWRender
 {
@@ -27,6 +49,7 @@ Objects::Objects(Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Gro
 
 Objects::~Objects()
 {
+    mBatches.clear();
     mObjects.clear();
 
     for (CellMap::iterator iter = mCellSceneNodes.begin(); iter != mCellSceneNodes.end(); ++iter)
@@ -34,22 +57,31 @@ Objects::~Objects()
     mCellSceneNodes.clear();
 }
 
+osg::Group* Objects::getOrCreateCellNode(const MWWorld::CellStore* store)
+{
+    CellMap::iterator found = mCellSceneNodes.find(store);
+    if (found != mCellSceneNodes.end())
+        return found->second;
+
+    osg::ref_ptr<osg::Group> cellnode (new osg::Group);
+    cellnode->setName("Cell Root");
+    if (mOcclusionCulling)
+        cellnode->addCullCallback(new CellOcclusionCallback(mOcclusionCulling));
+    mRootNode->addChild(cellnode);
+    mCellSceneNodes[store] = cellnode;
+    return cellnode;
+}
+
+void Objects::setOcclusionCulling(OcclusionCulling* occlusionCulling)
+{
+    mOcclusionCulling = occlusionCulling;
+}
+
 void Objects::insertBegin(const MWWorld::Ptr& ptr)
 {
     assert(mObjects.find(ptr) == mObjects.end());
 
-    osg::ref_ptr<osg::Group> cellnode;
-
-    CellMap::iterator found = mCellSceneNodes.find(ptr.getCell());
-    if (found == mCellSceneNodes.end())
-    {
-        cellnode = new osg::Group;
-        cellnode->setName("Cell Root");
-        mRootNode->addChild(cellnode);
-        mCellSceneNodes[ptr.getCell()] = cellnode;
-    }
-    else
-        cellnode = found->second;
+    osg::Group* cellnode = getOrCreateCellNode(ptr.getCell());
 
     osg::ref_ptr<SceneUtil::PositionAttitudeTransform> insert (new SceneUtil::PositionAttitudeTransform);
     cellnode->addChild(insert);
@@ -114,6 +146,8 @@ bool Objects::removeObject (const MWWorld::Ptr& ptr)
     if(!ptr.getRefData().getBaseNode())
         return true;
 
+    unbatchObject(ptr);
+
     PtrAnimationMap::iterator iter = mObjects.find(ptr);
     if(iter != mObjects.end())
     {
@@ -141,6 +175,15 @@ bool Objects::removeObject (const MWWorld::Ptr& ptr)
 
 void Objects::removeCell(const MWWorld::CellStore* store)
 {
+    // the batches are removed along with the cell node, no need to restore the instances
+    for(PtrBatchMap::iterator iter = mBatches.begin(); iter != mBatches.end();)
+    {
+        if(iter->first.getCell() == store)
+            mBatches.erase(iter++);
+        else
+            ++iter;
+    }
+
     for(PtrAnimationMap::iterator iter = mObjects.begin();iter != mObjects.end();)
     {
         MWWorld::Ptr ptr = iter->second->getPtr();
@@ -172,22 +215,96 @@ void Objects::removeCell(const MWWorld::CellStore* store)
     }
 }
 
+void Objects::batchCell(const MWWorld::CellStore* store)
+{
+    CellMap::iterator cellNode = mCellSceneNodes.find(store);
+    if (cellNode == mCellSceneNodes.end())
+        return;
+
+    // model, block coordinates
+    typedef std::tuple<std::string, int, int> BatchKey;
+    std::map<BatchKey, std::vector<MWWorld::Ptr> > candidates;
+
+    for (PtrAnimationMap::const_iterator iter = mObjects.begin(); iter != mObjects.end(); ++iter)
+    {
+        MWWorld::Ptr ptr = iter->second->getPtr();
+        if (ptr.getCell() != store || ptr.getTypeName() != typeid(ESM::Static).name())
+            continue;
+
+        // hidden objects and objects without a model, e.g. markers
+        osg::Node* baseNode = ptr.getRefData().getBaseNode();
+        if (!baseNode || baseNode->getNodeMask() != Mask_Static || mBatches.count(ptr))
+            continue;
+
+        std::string model = Misc::StringUtils::lowerCase(ptr.getClass().getModel(ptr));
+        if (model.empty())
+            continue;
+
+        const float* pos = ptr.getRefData().getPosition().pos;
+        int blockX = static_cast<int>(std::floor(pos[0] / sBatchBlockSize));
+        int blockY = static_cast<int>(std::floor(pos[1] / sBatchBlockSize));
+
+        candidates[std::make_tuple(model, blockX, blockY)].push_back(ptr);
+    }
+
+    Resource::SceneManager* sceneManager = mResourceSystem->getSceneManager();
+    for (std::map<BatchKey, std::vector<MWWorld::Ptr> >::const_iterator iter = candidates.begin(); iter != candidates.end(); ++iter)
+    {
+        const std::string& model = std::get<0>(iter->first);
+        if (iter->second.size() < sMinBatchInstances || !isModelMergeable(model))
+            continue;
+
+        osg::Vec3f origin ((std::get<1>(iter->first) + 0.5f) * sBatchBlockSize, (std::get<2>(iter->first) + 0.5f) * sBatchBlockSize, 0.f);
+        osg::ref_ptr<InstanceBatch> batch (new InstanceBatch(origin));
+        for (std::vector<MWWorld::Ptr>::const_iterator ptr = iter->second.begin(); ptr != iter->second.end(); ++ptr)
+        {
+            batch->addInstance(*ptr);
+            mBatches[*ptr] = batch;
+        }
+
+        batch->build(*sceneManager->getTemplate(model), sceneManager);
+        cellNode->second->addChild(batch);
+    }
+}
+
+void Objects::unbatchObject(const MWWorld::ConstPtr& ptr)
+{
+    PtrBatchMap::iterator found = mBatches.find(ptr);
+    if (found == mBatches.end())
+        return;
+
+    osg::ref_ptr<InstanceBatch> batch = found->second;
+    for (std::vector<MWWorld::Ptr>::const_iterator iter = batch->getInstances().begin(); iter != batch->getInstances().end(); ++iter)
+        mBatches.erase(*iter);
+
+    batch->dissolve();
+
+    if (mUnrefQueue.get())
+        mUnrefQueue->push(batch);
+}
+
+bool Objects::isModelMergeable(const std::string& model)
+{
+    std::map<std::string, bool>::const_iterator found = mMergeableModels.find(model);
+    if (found != mMergeableModels.end())
+        return found->second;
+
+    bool mergeable = MWRender::isMergeable(*mResourceSystem->getSceneManager()->getTemplate(model));
+    mMergeableModels[model] = mergeable;
+    return mergeable;
+}
+
 void Objects::updatePtr(const MWWorld::Ptr &old, const MWWorld::Ptr &cur)
 {
+    unbatchObject(old);
+
     osg::Node* objectNode = cur.getRefData().getBaseNode();
     if (!objectNode)
         return;
 
     MWWorld::CellStore *newCell = cur.getCell();
 
-    osg::Group* cellnode;
-    if(mCellSceneNodes.find(newCell) == mCellSceneNodes.end()) {
-        cellnode = new osg::Group;
-        mRootNode->addChild(cellnode);
-        mCellSceneNodes[newCell] = cellnode;
-    } else {
-        cellnode = mCellSceneNodes[newCell];
-    }
+    osg::Group* cellnode = getOrCreateCellNode(newCell);
 
     osg::UserDataContainer* userDataContainer = objectNode->getUserDataContainer();
     if (userDataContainer)
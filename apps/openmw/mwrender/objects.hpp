@@ -32,6 +32,8 @@ namespace SceneUtil
 namespace MWRender{
 
 class Animation;
+class InstanceBatch;
+class OcclusionCulling;
 
 class PtrHolder : public osg::Object
 {
@@ -62,14 +64,25 @@ class Objects{
     CellMap mCellSceneNodes;
     PtrAnimationMap mObjects;
 
+    typedef std::map<MWWorld::ConstPtr, osg::ref_ptr<InstanceBatch> > PtrBatchMap;
+    PtrBatchMap mBatches;
+
+    std::map<std::string, bool> mMergeableModels;
+
     osg::ref_ptr<osg::Group> mRootNode;
 
     Resource::ResourceSystem* mResourceSystem;
 
     osg::ref_ptr<SceneUtil::UnrefQueue> mUnrefQueue;
 
+    osg::ref_ptr<OcclusionCulling> mOcclusionCulling;
+
     void insertBegin(const MWWorld::Ptr& ptr);
 
+    osg::Group* getOrCreateCellNode(const MWWorld::CellStore* store);
+
+    bool isModelMergeable(const std::string& model);
+
 public:
     Objects(Resource::ResourceSystem* resourceSystem, osg::ref_ptr<osg::Group> rootNode, SceneUtil::UnrefQueue* unrefQueue);
     ~Objects();
@@ -89,6 +102,16 @@ public:
 
     void removeCell(const MWWorld::CellStore* store);
 
+    /// Render identical static models placed close to each other in \a store as batches.
+    /// @note Call after all objects of the cell have been inserted.
+    void batchCell(const MWWorld::CellStore* store);
+
+    /// Give \a ptr its own rendering back, e.g. before it is moved. The other instances of its batch are unbatched as well.
+    void unbatchObject(const MWWorld::ConstPtr& ptr);
+
+    /// Skip the objects hidden behind occluders when culling the cells created from now on.
+    void setOcclusionCulling(OcclusionCulling* occlusionCulling);
+
     /// Updates containing cell for object rendering data
     void updatePtr(const MWWorld::Ptr &old, const MWWorld::Ptr &cur);
 
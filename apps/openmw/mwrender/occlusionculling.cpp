@@ -0,0 +1,377 @@
+#include "occlusionculling.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <typeinfo>
+
+#include <osg/Camera>
+#include <osg/Geometry>
+#include <osg/Stats>
+#include <osg/Transform>
+#include <osg/TriangleIndexFunctor>
+
+#include <osgUtil/CullVisitor>
+
+#include <components/debug/debuglog.hpp>
+#include <components/esm/loadland.hpp>
+#include <components/esm/loadstat.hpp>
+#include <components/esmterrain/storage.hpp>
+#include <components/misc/stringops.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/positionattitudetransform.hpp>
+
+#include "../mwworld/cellstore.hpp"
+#include "../mwworld/class.hpp"
+
+#include "geometrymerger.hpp"
+#include "vismask.hpp"
+
+namespace
+{
+
+    // models with more triangles cost more to rasterize than they are likely to save
+    const std::size_t sMaxOccluderTriangles = 2000;
+
+    // occluders smaller than this on screen, relative to their distance, hardly hide anything
+    const float sMinOccluderScreenSize = 0.02f;
+
+    // terrain occluder quads per cell side
+    const int sTerrainOccluderQuads = 4;
+
+    bool isTransparent(const osg::StateSet* stateSet)
+    {
+        return stateSet && (stateSet->getAttribute(osg::StateAttribute::BLENDFUNC)
+                            || stateSet->getAttribute(osg::StateAttribute::ALPHAFUNC)
+                            || (stateSet->getMode(GL_BLEND) & osg::StateAttribute::ON));
+    }
+
+    struct CollectTriangles
+    {
+        CollectTriangles()
+            : mIndices(nullptr)
+            , mOffset(0)
+        {
+        }
+
+        void operator()(unsigned int i1, unsigned int i2, unsigned int i3)
+        {
+            mIndices->push_back(mOffset + i1);
+            mIndices->push_back(mOffset + i2);
+            mIndices->push_back(mOffset + i3);
+        }
+
+        std::vector<unsigned int>* mIndices;
+        unsigned int mOffset;
+    };
+
+    /// Collects the opaque triangles of a model template in model space.
+    class OccluderMeshVisitor : public osg::NodeVisitor
+    {
+    public:
+        OccluderMeshVisitor(std::vector<osg::Vec3f>& vertices, std::vector<unsigned int>& indices)
+            : osg::NodeVisitor(TRAVERSE_ACTIVE_CHILDREN)
+            , mVertices(vertices)
+            , mIndices(indices)
+        {
+            // skip hidden nodes, e.g. collision shapes
+            setTraversalMask(~MWRender::Mask_UpdateVisitor);
+            mMatrices.push_back(osg::Matrix::identity());
+        }
+
+        void apply(osg::Node& node) override
+        {
+            // transparent surfaces let objects behind them through, skip the whole subgraph
+            if (isTransparent(node.getStateSet()))
+                return;
+
+            traverse(node);
+        }
+
+        void apply(osg::Transform& transform) override
+        {
+            osg::Matrix matrix = mMatrices.back();
+            transform.computeLocalToWorldMatrix(matrix, this);
+            mMatrices.push_back(matrix);
+
+            apply(static_cast<osg::Node&>(transform));
+
+            mMatrices.pop_back();
+        }
+
+        void apply(osg::Drawable& drawable) override
+        {
+            if (isTransparent(drawable.getStateSet()))
+                return;
+
+            osg::Geometry* geometry = drawable.asGeometry();
+            if (!geometry)
+                return;
+            const osg::Vec3Array* vertices = dynamic_cast<const osg::Vec3Array*>(geometry->getVertexArray());
+            if (!vertices)
+                return;
+
+            osg::TriangleIndexFunctor<CollectTriangles> functor;
+            functor.mIndices = &mIndices;
+            functor.mOffset = static_cast<unsigned int>(mVertices.size());
+            geometry->accept(functor);
+
+            const osg::Matrix& matrix = mMatrices.back();
+            for (osg::Vec3Array::const_iterator it = vertices->begin(); it != vertices->end(); ++it)
+                mVertices.push_back(*it * matrix);
+        }
+
+    private:
+        std::vector<osg::Vec3f>& mVertices;
+        std::vector<unsigned int>& mIndices;
+        std::vector<osg::Matrix> mMatrices;
+    };
+
+}
+
+namespace MWRender
+{
+
+OcclusionCulling::OcclusionCulling(osg::Camera* camera, Resource::SceneManager* sceneManager, ESMTerrain::Storage* terrainStorage, float minOccluderSize)
+    : mCamera(camera)
+    , mSceneManager(sceneManager)
+    , mTerrainStorage(terrainStorage)
+    , mMinOccluderSize(minOccluderSize)
+    , mBuffer(256, 128)
+    , mFrameNumber(0)
+    , mHasBuffer(false)
+    , mNumOccluders(0)
+    , mNumOccluded(0)
+{
+}
+
+void OcclusionCulling::addCell(const MWWorld::CellStore* store)
+{
+    if (store->getCell()->isExterior())
+    {
+        std::shared_ptr<const OccluderMesh> mesh = createTerrainMesh(store->getCell()->getGridX(), store->getCell()->getGridY());
+        if (mesh)
+        {
+            Occluder& occluder = mTerrainOccluders[store];
+            occluder.mMesh = mesh;
+            occluder.mBound.init();
+            for (std::vector<osg::Vec3f>::const_iterator it = mesh->mVertices.begin(); it != mesh->mVertices.end(); ++it)
+                occluder.mBound.expandBy(*it);
+            occluder.mCell = store;
+        }
+    }
+
+    store->forEachConst([&] (const MWWorld::ConstPtr& ptr)
+    {
+        if (ptr.getTypeName() != typeid(ESM::Static).name() || !ptr.getRefData().getCount() || !ptr.getRefData().isEnabled())
+            return true;
+
+        // hidden objects and objects without a model, e.g. markers
+        const SceneUtil::PositionAttitudeTransform* baseNode = ptr.getRefData().getBaseNode();
+        if (!baseNode || baseNode->getNodeMask() != Mask_Static || baseNode->getBound().radius() < mMinOccluderSize)
+            return true;
+
+        std::shared_ptr<const OccluderMesh> mesh = getMesh(Misc::StringUtils::lowerCase(ptr.getClass().getModel(ptr)));
+        if (!mesh)
+            return true;
+
+        Occluder& occluder = mObjectOccluders[ptr];
+        occluder.mMesh = mesh;
+        baseNode->computeLocalToWorldMatrix(occluder.mTransform, nullptr);
+        occluder.mBound = baseNode->getBound();
+        occluder.mCell = store;
+        return true;
+    });
+}
+
+void OcclusionCulling::removeCell(const MWWorld::CellStore* store)
+{
+    mTerrainOccluders.erase(store);
+
+    for (std::map<MWWorld::ConstPtr, Occluder>::iterator it = mObjectOccluders.begin(); it != mObjectOccluders.end();)
+    {
+        if (it->second.mCell == store)
+            mObjectOccluders.erase(it++);
+        else
+            ++it;
+    }
+}
+
+void OcclusionCulling::removeObject(const MWWorld::ConstPtr& ptr)
+{
+    mObjectOccluders.erase(ptr);
+}
+
+std::shared_ptr<const OcclusionCulling::OccluderMesh> OcclusionCulling::getMesh(const std::string& model)
+{
+    std::map<std::string, std::shared_ptr<const OccluderMesh> >::const_iterator found = mMeshes.find(model);
+    if (found != mMeshes.end())
+        return found->second;
+
+    std::shared_ptr<OccluderMesh> mesh;
+    try
+    {
+        osg::ref_ptr<const osg::Node> node = mSceneManager->getTemplate(model);
+        // animated and otherwise dynamic models may move away from their triangles
+        if (isMergeable(*node))
+        {
+            mesh.reset(new OccluderMesh);
+            OccluderMeshVisitor visitor(mesh->mVertices, mesh->mIndices);
+            const_cast<osg::Node&>(*node).accept(visitor);
+
+            if (mesh->mIndices.empty() || mesh->mIndices.size() / 3 > sMaxOccluderTriangles)
+                mesh.reset();
+        }
+    }
+    catch (std::exception& e)
+    {
+        Log(Debug::Warning) << "Failed to create occluder for model '" << model << "': " << e.what();
+    }
+
+    mMeshes[model] = mesh;
+    return mesh;
+}
+
+std::shared_ptr<const OcclusionCulling::OccluderMesh> OcclusionCulling::createTerrainMesh(int cellX, int cellY)
+{
+    osg::ref_ptr<const ESMTerrain::LandObject> land = mTerrainStorage->getLand(cellX, cellY);
+    const ESM::Land::LandData* data = land ? land->getData(ESM::Land::DATA_VHGT) : nullptr;
+    if (!data)
+        return nullptr;
+
+    const int step = (ESM::Land::LAND_SIZE - 1) / sTerrainOccluderQuads;
+
+    float quadMinHeights[sTerrainOccluderQuads][sTerrainOccluderQuads];
+    for (int quadY=0; quadY<sTerrainOccluderQuads; ++quadY)
+    {
+        for (int quadX=0; quadX<sTerrainOccluderQuads; ++quadX)
+        {
+            float minHeight = std::numeric_limits<float>::max();
+            for (int y=quadY*step; y<=(quadY+1)*step; ++y)
+                for (int x=quadX*step; x<=(quadX+1)*step; ++x)
+                    minHeight = std::min(minHeight, data->mHeights[y * ESM::Land::LAND_SIZE + x]);
+            quadMinHeights[quadY][quadX] = minHeight;
+        }
+    }
+
+    // Every vertex takes the lowest height of the quads around it. The interpolated mesh then never rises above the
+    // actual terrain, even where the terrain is rendered at a lower level of detail.
+    std::shared_ptr<OccluderMesh> mesh (new OccluderMesh);
+    const int numVertices = sTerrainOccluderQuads + 1;
+    for (int vertexY=0; vertexY<numVertices; ++vertexY)
+    {
+        for (int vertexX=0; vertexX<numVertices; ++vertexX)
+        {
+            float height = std::numeric_limits<float>::max();
+            for (int quadY = std::max(0, vertexY-1); quadY <= std::min(sTerrainOccluderQuads-1, vertexY); ++quadY)
+                for (int quadX = std::max(0, vertexX-1); quadX <= std::min(sTerrainOccluderQuads-1, vertexX); ++quadX)
+                    height = std::min(height, quadMinHeights[quadY][quadX]);
+
+            mesh->mVertices.push_back(osg::Vec3f((cellX + vertexX / static_cast<float>(sTerrainOccluderQuads)) * ESM::Land::REAL_SIZE,
+                                                 (cellY + vertexY / static_cast<float>(sTerrainOccluderQuads)) * ESM::Land::REAL_SIZE,
+                                                 height));
+        }
+    }
+
+    for (int quadY=0; quadY<sTerrainOccluderQuads; ++quadY)
+    {
+        for (int quadX=0; quadX<sTerrainOccluderQuads; ++quadX)
+        {
+            unsigned int v00 = quadY * numVertices + quadX;
+            unsigned int v10 = v00 + 1;
+            unsigned int v01 = v00 + numVertices;
+            unsigned int v11 = v01 + 1;
+            unsigned int indices[6] = { v00, v10, v11, v00, v11, v01 };
+            mesh->mIndices.insert(mesh->mIndices.end(), indices, indices + 6);
+        }
+    }
+
+    return mesh;
+}
+
+void OcclusionCulling::operator()(osg::Node* node, osg::NodeVisitor* nv)
+{
+    osgUtil::CullVisitor* cv = static_cast<osgUtil::CullVisitor*>(nv);
+    if (cv->getCurrentCamera() == mCamera && cv->getFrameStamp())
+    {
+        mBuffer.clear(*cv->getModelViewMatrix() * *cv->getProjectionMatrix());
+        mNumOccluders = 0;
+        mNumOccluded = 0;
+
+        for (std::map<const MWWorld::CellStore*, Occluder>::const_iterator it = mTerrainOccluders.begin(); it != mTerrainOccluders.end(); ++it)
+            rasterize(cv, it->second);
+        for (std::map<MWWorld::ConstPtr, Occluder>::const_iterator it = mObjectOccluders.begin(); it != mObjectOccluders.end(); ++it)
+            rasterize(cv, it->second);
+
+        mBuffer.finish();
+        mFrameNumber = cv->getFrameStamp()->getFrameNumber();
+        mHasBuffer = true;
+    }
+
+    traverse(node, nv);
+}
+
+void OcclusionCulling::rasterize(osgUtil::CullVisitor* cv, const Occluder& occluder)
+{
+    if (cv->isCulled(occluder.mBound))
+        return;
+
+    float distance = (occluder.mBound.center() - cv->getEyePoint()).length();
+    if (occluder.mBound.radius() < distance * sMinOccluderScreenSize)
+        return;
+
+    mBuffer.addTriangles(occluder.mMesh->mVertices, occluder.mMesh->mIndices, occluder.mTransform);
+    ++mNumOccluders;
+}
+
+bool OcclusionCulling::isActive(osgUtil::CullVisitor* cv) const
+{
+    return mHasBuffer && cv->getCurrentCamera() == mCamera
+            && cv->getFrameStamp() && cv->getFrameStamp()->getFrameNumber() == mFrameNumber;
+}
+
+bool OcclusionCulling::isOccluded(const osg::Node& node)
+{
+    const osg::BoundingSphere& bound = node.getBound();
+    if (!bound.valid())
+        return false;
+
+    osg::BoundingBox box;
+    box.expandBy(bound);
+    if (!mBuffer.isOccluded(box))
+        return false;
+
+    ++mNumOccluded;
+    return true;
+}
+
+void OcclusionCulling::reportStats(unsigned int frameNumber, osg::Stats* stats) const
+{
+    stats->setAttribute(frameNumber, "Occluder", mNumOccluders);
+    stats->setAttribute(frameNumber, "Occluded", mNumOccluded);
+}
+
+CellOcclusionCallback::CellOcclusionCallback(OcclusionCulling* occlusionCulling)
+    : mOcclusionCulling(occlusionCulling)
+{
+}
+
+void CellOcclusionCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
+{
+    osgUtil::CullVisitor* cv = static_cast<osgUtil::CullVisitor*>(nv);
+    osg::Group* group = node->asGroup();
+    if (!group || !mOcclusionCulling->isActive(cv))
+    {
+        traverse(node, nv);
+        return;
+    }
+
+    // the same as traversing the group, but without the occluded children
+    for (unsigned int i=0; i<group->getNumChildren(); ++i)
+    {
+        osg::Node* child = group->getChild(i);
+        if (!mOcclusionCulling->isOccluded(*child))
+            child->accept(*nv);
+    }
+}
+
+}
@@ -0,0 +1,130 @@
+#ifndef OPENMW_MWRENDER_OCCLUSIONCULLING_H
+#define OPENMW_MWRENDER_OCCLUSIONCULLING_H
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <osg/BoundingSphere>
+#include <osg/Matrix>
+#include <osg/NodeCallback>
+
+#include <components/sceneutil/occlusionbuffer.hpp>
+
+#include "../mwworld/ptr.hpp"
+
+namespace osg
+{
+    class Camera;
+    class Stats;
+}
+
+namespace osgUtil
+{
+    class CullVisitor;
+}
+
+namespace Resource
+{
+    class SceneManager;
+}
+
+namespace ESMTerrain
+{
+    class Storage;
+}
+
+namespace MWWorld
+{
+    class CellStore;
+}
+
+namespace MWRender
+{
+
+    /// @brief CPU side occlusion culling of the objects in the loaded cells.
+    /// @par Large static objects and the terrain of the loaded cells are used as occluders. They are rasterized into a
+    /// SceneUtil::OcclusionBuffer when the main camera starts to cull the scene, the cells then skip the objects that are hidden.
+    /// @par Set as cull callback on the scene root, and a CellOcclusionCallback on each cell node below it.
+    /// @note The occluders are rasterized in the cull traversal, i.e. on the cull thread with the threading models that have one.
+    class OcclusionCulling : public osg::NodeCallback
+    {
+    public:
+        /// @param camera Only the cull traversals of this camera are affected.
+        /// @param minOccluderSize Minimum bounding radius of a static object to be used as occluder.
+        OcclusionCulling(osg::Camera* camera, Resource::SceneManager* sceneManager, ESMTerrain::Storage* terrainStorage, float minOccluderSize);
+
+        /// Use the large static objects and the terrain of a cell as occluders.
+        void addCell(const MWWorld::CellStore* store);
+
+        void removeCell(const MWWorld::CellStore* store);
+
+        /// Stop using an object as occluder, e.g. because it was moved or removed from the scene.
+        void removeObject(const MWWorld::ConstPtr& ptr);
+
+        /// Rasterize the occluders for the main camera.
+        void operator()(osg::Node* node, osg::NodeVisitor* nv) override;
+
+        /// @return Whether the occlusion buffer was built for this cull traversal.
+        bool isActive(osgUtil::CullVisitor* cv) const;
+
+        /// @param node A node in the space of the scene root.
+        bool isOccluded(const osg::Node& node);
+
+        void reportStats(unsigned int frameNumber, osg::Stats* stats) const;
+
+    private:
+        struct OccluderMesh
+        {
+            std::vector<osg::Vec3f> mVertices;
+            std::vector<unsigned int> mIndices;
+        };
+
+        struct Occluder
+        {
+            std::shared_ptr<const OccluderMesh> mMesh;
+            osg::Matrix mTransform;
+            osg::BoundingSphere mBound;
+            const MWWorld::CellStore* mCell;
+        };
+
+        /// @return nullptr if the model is not suitable as occluder.
+        std::shared_ptr<const OccluderMesh> getMesh(const std::string& model);
+
+        std::shared_ptr<const OccluderMesh> createTerrainMesh(int cellX, int cellY);
+
+        void rasterize(osgUtil::CullVisitor* cv, const Occluder& occluder);
+
+        osg::Camera* mCamera;
+        Resource::SceneManager* mSceneManager;
+        ESMTerrain::Storage* mTerrainStorage;
+        float mMinOccluderSize;
+
+        SceneUtil::OcclusionBuffer mBuffer;
+        unsigned int mFrameNumber;
+        bool mHasBuffer;
+
+        std::map<MWWorld::ConstPtr, Occluder> mObjectOccluders;
+        std::map<const MWWorld::CellStore*, Occluder> mTerrainOccluders;
+        std::map<std::string, std::shared_ptr<const OccluderMesh> > mMeshes;
+
+        unsigned int mNumOccluders;
+        unsigned int mNumOccluded;
+    };
+
+    /// @brief Cull callback for a cell node, skips the objects of the cell that are hidden behind occluders.
+    class CellOcclusionCallback : public osg::NodeCallback
+    {
+    public:
+        CellOcclusionCallback(OcclusionCulling* occlusionCulling);
+
+        void operator()(osg::Node* node, osg::NodeVisitor* nv) override;
+
+    private:
+        osg::ref_ptr<OcclusionCulling> mOcclusionCulling;
+    };
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+#include "pagedrefs.hpp"
+
+#include <algorithm>
+
+#include <components/debug/debuglog.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/esm/loadcell.hpp>
+
+namespace MWRender
+{
+
+void readCellRefs(const ESM::Cell& cell, const std::vector<ESM::ESMReader>& sources, std::vector<ESM::ESMReader>& readers,
+                  ToUTF8::Utf8Encoder* encoder, std::map<ESM::RefNum, ESM::CellRef>& refs)
+{
+    for (size_t i = 0; i < cell.mContextList.size(); ++i)
+    {
+        try
+        {
+            const ESM::ESM_Context& context = cell.mContextList[i];
+            size_t index = context.index;
+            if (readers.size() <= index)
+                readers.resize(index+1);
+
+            // a reader of our own, but with the master list of the loaded file to resolve the ref numbers
+            ESM::ESMReader& reader = readers[index];
+            if (reader.getName() != context.filename)
+            {
+                reader.setEncoder(encoder);
+                reader.openCopy(sources.at(index), context.filename);
+            }
+            cell.restore(reader, i);
+
+            ESM::CellRef ref;
+            ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
+            bool deleted = false;
+            while (cell.getNextRef(reader, ref, deleted))
+            {
+                if (std::find(cell.mMovedRefs.begin(), cell.mMovedRefs.end(), ref.mRefNum) != cell.mMovedRefs.end())
+                    continue;
+
+                if (deleted)
+                    refs.erase(ref.mRefNum);
+                else
+                    refs[ref.mRefNum] = ref;
+            }
+        }
+        catch (std::exception& e)
+        {
+            Log(Debug::Error) << "An error occurred reading references for cell " << cell.getDescription() << ": " << e.what();
+        }
+    }
+
+    for (ESM::CellRefTracker::const_iterator it = cell.mLeasedRefs.begin(); it != cell.mLeasedRefs.end(); ++it)
+    {
+        if (it->second)
+            refs.erase(it->first.mRefNum);
+        else
+            refs[it->first.mRefNum] = it->first;
+    }
+}
+
+}
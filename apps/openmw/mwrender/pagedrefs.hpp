@@ -0,0 +1,34 @@
+#ifndef OPENMW_MWRENDER_PAGEDREFS_H
+#define OPENMW_MWRENDER_PAGEDREFS_H
+
+#include <map>
+#include <vector>
+
+#include <components/esm/cellref.hpp>
+
+namespace ESM
+{
+    struct Cell;
+    class ESMReader;
+}
+
+namespace ToUTF8
+{
+    class Utf8Encoder;
+}
+
+namespace MWRender
+{
+
+    /// Read the references of a cell straight from the content files, following the rules of CellStore::loadRefs:
+    /// later content files override or delete the references of earlier ones, references moved to another cell are left out.
+    /// @param sources The readers the content files were loaded with, their master lists give the references their ref numbers.
+    /// @param readers Readers of the calling thread, indexed like \a sources and opened on demand.
+    /// @param encoder Encoder for the readers, must not be shared with another thread.
+    /// @note Only accesses the loaded headers of \a sources, so it can be called while they are in use on another thread.
+    void readCellRefs(const ESM::Cell& cell, const std::vector<ESM::ESMReader>& sources, std::vector<ESM::ESMReader>& readers,
+                      ToUTF8::Utf8Encoder* encoder, std::map<ESM::RefNum, ESM::CellRef>& refs);
+
+}
+
+#endif
@@ -3,6 +3,8 @@
 #include <limits>
 #include <cstdlib>
 
+#include <boost/filesystem/path.hpp>
+
 #include <osg/Light>
 #include <osg/LightModel>
 #include <osg/Fog>
@@ -13,6 +15,7 @@
 #include <osg/ComputeBoundsVisitor>
 #include <osg/ShapeDrawable>
 #include <osg/TextureCubeMap>
+#include <osg/Version>
 
 #include <osgUtil/LineSegmentIntersector>
 #include <osgUtil/IncrementalCompileOperation>
@@ -27,6 +30,8 @@
 #include <components/resource/imagemanager.hpp>
 #include <components/resource/scenemanager.hpp>
 #include <components/resource/keyframemanager.hpp>
+#include <components/resource/texturestreamer.hpp>
+#include <components/resource/imagecache.hpp>
 #include <components/shader/shadermanager.hpp>
 
 #include <components/settings/settings.hpp>
@@ -44,6 +49,7 @@
 #include <components/terrain/quadtreeworld.hpp>
 
 #include <components/esm/loadcell.hpp>
+#include <components/esm/loadstat.hpp>
 #include <components/fallback/fallback.hpp>
 
 #include <components/detournavigator/navigator.hpp>
@@ -67,6 +73,8 @@
 #include "util.hpp"
 #include "navmesh.hpp"
 #include "actorspaths.hpp"
+#include "objectpaging.hpp"
+#include "occlusionculling.hpp"
 
 namespace
 {
@@ -76,6 +84,17 @@ namespace
     float DLUnderwaterFogEnd;
     float DLInteriorFogStart;
     float DLInteriorFogEnd;
+
+    bool isPageable(const MWWorld::ConstPtr& ptr)
+    {
+        return ptr.isInCell() && ptr.getCell()->isExterior() && ptr.getCellRef().hasContentFile()
+            && ptr.getTypeName() == typeid(ESM::Static).name();
+    }
+
+    osg::Vec2i getCellIndex(const MWWorld::ConstPtr& ptr)
+    {
+        return osg::Vec2i(ptr.getCell()->getCell()->getGridX(), ptr.getCell()->getCell()->getGridY());
+    }
 }
 
 namespace MWRender
@@ -193,9 +212,49 @@ namespace MWRender
         Resource::ResourceSystem* mResourceSystem;
     };
 
+    /// Builds the shader programs listed in the manifest of the last session. The shaders are compiled by the
+    /// IncrementalCompileOperation on the graphics thread, spread over several frames.
+    class PrebuildShadersWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        PrebuildShadersWorkItem(Shader::ShaderManager& shaderManager, const std::string& manifestPath, osgUtil::IncrementalCompileOperation* incrementalCompileOperation)
+            : mShaderManager(shaderManager)
+            , mManifestPath(manifestPath)
+            , mIncrementalCompileOperation(incrementalCompileOperation)
+        {
+        }
+
+        virtual void doWork()
+        {
+            std::vector<Shader::ShaderManager::ProgramVariant> variants = mShaderManager.readManifest(mManifestPath);
+
+            osg::ref_ptr<osg::Group> programs (new osg::Group);
+            for (std::vector<Shader::ShaderManager::ProgramVariant>::const_iterator it = variants.begin(); it != variants.end(); ++it)
+            {
+                osg::ref_ptr<osg::Program> program = mShaderManager.buildProgram(*it);
+                if (!program)
+                    continue;
+                osg::ref_ptr<osg::Node> node (new osg::Node);
+                node->getOrCreateStateSet()->setAttributeAndModes(program, osg::StateAttribute::ON);
+                programs->addChild(node);
+            }
+
+            if (programs->getNumChildren() > 0 && mIncrementalCompileOperation)
+                mIncrementalCompileOperation->add(programs);
+
+            Log(Debug::Info) << "Prebuilt " << programs->getNumChildren() << " of " << variants.size() << " shader programs";
+        }
+
+    private:
+        Shader::ShaderManager& mShaderManager;
+        std::string mManifestPath;
+        osg::ref_ptr<osgUtil::IncrementalCompileOperation> mIncrementalCompileOperation;
+    };
+
     RenderingManager::RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode,
                                        Resource::ResourceSystem* resourceSystem, SceneUtil::WorkQueue* workQueue,
-                                       const std::string& resourcePath, DetourNavigator::Navigator& navigator)
+                                       const std::string& resourcePath, const std::string& cachePath, DetourNavigator::Navigator& navigator,
+                                       const ToUTF8::Utf8Encoder* encoder)
         : mViewer(viewer)
         , mRootNode(rootNode)
         , mResourceSystem(resourceSystem)
@@ -227,6 +286,27 @@ namespace MWRender
         resourceSystem->getSceneManager()->setAutoUseSpecularMaps(Settings::Manager::getBool("auto use object specular maps", "Shaders"));
         resourceSystem->getSceneManager()->setSpecularMapPattern(Settings::Manager::getString("specular map pattern", "Shaders"));
 
+        if (Settings::Manager::getBool("texture streaming", "General"))
+        {
+#if OSG_VERSION_GREATER_OR_EQUAL(3,6,0)
+            mTextureStreamer = new Resource::TextureStreamer(mResourceSystem->getImageManager(), mWorkQueue.get(), mViewer->getCamera(),
+                                                             std::max(1, Settings::Manager::getInt("texture streaming base size", "General")),
+                                                             static_cast<std::size_t>(std::max(0, Settings::Manager::getInt("texture streaming budget", "General"))) * 1024 * 1024);
+            mResourceSystem->getImageManager()->setTextureStreamer(mTextureStreamer);
+#else
+            // older versions upload a resized image into the existing texture object
+            Log(Debug::Warning) << "Texture streaming requires OpenSceneGraph 3.6 or newer and is disabled";
+#endif
+        }
+
+        if (Settings::Manager::getBool("image cache", "General"))
+            mResourceSystem->getImageManager()->setImageCache(new Resource::ImageCache((boost::filesystem::path(cachePath) / "images").string(),
+                                                                                       static_cast<std::uint64_t>(std::max(0, Settings::Manager::getInt("image cache size", "General"))) * 1024 * 1024));
+
+        int decodeThreads = Settings::Manager::getInt("preload decode threads", "Cells");
+        if (Settings::Manager::getBool("preload enabled", "Cells") && decodeThreads > 0)
+            mResourceSystem->getImageManager()->setDecodeWorkQueue(new SceneUtil::WorkQueue(decodeThreads));
+
         osg::ref_ptr<SceneUtil::LightManager> sceneRoot = new SceneUtil::LightManager;
         sceneRoot->setLightingMask(Mask_Lighting);
         mSceneRoot = sceneRoot;
@@ -286,6 +366,7 @@ namespace MWRender
 
         mDistantFog = Settings::Manager::getBool("use distant fog", "Fog");
         mDistantTerrain = Settings::Manager::getBool("distant terrain", "Terrain");
+        mBatchInstances = Settings::Manager::getBool("instance batching", "Cells");
 
         const std::string normalMapPattern = Settings::Manager::getString("normal map pattern", "Shaders");
         const std::string heightMapPattern = Settings::Manager::getString("normal height map pattern", "Shaders");
@@ -305,16 +386,41 @@ namespace MWRender
             const int vertexLodMod = Settings::Manager::getInt("vertex lod mod", "Terrain");
             float maxCompGeometrySize = Settings::Manager::getFloat("max composite geometry size", "Terrain");
             maxCompGeometrySize = std::max(maxCompGeometrySize, 1.f);
-            mTerrain.reset(new Terrain::QuadTreeWorld(
+            Terrain::QuadTreeWorld* quadTreeWorld = new Terrain::QuadTreeWorld(
                 sceneRoot, mRootNode, mResourceSystem, mTerrainStorage, Mask_Terrain, Mask_PreCompile, Mask_Debug,
-                compMapResolution, compMapLevel, lodFactor, vertexLodMod, maxCompGeometrySize));
+                compMapResolution, compMapLevel, lodFactor, vertexLodMod, maxCompGeometrySize);
+            mTerrain.reset(quadTreeWorld);
+
+            quadTreeWorld->setNumPreloadThreads(std::max(1, Settings::Manager::getInt("preload threads", "Terrain")));
+
+            if (Settings::Manager::getBool("composite map cache", "Terrain"))
+                quadTreeWorld->setCompositeMapCache((boost::filesystem::path(cachePath) / "compositemaps").string());
+
+            if (Settings::Manager::getBool("object paging", "Terrain"))
+            {
+                mObjectPaging.reset(new ObjectPaging(mResourceSystem->getSceneManager(), Settings::Manager::getFloat("object paging min size", "Terrain"), encoder));
+                quadTreeWorld->addChunkManager(mObjectPaging.get());
+                mResourceSystem->addResourceManager(mObjectPaging.get());
+            }
         }
         else
             mTerrain.reset(new Terrain::TerrainGrid(sceneRoot, mRootNode, mResourceSystem, mTerrainStorage, Mask_Terrain, Mask_PreCompile, Mask_Debug));
 
+        // paged objects are part of the terrain, they can't be told apart from it when caching the static shadow casters
+        if (Settings::Manager::getBool("cache static shadow casters", "Shadows") && !(mObjectPaging && Settings::Manager::getBool("terrain shadows", "Shadows")))
+            mShadowManager->setStaticShadowCasterMask(Mask_Static);
+
         mTerrain->setTargetFrameRate(Settings::Manager::getFloat("target framerate", "Cells"));
         mTerrain->setWorkQueue(mWorkQueue.get());
 
+        if (Settings::Manager::getBool("occlusion culling", "Camera"))
+        {
+            mOcclusionCulling = new OcclusionCulling(mViewer->getCamera(), mResourceSystem->getSceneManager(), mTerrainStorage,
+                                                     Settings::Manager::getFloat("occluder min size", "Camera"));
+            sceneRoot->addCullCallback(mOcclusionCulling);
+            mObjects->setOcclusionCulling(mOcclusionCulling);
+        }
+
         mCamera.reset(new Camera(mViewer->getCamera()));
 
         mViewer->setLightingMode(osgViewer::View::NO_LIGHT);
@@ -383,12 +489,28 @@ namespace MWRender
         mUniformNear = mRootNode->getOrCreateStateSet()->getUniform("near");
         mUniformFar = mRootNode->getOrCreateStateSet()->getUniform("far");
         updateProjectionMatrix();
+
+        if (Settings::Manager::getBool("prebuild shaders", "Shaders"))
+        {
+            mShaderManifestPath = (boost::filesystem::path(cachePath) / "shaders.manifest").string();
+            mWorkQueue->addWorkItem(new PrebuildShadersWorkItem(mResourceSystem->getSceneManager()->getShaderManager(),
+                                                                mShaderManifestPath, mViewer->getIncrementalCompileOperation()));
+        }
     }
 
     RenderingManager::~RenderingManager()
     {
         // let background loading thread finish before we delete anything else
         mWorkQueue = nullptr;
+
+        if (mTextureStreamer)
+            mResourceSystem->getImageManager()->setTextureStreamer(nullptr);
+
+        if (!mShaderManifestPath.empty())
+            mResourceSystem->getSceneManager()->getShaderManager().writeManifest(mShaderManifestPath);
+
+        if (mObjectPaging)
+            mResourceSystem->removeResourceManager(mObjectPaging.get());
     }
 
     MWRender::Objects& RenderingManager::getObjects()
@@ -509,10 +631,18 @@ namespace MWRender
     {
         mPathgrid->addCell(store);
 
+        if (mBatchInstances)
+            mObjects->batchCell(store);
+
+        if (mOcclusionCulling)
+            mOcclusionCulling->addCell(store);
+
         mWater->changeCell(store);
 
         if (store->getCell()->isExterior())
             mTerrain->loadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
+
+        mShadowManager->dirtyStaticShadowCasters();
     }
     void RenderingManager::removeCell(const MWWorld::CellStore *store)
     {
@@ -520,10 +650,15 @@ namespace MWRender
         mActorsPaths->removeCell(store);
         mObjects->removeCell(store);
 
+        if (mOcclusionCulling)
+            mOcclusionCulling->removeCell(store);
+
         if (store->getCell()->isExterior())
             mTerrain->unloadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
 
         mWater->removeCell(store);
+
+        mShadowManager->dirtyStaticShadowCasters();
     }
 
     void RenderingManager::enableTerrain(bool enable)
@@ -531,6 +666,23 @@ namespace MWRender
         mTerrain->enable(enable);
     }
 
+    void RenderingManager::setActiveGrid(const osg::Vec4i& grid)
+    {
+        mTerrain->setActiveGrid(grid);
+    }
+
+    void RenderingManager::pagingEnableObject(const MWWorld::ConstPtr& ptr, bool enabled)
+    {
+        if (mObjectPaging && isPageable(ptr) && mObjectPaging->enableObject(ptr.getCellRef().getRefNum(), getCellIndex(ptr), enabled))
+            mTerrain->rebuildViews();
+    }
+
+    void RenderingManager::pagingBlacklistObject(const MWWorld::ConstPtr& ptr)
+    {
+        if (mObjectPaging && isPageable(ptr) && mObjectPaging->blacklistObject(ptr.getCellRef().getRefNum(), getCellIndex(ptr)))
+            mTerrain->rebuildViews();
+    }
+
     void RenderingManager::setSkyEnabled(bool enabled)
     {
         mSky->setEnabled(enabled);
@@ -639,6 +791,9 @@ namespace MWRender
 
         mUnrefQueue->flush(mWorkQueue.get());
 
+        if (mTextureStreamer)
+            mTextureStreamer->update(mViewer->getFrameStamp()->getFrameNumber());
+
         if (!paused)
         {
             mEffectManager->update(dt);
@@ -691,16 +846,31 @@ namespace MWRender
             mCamera->rotateCamera(-ptr.getRefData().getPosition().rot[0], -ptr.getRefData().getPosition().rot[2], false);
         }
 
+        mObjects->unbatchObject(ptr);
+        if (mOcclusionCulling)
+            mOcclusionCulling->removeObject(ptr);
+        if (ptr.getRefData().getBaseNode()->getNodeMask() == Mask_Static)
+            mShadowManager->dirtyStaticShadowCasters();
         ptr.getRefData().getBaseNode()->setAttitude(rot);
     }
 
     void RenderingManager::moveObject(const MWWorld::Ptr &ptr, const osg::Vec3f &pos)
     {
+        mObjects->unbatchObject(ptr);
+        if (mOcclusionCulling)
+            mOcclusionCulling->removeObject(ptr);
+        if (ptr.getRefData().getBaseNode()->getNodeMask() == Mask_Static)
+            mShadowManager->dirtyStaticShadowCasters();
         ptr.getRefData().getBaseNode()->setPosition(pos);
     }
 
     void RenderingManager::scaleObject(const MWWorld::Ptr &ptr, const osg::Vec3f &scale)
     {
+        mObjects->unbatchObject(ptr);
+        if (mOcclusionCulling)
+            mOcclusionCulling->removeObject(ptr);
+        if (ptr.getRefData().getBaseNode()->getNodeMask() == Mask_Static)
+            mShadowManager->dirtyStaticShadowCasters();
         ptr.getRefData().getBaseNode()->setScale(scale);
 
         if (ptr == mCamera->getTrackingPtr()) // update height of camera
@@ -710,7 +880,11 @@ namespace MWRender
     void RenderingManager::removeObject(const MWWorld::Ptr &ptr)
     {
         mActorsPaths->remove(ptr);
+        if (ptr.getRefData().getBaseNode() && ptr.getRefData().getBaseNode()->getNodeMask() == Mask_Static)
+            mShadowManager->dirtyStaticShadowCasters();
         mObjects->removeObject(ptr);
+        if (mOcclusionCulling)
+            mOcclusionCulling->removeObject(ptr);
         mWater->removeEmitter(ptr);
     }
 
@@ -1094,6 +1268,9 @@ namespace MWRender
     {
         mObjects->updatePtr(old, updated);
         mActorsPaths->updatePtr(old, updated);
+        if (mOcclusionCulling)
+            mOcclusionCulling->removeObject(old);
+        mShadowManager->dirtyStaticShadowCasters();
     }
 
     void RenderingManager::spawnEffect(const std::string &model, const std::string &texture, const osg::Vec3f &worldPosition, float scale, bool isMagicVFX)
@@ -1104,12 +1281,19 @@ namespace MWRender
     void RenderingManager::notifyWorldSpaceChanged()
     {
         mEffectManager->clear();
+        mShadowManager->dirtyStaticShadowCasters();
     }
 
     void RenderingManager::clear()
     {
         mSky->setMoonColour(false);
 
+        if (mObjectPaging)
+        {
+            mObjectPaging->clear();
+            mTerrain->rebuildViews();
+        }
+
         notifyWorldSpaceChanged();
     }
 
@@ -1250,6 +1434,10 @@ namespace MWRender
             stats->setAttribute(frameNumber, "UnrefQueue", mUnrefQueue->getNumItems());
 
             mTerrain->reportStats(frameNumber, stats);
+            if (mOcclusionCulling)
+                mOcclusionCulling->reportStats(frameNumber, stats);
+            if (mTextureStreamer)
+                mTextureStreamer->reportStats(frameNumber, stats);
         }
     }
 
@@ -19,6 +19,7 @@ namespace osg
 {
     class Group;
     class PositionAttitudeTransform;
+    class Vec4i;
 }
 
 namespace osgUtil
@@ -30,6 +31,7 @@ namespace osgUtil
 namespace Resource
 {
     class ResourceSystem;
+    class TextureStreamer;
 }
 
 namespace osgViewer
@@ -59,6 +61,11 @@ namespace SceneUtil
     class UnrefQueue;
 }
 
+namespace ToUTF8
+{
+    class Utf8Encoder;
+}
+
 namespace DetourNavigator
 {
     struct Navigator;
@@ -80,13 +87,16 @@ namespace MWRender
     class LandManager;
     class NavMesh;
     class ActorsPaths;
+    class ObjectPaging;
+    class OcclusionCulling;
 
     class RenderingManager : public MWRender::RenderingInterface
     {
     public:
         RenderingManager(osgViewer::Viewer* viewer, osg::ref_ptr<osg::Group> rootNode,
                          Resource::ResourceSystem* resourceSystem, SceneUtil::WorkQueue* workQueue,
-                         const std::string& resourcePath, DetourNavigator::Navigator& navigator);
+                         const std::string& resourcePath, const std::string& cachePath, DetourNavigator::Navigator& navigator,
+                         const ToUTF8::Utf8Encoder* encoder);
         ~RenderingManager();
 
         MWRender::Objects& getObjects();
@@ -127,6 +137,14 @@ namespace MWRender
 
         void enableTerrain(bool enable);
 
+        /// Set the exterior cells that are loaded into the scene, (minX, minY, maxX, maxY) with exclusive maximums.
+        void setActiveGrid(const osg::Vec4i& grid);
+
+        /// Report that a reference loaded from a content file was enabled or disabled, see ObjectPaging.
+        void pagingEnableObject(const MWWorld::ConstPtr& ptr, bool enabled);
+        /// Report that a reference loaded from a content file was moved, rotated, scaled or deleted, see ObjectPaging.
+        void pagingBlacklistObject(const MWWorld::ConstPtr& ptr);
+
         void updatePtr(const MWWorld::Ptr& old, const MWWorld::Ptr& updated);
 
         void rotateObject(const MWWorld::Ptr& ptr, const osg::Quat& rot);
@@ -265,6 +283,9 @@ namespace MWRender
         std::unique_ptr<Water> mWater;
         std::unique_ptr<Terrain::World> mTerrain;
         TerrainStorage* mTerrainStorage;
+        std::unique_ptr<ObjectPaging> mObjectPaging;
+        osg::ref_ptr<OcclusionCulling> mOcclusionCulling;
+        osg::ref_ptr<Resource::TextureStreamer> mTextureStreamer;
         std::unique_ptr<SkyManager> mSky;
         std::unique_ptr<EffectManager> mEffectManager;
         std::unique_ptr<SceneUtil::ShadowManager> mShadowManager;
@@ -291,12 +312,16 @@ namespace MWRender
         float mViewDistance;
         bool mDistantFog : 1;
         bool mDistantTerrain : 1;
+        bool mBatchInstances : 1;
         bool mFieldOfViewOverridden : 1;
         float mFieldOfViewOverride;
         float mFieldOfView;
         float mFirstPersonFieldOfView;
         bool mBorders;
 
+        // where the shader programs used in this session are written to on exit, empty if disabled
+        std::string mShaderManifestPath;
+
         void operator = (const RenderingManager&);
         RenderingManager(const RenderingManager&);
     };
@@ -77,9 +77,11 @@ namespace MWScript
 
             if (Success)
             {
-                std::vector<Interpreter::Type_Code> code;
-                mParser.getCode (code);
-                mScripts.insert (std::make_pair (name, std::make_pair (code, mParser.getLocals())));
+                CompiledScript compiled;
+                compiled.mName = name;
+                mParser.getCode (compiled.mByteCode);
+                compiled.mLocals = mParser.getLocals();
+                mScripts.insert (std::make_pair (name, compiled));
 
                 return true;
             }
@@ -89,6 +91,11 @@ namespace MWScript
     }
 
     void ScriptManager::run (const std::string& name, Interpreter::Context& interpreterContext)
+    {
+        run (getCompiledScript (name), interpreterContext);
+    }
+
+    CompiledScript& ScriptManager::getCompiledScript (const std::string& name)
     {
         // compile script
         ScriptCollection::iterator iter = mScripts.find (name);
@@ -98,17 +105,24 @@ namespace MWScript
             if (!compile (name))
             {
                 // failed -> ignore script from now on.
-                std::vector<Interpreter::Type_Code> empty;
-                mScripts.insert (std::make_pair (name, std::make_pair (empty, Compiler::Locals())));
-                return;
+                CompiledScript empty;
+                empty.mName = name;
+                iter = mScripts.insert (std::make_pair (name, empty)).first;
+            }
+            else
+            {
+                iter = mScripts.find (name);
+                assert (iter!=mScripts.end());
             }
-
-            iter = mScripts.find (name);
-            assert (iter!=mScripts.end());
         }
 
+        return iter->second;
+    }
+
+    void ScriptManager::run (CompiledScript& script, Interpreter::Context& interpreterContext)
+    {
         // execute script
-        if (!iter->second.first.empty())
+        if (!script.mByteCode.empty())
             try
             {
                 if (!mOpcodesInstalled)
@@ -117,14 +131,14 @@ namespace MWScript
                     mOpcodesInstalled = true;
                 }
 
-                mInterpreter.run (&iter->second.first[0], iter->second.first.size(), interpreterContext);
+                mInterpreter.run (&script.mByteCode[0], script.mByteCode.size(), interpreterContext);
             }
             catch (const std::exception& e)
             {
-                Log(Debug::Error) << "Execution of script " << name << " failed:";
+                Log(Debug::Error) << "Execution of script " << script.mName << " failed:";
                 Log(Debug::Error) << e.what();
 
-                iter->second.first.clear(); // don't execute again.
+                script.mByteCode.clear(); // don't execute again.
             }
     }
 
@@ -157,7 +171,7 @@ namespace MWScript
             ScriptCollection::iterator iter = mScripts.find (name2);
 
             if (iter!=mScripts.end())
-                return iter->second.second;
+                return iter->second.mLocals;
         }
 
         {
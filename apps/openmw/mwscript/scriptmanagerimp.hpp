@@ -32,6 +32,13 @@ namespace Interpreter
 
 namespace MWScript
 {
+    struct CompiledScript
+    {
+        std::string mName;
+        std::vector<Interpreter::Type_Code> mByteCode; ///< empty, if the script failed to compile or run
+        Compiler::Locals mLocals;
+    };
+
     class ScriptManager : public MWBase::ScriptManager
     {
             Compiler::StreamErrorHandler mErrorHandler;
@@ -41,7 +48,6 @@ namespace MWScript
             Interpreter::Interpreter mInterpreter;
             bool mOpcodesInstalled;
 
-            typedef std::pair<std::vector<Interpreter::Type_Code>, Compiler::Locals> CompiledScript;
             typedef std::map<std::string, CompiledScript> ScriptCollection;
 
             ScriptCollection mScripts;
@@ -58,6 +64,15 @@ namespace MWScript
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext);
             ///< Run the script with the given name (compile first, if not compiled yet)
 
+            virtual CompiledScript& getCompiledScript (const std::string& name);
+            ///< Return the script with the given name (compile first, if not compiled yet).
+            ///
+            /// The returned reference stays valid for the lifetime of the script manager and can be
+            /// used to run the script repeatedly without looking it up again.
+
+            virtual void run (CompiledScript& script, Interpreter::Context& interpreterContext);
+            ///< Run a script returned by getCompiledScript.
+
             virtual bool compile (const std::string& name);
             ///< Compile script with the given namen
             /// \return Success?
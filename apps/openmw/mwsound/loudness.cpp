@@ -1,6 +1,8 @@
 #include "loudness.hpp"
 
 #include <stdint.h>
+#include <cmath>
+#include <cstring>
 #include <limits>
 #include <algorithm>
 
@@ -9,53 +11,109 @@
 namespace MWSound
 {
 
-void Sound_Loudness::analyzeLoudness(const std::vector< char >& data)
+namespace
 {
-    mQueue.insert( mQueue.end(), data.begin(), data.end() );
-    if (!mQueue.size())
-        return;
+    template<typename T>
+    inline T loadSample(const char *data)
+    {
+        T value;
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
 
-    int samplesPerSegment = static_cast<int>(mSampleRate / mSamplesPerSec);
-    int numSamples = bytesToFrames(mQueue.size(), mChannelConfig, mSampleType);
-    int advance = framesToBytes(1, mChannelConfig, mSampleType);
+    inline float toFloat(uint8_t value)
+    {
+        return static_cast<int8_t>(value ^ 0x80) / 128.f;
+    }
 
+    inline float toFloat(int16_t value)
+    {
+        return value / float(std::numeric_limits<int16_t>::max());
+    }
 
-    int segment=0;
-    int sample=0;
-    while (segment < numSamples/samplesPerSegment)
+    inline float toFloat(float value)
     {
-        float sum=0;
-        int samplesAdded = 0;
-        while (sample < numSamples && sample < (segment+1)*samplesPerSegment)
+        return std::max(-1.f, std::min(1.f, value)); // Float samples *should* be scaled to [-1,1] already.
+    }
+
+    /// Sum of the squared values of \a frames samples of the first channel, \a stride bytes apart.
+    /// Uses independent accumulators, so the compiler can vectorize the loop.
+    template<typename T>
+    float sumSquares(const char *data, size_t frames, size_t stride)
+    {
+        const size_t lanes = 8;
+        float sums[lanes] = {};
+
+        size_t frame = 0;
+        for (; frame + lanes <= frames; frame += lanes)
         {
-            // get sample on a scale from -1 to 1
-            float value = 0;
-            if (mSampleType == SampleType_UInt8)
-                value = ((char)(mQueue[sample*advance]^0x80))/128.f;
-            else if (mSampleType == SampleType_Int16)
-            {
-                value = *reinterpret_cast<const int16_t*>(&mQueue[sample*advance]);
-                value /= float(std::numeric_limits<int16_t>::max());
-            }
-            else if (mSampleType == SampleType_Float32)
+            const char *block = data + frame*stride;
+            for (size_t lane = 0; lane < lanes; ++lane)
             {
-                value = *reinterpret_cast<const float*>(&mQueue[sample*advance]);
-                value = std::max(-1.f, std::min(1.f, value)); // Float samples *should* be scaled to [-1,1] already.
+                float value = toFloat(loadSample<T>(block + lane*stride));
+                sums[lane] += value*value;
             }
+        }
+        for (; frame < frames; ++frame)
+        {
+            float value = toFloat(loadSample<T>(data + frame*stride));
+            sums[0] += value*value;
+        }
 
-            sum += value*value;
-            ++samplesAdded;
-            ++sample;
+        float sum = 0;
+        for (size_t lane = 0; lane < lanes; ++lane)
+            sum += sums[lane];
+        return sum;
+    }
+}
+
+float Sound_Loudness::computeRms(const char *data, size_t frames) const
+{
+    if (frames == 0)
+        return 0.f;
+
+    const size_t stride = framesToBytes(1, mChannelConfig, mSampleType);
+
+    float sum = 0;
+    switch (mSampleType)
+    {
+        case SampleType_UInt8: sum = sumSquares<uint8_t>(data, frames, stride); break;
+        case SampleType_Int16: sum = sumSquares<int16_t>(data, frames, stride); break;
+        case SampleType_Float32: sum = sumSquares<float>(data, frames, stride); break;
+    }
+    return std::sqrt(sum / frames);
+}
+
+void Sound_Loudness::analyzeLoudness(const char *data, size_t size)
+{
+    const size_t samplesPerSegment = static_cast<size_t>(mSampleRate / mSamplesPerSec);
+    if (samplesPerSegment == 0 || size == 0)
+        return;
+
+    const size_t segmentSize = framesToBytes(samplesPerSegment, mChannelConfig, mSampleType);
+
+    // Complete the segment left over from the previous call first
+    if (!mQueue.empty())
+    {
+        size_t missing = segmentSize - mQueue.size();
+        if (size < missing)
+        {
+            mQueue.insert(mQueue.end(), data, data + size);
+            return;
         }
 
-        float rms = 0; // root mean square
-        if (samplesAdded > 0)
-            rms = std::sqrt(sum / samplesAdded);
-        mSamples.push_back(rms);
-        ++segment;
+        mQueue.insert(mQueue.end(), data, data + missing);
+        mSamples.push_back(computeRms(mQueue.data(), samplesPerSegment));
+        mQueue.clear();
+        data += missing;
+        size -= missing;
     }
 
-    mQueue.erase(mQueue.begin(), mQueue.begin() + sample*advance);
+    // Analyze whole segments directly from the given buffer
+    for (; size >= segmentSize; data += segmentSize, size -= segmentSize)
+        mSamples.push_back(computeRms(data, samplesPerSegment));
+
+    mQueue.assign(data, data + size);
 }
 
 
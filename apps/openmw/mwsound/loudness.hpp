@@ -2,13 +2,14 @@
 #define GAME_SOUND_LOUDNESS_H
 
 #include <vector>
-#include <deque>
 
 #include "sound_decoder.hpp"
 
 namespace MWSound
 {
 
+const int sLoudnessFPS = 20; // loudness values per second of audio
+
 class Sound_Loudness {
     float mSamplesPerSec;
     int mSampleRate;
@@ -18,7 +19,10 @@ class Sound_Loudness {
     // Loudness sample info
     std::vector<float> mSamples;
 
-    std::deque<char> mQueue;
+    // Remaining data from the last call to analyzeLoudness, shorter than one segment
+    std::vector<char> mQueue;
+
+    float computeRms(const char *data, size_t frames) const;
 
 public:
     /**
@@ -44,7 +48,8 @@ public:
      * will be kept in the mQueue and used in the next call to analyzeLoudness.
      * @param data the sound buffer to analyze, containing raw samples
      */
-    void analyzeLoudness(const std::vector<char>& data);
+    void analyzeLoudness(const std::vector<char>& data) { analyzeLoudness(data.data(), data.size()); }
+    void analyzeLoudness(const char *data, size_t size);
 
     /**
      * Get loudness at a particular time. Before calling this, the stream has to be analyzed up to that point in time (see analyzeLoudness()).
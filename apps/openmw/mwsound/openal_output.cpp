@@ -35,8 +35,6 @@
 namespace
 {
 
-const int sLoudnessFPS = 20; // loudness values per second of audio
-
 ALCenum checkALCError(ALCdevice *device, const char *func, int line)
 {
     ALCenum err = alcGetError(device);
@@ -944,12 +942,13 @@ void OpenAL_Output::setHrtf(const std::string &hrtfname, HrtfMode hrtfmode)
 
 std::pair<Sound_Handle,size_t> OpenAL_Output::loadSound(const std::string &fname)
 {
-    getALError();
-
-    std::vector<char> data;
-    ALenum format = AL_NONE;
-    int srate = 0;
+    Sound_Data data;
+    decodeSound(fname, data);
+    return loadSound(data);
+}
 
+void OpenAL_Output::decodeSound(const std::string &fname, Sound_Data &data)
+{
     try
     {
         DecoderPtr decoder = mManager.getDecoder();
@@ -965,29 +964,37 @@ std::pair<Sound_Handle,size_t> OpenAL_Output::loadSound(const std::string &fname
             decoder->open(file);
         }
 
-        ChannelConfig chans;
-        SampleType type;
-        decoder->getInfo(&srate, &chans, &type);
-        format = getALFormat(chans, type);
-        if(format) decoder->readAll(data);
+        decoder->getInfo(&data.mSampleRate, &data.mChannels, &data.mSampleType);
+        decoder->readAll(data.mData);
     }
     catch(std::exception &e)
     {
         Log(Debug::Error) << "Failed to load audio from " << fname << ": " << e.what();
+        data.mData.clear();
     }
+}
+
+std::pair<Sound_Handle,size_t> OpenAL_Output::loadSound(Sound_Data &data)
+{
+    getALError();
+
+    ALenum format = AL_NONE;
+    int srate = data.mSampleRate;
+    if(!data.mData.empty())
+        format = getALFormat(data.mChannels, data.mSampleType);
 
-    if(data.empty())
+    if(!format)
     {
         // If we failed to get any usable audio, substitute with silence.
         format = AL_FORMAT_MONO8;
         srate = 8000;
-        data.assign(8000, -128);
+        data.mData.assign(8000, -128);
     }
 
     ALint size;
     ALuint buf = 0;
     alGenBuffers(1, &buf);
-    alBufferData(buf, format, data.data(), data.size(), srate);
+    alBufferData(buf, format, data.mData.data(), data.mData.size(), srate);
     alGetBufferi(buf, AL_SIZE, &size);
     if(getALError() != AL_NO_ERROR)
     {
@@ -67,6 +67,8 @@ namespace MWSound
         virtual void setHrtf(const std::string &hrtfname, HrtfMode hrtfmode);
 
         virtual std::pair<Sound_Handle,size_t> loadSound(const std::string &fname);
+        virtual void decodeSound(const std::string &fname, Sound_Data &data);
+        virtual std::pair<Sound_Handle,size_t> loadSound(Sound_Data &data);
         virtual size_t unloadSound(Sound_Handle data);
 
         virtual bool playSound(Sound *sound, Sound_Handle data, float offset);
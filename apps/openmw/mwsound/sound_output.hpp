@@ -6,6 +6,7 @@
 #include <vector>
 
 #include "soundmanagerimp.hpp"
+#include "sound_decoder.hpp"
 
 namespace MWSound
 {
@@ -19,6 +20,18 @@ namespace MWSound
     // An opaque handle for the implementation's sound instances.
     typedef void *Sound_Instance;
 
+    // Fully decoded sound data, ready to be handed to the output. May be
+    // produced on a worker thread.
+    struct Sound_Data
+    {
+        std::vector<char> mData;
+        int mSampleRate;
+        ChannelConfig mChannels;
+        SampleType mSampleType;
+
+        Sound_Data() : mSampleRate(0), mChannels(ChannelConfig_Mono), mSampleType(SampleType_UInt8) { }
+    };
+
     enum class HrtfMode {
         Disable,
         Enable,
@@ -37,6 +50,11 @@ namespace MWSound
         virtual void setHrtf(const std::string &hrtfname, HrtfMode hrtfmode) = 0;
 
         virtual std::pair<Sound_Handle,size_t> loadSound(const std::string &fname) = 0;
+        /// Decode the given sound file into memory. Does not touch the output device, so it is
+        /// safe to call from a worker thread.
+        virtual void decodeSound(const std::string &fname, Sound_Data &data) = 0;
+        /// Create an output buffer from previously decoded data. Must be called from the main thread.
+        virtual std::pair<Sound_Handle,size_t> loadSound(Sound_Data &data) = 0;
         virtual size_t unloadSound(Sound_Handle data) = 0;
 
         virtual bool playSound(Sound *sound, Sound_Handle data, float offset) = 0;
@@ -78,6 +96,7 @@ namespace MWSound
 
         friend class OpenAL_Output;
         friend class SoundManager;
+        friend class SoundDecodeItem;
     };
 }
 
@@ -3,12 +3,14 @@
 #include <algorithm>
 #include <map>
 #include <numeric>
+#include <atomic>
 
 #include <osg/Matrixf>
 
 #include <components/misc/rng.hpp>
 #include <components/debug/debuglog.hpp>
 #include <components/vfs/manager.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -26,6 +28,7 @@
 
 #include "openal_output.hpp"
 #include "ffmpeg_decoder.hpp"
+#include "loudness.hpp"
 
 
 namespace MWSound
@@ -33,6 +36,110 @@ namespace MWSound
     // For combining PlayMode and Type flags
     inline int operator|(PlayMode a, Type b) { return static_cast<int>(a) | static_cast<int>(b); }
 
+    // Number of voice files to keep the loudness tracks of
+    const std::size_t sMaxVoiceLoudnessTracks = 64;
+
+    /// Decodes a sound file into memory on a worker thread. The result is handed over to the
+    /// output by the main thread.
+    class SoundDecodeItem : public SceneUtil::WorkItem
+    {
+    public:
+        SoundDecodeItem(Sound_Output& output, const std::string& resourceName)
+            : mOutput(output)
+            , mResourceName(resourceName)
+            , mAborted(false)
+        {
+        }
+
+        virtual void doWork()
+        {
+            if (mAborted)
+                return;
+
+            mOutput.decodeSound(mResourceName, mData);
+        }
+
+        virtual void abort()
+        {
+            mAborted = true;
+        }
+
+        Sound_Data mData;
+
+    private:
+        Sound_Output& mOutput;
+        std::string mResourceName;
+        std::atomic<bool> mAborted;
+    };
+
+    /// Decodes a whole voice file on a worker thread to compute its loudness track for lip syncing.
+    class VoiceLoudnessItem : public SceneUtil::WorkItem
+    {
+    public:
+        VoiceLoudnessItem(DecoderPtr decoder, const std::string& voicefile)
+            : mDecoder(decoder)
+            , mVoiceFile(voicefile)
+            , mAborted(false)
+        {
+        }
+
+        virtual void doWork()
+        {
+            if (mAborted)
+                return;
+
+            try
+            {
+                // Workaround: Bethesda at some point converted some of the files to mp3, but the references were kept as .wav.
+                if (mDecoder->mResourceMgr->exists(mVoiceFile))
+                    mDecoder->open(mVoiceFile);
+                else
+                {
+                    std::string file = mVoiceFile;
+                    std::string::size_type pos = file.rfind('.');
+                    if (pos != std::string::npos)
+                        file = file.substr(0, pos)+".mp3";
+                    mDecoder->open(file);
+                }
+
+                int srate;
+                ChannelConfig chans;
+                SampleType type;
+                mDecoder->getInfo(&srate, &chans, &type);
+
+                std::vector<char> data;
+                mDecoder->readAll(data);
+                mDecoder->close();
+
+                std::unique_ptr<Sound_Loudness> loudness(new Sound_Loudness(sLoudnessFPS, srate, chans, type));
+                loudness->analyzeLoudness(data);
+                mLoudness = std::move(loudness);
+            }
+            catch (std::exception& e)
+            {
+                Log(Debug::Error) << "Failed to analyze loudness of " << mVoiceFile << ": " << e.what();
+            }
+            mDecoder.reset();
+        }
+
+        virtual void abort()
+        {
+            mAborted = true;
+        }
+
+        /// @note May only be used once the item is done. Returns nullptr if the analysis failed.
+        const Sound_Loudness* getLoudness() const
+        {
+            return mLoudness.get();
+        }
+
+    private:
+        DecoderPtr mDecoder;
+        std::string mVoiceFile;
+        std::unique_ptr<Sound_Loudness> mLoudness;
+        std::atomic<bool> mAborted;
+    };
+
     SoundManager::SoundManager(const VFS::Manager* vfs, bool useSound)
         : mVFS(vfs)
         , mOutput(new DEFAULT_OUTPUT(*this))
@@ -95,6 +202,9 @@ namespace MWSound
             return;
         }
 
+        // Not the shared work queue, so that decoding does not wait behind cell preloading
+        mWorkQueue = new SceneUtil::WorkQueue;
+
         std::vector<std::string> names = mOutput->enumerate();
         std::stringstream stream;
 
@@ -119,6 +229,17 @@ namespace MWSound
     SoundManager::~SoundManager()
     {
         clear();
+        for(PendingBufferMap::value_type &pending : mPendingBuffers)
+            pending.second->abort();
+        for(PendingBufferMap::value_type &pending : mPendingBuffers)
+            pending.second->waitTillDone();
+        mPendingBuffers.clear();
+        for(VoiceLoudnessMap::value_type &voice : mVoiceLoudness)
+            voice.second.mItem->abort();
+        for(VoiceLoudnessMap::value_type &voice : mVoiceLoudness)
+            voice.second.mItem->waitTillDone();
+        mVoiceLoudness.clear();
+        mVoiceLoudnessUsage.clear();
         for(Sound_Buffer &sfx : *mSoundBuffers)
         {
             if(sfx.mHandle)
@@ -175,7 +296,8 @@ namespace MWSound
         if(snd != mBufferNameMap.end())
         {
             Sound_Buffer *sfx = snd->second;
-            if(sfx->mHandle) return sfx;
+            if(sfx->mHandle || mPendingBuffers.find(sfx) != mPendingBuffers.end())
+                return sfx;
         }
         return nullptr;
     }
@@ -213,33 +335,140 @@ namespace MWSound
 #undef UNLIKELY
 
         if(!sfx->mHandle)
+            requestBuffer(sfx);
+
+        return sfx;
+    }
+
+    void SoundManager::requestBuffer(Sound_Buffer *sfx)
+    {
+        if(mPendingBuffers.find(sfx) != mPendingBuffers.end())
+            return;
+
+        if(!mWorkQueue)
         {
             size_t size;
             std::tie(sfx->mHandle, size) = mOutput->loadSound(sfx->mResourceName);
-            if(!sfx->mHandle) return nullptr;
+            if(sfx->mHandle)
+                bufferLoaded(sfx, size);
+            return;
+        }
 
-            mBufferCacheSize += size;
-            if(mBufferCacheSize > mBufferCacheMax)
+        osg::ref_ptr<SoundDecodeItem> item(new SoundDecodeItem(*mOutput, sfx->mResourceName));
+        mWorkQueue->addWorkItem(item);
+        mPendingBuffers.emplace(sfx, item);
+    }
+
+    void SoundManager::bufferLoaded(Sound_Buffer *sfx, size_t size)
+    {
+        mBufferCacheSize += size;
+        if(mBufferCacheSize > mBufferCacheMax)
+        {
+            do {
+                if(mUnusedBuffers.empty())
+                {
+                    Log(Debug::Warning) << "No unused sound buffers to free, using " << mBufferCacheSize << " bytes!";
+                    break;
+                }
+                Sound_Buffer *unused = mUnusedBuffers.back();
+
+                size = mOutput->unloadSound(unused->mHandle);
+                mBufferCacheSize -= size;
+                unused->mHandle = 0;
+
+                mUnusedBuffers.pop_back();
+            } while(mBufferCacheSize > mBufferCacheMin);
+        }
+        if(sfx->mUses == 0)
+            mUnusedBuffers.push_front(sfx);
+    }
+
+    void SoundManager::updatePendingBuffers()
+    {
+        PendingBufferMap::iterator iter = mPendingBuffers.begin();
+        while(iter != mPendingBuffers.end())
+        {
+            if(!iter->second->isDone())
             {
-                do {
-                    if(mUnusedBuffers.empty())
-                    {
-                        Log(Debug::Warning) << "No unused sound buffers to free, using " << mBufferCacheSize << " bytes!";
-                        break;
-                    }
-                    Sound_Buffer *unused = mUnusedBuffers.back();
+                ++iter;
+                continue;
+            }
 
-                    size = mOutput->unloadSound(unused->mHandle);
-                    mBufferCacheSize -= size;
-                    unused->mHandle = 0;
+            Sound_Buffer *sfx = iter->first;
+            size_t size;
+            std::tie(sfx->mHandle, size) = mOutput->loadSound(iter->second->mData);
+            iter = mPendingBuffers.erase(iter);
+            if(sfx->mHandle)
+                bufferLoaded(sfx, size);
+        }
+    }
 
-                    mUnusedBuffers.pop_back();
-                } while(mBufferCacheSize > mBufferCacheMin);
+    bool SoundManager::startSound(Sound *sound, Sound_Buffer *sfx, float offset)
+    {
+        if(!sfx->mHandle)
+        {
+            if(mPendingBuffers.find(sfx) == mPendingBuffers.end())
+                return false;
+            mPendingSounds.push_back(PendingSound{sound, sfx, offset});
+            return true;
+        }
+
+        if(sound->getIs3D())
+            return mOutput->playSound3D(sound, sfx->mHandle, offset);
+        return mOutput->playSound(sound, sfx->mHandle, offset);
+    }
+
+    void SoundManager::startPendingSounds()
+    {
+        PendingSoundList::iterator iter = mPendingSounds.begin();
+        while(iter != mPendingSounds.end())
+        {
+            Sound_Buffer *sfx = iter->mBuffer;
+            if(mPendingBuffers.find(sfx) != mPendingBuffers.end())
+            {
+                ++iter;
+                continue;
+            }
+
+            // If the buffer failed to load, or the sound can't be started, the sound isn't
+            // playing and gets cleaned up in updateSounds.
+            Sound *sound = iter->mSound;
+            float offset = iter->mOffset;
+            iter = mPendingSounds.erase(iter);
+            if(sfx->mHandle)
+            {
+                if(sound->getIs3D())
+                    mOutput->playSound3D(sound, sfx->mHandle, offset);
+                else
+                    mOutput->playSound(sound, sfx->mHandle, offset);
             }
-            mUnusedBuffers.push_front(sfx);
         }
+    }
 
-        return sfx;
+    SoundManager::PendingSoundList::iterator SoundManager::findPendingSound(Sound *sound)
+    {
+        return std::find_if(mPendingSounds.begin(), mPendingSounds.end(),
+            [sound](const PendingSound &pending) -> bool
+            { return pending.mSound == sound; }
+        );
+    }
+
+    bool SoundManager::isSoundPlaying(Sound *sound) const
+    {
+        if(std::find_if(mPendingSounds.begin(), mPendingSounds.end(),
+            [sound](const PendingSound &pending) -> bool
+            { return pending.mSound == sound; }
+        ) != mPendingSounds.end())
+            return true;
+        return mOutput->isSoundPlaying(sound);
+    }
+
+    void SoundManager::finishSound(Sound *sound)
+    {
+        PendingSoundList::iterator iter = findPendingSound(sound);
+        if(iter != mPendingSounds.end())
+            mPendingSounds.erase(iter);
+        mOutput->finishSound(sound);
     }
 
     DecoderPtr SoundManager::loadVoice(const std::string &voicefile)
@@ -302,7 +531,40 @@ namespace MWSound
         return ret;
     }
 
-    Stream *SoundManager::playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal)
+    osg::ref_ptr<VoiceLoudnessItem> SoundManager::getVoiceLoudness(const std::string &voicefile)
+    {
+        if(!mWorkQueue)
+            return nullptr;
+
+        VoiceLoudnessMap::iterator found = mVoiceLoudness.find(voicefile);
+        if(found != mVoiceLoudness.end())
+        {
+            mVoiceLoudnessUsage.splice(mVoiceLoudnessUsage.begin(), mVoiceLoudnessUsage, found->second.mUsage);
+            return found->second.mItem;
+        }
+
+        // Drop the least recently said tracks. Unfinished ones are kept, the destructor waits for them.
+        // Streams still playing a dropped track hold their own reference to it.
+        std::list<std::string>::iterator usage = mVoiceLoudnessUsage.end();
+        while(mVoiceLoudness.size() >= sMaxVoiceLoudnessTracks && usage != mVoiceLoudnessUsage.begin())
+        {
+            --usage;
+            VoiceLoudnessMap::iterator oldest = mVoiceLoudness.find(*usage);
+            if(oldest->second.mItem->isDone())
+            {
+                mVoiceLoudness.erase(oldest);
+                usage = mVoiceLoudnessUsage.erase(usage);
+            }
+        }
+
+        osg::ref_ptr<VoiceLoudnessItem> item(new VoiceLoudnessItem(getDecoder(), voicefile));
+        mWorkQueue->addWorkItem(item);
+        mVoiceLoudnessUsage.push_front(voicefile);
+        mVoiceLoudness.emplace(voicefile, VoiceLoudness{item, mVoiceLoudnessUsage.begin()});
+        return item;
+    }
+
+    Stream *SoundManager::playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal, VoiceLoudnessItem *loudness)
     {
         MWBase::World* world = MWBase::Environment::get().getWorld();
         static const float fAudioMinDistanceMult = world->getStore().get<ESM::GameSetting>().find("fAudioMinDistanceMult")->mValue.getFloat();
@@ -312,25 +574,35 @@ namespace MWSound
         static float minDistance = std::max(fAudioVoiceDefaultMinDistance * fAudioMinDistanceMult, 1.0f);
         static float maxDistance = std::max(fAudioVoiceDefaultMaxDistance * fAudioMaxDistanceMult, minDistance);
 
+        // Use the loudness track only once it's available. Until then, e.g. the first time a line is said,
+        // the stream analyzes the data as it's played.
+        if(loudness && (!loudness->isDone() || !loudness->getLoudness()))
+            loudness = nullptr;
+
         bool played;
         float basevol = volumeFromType(Type::Voice);
         Stream *sound = getStreamRef();
         if(playlocal)
         {
             sound->init(1.0f, basevol, 1.0f, PlayMode::NoEnv|Type::Voice|Play_2D);
-            played = mOutput->streamSound(decoder, sound, true);
+            played = mOutput->streamSound(decoder, sound, !loudness);
         }
         else
         {
             sound->init(pos, 1.0f, basevol, 1.0f, minDistance, maxDistance,
                         PlayMode::Normal|Type::Voice|Play_3D);
-            played = mOutput->streamSound3D(decoder, sound, true);
+            played = mOutput->streamSound3D(decoder, sound, !loudness);
         }
         if(!played)
         {
             mUnusedStreams.push_back(sound);
             return nullptr;
         }
+
+        if(loudness)
+            mSayLoudness[sound] = loudness;
+        else
+            mSayLoudness.erase(sound);
         return sound;
     }
 
@@ -517,7 +789,7 @@ namespace MWSound
         const osg::Vec3f pos = world->getActorHeadTransform(ptr).getTrans();
 
         stopSay(ptr);
-        Stream *sound = playVoice(decoder, pos, (ptr == MWMechanics::getPlayer()));
+        Stream *sound = playVoice(decoder, pos, (ptr == MWMechanics::getPlayer()), getVoiceLoudness(voicefile).get());
         if(!sound) return;
 
         mSaySoundsQueue.emplace(ptr, sound);
@@ -529,6 +801,9 @@ namespace MWSound
         if(snditer != mActiveSaySounds.end())
         {
             Stream *sound = snditer->second;
+            StreamLoudnessMap::const_iterator loudness = mSayLoudness.find(sound);
+            if(loudness != mSayLoudness.end())
+                return loudness->second->getLoudness()->getLoudnessAtTime(mOutput->getStreamOffset(sound));
             return mOutput->getStreamLoudness(sound);
         }
 
@@ -548,7 +823,7 @@ namespace MWSound
             return;
 
         stopSay(MWWorld::ConstPtr());
-        Stream *sound = playVoice(decoder, osg::Vec3f(), true);
+        Stream *sound = playVoice(decoder, osg::Vec3f(), true, getVoiceLoudness(voicefile).get());
         if(!sound) return;
 
         mActiveSaySounds.insert(std::make_pair(MWWorld::ConstPtr(), sound));
@@ -654,7 +929,7 @@ namespace MWSound
 
         Sound *sound = getSoundRef();
         sound->init(volume * sfx->mVolume, volumeFromType(type), pitch, mode|type|Play_2D);
-        if(!mOutput->playSound(sound, sfx->mHandle, offset))
+        if(!startSound(sound, sfx, offset))
         {
             mUnusedSounds.push_back(sound);
             return nullptr;
@@ -693,14 +968,13 @@ namespace MWSound
         if(!(mode&PlayMode::NoPlayerLocal) && ptr == MWMechanics::getPlayer())
         {
             sound->init(volume * sfx->mVolume, volumeFromType(type), pitch, mode|type|Play_2D);
-            played = mOutput->playSound(sound, sfx->mHandle, offset);
         }
         else
         {
             sound->init(objpos, volume * sfx->mVolume, volumeFromType(type), pitch,
                         sfx->mMinDist, sfx->mMaxDist, mode|type|Play_3D);
-            played = mOutput->playSound3D(sound, sfx->mHandle, offset);
         }
+        played = startSound(sound, sfx, offset);
         if(!played)
         {
             mUnusedSounds.push_back(sound);
@@ -731,7 +1005,7 @@ namespace MWSound
         Sound *sound = getSoundRef();
         sound->init(initialPos, volume * sfx->mVolume, volumeFromType(type), pitch,
                     sfx->mMinDist, sfx->mMaxDist, mode|type|Play_3D);
-        if(!mOutput->playSound3D(sound, sfx->mHandle, offset))
+        if(!startSound(sound, sfx, offset))
         {
             mUnusedSounds.push_back(sound);
             return nullptr;
@@ -747,10 +1021,18 @@ namespace MWSound
         return sound;
     }
 
+    void SoundManager::preloadSound(const std::string& soundId)
+    {
+        if(!mOutput->isInitialized())
+            return;
+
+        loadSound(Misc::StringUtils::lowerCase(soundId));
+    }
+
     void SoundManager::stopSound(Sound *sound)
     {
         if(sound)
-            mOutput->finishSound(sound);
+            finishSound(sound);
     }
 
     void SoundManager::stopSound(Sound_Buffer *sfx, const MWWorld::ConstPtr &ptr)
@@ -761,7 +1043,7 @@ namespace MWSound
             for(SoundBufferRefPair &snd : snditer->second)
             {
                 if(snd.second == sfx)
-                    mOutput->finishSound(snd.first);
+                    finishSound(snd.first);
             }
         }
     }
@@ -794,7 +1076,7 @@ namespace MWSound
         if(snditer != mActiveSounds.end())
         {
             for(SoundBufferRefPair &snd : snditer->second)
-                mOutput->finishSound(snd.first);
+                finishSound(snd.first);
         }
         SaySoundMap::iterator sayiter = mSaySoundsQueue.find(ptr);
         if(sayiter != mSaySoundsQueue.end())
@@ -811,7 +1093,7 @@ namespace MWSound
             if(!snd.first.isEmpty() && snd.first != MWMechanics::getPlayer() && snd.first.getCell() == cell)
             {
                 for(SoundBufferRefPair &sndbuf : snd.second)
-                    mOutput->finishSound(sndbuf.first);
+                    finishSound(sndbuf.first);
             }
         }
 
@@ -851,7 +1133,7 @@ namespace MWSound
             Sound_Buffer *sfx = lookupSound(Misc::StringUtils::lowerCase(soundId));
             return std::find_if(snditer->second.cbegin(), snditer->second.cend(),
                 [this,sfx](const SoundBufferRefPair &snd) -> bool
-                { return snd.second == sfx && mOutput->isSoundPlaying(snd.first); }
+                { return snd.second == sfx && isSoundPlaying(snd.first); }
             ) != snditer->second.cend();
         }
         return false;
@@ -988,7 +1270,7 @@ namespace MWSound
         {
             if (volume == 0.0f)
             {
-                mOutput->finishSound(mNearWaterSound);
+                finishSound(mNearWaterSound);
                 mNearWaterSound = nullptr;
             }
             else
@@ -1014,7 +1296,7 @@ namespace MWSound
 
                 if(soundIdChanged)
                 {
-                    mOutput->finishSound(mNearWaterSound);
+                    finishSound(mNearWaterSound);
                     mNearWaterSound = playSound(soundId, volume, 1.0f, Type::Sfx, PlayMode::Loop);
                 }
                 else if (sfx)
@@ -1039,6 +1321,10 @@ namespace MWSound
             mSaySoundsQueue.erase(queuesayiter++);
         }
 
+        // Start sounds as soon as their buffers finished loading, regardless of the update rate
+        updatePendingBuffers();
+        startPendingSounds();
+
         static float timePassed = 0.0;
 
         timePassed += duration;
@@ -1056,7 +1342,7 @@ namespace MWSound
             env = Env_Underwater;
         else if(mUnderwaterSound)
         {
-            mOutput->finishSound(mUnderwaterSound);
+            finishSound(mUnderwaterSound);
             mUnderwaterSound = nullptr;
         }
 
@@ -1091,19 +1377,19 @@ namespace MWSound
                     if(sound->getDistanceCull())
                     {
                         if((mListenerPos - objpos).length2() > 2000*2000)
-                            mOutput->finishSound(sound);
+                            finishSound(sound);
                     }
                 }
 
-                if(!mOutput->isSoundPlaying(sound))
+                if(!isSoundPlaying(sound))
                 {
-                    mOutput->finishSound(sound);
+                    finishSound(sound);
                     mUnusedSounds.push_back(sound);
                     if(sound == mUnderwaterSound)
                         mUnderwaterSound = nullptr;
                     if(sound == mNearWaterSound)
                         mNearWaterSound = nullptr;
-                    if(sfx->mUses-- == 1)
+                    if(sfx->mUses-- == 1 && sfx->mHandle)
                         mUnusedBuffers.push_front(sfx);
                     sndidx = snditer->second.erase(sndidx);
                 }
@@ -1368,10 +1654,10 @@ namespace MWSound
         {
             for(SoundBufferRefPair &sndbuf : snd.second)
             {
-                mOutput->finishSound(sndbuf.first);
+                finishSound(sndbuf.first);
                 mUnusedSounds.push_back(sndbuf.first);
                 Sound_Buffer *sfx = sndbuf.second;
-                if(sfx->mUses-- == 1)
+                if(sfx->mUses-- == 1 && sfx->mHandle)
                     mUnusedBuffers.push_front(sfx);
             }
         }
@@ -5,9 +5,12 @@
 #include <string>
 #include <utility>
 #include <deque>
+#include <list>
 #include <map>
 #include <unordered_map>
 
+#include <osg/ref_ptr>
+
 #include <components/settings/settings.hpp>
 
 #include <components/fallback/fallback.hpp>
@@ -24,6 +27,11 @@ namespace ESM
     struct Sound;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWSound
 {
     class Sound_Output;
@@ -31,6 +39,9 @@ namespace MWSound
     class Sound;
     class Stream;
     class Sound_Buffer;
+    class SoundDecodeItem;
+    class VoiceLoudnessItem;
+    class Sound_Loudness;
 
     enum Environment {
         Env_Normal,
@@ -48,6 +59,9 @@ namespace MWSound
 
         std::unique_ptr<Sound_Output> mOutput;
 
+        // Decodes sound buffers and loudness tracks, nullptr if there is no output
+        osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
+
         // Caches available music tracks by <playlist name, (sound files) >
         std::unordered_map<std::string, std::vector<std::string>> mMusicFiles;
         std::unordered_map<std::string, std::vector<int>> mMusicToPlay; // A list with music files not yet played
@@ -81,6 +95,21 @@ namespace MWSound
         typedef std::deque<Sound_Buffer*> SoundList;
         SoundList mUnusedBuffers;
 
+        // Buffers currently being decoded in the background.
+        typedef std::unordered_map<Sound_Buffer*,osg::ref_ptr<SoundDecodeItem>> PendingBufferMap;
+        PendingBufferMap mPendingBuffers;
+
+        // Sounds requested to play whose buffer is not ready yet. They are already listed in
+        // mActiveSounds, and get started once their buffer has finished loading.
+        struct PendingSound
+        {
+            Sound *mSound;
+            Sound_Buffer *mBuffer;
+            float mOffset;
+        };
+        typedef std::vector<PendingSound> PendingSoundList;
+        PendingSoundList mPendingSounds;
+
         std::unique_ptr<std::deque<Sound>> mSounds;
         std::vector<Sound*> mUnusedSounds;
 
@@ -96,6 +125,21 @@ namespace MWSound
         SaySoundMap mSaySoundsQueue;
         SaySoundMap mActiveSaySounds;
 
+        // Loudness tracks of voice files, computed in the background the first time they're said and used
+        // when they're said again.
+        // Only the most recently said files are kept, the front of mVoiceLoudnessUsage is the latest.
+        struct VoiceLoudness
+        {
+            osg::ref_ptr<VoiceLoudnessItem> mItem;
+            std::list<std::string>::iterator mUsage;
+        };
+        typedef std::unordered_map<std::string,VoiceLoudness> VoiceLoudnessMap;
+        VoiceLoudnessMap mVoiceLoudness;
+        std::list<std::string> mVoiceLoudnessUsage;
+        // Say sounds using a finished loudness track, instead of analyzing the stream.
+        typedef std::unordered_map<const Stream*,osg::ref_ptr<VoiceLoudnessItem>> StreamLoudnessMap;
+        StreamLoudnessMap mSayLoudness;
+
         typedef std::vector<Stream*> TrackList;
         TrackList mActiveTracks;
 
@@ -117,13 +161,30 @@ namespace MWSound
         Sound_Buffer *lookupSound(const std::string &soundId) const;
         Sound_Buffer *loadSound(const std::string &soundId);
 
+        // Starts loading the buffer's data, in the background if a work queue is available.
+        void requestBuffer(Sound_Buffer *sfx);
+        // Accounts for a newly loaded buffer, freeing unused buffers if the cache is full.
+        void bufferLoaded(Sound_Buffer *sfx, size_t size);
+        void updatePendingBuffers();
+
+        // Plays the sound now if its buffer is loaded, otherwise queues it until the buffer is ready.
+        bool startSound(Sound *sound, Sound_Buffer *sfx, float offset);
+        void startPendingSounds();
+        PendingSoundList::iterator findPendingSound(Sound *sound);
+        bool isSoundPlaying(Sound *sound) const;
+        void finishSound(Sound *sound);
+
         // returns a decoder to start streaming, or nullptr if the sound was not found
         DecoderPtr loadVoice(const std::string &voicefile);
 
         Sound *getSoundRef();
         Stream *getStreamRef();
 
-        Stream *playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal);
+        // returns the item computing the loudness track of the voice file, starting it if needed,
+        // or nullptr if there is no work queue to compute it on
+        osg::ref_ptr<VoiceLoudnessItem> getVoiceLoudness(const std::string &voicefile);
+
+        Stream *playVoice(DecoderPtr decoder, const osg::Vec3f &pos, bool playlocal, VoiceLoudnessItem *loudness);
 
         void streamMusicFull(const std::string& filename);
         void advanceMusic(const std::string& filename);
@@ -219,6 +280,9 @@ namespace MWSound
         ///< Play a 3D sound at \a initialPos. If the sound should be moving, it must be updated using Sound::setPosition.
         ///< @param offset Number of seconds into the sound to start playback.
 
+        virtual void preloadSound(const std::string& soundId);
+        ///< Start loading the given sound in the background, so it is ready when it is played.
+
         virtual void stopSound(Sound *sound);
         ///< Stop the given sound from playing
         /// @note no-op if \a sound is null
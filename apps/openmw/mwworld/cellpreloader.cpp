@@ -8,6 +8,7 @@
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/bulletshapemanager.hpp>
 #include <components/resource/keyframemanager.hpp>
+#include <components/resource/imagemanager.hpp>
 #include <components/misc/resourcehelpers.hpp>
 #include <components/misc/stringops.hpp>
 #include <components/terrain/world.hpp>
@@ -85,6 +86,10 @@ namespace MWWorld
         virtual void abort()
         {
             mAbort = true;
+
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mDecodeItemsMutex);
+            for (osg::ref_ptr<SceneUtil::WorkItem>& item : mDecodeItems)
+                item->abort();
         }
 
         /// Preload work to be called from the worker thread.
@@ -102,15 +107,35 @@ namespace MWWorld
                 }
             }
 
+            // decode the textures on the image manager's threads, while the meshes using them are loaded here
+            std::vector<std::string> textures;
             for (std::string& mesh: mMeshes)
             {
                 if (mAbort)
                     break;
 
-                try
+                mesh = Misc::ResourceHelpers::correctActorModelPath(mesh, mSceneManager->getVFS());
+                mSceneManager->getTextures(mesh, textures);
+            }
+
+            std::vector<osg::ref_ptr<SceneUtil::WorkItem> > decodeItems = mSceneManager->getImageManager()->decodeImages(textures);
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mDecodeItemsMutex);
+                mDecodeItems.swap(decodeItems);
+                if (mAbort)
                 {
-                    mesh = Misc::ResourceHelpers::correctActorModelPath(mesh, mSceneManager->getVFS());
+                    for (osg::ref_ptr<SceneUtil::WorkItem>& item : mDecodeItems)
+                        item->abort();
+                }
+            }
 
+            for (std::string& mesh: mMeshes)
+            {
+                if (mAbort)
+                    break;
+
+                try
+                {
                     if (mPreloadInstances)
                     {
                         mPreloadedObjects.push_back(mSceneManager->cacheInstance(mesh));
@@ -165,6 +190,9 @@ namespace MWWorld
 
         // keep a ref to the loaded objects to make sure it stays loaded as long as this cell is in the preloaded state
         std::vector<osg::ref_ptr<const osg::Object> > mPreloadedObjects;
+
+        OpenThreads::Mutex mDecodeItemsMutex;
+        std::vector<osg::ref_ptr<SceneUtil::WorkItem> > mDecodeItems;
     };
 
     class TerrainPreloadItem : public SceneUtil::WorkItem
@@ -1,18 +1,19 @@
 #ifndef GAME_MWWORLD_CELLREFLIST_H
 #define GAME_MWWORLD_CELLREFLIST_H
 
-#include <list>
-
 #include "livecellref.hpp"
+#include "chunkedlist.hpp"
 
 namespace MWWorld
 {
     /// \brief Collection of references of one type
+    ///
+    /// \note References never move in memory, Ptrs to them stay valid until they are removed.
     template <typename X>
     struct CellRefList
     {
         typedef LiveCellRef<X> LiveRef;
-        typedef std::list<LiveRef> List;
+        typedef ChunkedList<LiveRef> List;
         List mList;
 
         /// Search for the given reference in the given reclist from
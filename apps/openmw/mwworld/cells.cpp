@@ -1,19 +1,44 @@
 #include "cells.hpp"
 
+#include <algorithm>
+
 #include <components/debug/debuglog.hpp>
 #include <components/esm/esmreader.hpp>
 #include <components/esm/esmwriter.hpp>
 #include <components/esm/defs.hpp>
 #include <components/esm/cellstate.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
-#include <components/settings/settings.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
 
+#include "../mwmechanics/creaturestats.hpp"
+
 #include "esmstore.hpp"
 #include "containerstore.hpp"
 #include "cellstore.hpp"
+#include "class.hpp"
+
+namespace
+{
+    /// Order in which cells holding the same ID are searched: exteriors in reverse, then interiors.
+    /// Searching the exteriors in reverse is a workaround for an ambiguous chargen_plank reference in the
+    /// vanilla game. There is one at -22,16 and one at -2,-9, the latter should be used.
+    bool isSearchedBefore (const MWWorld::CellStore* left, const MWWorld::CellStore* right)
+    {
+        const ESM::Cell* leftCell = left->getCell();
+        const ESM::Cell* rightCell = right->getCell();
+
+        if (leftCell->isExterior()!=rightCell->isExterior())
+            return leftCell->isExterior();
+
+        if (leftCell->isExterior())
+            return std::make_pair (leftCell->getGridX(), leftCell->getGridY())
+                > std::make_pair (rightCell->getGridX(), rightCell->getGridY());
+
+        return Misc::StringUtils::ciLess (leftCell->mName, rightCell->mName);
+    }
+}
 
 MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
 {
@@ -24,7 +49,7 @@ MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
 
         if (result==mInteriors.end())
         {
-            result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader))).first;
+            result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
         }
 
         return &result->second;
@@ -37,7 +62,7 @@ MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
         if (result==mExteriors.end())
         {
             result = mExteriors.insert (std::make_pair (
-                std::make_pair (cell->getGridX(), cell->getGridY()), CellStore (cell, mStore, mReader))).first;
+                std::make_pair (cell->getGridX(), cell->getGridY()), CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
 
         }
 
@@ -49,25 +74,47 @@ void MWWorld::Cells::clear()
 {
     mInteriors.clear();
     mExteriors.clear();
-    std::fill(mIdCache.begin(), mIdCache.end(), std::make_pair("", (MWWorld::CellStore*)0));
-    mIdCacheIndex = 0;
+    mRefIdIndex.clear();
+    mAllCellsListed = false;
+    mActorIdIndex.clear();
 }
 
-MWWorld::Ptr MWWorld::Cells::getPtrAndCache (const std::string& name, CellStore& cellStore)
+MWWorld::Cells::IndexEntry MWWorld::Cells::makeIndexEntry (const Ptr& ptr) const
 {
-    Ptr ptr = getPtr (name, cellStore);
+    IndexEntry entry;
+    entry.mRef = ptr.getBase();
+    entry.mCell = ptr.getCell()->getOriginalCell (ptr);
+    return entry;
+}
 
-    if (!ptr.isEmpty() && ptr.isInCell())
-    {
-        mIdCache[mIdCacheIndex].first = name;
-        mIdCache[mIdCacheIndex].second = &cellStore;
-        if (++mIdCacheIndex>=mIdCache.size())
-            mIdCacheIndex = 0;
-    }
+MWWorld::Ptr MWWorld::Cells::getIndexedPtr (const IndexEntry& entry) const
+{
+    // References are never removed from a loaded cell, so the entry stays valid until clear()
+    Ptr ptr = entry.mCell->getCurrentPtr (entry.mRef);
+
+    if (!CellStore::isAccessible (ptr.getRefData(), ptr.getCellRef()))
+        return Ptr();
 
     return ptr;
 }
 
+void MWWorld::Cells::listAllCells()
+{
+    if (mAllCellsListed)
+        return;
+
+    const MWWorld::Store<ESM::Cell> &cells = mStore.get<ESM::Cell>();
+    MWWorld::Store<ESM::Cell>::iterator iter;
+
+    for (iter = cells.extBegin(); iter != cells.extEnd(); ++iter)
+        getCellStore (&(*iter))->preload();
+
+    for (iter = cells.intBegin(); iter != cells.intEnd(); ++iter)
+        getCellStore (&(*iter))->preload();
+
+    mAllCellsListed = true;
+}
+
 void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
 {
     if (cell.getState()!=CellStore::State_Loaded)
@@ -87,8 +134,7 @@ void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
 
 MWWorld::Cells::Cells (const MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& reader)
 : mStore (store), mReader (reader),
-  mIdCache (Settings::Manager::getInt("pointers cache size", "Cells"), std::pair<std::string, CellStore *> ("", (CellStore*)0)),
-  mIdCacheIndex (0)
+  mAllCellsListed (false)
 {}
 
 MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
@@ -119,7 +165,7 @@ MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
         }
 
         result = mExteriors.insert (std::make_pair (
-            std::make_pair (x, y), CellStore (cell, mStore, mReader))).first;
+            std::make_pair (x, y), CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
     }
 
     if (result->second.getState()!=CellStore::State_Loaded)
@@ -139,7 +185,7 @@ MWWorld::CellStore *MWWorld::Cells::getInterior (const std::string& name)
     {
         const ESM::Cell *cell = mStore.get<ESM::Cell>().find(lowerName);
 
-        result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader))).first;
+        result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader, &mRefIdIndex))).first;
     }
 
     if (result->second.getState()!=CellStore::State_Loaded)
@@ -198,63 +244,66 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name, CellStore& cell,
     return Ptr();
 }
 
-MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
+MWWorld::Ptr MWWorld::Cells::searchIndexViaActorId (int actorId) const
 {
-    // First check the cache
-    for (std::vector<std::pair<std::string, CellStore *> >::iterator iter (mIdCache.begin());
-        iter!=mIdCache.end(); ++iter)
-        if (iter->first==name && iter->second)
-        {
-            Ptr ptr = getPtr (name, *iter->second);
-            if (!ptr.isEmpty())
-                return ptr;
-        }
+    std::unordered_map<int, IndexEntry>::const_iterator found = mActorIdIndex.find (actorId);
 
-    // Then check cells that are already listed
-    // Search in reverse, this is a workaround for an ambiguous chargen_plank reference in the vanilla game.
-    // there is one at -22,16 and one at -2,-9, the latter should be used.
-    for (std::map<std::pair<int, int>, CellStore>::reverse_iterator iter = mExteriors.rbegin();
-        iter!=mExteriors.rend(); ++iter)
-    {
-        Ptr ptr = getPtrAndCache (name, iter->second);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
+    if (found==mActorIdIndex.end())
+        return Ptr();
 
-    for (std::map<std::string, CellStore>::iterator iter = mInteriors.begin();
-        iter!=mInteriors.end(); ++iter)
-    {
-        Ptr ptr = getPtrAndCache (name, iter->second);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
+    Ptr ptr = getIndexedPtr (found->second);
 
-    // Now try the other cells
-    const MWWorld::Store<ESM::Cell> &cells = mStore.get<ESM::Cell>();
-    MWWorld::Store<ESM::Cell>::iterator iter;
+    // Same conditions as CellStore::searchViaActorId
+    if (ptr.isEmpty() || ptr.getRefData().getCount()<=0 || !ptr.getClass().isActor()
+        || !ptr.getClass().getCreatureStats (ptr).matchesActorId (actorId))
+        return Ptr();
 
-    for (iter = cells.extBegin(); iter != cells.extEnd(); ++iter)
-    {
-        CellStore *cellStore = getCellStore (&(*iter));
+    return ptr;
+}
+
+void MWWorld::Cells::addToActorIndex (int actorId, const Ptr& ptr)
+{
+    if (ptr.isInCell())
+        mActorIdIndex[actorId] = makeIndexEntry (ptr);
+}
+
+MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
+{
+    listAllCells();
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+    // Copied, as loading a candidate adds its references to the index again
+    std::vector<CellStore*> candidates = mRefIdIndex.find (name);
+    std::sort (candidates.begin(), candidates.end(), isSearchedBefore);
 
+    for (CellStore* cell : candidates)
+    {
+        Ptr ptr = getPtr (name, *cell);
         if (!ptr.isEmpty())
             return ptr;
     }
 
-    for (iter = cells.intBegin(); iter != cells.intEnd(); ++iter)
-    {
-        CellStore *cellStore = getCellStore (&(*iter));
+    return Ptr();
+}
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+MWWorld::Ptr MWWorld::Cells::searchPtr (const std::string& name, const std::set<CellStore*>& activeCells, bool activeOnly)
+{
+    // Active cells are loaded, so all of their references are in the index
+    std::vector<CellStore*> candidates = mRefIdIndex.find (name);
+
+    for (CellStore* cell : candidates)
+    {
+        if (!activeCells.count (cell))
+            continue;
 
+        Ptr ptr = getPtr (name, *cell);
         if (!ptr.isEmpty())
             return ptr;
     }
 
-    // giving up
-    return Ptr();
+    if (activeOnly)
+        return Ptr();
+
+    return getPtr (name);
 }
 
 void MWWorld::Cells::getExteriorPtrs(const std::string &name, std::vector<MWWorld::Ptr> &out)
@@ -264,13 +313,19 @@ void MWWorld::Cells::getExteriorPtrs(const std::string &name, std::vector<MWWorl
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             out.push_back(ptr);
     }
 }
 
+void MWWorld::Cells::getExteriorStores (std::vector<CellStore*>& out)
+{
+    for (std::map<std::pair<int, int>, CellStore>::iterator iter = mExteriors.begin(); iter != mExteriors.end(); ++iter)
+        out.push_back (&iter->second);
+}
+
 void MWWorld::Cells::getInteriorPtrs(const std::string &name, std::vector<MWWorld::Ptr> &out)
 {
     const MWWorld::Store<ESM::Cell> &cells = mStore.get<ESM::Cell>();
@@ -278,7 +333,7 @@ void MWWorld::Cells::getInteriorPtrs(const std::string &name, std::vector<MWWorl
     {
         CellStore *cellStore = getCellStore (&(*iter));
 
-        Ptr ptr = getPtrAndCache (name, *cellStore);
+        Ptr ptr = getPtr (name, *cellStore);
 
         if (!ptr.isEmpty())
             out.push_back(ptr);
@@ -3,9 +3,12 @@
 
 #include <map>
 #include <list>
+#include <set>
 #include <string>
+#include <unordered_map>
 
 #include "ptr.hpp"
+#include "refidindex.hpp"
 
 namespace ESM
 {
@@ -31,15 +34,30 @@ namespace MWWorld
             std::vector<ESM::ESMReader>& mReader;
             mutable std::map<std::string, CellStore> mInteriors;
             mutable std::map<std::pair<int, int>, CellStore> mExteriors;
-            std::vector<std::pair<std::string, CellStore *> > mIdCache;
-            std::size_t mIdCacheIndex;
+            RefIdIndex<CellStore> mRefIdIndex;
+            bool mAllCellsListed;
+
+            /// Location of an actor that has been found before. The cell is the one the reference
+            /// originated from, which keeps track of where the reference has been moved to since.
+            struct IndexEntry
+            {
+                LiveCellRefBase *mRef;
+                CellStore *mCell;
+            };
+
+            std::unordered_map<int, IndexEntry> mActorIdIndex;
+
+            IndexEntry makeIndexEntry (const Ptr& ptr) const;
+
+            Ptr getIndexedPtr (const IndexEntry& entry) const;
 
             Cells (const Cells&);
             Cells& operator= (const Cells&);
 
             CellStore *getCellStore (const ESM::Cell *cell);
 
-            Ptr getPtrAndCache (const std::string& name, CellStore& cellStore);
+            void listAllCells();
+            ///< Add the references of all cells of the content files to the index.
 
             void writeCell (ESM::ESMWriter& writer, CellStore& cell) const;
 
@@ -61,6 +79,19 @@ namespace MWWorld
 
             /// @note name must be lower case
             Ptr getPtr (const std::string& name);
+
+            Ptr searchPtr (const std::string& name, const std::set<CellStore*>& activeCells, bool activeOnly);
+            ///< Return a reference with ID \a name. IDs are not necessarily unique, references in
+            /// \a activeCells take priority.
+            /// @note name must be lower case
+
+            Ptr searchIndexViaActorId (int actorId) const;
+            ///< Return the actor with \a actorId that has been passed to addToActorIndex before, if it is
+            /// still in the game world. Empty Ptr otherwise.
+
+            void addToActorIndex (int actorId, const Ptr& ptr);
+            ///< Remember \a ptr for actor ID lookups via searchIndexViaActorId.
+
             void rest (double hours);
 
             /// Get all Ptrs referencing \a name in exterior cells
@@ -73,6 +104,9 @@ namespace MWWorld
             /// @note name must be lower case
             void getInteriorPtrs (const std::string& name, std::vector<MWWorld::Ptr>& out);
 
+            /// Get all exterior cells that have been created so far, e.g. by reading a saved game.
+            void getExteriorStores (std::vector<CellStore*>& out);
+
             int countSavedGameRecords() const;
 
             void write (ESM::ESMWriter& writer, Loading::Listener& progress) const;
@@ -186,7 +186,7 @@ namespace MWWorld
 
         if (const X *ptr = store.search (ref.mRefID))
         {
-            typename std::list<LiveRef>::iterator iter =
+            typename List::iterator iter =
                 std::find(mList.begin(), mList.end(), ref.mRefNum);
 
             LiveRef liveCellRef (ref, ptr);
@@ -226,6 +226,8 @@ namespace MWWorld
             load();
 
         mHasState = true;
+        addToIndex(object.getCellRef().getRefId());
+
         MovedRefTracker::iterator found = mMovedToAnotherCell.find(object.getBase());
         if (found != mMovedToAnotherCell.end())
         {
@@ -344,12 +346,28 @@ namespace MWWorld
         return false;
     }
 
-    CellStore::CellStore (const ESM::Cell *cell, const MWWorld::ESMStore& esmStore, std::vector<ESM::ESMReader>& readerList)
-        : mStore(esmStore), mReader(readerList), mCell (cell), mState (State_Unloaded), mHasState (false), mLastRespawn(0,0)
+    CellStore* CellStore::getOriginalCell(const MWWorld::Ptr& ptr)
+    {
+        MovedRefTracker::iterator found = mMovedHere.find(ptr.getBase());
+        if (found != mMovedHere.end())
+            return found->second;
+        return this;
+    }
+
+    CellStore::CellStore (const ESM::Cell *cell, const MWWorld::ESMStore& esmStore, std::vector<ESM::ESMReader>& readerList,
+                          RefIdIndex<CellStore>* refIdIndex)
+        : mStore(esmStore), mReader(readerList), mCell (cell), mState (State_Unloaded), mHasState (false), mRefIdIndex (refIdIndex),
+          mLastRespawn(0,0)
     {
         mWaterLevel = cell->mWater;
     }
 
+    void CellStore::addToIndex (const std::string& id)
+    {
+        if (mRefIdIndex)
+            mRefIdIndex->add (Misc::StringUtils::lowerCase (id), this);
+    }
+
     const ESM::Cell *CellStore::getCell() const
     {
         return mCell;
@@ -455,10 +473,13 @@ namespace MWWorld
     {
         if (mState!=State_Loaded)
         {
+            loadRefs ();
+
             if (mState==State_Preloaded)
+            {
                 mIds.clear();
-
-            loadRefs ();
+                std::vector<RefLocation>().swap (mRefLocations);
+            }
 
             mState = State_Loaded;
         }
@@ -483,6 +504,8 @@ namespace MWWorld
         if (mCell->mContextList.empty())
             return; // this is a dynamically generated cell -> skipping.
 
+        std::map<ESM::RefNum, std::size_t> locations; // index into mRefLocations
+
         // Load references from all plugins that do something with this cell.
         for (size_t i = 0; i < mCell->mContextList.size(); i++)
         {
@@ -493,14 +516,13 @@ namespace MWWorld
                 mCell->restore (esm[index], i);
 
                 ESM::CellRef ref;
+                ESM::Cell::RefPosition position;
 
-                // Get each reference in turn
+                // Get each reference in turn. Only the ID and location are needed here, the rest of
+                // the reference is parsed when the cell is loaded.
                 bool deleted = false;
-                while (mCell->getNextRef (esm[index], ref, deleted))
+                while (ESM::Cell::getNextRefId (esm[index], ref, deleted, &position))
                 {
-                    if (deleted)
-                        continue;
-
                     // Don't list reference if it was moved to a different cell.
                     ESM::MovedCellRefTracker::const_iterator iter =
                         std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
@@ -508,6 +530,20 @@ namespace MWWorld
                         continue;
                     }
 
+                    // Later content files replace the reference, deleted ones are still loaded
+                    RefLocation location { ref.mRefNum, static_cast<int>(i), position };
+                    std::map<ESM::RefNum, std::size_t>::iterator found = locations.find (ref.mRefNum);
+                    if (found != locations.end())
+                        mRefLocations[found->second] = location;
+                    else
+                    {
+                        locations.emplace (ref.mRefNum, mRefLocations.size());
+                        mRefLocations.push_back (location);
+                    }
+
+                    if (deleted)
+                        continue;
+
                     mIds.push_back (Misc::StringUtils::lowerCase (ref.mRefID));
                 }
             }
@@ -528,6 +564,12 @@ namespace MWWorld
         }
 
         std::sort (mIds.begin(), mIds.end());
+
+        if (mRefIdIndex)
+        {
+            for (const std::string& id : mIds)
+                mRefIdIndex->add (id, this);
+        }
     }
 
     void CellStore::loadRefs()
@@ -541,35 +583,58 @@ namespace MWWorld
 
         std::map<ESM::RefNum, std::string> refNumToID; // used to detect refID modifications
 
-        // Load references from all plugins that do something with this cell.
-        for (size_t i = 0; i < mCell->mContextList.size(); i++)
+        if (mState == State_Preloaded)
         {
-            try
+            // Only read the last version of each reference, straight from where listRefs has found it
+            for (const RefLocation& location : mRefLocations)
             {
-                // Reopen the ESM reader and seek to the right position.
-                int index = mCell->mContextList.at(i).index;
-                mCell->restore (esm[index], i);
-
-                ESM::CellRef ref;
-                ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
-
-                // Get each reference in turn
-                bool deleted = false;
-                while(mCell->getNextRef(esm[index], ref, deleted))
+                try
                 {
-                    // Don't load reference if it was moved to a different cell.
-                    ESM::MovedCellRefTracker::const_iterator iter =
-                        std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
-                    if (iter != mCell->mMovedRefs.end()) {
-                        continue;
-                    }
+                    int index = mCell->mContextList.at(location.mContext).index;
 
-                    loadRef (ref, deleted, refNumToID);
+                    ESM::CellRef ref;
+                    bool deleted = false;
+                    if (mCell->getRefAt (esm[index], location.mContext, location.mPosition, ref, deleted))
+                        loadRef (ref, deleted, refNumToID);
+                }
+                catch (std::exception& e)
+                {
+                    Log(Debug::Error) << "An error occurred loading references for cell " << getCell()->getDescription() << ": " << e.what();
                 }
             }
-            catch (std::exception& e)
+        }
+        else
+        {
+            // Load references from all plugins that do something with this cell.
+            for (size_t i = 0; i < mCell->mContextList.size(); i++)
             {
-                Log(Debug::Error) << "An error occurred loading references for cell " << getCell()->getDescription() << ": " << e.what();
+                try
+                {
+                    // Reopen the ESM reader and seek to the right position.
+                    int index = mCell->mContextList.at(i).index;
+                    mCell->restore (esm[index], i);
+
+                    ESM::CellRef ref;
+                    ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
+
+                    // Get each reference in turn
+                    bool deleted = false;
+                    while(mCell->getNextRef(esm[index], ref, deleted))
+                    {
+                        // Don't load reference if it was moved to a different cell.
+                        ESM::MovedCellRefTracker::const_iterator iter =
+                            std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
+                        if (iter != mCell->mMovedRefs.end()) {
+                            continue;
+                        }
+
+                        loadRef (ref, deleted, refNumToID);
+                    }
+                }
+                catch (std::exception& e)
+                {
+                    Log(Debug::Error) << "An error occurred loading references for cell " << getCell()->getDescription() << ": " << e.what();
+                }
             }
         }
 
@@ -683,6 +748,9 @@ namespace MWWorld
         }
 
         refNumToID[ref.mRefNum] = ref.mRefID;
+
+        if (mRefIdIndex && !deleted)
+            mRefIdIndex->add (ref.mRefID, this);
     }
 
     void CellStore::loadState (const ESM::CellState& state)
@@ -776,6 +844,8 @@ namespace MWWorld
                 continue;
             }
 
+            addToIndex(cref.mRefID);
+
             switch (type)
             {
                 case ESM::REC_ACTI:
@@ -31,9 +31,11 @@
 #include <components/esm/loadnpc.hpp>
 #include <components/esm/loadmisc.hpp>
 #include <components/esm/loadbody.hpp>
+#include <components/esm/loadcell.hpp>
 
 #include "timestamp.hpp"
 #include "ptr.hpp"
+#include "refidindex.hpp"
 
 namespace ESM
 {
@@ -71,6 +73,20 @@ namespace MWWorld
             State mState;
             bool mHasState;
             std::vector<std::string> mIds;
+
+            /// Where the last content file changing a reference has put it
+            struct RefLocation
+            {
+                ESM::RefNum mRefNum;
+                int mContext;
+                ESM::Cell::RefPosition mPosition;
+            };
+
+            // References of the content files of a preloaded cell, in the order they first appear in.
+            // Loading the cell reads each of them once from its location.
+            std::vector<RefLocation> mRefLocations;
+
+            RefIdIndex<CellStore>* mRefIdIndex;
             float mWaterLevel;
 
             MWWorld::TimeStamp mLastRespawn;
@@ -109,9 +125,6 @@ namespace MWWorld
             // Merged list of ref's currently in this cell - i.e. with added refs from mMovedHere, removed refs from mMovedToAnotherCell
             std::vector<LiveCellRefBase*> mMergedRefs;
 
-            // Get the Ptr for the given ref which originated from this cell (possibly moved to another cell at this point).
-            Ptr getCurrentPtr(MWWorld::LiveCellRefBase* ref);
-
             /// Moves object from the given cell to this cell.
             void moveFrom(const MWWorld::Ptr& object, MWWorld::CellStore* from);
 
@@ -195,13 +208,16 @@ namespace MWWorld
                 CellRefList<T>& list = get<T>();
                 LiveCellRefBase* ret = &list.insert(*ref);
                 updateMergedRefs();
+                addToIndex(ret->mRef.getRefId());
                 return ret;
             }
 
             /// @param readerList The readers to use for loading of the cell on-demand.
+            /// @param refIdIndex The index to add the IDs of references in this cell to, optional.
             CellStore (const ESM::Cell *cell_,
                        const MWWorld::ESMStore& store,
-                       std::vector<ESM::ESMReader>& readerList);
+                       std::vector<ESM::ESMReader>& readerList,
+                       RefIdIndex<CellStore>* refIdIndex = nullptr);
 
             const ESM::Cell *getCell() const;
 
@@ -235,6 +251,12 @@ namespace MWWorld
 
             bool movedHere(const MWWorld::Ptr& ptr) const;
 
+            /// Get the Ptr for the given ref which originated from this cell (possibly moved to another cell at this point).
+            Ptr getCurrentPtr(MWWorld::LiveCellRefBase* ref);
+
+            /// Get the cell the given ref, which is currently in this cell, originated from.
+            CellStore* getOriginalCell(const MWWorld::Ptr& ptr);
+
             void setWaterLevel (float level);
 
             void setFog (ESM::FogState* fog);
@@ -381,7 +403,7 @@ namespace MWWorld
 
         private:
 
-            /// Run through references and store IDs
+            /// Run through references and store IDs and locations
             void listRefs();
 
             void loadRefs();
@@ -390,6 +412,9 @@ namespace MWWorld
             ///< Make case-adjustments to \a ref and insert it into the respective container.
             ///
             /// Invalid \a ref objects are silently dropped.
+
+            void addToIndex (const std::string& id);
+            ///< Note that this cell may hold a reference with \a id, if there is an index.
     };
 
     template<>
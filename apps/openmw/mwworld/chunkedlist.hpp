@@ -0,0 +1,350 @@
+#ifndef GAME_MWWORLD_CHUNKEDLIST_H
+#define GAME_MWWORLD_CHUNKEDLIST_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace MWWorld
+{
+    /// \brief Sequence container with the interface and iterator guarantees of a std::list subset
+    ///
+    /// Elements live in chunks that are allocated in bulk and never move, so pointers and iterators
+    /// stay valid until the element is erased. Erased slots are kept in a free list and reused by
+    /// later insertions. Iteration follows insertion order; without erasures, that is the order of
+    /// the elements in memory.
+    template <typename T>
+    class ChunkedList
+    {
+            struct NodeBase
+            {
+                NodeBase *mPrev;
+                NodeBase *mNext;
+            };
+
+            struct Node : NodeBase
+            {
+                typename std::aligned_storage<sizeof (T), alignof (T)>::type mStorage;
+
+                T& value() { return *reinterpret_cast<T *> (&mStorage); }
+            };
+
+            struct Chunk
+            {
+                std::unique_ptr<Node[]> mNodes;
+                std::size_t mSize;
+            };
+
+            static const std::size_t sMinChunkSize = 4;
+            static const std::size_t sMaxChunkSize = 256;
+
+            NodeBase mHead; // sentinel, mHead.mNext is the first element
+            NodeBase *mFree; // singly linked via mNext
+            std::vector<Chunk> mChunks;
+            std::size_t mCapacity;
+            std::size_t mSize;
+
+            void init()
+            {
+                mHead.mPrev = mHead.mNext = &mHead;
+                mFree = nullptr;
+                mCapacity = 0;
+                mSize = 0;
+            }
+
+            void addChunk()
+            {
+                // grow geometrically; most lists (e.g. inventories) only hold a handful of references
+                std::size_t size = mCapacity<sMinChunkSize ? sMinChunkSize :
+                    (mCapacity<sMaxChunkSize ? mCapacity : sMaxChunkSize);
+
+                Chunk chunk;
+                chunk.mNodes.reset (new Node[size]);
+                chunk.mSize = size;
+                mChunks.push_back (std::move (chunk));
+
+                pushFree (mChunks.back());
+
+                mCapacity += size;
+            }
+
+            // hand out slots in address order
+            void pushFree (const Chunk& chunk)
+            {
+                for (std::size_t i=chunk.mSize; i>0; --i)
+                {
+                    chunk.mNodes[i-1].mNext = mFree;
+                    mFree = &chunk.mNodes[i-1];
+                }
+            }
+
+            Node *allocate()
+            {
+                if (!mFree)
+                    addChunk();
+
+                Node *node = static_cast<Node *> (mFree);
+                mFree = mFree->mNext;
+                return node;
+            }
+
+            void link (NodeBase *node, NodeBase *before)
+            {
+                node->mNext = before;
+                node->mPrev = before->mPrev;
+                before->mPrev->mNext = node;
+                before->mPrev = node;
+                ++mSize;
+            }
+
+        public:
+
+            template <typename Value, typename NodePtr>
+            class Iterator
+            {
+                    NodePtr mNode;
+
+                    friend class ChunkedList;
+
+                public:
+
+                    typedef std::bidirectional_iterator_tag iterator_category;
+                    typedef typename std::remove_const<Value>::type value_type;
+                    typedef std::ptrdiff_t difference_type;
+                    typedef Value *pointer;
+                    typedef Value& reference;
+
+                    Iterator() : mNode (nullptr) {}
+
+                    explicit Iterator (NodePtr node) : mNode (node) {}
+
+                    // iterator -> const_iterator
+                    template <typename OtherValue, typename OtherNodePtr>
+                    Iterator (const Iterator<OtherValue, OtherNodePtr>& other) : mNode (other.getNode()) {}
+
+                    NodePtr getNode() const { return mNode; }
+
+                    reference operator*() const { return static_cast<Node *> (const_cast<NodeBase *> (mNode))->value(); }
+
+                    pointer operator->() const { return &**this; }
+
+                    Iterator& operator++() { mNode = mNode->mNext; return *this; }
+
+                    Iterator operator++ (int) { Iterator result (*this); ++*this; return result; }
+
+                    Iterator& operator--() { mNode = mNode->mPrev; return *this; }
+
+                    Iterator operator-- (int) { Iterator result (*this); --*this; return result; }
+
+                    template <typename OtherValue, typename OtherNodePtr>
+                    bool operator== (const Iterator<OtherValue, OtherNodePtr>& other) const
+                    {
+                        return mNode==other.getNode();
+                    }
+
+                    template <typename OtherValue, typename OtherNodePtr>
+                    bool operator!= (const Iterator<OtherValue, OtherNodePtr>& other) const
+                    {
+                        return mNode!=other.getNode();
+                    }
+            };
+
+            typedef T value_type;
+            typedef std::size_t size_type;
+            typedef T& reference;
+            typedef const T& const_reference;
+            typedef Iterator<T, NodeBase *> iterator;
+            typedef Iterator<const T, const NodeBase *> const_iterator;
+
+            ChunkedList()
+            {
+                init();
+            }
+
+            ChunkedList (const ChunkedList& other)
+            {
+                init();
+
+                for (const_iterator iter (other.begin()); iter!=other.end(); ++iter)
+                    push_back (*iter);
+            }
+
+            ChunkedList (ChunkedList&& other)
+            {
+                init();
+                swap (other);
+            }
+
+            ~ChunkedList()
+            {
+                clear();
+            }
+
+            ChunkedList& operator= (const ChunkedList& other)
+            {
+                if (this!=&other)
+                {
+                    clear();
+
+                    for (const_iterator iter (other.begin()); iter!=other.end(); ++iter)
+                        push_back (*iter);
+                }
+
+                return *this;
+            }
+
+            ChunkedList& operator= (ChunkedList&& other)
+            {
+                if (this!=&other)
+                {
+                    clear();
+                    swap (other);
+                }
+
+                return *this;
+            }
+
+            void swap (ChunkedList& other)
+            {
+                NodeBase *first = mSize ? mHead.mNext : nullptr;
+                NodeBase *last = mSize ? mHead.mPrev : nullptr;
+                NodeBase *otherFirst = other.mSize ? other.mHead.mNext : nullptr;
+                NodeBase *otherLast = other.mSize ? other.mHead.mPrev : nullptr;
+
+                // the sentinels stay in place, so the elements need to be relinked to them
+                if (otherFirst)
+                {
+                    mHead.mNext = otherFirst;
+                    mHead.mPrev = otherLast;
+                    otherFirst->mPrev = &mHead;
+                    otherLast->mNext = &mHead;
+                }
+                else
+                    mHead.mPrev = mHead.mNext = &mHead;
+
+                if (first)
+                {
+                    other.mHead.mNext = first;
+                    other.mHead.mPrev = last;
+                    first->mPrev = &other.mHead;
+                    last->mNext = &other.mHead;
+                }
+                else
+                    other.mHead.mPrev = other.mHead.mNext = &other.mHead;
+
+                std::swap (mFree, other.mFree);
+                mChunks.swap (other.mChunks);
+                std::swap (mCapacity, other.mCapacity);
+                std::swap (mSize, other.mSize);
+            }
+
+            iterator begin() { return iterator (mHead.mNext); }
+
+            iterator end() { return iterator (&mHead); }
+
+            const_iterator begin() const { return const_iterator (mHead.mNext); }
+
+            const_iterator end() const { return const_iterator (&mHead); }
+
+            bool empty() const { return mSize==0; }
+
+            size_type size() const { return mSize; }
+
+            reference front() { return *begin(); }
+
+            const_reference front() const { return *begin(); }
+
+            reference back() { return *--end(); }
+
+            const_reference back() const { return *--end(); }
+
+            template <typename... Args>
+            iterator emplace (const_iterator position, Args&&... args)
+            {
+                Node *node = allocate();
+
+                try
+                {
+                    new (&node->mStorage) T (std::forward<Args> (args)...);
+                }
+                catch (...)
+                {
+                    node->mNext = mFree;
+                    mFree = node;
+                    throw;
+                }
+
+                link (node, const_cast<NodeBase *> (position.getNode()));
+
+                return iterator (node);
+            }
+
+            template <typename... Args>
+            reference emplace_back (Args&&... args)
+            {
+                return *emplace (end(), std::forward<Args> (args)...);
+            }
+
+            iterator insert (const_iterator position, const T& value)
+            {
+                return emplace (position, value);
+            }
+
+            void push_back (const T& value)
+            {
+                emplace (end(), value);
+            }
+
+            void push_back (T&& value)
+            {
+                emplace (end(), std::move (value));
+            }
+
+            /// \return Iterator to the element after the erased one.
+            iterator erase (const_iterator position)
+            {
+                NodeBase *node = const_cast<NodeBase *> (position.getNode());
+                NodeBase *next = node->mNext;
+
+                node->mPrev->mNext = next;
+                next->mPrev = node->mPrev;
+                --mSize;
+
+                static_cast<Node *> (node)->value().~T();
+
+                node->mNext = mFree;
+                mFree = node;
+
+                return iterator (next);
+            }
+
+            /// Destroy all elements, but keep the memory for reuse.
+            void clear()
+            {
+                for (NodeBase *node = mHead.mNext; node!=&mHead; node = node->mNext)
+                    static_cast<Node *> (node)->value().~T();
+
+                mHead.mPrev = mHead.mNext = &mHead;
+                mSize = 0;
+                mFree = nullptr;
+
+                for (typename std::vector<Chunk>::const_reverse_iterator iter (mChunks.rbegin());
+                    iter!=mChunks.rend(); ++iter)
+                    pushFree (*iter);
+            }
+
+            /// Destroy all elements and release the memory.
+            void release()
+            {
+                clear();
+                mChunks.clear();
+                init();
+            }
+    };
+}
+
+#endif
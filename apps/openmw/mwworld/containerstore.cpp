@@ -39,25 +39,13 @@ namespace
         return sum;
     }
 
-    template<typename T>
-    MWWorld::Ptr searchId (MWWorld::CellRefList<T>& list, const std::string& id,
-        MWWorld::ContainerStore *store)
+    struct GetRefId
     {
-        std::string id2 = Misc::StringUtils::lowerCase (id);
-
-        for (typename MWWorld::CellRefList<T>::List::iterator iter (list.mList.begin());
-             iter!=list.mList.end(); ++iter)
+        std::string operator() (const MWWorld::ContainerStoreIterator& iter) const
         {
-            if (Misc::StringUtils::ciEqual(iter->mBase->mId, id2) && iter->mData.getCount())
-            {
-                MWWorld::Ptr ptr (&*iter, 0);
-                ptr.setContainerStore (store);
-                return ptr;
-            }
+            return iter->getCellRef().getRefId();
         }
-
-        return MWWorld::Ptr();
-    }
+    };
 }
 
 template<typename T>
@@ -77,6 +65,8 @@ MWWorld::ContainerStoreIterator MWWorld::ContainerStore::getState (CellRefList<T
     ref.load (state);
     collection.mList.push_back (ref);
 
+    mStackIndex.invalidate();
+
     return ContainerStoreIterator (this, --collection.mList.end());
 }
 
@@ -148,22 +138,28 @@ MWWorld::ContainerStoreIterator MWWorld::ContainerStore::end()
     return ContainerStoreIterator (this);
 }
 
+const MWWorld::ContainerStore::Stacks& MWWorld::ContainerStore::getStacks(const std::string &id)
+{
+    mStackIndex.update (begin(), end(), GetRefId());
+    return mStackIndex.find (id);
+}
+
 int MWWorld::ContainerStore::count(const std::string &id)
 {
     int total=0;
-    for (MWWorld::ContainerStoreIterator iter (begin()); iter!=end(); ++iter)
-        if (Misc::StringUtils::ciEqual(iter->getCellRef().getRefId(), id))
-            total += iter->getRefData().getCount();
+    const Stacks& candidates = getStacks(id);
+    for (Stacks::const_iterator iter (candidates.begin()); iter!=candidates.end(); ++iter)
+        total += (*iter)->getRefData().getCount();
     return total;
 }
 
 int MWWorld::ContainerStore::restockCount(const std::string &id)
 {
     int total=0;
-    for (MWWorld::ContainerStoreIterator iter (begin()); iter!=end(); ++iter)
-        if (Misc::StringUtils::ciEqual(iter->getCellRef().getRefId(), id))
-            if (iter->getCellRef().getSoul().empty())
-                total += iter->getRefData().getCount();
+    const Stacks& candidates = getStacks(id);
+    for (Stacks::const_iterator iter (candidates.begin()); iter!=candidates.end(); ++iter)
+        if ((*iter)->getCellRef().getSoul().empty())
+            total += (*iter)->getRefData().getCount();
     return total;
 }
 
@@ -195,11 +191,14 @@ MWWorld::ContainerStoreIterator MWWorld::ContainerStore::unstack(const Ptr &ptr,
 MWWorld::ContainerStoreIterator MWWorld::ContainerStore::restack(const MWWorld::Ptr& item)
 {
     MWWorld::ContainerStoreIterator retval = end();
-    for (MWWorld::ContainerStoreIterator iter (begin()); iter != end(); ++iter)
+    const Stacks& candidates = getStacks(item.getCellRef().getRefId());
+    // Stacks with a count of 0 are skipped, like the iteration over the whole store used to do, so an item
+    // whose count was set to 0 still counts as not being from this container.
+    for (Stacks::const_iterator iter (candidates.begin()); iter != candidates.end(); ++iter)
     {
-        if (item == *iter)
+        if ((*iter)->getRefData().getCount() && item == **iter)
         {
-            retval = iter;
+            retval = *iter;
             break;
         }
     }
@@ -207,13 +206,14 @@ MWWorld::ContainerStoreIterator MWWorld::ContainerStore::restack(const MWWorld::
     if (retval == end())
         throw std::runtime_error("item is not from this container");
 
-    for (MWWorld::ContainerStoreIterator iter (begin()); iter != end(); ++iter)
+    // only items with the same ID can stack
+    for (Stacks::const_iterator iter (candidates.begin()); iter != candidates.end(); ++iter)
     {
-        if (stacks(*iter, item))
+        if ((*iter)->getRefData().getCount() && stacks(**iter, item))
         {
-            iter->getRefData().setCount(iter->getRefData().getCount() + item.getRefData().getCount());
+            (*iter)->getRefData().setCount((*iter)->getRefData().getCount() + item.getRefData().getCount());
             item.getRefData().setCount(0);
-            retval = iter;
+            retval = *iter;
             break;
         }
     }
@@ -352,13 +352,14 @@ MWWorld::ContainerStoreIterator MWWorld::ContainerStore::addImp (const Ptr& ptr,
     {
         int realCount = count * ptr.getClass().getValue(ptr);
 
-        for (MWWorld::ContainerStoreIterator iter (begin(type)); iter!=end(); ++iter)
+        const Stacks& gold = getStacks(MWWorld::ContainerStore::sGoldId);
+        for (Stacks::const_iterator iter (gold.begin()); iter!=gold.end(); ++iter)
         {
-            if (Misc::StringUtils::ciEqual((*iter).getCellRef().getRefId(), MWWorld::ContainerStore::sGoldId))
+            if ((*iter)->getRefData().getCount())
             {
-                iter->getRefData().setCount(iter->getRefData().getCount() + realCount);
+                (*iter)->getRefData().setCount((*iter)->getRefData().getCount() + realCount);
                 flagAsModified();
-                return iter;
+                return *iter;
             }
         }
 
@@ -366,16 +367,17 @@ MWWorld::ContainerStoreIterator MWWorld::ContainerStore::addImp (const Ptr& ptr,
         return addNewStack(ref.getPtr(), realCount);
     }
 
-    // determine whether to stack or not
-    for (MWWorld::ContainerStoreIterator iter (begin(type)); iter!=end(); ++iter)
+    // determine whether to stack or not; only items with the same ID can stack
+    const Stacks& candidates = getStacks(ptr.getCellRef().getRefId());
+    for (Stacks::const_iterator iter (candidates.begin()); iter!=candidates.end(); ++iter)
     {
-        if (stacks(*iter, ptr))
+        if ((*iter)->getRefData().getCount() && (*iter).getType()==type && stacks(**iter, ptr))
         {
             // stack
-            iter->getRefData().setCount( iter->getRefData().getCount() + count );
+            (*iter)->getRefData().setCount( (*iter)->getRefData().getCount() + count );
 
             flagAsModified();
-            return iter;
+            return *iter;
         }
     }
     // if we got here, this means no stacking
@@ -404,6 +406,8 @@ MWWorld::ContainerStoreIterator MWWorld::ContainerStore::addNewStack (const Cons
 
     it->getRefData().setCount(count);
 
+    mStackIndex.add (it->getCellRef().getRefId(), it);
+
     flagAsModified();
     return it;
 }
@@ -412,9 +416,11 @@ int MWWorld::ContainerStore::remove(const std::string& itemId, int count, const
 {
     int toRemove = count;
 
-    for (ContainerStoreIterator iter(begin()); iter != end() && toRemove > 0; ++iter)
-        if (Misc::StringUtils::ciEqual(iter->getCellRef().getRefId(), itemId))
-            toRemove -= remove(*iter, toRemove, actor);
+    // copied, because removing an item from an inventory may add new stacks (e.g. by auto-equipping)
+    Stacks candidates = getStacks(itemId);
+    for (Stacks::const_iterator iter(candidates.begin()); iter != candidates.end() && toRemove > 0; ++iter)
+        if ((*iter)->getRefData().getCount())
+            toRemove -= remove(**iter, toRemove, actor);
 
     flagAsModified();
 
@@ -695,20 +701,23 @@ MWWorld::Ptr MWWorld::ContainerStore::findReplacement(const std::string& id)
 {
     MWWorld::Ptr item;
     int itemHealth = 1;
-    for (MWWorld::ContainerStoreIterator iter = begin(); iter != end(); ++iter)
+    const Stacks& candidates = getStacks(id);
+    for (Stacks::const_iterator iter = candidates.begin(); iter != candidates.end(); ++iter)
     {
-        int iterHealth = iter->getClass().hasItemHealth(*iter) ? iter->getClass().getItemHealth(*iter) : 1;
-        if (Misc::StringUtils::ciEqual(iter->getCellRef().getRefId(), id))
+        MWWorld::Ptr ptr = **iter;
+        if (!ptr.getRefData().getCount())
+            continue;
+
+        int iterHealth = ptr.getClass().hasItemHealth(ptr) ? ptr.getClass().getItemHealth(ptr) : 1;
+
+        // Prefer the stack with the lowest remaining uses
+        // Try to get item with zero durability only if there are no other items found
+        if (item.isEmpty() ||
+            (iterHealth > 0 && iterHealth < itemHealth) ||
+            (itemHealth <= 0 && iterHealth > 0))
         {
-            // Prefer the stack with the lowest remaining uses
-            // Try to get item with zero durability only if there are no other items found
-            if (item.isEmpty() ||
-                (iterHealth > 0 && iterHealth < itemHealth) ||
-                (itemHealth <= 0 && iterHealth > 0))
-            {
-                item = *iter;
-                itemHealth = iterHealth;
-            }
+            item = ptr;
+            itemHealth = iterHealth;
         }
     }
 
@@ -717,79 +726,12 @@ MWWorld::Ptr MWWorld::ContainerStore::findReplacement(const std::string& id)
 
 MWWorld::Ptr MWWorld::ContainerStore::search (const std::string& id)
 {
-    {
-        Ptr ptr = searchId (potions, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (appas, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (armors, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (books, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (clothes, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (ingreds, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (lights, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (lockpicks, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (miscItems, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (probes, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (repairs, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    {
-        Ptr ptr = searchId (weapons, id, this);
-        if (!ptr.isEmpty())
-            return ptr;
-    }
+    const Stacks& candidates = getStacks(id);
+    for (Stacks::const_iterator iter = candidates.begin(); iter != candidates.end(); ++iter)
+        if ((*iter)->getRefData().getCount())
+            return **iter;
 
-    return Ptr();
+    return MWWorld::Ptr();
 }
 
 void MWWorld::ContainerStore::writeState (ESM::InventoryState& state) const
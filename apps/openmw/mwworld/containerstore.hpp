@@ -3,7 +3,9 @@
 
 #include <iterator>
 #include <map>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include <components/esm/loadalch.hpp>
 #include <components/esm/loadappa.hpp>
@@ -20,6 +22,7 @@
 
 #include "ptr.hpp"
 #include "cellreflist.hpp"
+#include "stackindex.hpp"
 
 namespace ESM
 {
@@ -45,6 +48,135 @@ namespace MWWorld
             virtual void itemRemoved(const ConstPtr& item, int count) {}
     };
 
+    template<class PtrType>
+    class ContainerStoreIteratorBase
+        : public std::iterator<std::forward_iterator_tag, PtrType, std::ptrdiff_t, PtrType *, PtrType&>
+    {
+        template<class From, class To, class Dummy>
+        struct IsConvertible
+        {
+            static const bool value = true;
+        };
+
+        template<class Dummy>
+        struct IsConvertible<ConstPtr, Ptr, Dummy>
+        {
+            static const bool value = false;
+        };
+
+        template<class T, class U>
+        struct IteratorTrait
+        {
+            typedef typename MWWorld::CellRefList<T>::List::iterator type;
+        };
+
+        template<class T>
+        struct IteratorTrait<T, ConstPtr>
+        {
+            typedef typename MWWorld::CellRefList<T>::List::const_iterator type;
+        };
+
+        template<class T>
+        struct Iterator : IteratorTrait<T, PtrType>
+        {
+        };
+
+        template<class T, class Dummy>
+        struct ContainerStoreTrait
+        {
+            typedef ContainerStore* type;
+        };
+        
+        template<class Dummy>
+        struct ContainerStoreTrait<ConstPtr, Dummy>
+        {
+            typedef const ContainerStore* type;
+        };
+
+        typedef typename ContainerStoreTrait<PtrType, void>::type ContainerStoreType;
+
+        int mType;
+        int mMask;
+        ContainerStoreType mContainer;
+        mutable PtrType mPtr;
+
+        typename Iterator<ESM::Potion>::type mPotion;
+        typename Iterator<ESM::Apparatus>::type mApparatus;
+        typename Iterator<ESM::Armor>::type mArmor;
+        typename Iterator<ESM::Book>::type mBook;
+        typename Iterator<ESM::Clothing>::type mClothing;
+        typename Iterator<ESM::Ingredient>::type mIngredient;
+        typename Iterator<ESM::Light>::type mLight;
+        typename Iterator<ESM::Lockpick>::type mLockpick;
+        typename Iterator<ESM::Miscellaneous>::type mMiscellaneous;
+        typename Iterator<ESM::Probe>::type mProbe;
+        typename Iterator<ESM::Repair>::type mRepair;
+        typename Iterator<ESM::Weapon>::type mWeapon;
+
+        ContainerStoreIteratorBase (ContainerStoreType container);
+        ///< End-iterator
+
+        ContainerStoreIteratorBase (int mask, ContainerStoreType container);
+        ///< Begin-iterator
+
+        // construct iterator using a CellRefList iterator
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Potion>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Apparatus>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Armor>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Book>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Clothing>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Ingredient>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Light>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Lockpick>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Miscellaneous>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Probe>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Repair>::type);
+        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Weapon>::type);
+
+        template<class T>
+        void copy (const ContainerStoreIteratorBase<T>& src);
+        
+        void incType ();
+        
+        void nextType ();
+
+        bool resetIterator ();
+        ///< Reset iterator for selected type.
+        ///
+        /// \return Type not empty?
+
+        bool incIterator ();
+        ///< Increment iterator for selected type.
+        ///
+        /// \return reached the end?
+
+        public:
+            template<class T>
+            ContainerStoreIteratorBase (const ContainerStoreIteratorBase<T>& other)
+            {
+                char CANNOT_CONVERT_CONST_ITERATOR_TO_ITERATOR[IsConvertible<T, PtrType, void>::value ? 1 : -1];
+                ((void)CANNOT_CONVERT_CONST_ITERATOR_TO_ITERATOR);
+                copy (other);
+            }
+
+            template<class T>
+            bool isEqual(const ContainerStoreIteratorBase<T>& other) const;
+
+            PtrType *operator->() const;
+            PtrType operator*() const;
+
+            ContainerStoreIteratorBase& operator++ ();
+            ContainerStoreIteratorBase operator++ (int);
+            ContainerStoreIteratorBase& operator= (const ContainerStoreIteratorBase& rhs);
+
+            int getType() const;
+            const ContainerStore *getContainerStore() const;
+
+            friend class ContainerStore;
+            friend class ContainerStoreIteratorBase<Ptr>;
+            friend class ContainerStoreIteratorBase<ConstPtr>;
+    };
+
     class ContainerStore
     {
         public:
@@ -92,6 +224,14 @@ namespace MWWorld
 
             mutable float mCachedWeight;
             mutable bool mWeightUpToDate;
+
+            typedef StackIndex<ContainerStoreIterator>::Stacks Stacks;
+
+            StackIndex<ContainerStoreIterator> mStackIndex;
+
+            const Stacks& getStacks (const std::string& id);
+            ///< @return All stacks with the ID \a id, including stacks with a count of 0.
+
             ContainerStoreIterator addImp (const Ptr& ptr, int count);
             void addInitialItem (const std::string& id, const std::string& owner, int count, bool topLevel=true, const std::string& levItem = "");
 
@@ -215,135 +355,6 @@ namespace MWWorld
     };
 
     
-    template<class PtrType>
-    class ContainerStoreIteratorBase
-        : public std::iterator<std::forward_iterator_tag, PtrType, std::ptrdiff_t, PtrType *, PtrType&>
-    {
-        template<class From, class To, class Dummy>
-        struct IsConvertible
-        {
-            static const bool value = true;
-        };
-
-        template<class Dummy>
-        struct IsConvertible<ConstPtr, Ptr, Dummy>
-        {
-            static const bool value = false;
-        };
-
-        template<class T, class U>
-        struct IteratorTrait
-        {
-            typedef typename MWWorld::CellRefList<T>::List::iterator type;
-        };
-
-        template<class T>
-        struct IteratorTrait<T, ConstPtr>
-        {
-            typedef typename MWWorld::CellRefList<T>::List::const_iterator type;
-        };
-
-        template<class T>
-        struct Iterator : IteratorTrait<T, PtrType>
-        {
-        };
-
-        template<class T, class Dummy>
-        struct ContainerStoreTrait
-        {
-            typedef ContainerStore* type;
-        };
-        
-        template<class Dummy>
-        struct ContainerStoreTrait<ConstPtr, Dummy>
-        {
-            typedef const ContainerStore* type;
-        };
-
-        typedef typename ContainerStoreTrait<PtrType, void>::type ContainerStoreType;
-
-        int mType;
-        int mMask;
-        ContainerStoreType mContainer;
-        mutable PtrType mPtr;
-
-        typename Iterator<ESM::Potion>::type mPotion;
-        typename Iterator<ESM::Apparatus>::type mApparatus;
-        typename Iterator<ESM::Armor>::type mArmor;
-        typename Iterator<ESM::Book>::type mBook;
-        typename Iterator<ESM::Clothing>::type mClothing;
-        typename Iterator<ESM::Ingredient>::type mIngredient;
-        typename Iterator<ESM::Light>::type mLight;
-        typename Iterator<ESM::Lockpick>::type mLockpick;
-        typename Iterator<ESM::Miscellaneous>::type mMiscellaneous;
-        typename Iterator<ESM::Probe>::type mProbe;
-        typename Iterator<ESM::Repair>::type mRepair;
-        typename Iterator<ESM::Weapon>::type mWeapon;
-
-        ContainerStoreIteratorBase (ContainerStoreType container);
-        ///< End-iterator
-
-        ContainerStoreIteratorBase (int mask, ContainerStoreType container);
-        ///< Begin-iterator
-
-        // construct iterator using a CellRefList iterator
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Potion>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Apparatus>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Armor>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Book>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Clothing>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Ingredient>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Light>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Lockpick>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Miscellaneous>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Probe>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Repair>::type);
-        ContainerStoreIteratorBase (ContainerStoreType container, typename Iterator<ESM::Weapon>::type);
-
-        template<class T>
-        void copy (const ContainerStoreIteratorBase<T>& src);
-        
-        void incType ();
-        
-        void nextType ();
-
-        bool resetIterator ();
-        ///< Reset iterator for selected type.
-        ///
-        /// \return Type not empty?
-
-        bool incIterator ();
-        ///< Increment iterator for selected type.
-        ///
-        /// \return reached the end?
-
-        public:
-            template<class T>
-            ContainerStoreIteratorBase (const ContainerStoreIteratorBase<T>& other)
-            {
-                char CANNOT_CONVERT_CONST_ITERATOR_TO_ITERATOR[IsConvertible<T, PtrType, void>::value ? 1 : -1];
-                ((void)CANNOT_CONVERT_CONST_ITERATOR_TO_ITERATOR);
-                copy (other);
-            }
-
-            template<class T>
-            bool isEqual(const ContainerStoreIteratorBase<T>& other) const;
-
-            PtrType *operator->() const;
-            PtrType operator*() const;
-
-            ContainerStoreIteratorBase& operator++ ();
-            ContainerStoreIteratorBase operator++ (int);
-            ContainerStoreIteratorBase& operator= (const ContainerStoreIteratorBase& rhs);
-
-            int getType() const;
-            const ContainerStore *getContainerStore() const;
-
-            friend class ContainerStore;
-            friend class ContainerStoreIteratorBase<Ptr>;
-            friend class ContainerStoreIteratorBase<ConstPtr>;
-    };
-
     template<class T, class U>
     bool operator== (const ContainerStoreIteratorBase<T>& left, const ContainerStoreIteratorBase<U>& right);
     template<class T, class U>
@@ -1,7 +1,9 @@
 #include "esmloader.hpp"
 #include "esmstore.hpp"
 
+#include <components/debug/debuglog.hpp>
 #include <components/esm/esmreader.hpp>
+#include <components/files/mappedfilestream.hpp>
 
 namespace MWWorld
 {
@@ -23,7 +25,20 @@ void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
   lEsm.setEncoder(mEncoder);
   lEsm.setIndex(index);
   lEsm.setGlobalReaderList(&mEsm);
-  lEsm.open(filepath.string());
+
+  // The readers stay open to load cell references on demand, which seeks all over the file.
+  Files::IStreamPtr stream;
+  try
+  {
+    stream = Files::openMappedFileStream(filepath.string());
+  }
+  catch (const std::exception& e)
+  {
+    Log(Debug::Warning) << "Failed to map " << filepath.string() << " into memory: " << e.what();
+    stream = Files::openConstrainedFileStream(filepath.string().c_str());
+  }
+
+  lEsm.open(stream, filepath.string());
   mEsm[index] = lEsm;
   mStore.load(mEsm[index], &mListener);
 }
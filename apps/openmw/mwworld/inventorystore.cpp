@@ -212,7 +212,8 @@ MWWorld::ConstContainerStoreIterator MWWorld::InventoryStore::getSlot (int slot)
 
 bool MWWorld::InventoryStore::canActorAutoEquip(const MWWorld::Ptr& actor, const MWWorld::Ptr& item)
 {
-    if (!Settings::Manager::getBool("prevent merchant equipping", "Game"))
+    static const Settings::SettingValue<bool> preventMerchantEquipping("prevent merchant equipping", "Game");
+    if (!preventMerchantEquipping.get())
         return true;
 
     // Only autoEquip if we are the original owner of the item.
@@ -64,25 +64,105 @@ namespace
 
 }
 
-MWWorld::LocalScripts::LocalScripts (const MWWorld::ESMStore& store) : mStore (store)
+MWWorld::LocalScripts::LocalScripts (const MWWorld::ESMStore& store)
+: mIter (0), mCurrent (-1), mStart (0), mRemoved (0), mWrapped (false), mStore (store)
+{}
+
+void MWWorld::LocalScripts::removeAt (std::size_t index)
+{
+    Script& script = mScripts[index];
+
+    mIndex.erase (&script.mPtr.getRefData());
+
+    script.mName.clear();
+    script.mPtr = Ptr();
+    script.mCompiled = 0;
+    ++mRemoved;
+
+    if (index==mCurrent)
+        mCurrent = -1;
+}
+
+void MWWorld::LocalScripts::compact()
 {
-    mIter = mScripts.end();
+    if (!mRemoved)
+        return;
+
+    std::size_t target = 0;
+    std::size_t iter = mIter;
+
+    for (std::size_t i=0; i<mScripts.size(); ++i)
+    {
+        if (i==mIter)
+            iter = target;
+
+        if (mScripts[i].mPtr.isEmpty())
+            continue;
+
+        if (i!=target)
+        {
+            mScripts[target] = std::move (mScripts[i]);
+            mIndex[&mScripts[target].mPtr.getRefData()] = target;
+        }
+
+        ++target;
+    }
+
+    mIter = mIter<mScripts.size() ? iter : target;
+    mScripts.resize (target);
+    mRemoved = 0;
 }
 
 void MWWorld::LocalScripts::startIteration()
 {
-    mIter = mScripts.begin();
+    compact();
+
+    if (mIter>=mScripts.size())
+        mIter = 0;
+
+    mStart = mIter;
+    mCurrent = -1;
+    mWrapped = false;
 }
 
-bool MWWorld::LocalScripts::getNext(std::pair<std::string, Ptr>& script)
+MWWorld::LocalScripts::Script *MWWorld::LocalScripts::getNext()
 {
-    while (mIter!=mScripts.end())
+    while (true)
     {
-        std::list<std::pair<std::string, Ptr> >::iterator iter = mIter++;
-        script = *iter;
-        return true;
+        if (mWrapped && mIter>=mStart)
+        {
+            mIter = mStart;
+            return 0;
+        }
+
+        if (mIter>=mScripts.size())
+        {
+            if (mStart==0)
+                return 0;
+
+            mIter = 0;
+            mWrapped = true;
+            continue;
+        }
+
+        mCurrent = mIter++;
+
+        if (!mScripts[mCurrent].mPtr.isEmpty())
+            return &mScripts[mCurrent];
     }
-    return false;
+}
+
+MWWorld::LocalScripts::Script *MWWorld::LocalScripts::getCurrent()
+{
+    if (mCurrent>=mScripts.size())
+        return 0;
+
+    return &mScripts[mCurrent];
+}
+
+std::size_t MWWorld::LocalScripts::getSize() const
+{
+    return mScripts.size()-mRemoved;
 }
 
 void MWWorld::LocalScripts::add (const std::string& scriptName, const Ptr& ptr)
@@ -93,15 +173,24 @@ void MWWorld::LocalScripts::add (const std::string& scriptName, const Ptr& ptr)
         {
             ptr.getRefData().setLocals (*script);
 
-            for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin(); iter!=mScripts.end(); ++iter)
-                if (iter->second==ptr)
-                {
-                    Log(Debug::Warning) << "Error: tried to add local script twice for " << ptr.getCellRef().getRefId();
-                    remove(ptr);
-                    break;
-                }
+            std::unordered_map<const RefData *, std::size_t>::const_iterator iter =
+                mIndex.find (&ptr.getRefData());
+
+            if (iter!=mIndex.end())
+            {
+                Log(Debug::Warning) << "Error: tried to add local script twice for " << ptr.getCellRef().getRefId();
+                removeAt (iter->second);
+            }
 
-            mScripts.push_back (std::make_pair (scriptName, ptr));
+            Script entry;
+            entry.mName = scriptName;
+            entry.mPtr = ptr;
+            entry.mCompiled = 0;
+            entry.mCost = 0;
+            entry.mSlow = false;
+
+            mIndex[&ptr.getRefData()] = mScripts.size();
+            mScripts.push_back (std::move (entry));
         }
         catch (const std::exception& exception)
         {
@@ -130,50 +219,30 @@ void MWWorld::LocalScripts::addCell (CellStore *cell)
 void MWWorld::LocalScripts::clear()
 {
     mScripts.clear();
+    mIndex.clear();
+    mIter = 0;
+    mCurrent = -1;
+    mStart = 0;
+    mRemoved = 0;
+    mWrapped = false;
 }
 
 void MWWorld::LocalScripts::clearCell (CellStore *cell)
 {
-    std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
-
-    while (iter!=mScripts.end())
-    {
-        if (iter->second.mCell==cell)
-        {
-            if (iter==mIter)
-               ++mIter;
-
-            mScripts.erase (iter++);
-        }
-        else
-            ++iter;
-    }
+    for (std::size_t i=0; i<mScripts.size(); ++i)
+        if (!mScripts[i].mPtr.isEmpty() && mScripts[i].mPtr.mCell==cell)
+            removeAt (i);
 }
 
 void MWWorld::LocalScripts::remove (RefData *ref)
 {
-    for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
-        iter!=mScripts.end(); ++iter)
-        if (&(iter->second.getRefData()) == ref)
-        {
-            if (iter==mIter)
-                ++mIter;
+    std::unordered_map<const RefData *, std::size_t>::const_iterator iter = mIndex.find (ref);
 
-            mScripts.erase (iter);
-            break;
-        }
+    if (iter!=mIndex.end())
+        removeAt (iter->second);
 }
 
 void MWWorld::LocalScripts::remove (const Ptr& ptr)
 {
-    for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
-        iter!=mScripts.end(); ++iter)
-        if (iter->second==ptr)
-        {
-            if (iter==mIter)
-                ++mIter;
-
-            mScripts.erase (iter);
-            break;
-        }
+    remove (&ptr.getRefData());
 }
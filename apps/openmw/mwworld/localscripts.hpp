@@ -1,11 +1,17 @@
 #ifndef GAME_MWWORLD_LOCALSCRIPTS_H
 #define GAME_MWWORLD_LOCALSCRIPTS_H
 
-#include <list>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "ptr.hpp"
 
+namespace MWScript
+{
+    struct CompiledScript;
+}
+
 namespace MWWorld
 {
     class ESMStore;
@@ -13,22 +19,59 @@ namespace MWWorld
     class RefData;
 
     /// \brief List of active local scripts
+    ///
+    /// Iteration is resumable: if it is stopped before getNext() returned 0, the next iteration
+    /// starts with the first script that has not been run yet.
     class LocalScripts
     {
-            std::list<std::pair<std::string, Ptr> > mScripts;
-            std::list<std::pair<std::string, Ptr> >::iterator mIter;
+        public:
+
+            struct Script
+            {
+                std::string mName;
+                Ptr mPtr;
+                MWScript::CompiledScript *mCompiled; ///< 0 until the script is run for the first time
+                double mCost; ///< time in seconds taken by the last run
+                bool mSlow; ///< has exceeded the slow script threshold at least once?
+            };
+
+        private:
+
+            // Removed scripts stay in the vector with an empty name until the next call to
+            // startIteration(), so that positions do not change while iterating.
+            std::vector<Script> mScripts;
+            std::unordered_map<const RefData *, std::size_t> mIndex;
+            std::size_t mIter;
+            std::size_t mCurrent;
+            std::size_t mStart;
+            std::size_t mRemoved;
+            bool mWrapped;
             const MWWorld::ESMStore& mStore;
 
+            void removeAt (std::size_t index);
+
+            void compact();
+
         public:
 
             LocalScripts (const MWWorld::ESMStore& store);
 
             void startIteration();
-            ///< Set the iterator to the begin of the script list.
+            ///< Start a new iteration, continuing where an unfinished iteration stopped.
 
-            bool getNext(std::pair<std::string, Ptr>& script);
+            Script *getNext();
             ///< Get next local script
-            /// @return Did we get a script?
+            /// @return 0, if all scripts have been visited during this iteration.
+            ///
+            /// \attention The returned pointer is invalidated when a script is added.
+
+            Script *getCurrent();
+            ///< Return the script last returned by getNext() (0 if it has been removed since).
+            ///
+            /// \attention The returned pointer is invalidated when a script is added.
+
+            std::size_t getSize() const;
+            ///< Return number of active local scripts.
 
             void add (const std::string& scriptName, const Ptr& ptr);
             ///< Add script to collection of active local scripts.
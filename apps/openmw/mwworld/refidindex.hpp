@@ -0,0 +1,76 @@
+#ifndef GAME_MWWORLD_REFIDINDEX_H
+#define GAME_MWWORLD_REFIDINDEX_H
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace MWWorld
+{
+    /// \brief Index of the cells that may hold a reference with a given ID
+    ///
+    /// A cell adds the IDs of its content file references when they are listed or loaded, and the ID of
+    /// every reference placed into it or moved to it later on. Entries are not removed when a reference
+    /// is deleted or leaves a cell, so a listed cell is only a candidate that still has to be searched.
+    /// Once all cells have added their content file references, an ID that is not in the index is not
+    /// held by any cell.
+    template <class Cell>
+    class RefIdIndex
+    {
+            struct Entry
+            {
+                std::vector<Cell*> mCells;
+                bool mSorted = true;
+            };
+
+            std::unordered_map<std::string, Entry> mEntries;
+
+        public:
+
+            /// @note id must be lower case
+            void add (const std::string& id, Cell* cell)
+            {
+                Entry& entry = mEntries[id];
+
+                // a cell usually adds all of its IDs at once
+                if (!entry.mCells.empty() && entry.mCells.back()==cell)
+                    return;
+
+                if (!entry.mCells.empty() && !std::less<Cell*>() (entry.mCells.back(), cell))
+                    entry.mSorted = false;
+
+                entry.mCells.push_back (cell);
+            }
+
+            /// @return The cells that may hold a reference with \a id, without duplicates and sorted by
+            /// address, i.e. suitable for std::binary_search.
+            /// @note id must be lower case
+            const std::vector<Cell*>& find (const std::string& id)
+            {
+                static const std::vector<Cell*> sEmpty;
+
+                typename std::unordered_map<std::string, Entry>::iterator found = mEntries.find (id);
+                if (found==mEntries.end())
+                    return sEmpty;
+
+                Entry& entry = found->second;
+                if (!entry.mSorted)
+                {
+                    std::sort (entry.mCells.begin(), entry.mCells.end(), std::less<Cell*>());
+                    entry.mCells.erase (std::unique (entry.mCells.begin(), entry.mCells.end()), entry.mCells.end());
+                    entry.mSorted = true;
+                }
+
+                return entry.mCells;
+            }
+
+            void clear()
+            {
+                mEntries.clear();
+            }
+    };
+}
+
+#endif
@@ -1,10 +1,13 @@
 #include "scene.hpp"
 
 #include <limits>
+#include <set>
 
 #include <BulletCollision/CollisionDispatch/btCollisionObject.h>
 #include <BulletCollision/CollisionShapes/btCompoundShape.h>
 
+#include <osg/Vec4i>
+
 #include <components/debug/debuglog.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
 #include <components/misc/resourcehelpers.hpp>
@@ -81,6 +84,32 @@ namespace
         );
     }
 
+    void preloadSoundGenerators(const MWWorld::CellStore& cell)
+    {
+        std::set<std::string> creatures;
+        cell.forEachConst([&] (const MWWorld::ConstPtr& ptr)
+        {
+            if (ptr.getTypeName() == typeid(ESM::Creature).name())
+            {
+                const ESM::Creature* creature = ptr.get<ESM::Creature>()->mBase;
+                creatures.insert(Misc::StringUtils::lowerCase(creature->mOriginal.empty() ? creature->mId : creature->mOriginal));
+            }
+            return true;
+        });
+
+        if (creatures.empty())
+            return;
+
+        // Generic sound generators are used as a fallback for any creature
+        MWBase::SoundManager* sndMgr = MWBase::Environment::get().getSoundManager();
+        const MWWorld::ESMStore& store = MWBase::Environment::get().getWorld()->getStore();
+        for (const ESM::SoundGenerator& sound : store.get<ESM::SoundGenerator>())
+        {
+            if (sound.mCreature.empty() || creatures.count(Misc::StringUtils::lowerCase(sound.mCreature)))
+                sndMgr->preloadSound(sound.mSound);
+        }
+    }
+
     void addObject(const MWWorld::Ptr& ptr, MWPhysics::PhysicsSystem& physics,
                    MWRender::RenderingManager& rendering)
     {
@@ -428,6 +457,8 @@ namespace MWWorld
             /// \todo rescale depending on the state of a new GMST
             insertCell (*cell, true, loadingListener);
 
+            preloadSoundGenerators(*cell);
+
             mRendering.addCell(cell);
             MWBase::Environment::get().getWindowManager()->addCell(cell);
             bool waterEnabled = cell->getCell()->hasWater() || cell->isExterior();
@@ -523,6 +554,9 @@ namespace MWWorld
             unloadCell (active++);
         }
 
+        mRendering.setActiveGrid(osg::Vec4i(playerCellX - mHalfGridSize, playerCellY - mHalfGridSize,
+            playerCellX + mHalfGridSize + 1, playerCellY + mHalfGridSize + 1));
+
         std::size_t refsToLoad = 0;
         std::vector<std::pair<int, int>> cellsPositionsToLoad;
         // get the number of refs to load
@@ -0,0 +1,90 @@
+#ifndef GAME_MWWORLD_STACKINDEX_H
+#define GAME_MWWORLD_STACKINDEX_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <components/misc/stringops.hpp>
+
+namespace MWWorld
+{
+    /// \brief Iterators to the stacks of a container, grouped by lower case item ID
+    ///
+    /// Built from all stacks of the container on first use. While it is up to date, new stacks are
+    /// appended with add(); any other change to the lists of the container has to invalidate it. A
+    /// copy starts out invalidated, because the iterators point into the lists of the original.
+    template <class Iterator>
+    class StackIndex
+    {
+        public:
+
+            typedef std::vector<Iterator> Stacks;
+
+        private:
+
+            std::unordered_map<std::string, Stacks> mStacks;
+            bool mUpToDate;
+
+        public:
+
+            StackIndex() : mUpToDate (false) {}
+
+            StackIndex (const StackIndex&) : mUpToDate (false) {}
+
+            StackIndex& operator= (const StackIndex&)
+            {
+                invalidate();
+                return *this;
+            }
+
+            bool isUpToDate() const { return mUpToDate; }
+
+            void invalidate()
+            {
+                mStacks.clear();
+                mUpToDate = false;
+            }
+
+            /// Build the index from the stacks in [\a begin, \a end), unless it is up to date.
+            /// \param getId Returns the item ID of the stack an iterator points to.
+            template <class GetId>
+            void update (Iterator begin, Iterator end, GetId getId)
+            {
+                if (mUpToDate)
+                    return;
+
+                mStacks.clear();
+
+                for (Iterator iter (begin); iter!=end; ++iter)
+                    mStacks[Misc::StringUtils::lowerCase (getId (iter))].push_back (iter);
+
+                mUpToDate = true;
+            }
+
+            /// Append a new stack. Does nothing while the index is invalidated, as the next update()
+            /// finds the stack anyway.
+            void add (const std::string& id, const Iterator& stack)
+            {
+                if (mUpToDate)
+                    mStacks[Misc::StringUtils::lowerCase (id)].push_back (stack);
+            }
+
+            /// @return The stacks with the ID \a id (case insensitive), in the order they were indexed.
+            /// @note Call update() first.
+            const Stacks& find (const std::string& id) const
+            {
+                static const Stacks sEmpty;
+
+                typename std::unordered_map<std::string, Stacks>::const_iterator found =
+                    mStacks.find (Misc::StringUtils::lowerCase (id));
+
+                if (found==mStacks.end())
+                    return sEmpty;
+
+                return found->second;
+            }
+    };
+}
+
+#endif
@@ -158,7 +158,7 @@ namespace MWWorld
         const std::vector<std::string>& contentFiles,
         ToUTF8::Utf8Encoder* encoder, int activationDistanceOverride,
         const std::string& startCell, const std::string& startupScript,
-        const std::string& resourcePath, const std::string& userDataPath)
+        const std::string& resourcePath, const std::string& userDataPath, const std::string& cachePath)
     : mResourceSystem(resourceSystem), mLocalScripts (mStore),
       mSky (true), mCells (mStore, mEsm),
       mGodMode(false), mScriptsEnabled(true), mContentFiles (contentFiles), mUserDataPath(userDataPath),
@@ -210,7 +210,7 @@ namespace MWWorld
             mNavigator.reset(new DetourNavigator::NavigatorStub());
         }
 
-        mRendering.reset(new MWRender::RenderingManager(viewer, rootNode, resourceSystem, workQueue, resourcePath, *mNavigator));
+        mRendering.reset(new MWRender::RenderingManager(viewer, rootNode, resourceSystem, workQueue, resourcePath, cachePath, *mNavigator, encoder));
         mProjectileManager.reset(new ProjectileManager(mRendering->getLightRoot(), resourceSystem, mRendering.get(), mPhysics.get()));
         mRendering->preloadCommonAssets();
 
@@ -421,6 +421,33 @@ namespace MWWorld
         }
     }
 
+    void World::readRecordsDone()
+    {
+        // Distant statics are paged straight from the content files, so report the ones the saved game changed.
+        std::vector<CellStore*> cells;
+        mCells.getExteriorStores(cells);
+
+        for (std::vector<CellStore*>::iterator cell = cells.begin(); cell != cells.end(); ++cell)
+        {
+            const CellRefList<ESM::Static>& statics = (*cell)->getReadOnlyStatics();
+            for (CellRefList<ESM::Static>::List::const_iterator ref = statics.mList.begin(); ref != statics.mList.end(); ++ref)
+            {
+                if (!ref->mData.hasChanged())
+                    continue;
+
+                ConstPtr ptr (&*ref, *cell);
+
+                if (!ref->mData.isEnabled())
+                    mRendering->pagingEnableObject(ptr, false);
+
+                // The saved game does not keep the original scale of a reference, so any other change is
+                // treated as a move, rotation, scale or deletion.
+                if (ref->mData.isEnabled() || ref->mData.isDeleted() || !ref->mData.getCount())
+                    mRendering->pagingBlacklistObject(ptr);
+            }
+        }
+    }
+
     void World::ensureNeededRecords()
     {
         std::map<std::string, ESM::Variant> gmst;
@@ -690,21 +717,9 @@ namespace MWWorld
 
         std::string lowerCaseName = Misc::StringUtils::lowerCase(name);
 
-        for (CellStore* cellstore : mWorldScene->getActiveCells())
-        {
-            // TODO: caching still doesn't work efficiently here (only works for the one CellStore that the reference is in)
-            Ptr ptr = mCells.getPtr (lowerCaseName, *cellstore, false);
-
-            if (!ptr.isEmpty())
-                return ptr;
-        }
-
-        if (!activeOnly)
-        {
-            ret = mCells.getPtr (lowerCaseName);
-            if (!ret.isEmpty())
-                return ret;
-        }
+        ret = mCells.searchPtr (lowerCaseName, mWorldScene->getActiveCells(), activeOnly);
+        if (!ret.isEmpty())
+            return ret;
 
         if (searchInContainers)
         {
@@ -736,7 +751,15 @@ namespace MWWorld
         if (actorId == getPlayerPtr().getClass().getCreatureStats(getPlayerPtr()).getActorId())
             return getPlayerPtr();
         // Now search cells
-        return mWorldScene->searchPtrViaActorId (actorId);
+        Ptr ptr = mCells.searchIndexViaActorId (actorId);
+        if (!ptr.isEmpty() && mWorldScene->isCellActive (*ptr.getCell()))
+            return ptr;
+
+        ptr = mWorldScene->searchPtrViaActorId (actorId);
+        if (!ptr.isEmpty())
+            mCells.addToActorIndex (actorId, ptr);
+
+        return ptr;
     }
 
     struct FindContainerVisitor
@@ -813,6 +836,8 @@ namespace MWWorld
         {
             reference.getRefData().enable();
 
+            mRendering->pagingEnableObject(reference, true);
+
             if(mWorldScene->getActiveCells().find (reference.getCell()) != mWorldScene->getActiveCells().end() && reference.getRefData().getCount())
                 mWorldScene->addObjectToScene (reference);
         }
@@ -850,6 +875,8 @@ namespace MWWorld
 
             reference.getRefData().disable();
 
+            mRendering->pagingEnableObject(reference, false);
+
             if(mWorldScene->getActiveCells().find (reference.getCell())!=mWorldScene->getActiveCells().end() && reference.getRefData().getCount())
                 mWorldScene->removeObjectFromScene (reference);
         }
@@ -1158,6 +1185,8 @@ namespace MWWorld
 
             ptr.getRefData().setCount(0);
 
+            mRendering->pagingBlacklistObject(ptr);
+
             if (ptr.isInCell()
                 && mWorldScene->getActiveCells().find(ptr.getCell()) != mWorldScene->getActiveCells().end()
                 && ptr.getRefData().isEnabled())
@@ -1190,6 +1219,8 @@ namespace MWWorld
 
     MWWorld::Ptr World::moveObject(const Ptr &ptr, CellStore* newCell, float x, float y, float z, bool movePhysics)
     {
+        mRendering->pagingBlacklistObject(ptr);
+
         ESM::Position pos = ptr.getRefData().getPosition();
 
         pos.pos[0] = x;
@@ -1329,6 +1360,8 @@ namespace MWWorld
 
         ptr.getCellRef().setScale(scale);
 
+        mRendering->pagingBlacklistObject(ptr);
+
         mWorldScene->updateObjectScale(ptr);
 
         if (mPhysics->getActor(ptr))
@@ -1373,6 +1406,8 @@ namespace MWWorld
 
         ptr.getRefData().setPosition(pos);
 
+        mRendering->pagingBlacklistObject(ptr);
+
         if(ptr.getRefData().getBaseNode() != 0)
         {
             mWorldScene->updateObjectRotation(ptr, true);
@@ -3619,7 +3654,8 @@ namespace MWWorld
 
     void World::spawnBloodEffect(const Ptr &ptr, const osg::Vec3f &worldPosition)
     {
-        if (ptr == getPlayerPtr() && Settings::Manager::getBool("hit fader", "GUI"))
+        static const Settings::SettingValue<bool> hitFader("hit fader", "GUI");
+        if (ptr == getPlayerPtr() && hitFader.get())
             return;
 
         std::string texture = Fallback::Map::getString("Blood_Texture_" + std::to_string(ptr.getClass().getBloodTexture(ptr)));
@@ -200,7 +200,7 @@ namespace MWWorld
                 const std::vector<std::string>& contentFiles,
                 ToUTF8::Utf8Encoder* encoder, int activationDistanceOverride,
                 const std::string& startCell, const std::string& startupScript,
-                const std::string& resourcePath, const std::string& userDataPath);
+                const std::string& resourcePath, const std::string& userDataPath, const std::string& cachePath);
 
             virtual ~World();
 
@@ -217,6 +217,8 @@ namespace MWWorld
             void readRecord (ESM::ESMReader& reader, uint32_t type,
                 const std::map<int, int>& contentFileMap) override;
 
+            void readRecordsDone() override;
+
             CellStore *getExterior (int x, int y) override;
 
             CellStore *getInterior (const std::string& name) override;
@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <sstream>
+
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+#include <components/esm/loadcell.hpp>
+
+namespace
+{
+    using namespace testing;
+
+    struct ESMLoadCellTest : Test
+    {
+        ESM::ESMReader mReader;
+        ESM::Cell mCell;
+
+        ESMLoadCellTest()
+        {
+            std::stringstream stream;
+
+            ESM::ESMWriter writer;
+            writer.setFormat(0);
+            writer.setVersion();
+            writer.setType(0);
+            writer.setAuthor("");
+            writer.setDescription("");
+            writer.setRecordCount(1);
+            writer.save(stream);
+
+            ESM::Cell cell;
+            cell.blank();
+
+            writer.startRecord(ESM::REC_CELL);
+            cell.save(writer);
+            for (unsigned int i = 1; i <= 3; ++i)
+            {
+                ESM::CellRef ref;
+                ref.blank();
+                ref.mRefNum.mIndex = i;
+                ref.mRefNum.mContentFile = 0; // a new reference of this file
+                ref.mRefID = "ref" + std::to_string(i);
+                ref.mScale = 0.5f * i;
+                ref.mOwner = "owner" + std::to_string(i);
+                ref.mPos.pos[0] = 10.f * i;
+                ref.save(writer, false, false, i == 3);
+            }
+            writer.endRecord(ESM::REC_CELL);
+            writer.close();
+
+            mReader.open(std::make_shared<std::stringstream>(stream.str()), "test.esm");
+            mReader.getRecName();
+            mReader.getRecHeader();
+
+            bool deleted = false;
+            mCell.load(mReader, deleted);
+            mCell.restore(mReader, 0);
+        }
+    };
+
+    TEST_F(ESMLoadCellTest, getNextRefId_should_only_read_the_id)
+    {
+        ESM::CellRef ref;
+        bool deleted = false;
+
+        ASSERT_TRUE(ESM::Cell::getNextRefId(mReader, ref, deleted));
+        EXPECT_EQ(ref.mRefNum.mIndex, 1u);
+        EXPECT_EQ(ref.mRefID, "ref1");
+        EXPECT_EQ(ref.mScale, 1.f);
+        EXPECT_EQ(ref.mOwner, "");
+        EXPECT_FALSE(deleted);
+    }
+
+    TEST_F(ESMLoadCellTest, getRefAt_should_read_the_whole_reference_at_the_position)
+    {
+        std::vector<ESM::Cell::RefPosition> positions;
+        ESM::CellRef ref;
+        ESM::Cell::RefPosition position;
+        bool deleted = false;
+        while (ESM::Cell::getNextRefId(mReader, ref, deleted, &position))
+            positions.push_back(position);
+
+        ASSERT_EQ(positions.size(), 3u);
+
+        ASSERT_TRUE(mCell.getRefAt(mReader, 0, positions[1], ref, deleted));
+        EXPECT_EQ(ref.mRefNum.mIndex, 2u);
+        EXPECT_EQ(ref.mRefID, "ref2");
+        EXPECT_EQ(ref.mScale, 1.f);
+        EXPECT_EQ(ref.mOwner, "owner2");
+        EXPECT_EQ(ref.mPos.pos[0], 20.f);
+        EXPECT_FALSE(deleted);
+
+        ASSERT_TRUE(mCell.getRefAt(mReader, 0, positions[0], ref, deleted));
+        EXPECT_EQ(ref.mRefID, "ref1");
+        EXPECT_EQ(ref.mScale, 0.5f);
+        EXPECT_FALSE(deleted);
+    }
+
+    TEST_F(ESMLoadCellTest, getRefAt_should_continue_with_the_next_reference)
+    {
+        ESM::CellRef ref;
+        ESM::Cell::RefPosition position;
+        bool deleted = false;
+        ASSERT_TRUE(ESM::Cell::getNextRefId(mReader, ref, deleted, &position));
+        while (ESM::Cell::getNextRefId(mReader, ref, deleted))
+            ;
+
+        ASSERT_TRUE(mCell.getRefAt(mReader, 0, position, ref, deleted));
+        EXPECT_EQ(ref.mRefID, "ref1");
+
+        ASSERT_TRUE(ESM::Cell::getNextRef(mReader, ref, deleted));
+        EXPECT_EQ(ref.mRefID, "ref2");
+
+        ASSERT_TRUE(ESM::Cell::getNextRef(mReader, ref, deleted));
+        EXPECT_EQ(ref.mRefID, "ref3");
+        EXPECT_TRUE(deleted);
+
+        EXPECT_FALSE(ESM::Cell::getNextRef(mReader, ref, deleted));
+    }
+}
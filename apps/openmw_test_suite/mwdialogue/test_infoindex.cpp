@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include <components/esm/loaddial.hpp>
+#include <components/misc/stringops.hpp>
+
+#include "apps/openmw/mwdialogue/infoindex.hpp"
+
+namespace
+{
+    using namespace testing;
+    using namespace MWDialogue;
+
+    // The speaker checks of Filter::testActor before infos were indexed, with the actor's data taken
+    // from the speaker. The faction rank and gender checks that follow them are left out.
+    bool testActorUnindexed (const ESM::DialInfo& info, const InfoIndex::Speaker& speaker)
+    {
+        bool isCreature = speaker.mCreature;
+
+        // actor id
+        if (!info.mActor.empty())
+        {
+            if ( !Misc::StringUtils::ciEqual(info.mActor, speaker.mId))
+                return false;
+        }
+        else if (isCreature)
+        {
+            // Creatures must not have topics aside of those specific to their id
+            return false;
+        }
+
+        // NPC race
+        if (!info.mRace.empty())
+        {
+            if (isCreature)
+                return true;
+
+            if (!Misc::StringUtils::ciEqual(info.mRace, speaker.mRace))
+                return false;
+        }
+
+        // NPC class
+        if (!info.mClass.empty())
+        {
+            if (isCreature)
+                return true;
+
+            if ( !Misc::StringUtils::ciEqual(info.mClass, speaker.mClass))
+                return false;
+        }
+
+        // NPC faction
+        if (info.mFactionLess)
+        {
+            if (isCreature)
+                return true;
+
+            if (!speaker.mFaction.empty())
+                return false;
+        }
+        else if (!info.mFaction.empty())
+        {
+            if (isCreature)
+                return true;
+
+            if (!Misc::StringUtils::ciEqual(speaker.mFaction, info.mFaction))
+                return false;
+        }
+
+        return true;
+    }
+
+    std::vector<const ESM::DialInfo *> listLinear (const ESM::Dialogue& dialogue, const InfoIndex::Speaker& speaker)
+    {
+        std::vector<const ESM::DialInfo *> infos;
+
+        for (const ESM::DialInfo& info : dialogue.mInfo)
+            if (testActorUnindexed (info, speaker))
+                infos.push_back (&info);
+
+        return infos;
+    }
+
+    std::vector<const ESM::DialInfo *> listIndexed (const InfoIndex& index, const InfoIndex::Speaker& speaker)
+    {
+        std::vector<std::size_t> candidates;
+        index.getCandidates (speaker, candidates);
+
+        std::vector<const ESM::DialInfo *> infos;
+
+        for (std::size_t candidate : candidates)
+            if (InfoIndex::matchesSpeaker (index.getInfo (candidate), speaker))
+                infos.push_back (&index.getInfo (candidate));
+
+        return infos;
+    }
+
+    struct DialogueInfoIndexTest : Test
+    {
+        const std::vector<std::string> mIds {"", "fargoth", "Fargoth", "hrisskar flat-foot", "scamp"};
+        const std::vector<std::string> mRaces {"", "Wood Elf", "wood elf", "Nord"};
+        const std::vector<std::string> mClasses {"", "Pauper", "Thief"};
+        const std::vector<std::string> mFactions {"", "Thieves Guild", "thieves guild", "Fighters Guild"};
+
+        std::mt19937 mRandom {42};
+
+        const std::string& pick (const std::vector<std::string>& values)
+        {
+            return values[std::uniform_int_distribution<std::size_t> (0, values.size()-1) (mRandom)];
+        }
+
+        InfoIndex::Speaker makeSpeaker (const std::string& id, const std::string& race,
+            const std::string& class_, const std::string& faction, bool creature)
+        {
+            InfoIndex::Speaker speaker;
+            speaker.mId = Misc::StringUtils::lowerCase (id);
+            speaker.mCreature = creature;
+
+            if (!creature)
+            {
+                speaker.mRace = Misc::StringUtils::lowerCase (race);
+                speaker.mClass = Misc::StringUtils::lowerCase (class_);
+                speaker.mFaction = Misc::StringUtils::lowerCase (faction);
+            }
+
+            return speaker;
+        }
+    };
+
+    TEST_F (DialogueInfoIndexTest, candidates_should_give_same_result_as_linear_search)
+    {
+        ESM::Dialogue dialogue;
+
+        for (int i=0; i<2000; ++i)
+        {
+            ESM::DialInfo info;
+            info.mId = std::to_string (i);
+            info.mActor = pick (mIds);
+            info.mRace = pick (mRaces);
+            info.mClass = pick (mClasses);
+            info.mFaction = pick (mFactions);
+            info.mFactionLess = std::uniform_int_distribution<int> (0, 9) (mRandom)==0;
+            dialogue.mInfo.push_back (info);
+        }
+
+        const InfoIndex index (dialogue);
+        ASSERT_EQ (index.getSize(), dialogue.mInfo.size());
+
+        for (const std::string& id : mIds)
+            for (const std::string& race : mRaces)
+                for (const std::string& class_ : mClasses)
+                    for (const std::string& faction : mFactions)
+                        for (bool creature : {false, true})
+                        {
+                            const InfoIndex::Speaker speaker = makeSpeaker (id, race, class_, faction, creature);
+                            EXPECT_EQ (listIndexed (index, speaker), listLinear (dialogue, speaker))
+                                << "speaker " << id << ", " << race << ", " << class_ << ", " << faction
+                                << (creature ? " (creature)" : "");
+                        }
+    }
+
+    TEST_F (DialogueInfoIndexTest, candidates_should_exclude_infos_for_other_speakers)
+    {
+        ESM::Dialogue dialogue;
+
+        ESM::DialInfo info;
+        info.mFactionLess = false;
+        info.mActor = "fargoth";
+        dialogue.mInfo.push_back (info);
+        info.mActor.clear();
+        info.mRace = "Nord";
+        dialogue.mInfo.push_back (info);
+        info.mRace.clear();
+        dialogue.mInfo.push_back (info);
+
+        const InfoIndex index (dialogue);
+        std::vector<std::size_t> candidates;
+
+        index.getCandidates (makeSpeaker ("fargoth", "Wood Elf", "", "", false), candidates);
+        EXPECT_EQ (candidates, std::vector<std::size_t> ({0, 2}));
+
+        index.getCandidates (makeSpeaker ("scamp", "", "", "", true), candidates);
+        EXPECT_TRUE (candidates.empty());
+    }
+
+    TEST_F (DialogueInfoIndexTest, selects_should_be_decoded_per_info)
+    {
+        ESM::Dialogue dialogue;
+
+        ESM::DialInfo info;
+        info.mFactionLess = false;
+        ESM::DialInfo::SelectStruct select;
+        select.mSelectRule = "01120X";
+        info.mSelects.push_back (select);
+        dialogue.mInfo.push_back (info);
+
+        info.mSelects.clear();
+        dialogue.mInfo.push_back (info);
+
+        select.mSelectRule = "01500X";
+        info.mSelects.push_back (select);
+        select.mSelectRule = "01670X";
+        info.mSelects.push_back (select);
+        dialogue.mInfo.push_back (info);
+
+        const InfoIndex index (dialogue);
+
+        ASSERT_EQ (index.getSelectsEnd (0)-index.getSelectsBegin (0), 1);
+        EXPECT_EQ (index.getSelectsBegin (0)->getFunction(), SelectWrapper::Function_PcSkill);
+        EXPECT_EQ (index.getSelectsBegin (0)->getArgument(), 1);
+
+        EXPECT_EQ (index.getSelectsEnd (1)-index.getSelectsBegin (1), 0);
+
+        ASSERT_EQ (index.getSelectsEnd (2)-index.getSelectsBegin (2), 2);
+        EXPECT_EQ (index.getSelectsBegin (2)[0].getFunction(), SelectWrapper::Function_Choice);
+        EXPECT_EQ (index.getSelectsBegin (2)[1].getFunction(), SelectWrapper::Function_AiSetting);
+        EXPECT_EQ (index.getSelectsBegin (2)[1].getArgument(), 1);
+    }
+}
@@ -65,3 +65,102 @@ TEST_F(KeywordSearchTest, keyword_test_conflict_resolution3)
     ASSERT_TRUE (matches.size() == 1);
     ASSERT_TRUE (std::string(matches.front().mBeg, matches.front().mEnd) == "bar lock");
 }
+
+TEST_F(KeywordSearchTest, keyword_test_case_insensitive)
+{
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("Vivec", 1);
+
+    std::string text = "Lord VIVEC and vivec";
+
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+    search.highlightKeywords(text.begin(), text.end(), matches);
+
+    ASSERT_TRUE (matches.size() == 2);
+    ASSERT_TRUE (std::string(matches[0].mBeg, matches[0].mEnd) == "VIVEC");
+    ASSERT_TRUE (std::string(matches[1].mBeg, matches[1].mEnd) == "vivec");
+    ASSERT_TRUE (matches[1].mValue == 1);
+}
+
+TEST_F(KeywordSearchTest, keyword_test_word_start)
+{
+    // keywords must start at the beginning of a word, but may end within a word
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("guild", 0);
+
+    std::string text = "guildmaster subguild";
+
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+    search.highlightKeywords(text.begin(), text.end(), matches);
+
+    ASSERT_TRUE (matches.size() == 1);
+    ASSERT_TRUE (matches.front().mBeg == text.begin());
+}
+
+TEST_F(KeywordSearchTest, keyword_test_keyword_within_failed_prefix)
+{
+    // "latest rumors" fails to match, but "rumors" still needs to be found within it
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("latest rumors", 0);
+    search.seed("rumors", 1);
+    search.seed("rum", 2);
+
+    std::string text = "latest rumor: rumors";
+
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+    search.highlightKeywords(text.begin(), text.end(), matches);
+
+    ASSERT_TRUE (matches.size() == 2);
+    ASSERT_TRUE (std::string(matches[0].mBeg, matches[0].mEnd) == "rum");
+    ASSERT_TRUE (std::string(matches[1].mBeg, matches[1].mEnd) == "rumors");
+    ASSERT_TRUE (matches[1].mValue == 1);
+}
+
+TEST_F(KeywordSearchTest, keyword_test_contains_keyword)
+{
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("little secret", 1);
+    search.seed("little", 2);
+
+    int value = 0;
+    ASSERT_TRUE (search.containsKeyword("Little Secret", value));
+    ASSERT_TRUE (value == 1);
+    ASSERT_TRUE (search.containsKeyword("little", value));
+    ASSERT_TRUE (value == 2);
+    ASSERT_FALSE (search.containsKeyword("little secrets", value));
+    ASSERT_FALSE (search.containsKeyword("littl", value));
+
+    search.clear();
+    ASSERT_FALSE (search.containsKeyword("little", value));
+}
+
+TEST_F(KeywordSearchTest, keyword_test_reseed_after_search)
+{
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("balmora", 0);
+
+    std::string text = "balmora and vivec";
+
+    std::vector<MWDialogue::KeywordSearch<std::string, int>::Match> matches;
+    search.highlightKeywords(text.begin(), text.end(), matches);
+    ASSERT_TRUE (matches.size() == 1);
+
+    search.seed("vivec", 1);
+
+    matches.clear();
+    search.highlightKeywords(text.begin(), text.end(), matches);
+    ASSERT_TRUE (matches.size() == 2);
+    ASSERT_TRUE (matches[1].mValue == 1);
+}
+
+TEST_F(KeywordSearchTest, keyword_test_duplicate_keyword)
+{
+    MWDialogue::KeywordSearch<std::string, int> search;
+    search.seed("balmora", 0);
+    ASSERT_THROW (search.seed("balmora", 1), std::runtime_error);
+
+    // the search is still usable
+    int value = 1;
+    ASSERT_TRUE (search.containsKeyword("balmora", value));
+    ASSERT_TRUE (value == 0);
+}
@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+#include <components/esm/loadcell.hpp>
+#include <components/loadinglistener/loadinglistener.hpp>
+#include <components/to_utf8/to_utf8.hpp>
+
+#include "apps/openmw/mwrender/pagedrefs.hpp"
+#include "apps/openmw/mwworld/esmstore.hpp"
+
+namespace
+{
+    using namespace testing;
+
+    Loading::Listener dummyListener;
+
+    ESM::CellRef makeRef(unsigned int index, int masterIndex, const std::string& id, float x)
+    {
+        ESM::CellRef ref;
+        ref.blank();
+        ref.mRefNum.mIndex = index;
+        ref.mRefNum.mContentFile = masterIndex; // index into the master list of the file, 1 based, 0 for a new reference
+        ref.mRefID = id;
+        ref.mPos.pos[0] = x;
+        return ref;
+    }
+
+    struct PagedRefsTest : Test
+    {
+        const boost::filesystem::path mPath = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("openmw-pagedrefs-%%%%%%%%");
+        ToUTF8::Utf8Encoder mEncoder { ToUTF8::WINDOWS_1252 };
+        MWWorld::ESMStore mStore;
+        std::vector<ESM::ESMReader> mReaders;
+
+        PagedRefsTest()
+        {
+            boost::filesystem::create_directories(mPath);
+        }
+
+        ~PagedRefsTest()
+        {
+            boost::system::error_code error;
+            boost::filesystem::remove_all(mPath, error);
+        }
+
+        void writeFile(const std::string& name, const std::vector<std::string>& masters, const std::vector<std::pair<ESM::CellRef, bool> >& refs)
+        {
+            boost::filesystem::ofstream stream (mPath / name, std::ios::binary);
+
+            ESM::ESMWriter writer;
+            writer.setEncoder(&mEncoder);
+            writer.setFormat(0);
+            writer.setVersion();
+            writer.setType(0);
+            writer.setAuthor("");
+            writer.setDescription("");
+            writer.setRecordCount(1);
+            for (const std::string& master : masters)
+                writer.addMaster(master, boost::filesystem::file_size(mPath / master));
+            writer.save(stream);
+
+            ESM::Cell cell;
+            cell.blank();
+
+            writer.startRecord(ESM::REC_CELL);
+            cell.save(writer);
+            for (const auto& ref : refs)
+                ref.first.save(writer, false, false, ref.second);
+            writer.endRecord(ESM::REC_CELL);
+            writer.close();
+        }
+
+        // the same way World sets up the readers of the game
+        void load(const std::vector<std::string>& files)
+        {
+            mReaders.resize(files.size());
+            for (size_t i = 0; i < files.size(); ++i)
+            {
+                ESM::ESMReader reader;
+                reader.setEncoder(&mEncoder);
+                reader.setIndex(static_cast<int>(i));
+                reader.setGlobalReaderList(&mReaders);
+                reader.open((mPath / files[i]).string());
+                mReaders[i] = reader;
+                mStore.load(mReaders[i], &dummyListener);
+            }
+        }
+
+        std::map<ESM::RefNum, ESM::CellRef> readCellRefs()
+        {
+            const ESM::Cell* cell = mStore.get<ESM::Cell>().search(0, 0);
+            EXPECT_TRUE(cell);
+
+            // the readers of the game must not be touched
+            ToUTF8::Utf8Encoder encoder (ToUTF8::WINDOWS_1252);
+            std::vector<ESM::ESMReader> readers;
+            std::map<ESM::RefNum, ESM::CellRef> refs;
+            if (cell)
+                MWRender::readCellRefs(*cell, mReaders, readers, &encoder, refs);
+            return refs;
+        }
+    };
+
+    ESM::RefNum makeRefNum(unsigned int index, int contentFile)
+    {
+        ESM::RefNum refNum;
+        refNum.mIndex = index;
+        refNum.mContentFile = contentFile;
+        return refNum;
+    }
+
+    TEST_F(PagedRefsTest, readCellRefs_should_apply_the_changes_of_plugins)
+    {
+        writeFile("master.esm", {}, {
+            { makeRef(1, 0, "overridden", 1.f), false },
+            { makeRef(2, 0, "deleted", 2.f), false },
+            { makeRef(3, 0, "disabled", 3.f), false },
+        });
+        writeFile("plugin.esp", { "master.esm" }, {
+            { makeRef(1, 1, "overridden", 10.f), false },
+            { makeRef(2, 1, "deleted", 2.f), true },
+            { makeRef(1, 0, "new", 4.f), false },
+        });
+        load({ "master.esm", "plugin.esp" });
+
+        const std::map<ESM::RefNum, ESM::CellRef> refs = readCellRefs();
+
+        ASSERT_EQ(refs.size(), 3u);
+
+        ASSERT_EQ(refs.count(makeRefNum(1, 0)), 1u);
+        EXPECT_EQ(refs.at(makeRefNum(1, 0)).mRefID, "overridden");
+        EXPECT_EQ(refs.at(makeRefNum(1, 0)).mPos.pos[0], 10.f);
+
+        EXPECT_EQ(refs.count(makeRefNum(2, 0)), 0u);
+
+        // the ref number a disabled reference is reported with
+        ASSERT_EQ(refs.count(makeRefNum(3, 0)), 1u);
+        EXPECT_EQ(refs.at(makeRefNum(3, 0)).mRefID, "disabled");
+
+        ASSERT_EQ(refs.count(makeRefNum(1, 1)), 1u);
+        EXPECT_EQ(refs.at(makeRefNum(1, 1)).mRefID, "new");
+    }
+
+    TEST_F(PagedRefsTest, readCellRefs_should_keep_new_references_of_different_plugins_apart)
+    {
+        writeFile("master.esm", {}, {});
+        writeFile("a.esp", { "master.esm" }, { { makeRef(1, 0, "a", 1.f), false } });
+        writeFile("b.esp", { "master.esm" }, { { makeRef(1, 0, "b", 2.f), false } });
+        load({ "master.esm", "a.esp", "b.esp" });
+
+        const std::map<ESM::RefNum, ESM::CellRef> refs = readCellRefs();
+
+        ASSERT_EQ(refs.size(), 2u);
+        EXPECT_EQ(refs.at(makeRefNum(1, 1)).mRefID, "a");
+        EXPECT_EQ(refs.at(makeRefNum(1, 2)).mRefID, "b");
+    }
+
+    TEST_F(PagedRefsTest, readCellRefs_should_decode_ids_with_the_encoder)
+    {
+        writeFile("master.esm", {}, { { makeRef(1, 0, "st\xc3\xa4tic", 1.f), false } });
+        load({ "master.esm" });
+
+        const std::map<ESM::RefNum, ESM::CellRef> refs = readCellRefs();
+
+        ASSERT_EQ(refs.size(), 1u);
+        EXPECT_EQ(refs.begin()->second.mRefID, "st\xc3\xa4tic");
+    }
+}
@@ -0,0 +1,230 @@
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "apps/openmw/mwworld/chunkedlist.hpp"
+
+namespace
+{
+    using namespace testing;
+    using MWWorld::ChunkedList;
+
+    // more than the first few chunks hold, so that the elements are spread over several of them
+    const int sCount = 100;
+
+    template <typename T>
+    std::vector<T> toVector(const ChunkedList<T>& list)
+    {
+        return std::vector<T>(list.begin(), list.end());
+    }
+
+    std::vector<int> makeRange(int count)
+    {
+        std::vector<int> values;
+        for (int i = 0; i < count; ++i)
+            values.push_back(i);
+        return values;
+    }
+
+    TEST(MWWorldChunkedListTest, push_back_should_keep_insertion_order_across_chunks)
+    {
+        ChunkedList<int> list;
+        for (int i = 0; i < sCount; ++i)
+            list.push_back(i);
+
+        EXPECT_EQ(list.size(), static_cast<std::size_t>(sCount));
+        EXPECT_EQ(list.front(), 0);
+        EXPECT_EQ(list.back(), sCount - 1);
+        EXPECT_EQ(toVector(list), makeRange(sCount));
+    }
+
+    TEST(MWWorldChunkedListTest, reverse_iteration_should_visit_elements_across_chunks_backwards)
+    {
+        ChunkedList<int> list;
+        for (int i = 0; i < sCount; ++i)
+            list.push_back(i);
+
+        std::vector<int> values;
+        for (ChunkedList<int>::const_iterator it = list.end(); it != list.begin();)
+            values.push_back(*--it);
+
+        const std::vector<int> expected = makeRange(sCount);
+        EXPECT_EQ(values, std::vector<int>(expected.rbegin(), expected.rend()));
+    }
+
+    TEST(MWWorldChunkedListTest, elements_should_not_move_when_chunks_are_added)
+    {
+        ChunkedList<int> list;
+        list.push_back(0);
+        const int* first = &list.front();
+        const ChunkedList<int>::iterator firstIt = list.begin();
+
+        for (int i = 1; i < sCount; ++i)
+            list.push_back(i);
+
+        EXPECT_EQ(&list.front(), first);
+        EXPECT_EQ(&*firstIt, first);
+    }
+
+    TEST(MWWorldChunkedListTest, insert_should_place_element_before_position)
+    {
+        ChunkedList<int> list;
+        for (int i = 0; i < 8; ++i)
+            list.push_back(i);
+
+        ChunkedList<int>::iterator position = list.begin();
+        std::advance(position, 4);
+        const ChunkedList<int>::iterator inserted = list.insert(position, 42);
+
+        EXPECT_EQ(*inserted, 42);
+        EXPECT_EQ(toVector(list), std::vector<int>({0, 1, 2, 3, 42, 4, 5, 6, 7}));
+    }
+
+    TEST(MWWorldChunkedListTest, erase_should_return_next_element_and_keep_others_in_place)
+    {
+        ChunkedList<int> list;
+        for (int i = 0; i < 8; ++i)
+            list.push_back(i);
+        std::vector<const int*> addresses;
+        for (const int& value : list)
+            addresses.push_back(&value);
+
+        // the last element of the first chunk and the first one of the second
+        ChunkedList<int>::iterator position = list.begin();
+        std::advance(position, 3);
+        position = list.erase(position);
+        EXPECT_EQ(*position, 4);
+        position = list.erase(position);
+        EXPECT_EQ(*position, 5);
+
+        EXPECT_EQ(list.size(), 6u);
+        EXPECT_EQ(toVector(list), std::vector<int>({0, 1, 2, 5, 6, 7}));
+        EXPECT_EQ(&list.front(), addresses[0]);
+        EXPECT_EQ(&list.back(), addresses[7]);
+    }
+
+    TEST(MWWorldChunkedListTest, erase_of_last_element_should_return_end)
+    {
+        ChunkedList<int> list;
+        list.push_back(0);
+        list.push_back(1);
+
+        EXPECT_EQ(list.erase(--list.end()), list.end());
+        EXPECT_EQ(toVector(list), std::vector<int>({0}));
+    }
+
+    TEST(MWWorldChunkedListTest, push_back_after_erase_should_reuse_erased_slot)
+    {
+        ChunkedList<int> list;
+        for (int i = 0; i < 8; ++i)
+            list.push_back(i);
+
+        ChunkedList<int>::iterator position = list.begin();
+        std::advance(position, 2);
+        const int* erased = &*position;
+        list.erase(position);
+
+        list.push_back(8);
+
+        EXPECT_EQ(&list.back(), erased);
+        EXPECT_EQ(toVector(list), std::vector<int>({0, 1, 3, 4, 5, 6, 7, 8}));
+    }
+
+    TEST(MWWorldChunkedListTest, clear_should_keep_memory_for_new_elements)
+    {
+        ChunkedList<int> list;
+        for (int i = 0; i < 8; ++i)
+            list.push_back(i);
+        const int* first = &list.front();
+
+        list.clear();
+        EXPECT_TRUE(list.empty());
+        EXPECT_EQ(list.begin(), list.end());
+
+        list.push_back(42);
+        EXPECT_EQ(&list.front(), first);
+        EXPECT_EQ(toVector(list), std::vector<int>({42}));
+    }
+
+    TEST(MWWorldChunkedListTest, copy_should_have_the_same_elements)
+    {
+        ChunkedList<std::string> list;
+        for (int i = 0; i < sCount; ++i)
+            list.push_back(std::to_string(i));
+
+        const ChunkedList<std::string> copy (list);
+        EXPECT_EQ(toVector(copy), toVector(list));
+
+        ChunkedList<std::string> assigned;
+        assigned.push_back("old");
+        assigned = list;
+        EXPECT_EQ(toVector(assigned), toVector(list));
+    }
+
+    TEST(MWWorldChunkedListTest, move_should_take_the_elements)
+    {
+        ChunkedList<std::string> list;
+        for (int i = 0; i < sCount; ++i)
+            list.push_back(std::to_string(i));
+        const std::vector<std::string> expected = toVector(list);
+        const std::string* first = &list.front();
+
+        ChunkedList<std::string> moved (std::move(list));
+        EXPECT_EQ(toVector(moved), expected);
+        EXPECT_EQ(&moved.front(), first);
+        EXPECT_TRUE(list.empty());
+
+        ChunkedList<std::string> assigned;
+        assigned.push_back("old");
+        assigned = std::move(moved);
+        EXPECT_EQ(toVector(assigned), expected);
+        EXPECT_TRUE(moved.empty());
+
+        // the moved-from lists stay usable
+        moved.push_back("new");
+        EXPECT_EQ(toVector(moved), std::vector<std::string>({"new"}));
+    }
+
+    TEST(MWWorldChunkedListTest, elements_should_be_destroyed_on_erase_clear_and_destruction)
+    {
+        const std::shared_ptr<int> value = std::make_shared<int>(42);
+
+        {
+            ChunkedList<std::shared_ptr<int> > list;
+            for (int i = 0; i < sCount; ++i)
+                list.push_back(value);
+            EXPECT_EQ(value.use_count(), sCount + 1);
+
+            list.erase(list.begin());
+            EXPECT_EQ(value.use_count(), sCount);
+
+            list.clear();
+            EXPECT_EQ(value.use_count(), 1);
+
+            for (int i = 0; i < sCount; ++i)
+                list.emplace_back(value);
+            EXPECT_EQ(value.use_count(), sCount + 1);
+        }
+
+        EXPECT_EQ(value.use_count(), 1);
+    }
+
+    TEST(MWWorldChunkedListTest, release_should_destroy_elements)
+    {
+        const std::shared_ptr<int> value = std::make_shared<int>(42);
+
+        ChunkedList<std::shared_ptr<int> > list;
+        for (int i = 0; i < sCount; ++i)
+            list.push_back(value);
+
+        list.release();
+        EXPECT_TRUE(list.empty());
+        EXPECT_EQ(value.use_count(), 1);
+
+        list.push_back(value);
+        EXPECT_EQ(list.size(), 1u);
+    }
+}
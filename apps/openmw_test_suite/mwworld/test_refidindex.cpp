@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "apps/openmw/mwworld/refidindex.hpp"
+
+namespace
+{
+    using namespace testing;
+
+    struct Cell
+    {
+    };
+
+    struct RefIdIndexTest : Test
+    {
+        Cell mCells[3];
+        MWWorld::RefIdIndex<Cell> mIndex;
+
+        std::vector<Cell*> sorted(std::vector<Cell*> cells) const
+        {
+            std::sort(cells.begin(), cells.end(), std::less<Cell*>());
+            return cells;
+        }
+    };
+
+    TEST_F(RefIdIndexTest, find_without_added_id_should_return_no_cells)
+    {
+        mIndex.add("guard", &mCells[0]);
+
+        EXPECT_TRUE(mIndex.find("merchant").empty());
+    }
+
+    TEST_F(RefIdIndexTest, find_should_return_each_cell_the_id_was_added_for_once)
+    {
+        // listing a cell, placing a reference in another one and moving one back
+        mIndex.add("guard", &mCells[2]);
+        mIndex.add("guard", &mCells[2]);
+        mIndex.add("guard", &mCells[0]);
+        mIndex.add("guard", &mCells[2]);
+        mIndex.add("merchant", &mCells[1]);
+
+        EXPECT_EQ(mIndex.find("guard"), sorted({ &mCells[0], &mCells[2] }));
+        EXPECT_EQ(mIndex.find("merchant"), std::vector<Cell*>({ &mCells[1] }));
+    }
+
+    TEST_F(RefIdIndexTest, find_should_return_cells_suitable_for_binary_search)
+    {
+        for (int i = 2; i >= 0; --i)
+            mIndex.add("guard", &mCells[i]);
+
+        const std::vector<Cell*>& cells = mIndex.find("guard");
+
+        for (Cell& cell : mCells)
+            EXPECT_TRUE(std::binary_search(cells.begin(), cells.end(), &cell, std::less<Cell*>()));
+    }
+
+    TEST_F(RefIdIndexTest, add_after_find_should_extend_the_cells)
+    {
+        mIndex.add("guard", &mCells[1]);
+        ASSERT_EQ(mIndex.find("guard").size(), 1u);
+
+        mIndex.add("guard", &mCells[0]);
+        mIndex.add("guard", &mCells[1]);
+
+        EXPECT_EQ(mIndex.find("guard"), sorted({ &mCells[0], &mCells[1] }));
+    }
+
+    TEST_F(RefIdIndexTest, clear_should_remove_all_ids)
+    {
+        mIndex.add("guard", &mCells[0]);
+        mIndex.clear();
+
+        EXPECT_TRUE(mIndex.find("guard").empty());
+    }
+}
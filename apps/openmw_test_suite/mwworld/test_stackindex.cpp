@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <list>
+#include <string>
+
+#include "apps/openmw/mwworld/stackindex.hpp"
+
+namespace
+{
+    using namespace testing;
+
+    // the items of a container, as their IDs
+    typedef std::list<std::string> Items;
+    typedef MWWorld::StackIndex<Items::const_iterator> StackIndex;
+
+    struct GetId
+    {
+        const std::string& operator() (Items::const_iterator iter) const
+        {
+            return *iter;
+        }
+    };
+
+    struct MWWorldStackIndexTest : Test
+    {
+        Items mItems;
+        StackIndex mIndex;
+
+        MWWorldStackIndexTest()
+        {
+            mItems.push_back("gold_001");
+            mItems.push_back("Iron Dagger");
+            mItems.push_back("gold_001");
+        }
+
+        void update()
+        {
+            mIndex.update(mItems.begin(), mItems.end(), GetId());
+        }
+
+        Items::const_iterator at(int index) const
+        {
+            Items::const_iterator iter = mItems.begin();
+            std::advance(iter, index);
+            return iter;
+        }
+    };
+
+    TEST_F(MWWorldStackIndexTest, find_should_return_nothing_before_update)
+    {
+        EXPECT_FALSE(mIndex.isUpToDate());
+        EXPECT_TRUE(mIndex.find("gold_001").empty());
+    }
+
+    TEST_F(MWWorldStackIndexTest, update_should_index_stacks_in_order)
+    {
+        update();
+
+        EXPECT_TRUE(mIndex.isUpToDate());
+        EXPECT_EQ(mIndex.find("gold_001"), StackIndex::Stacks({at(0), at(2)}));
+        EXPECT_EQ(mIndex.find("iron dagger"), StackIndex::Stacks({at(1)}));
+        EXPECT_TRUE(mIndex.find("glass dagger").empty());
+    }
+
+    TEST_F(MWWorldStackIndexTest, find_should_ignore_case)
+    {
+        update();
+
+        EXPECT_EQ(mIndex.find("GOLD_001"), StackIndex::Stacks({at(0), at(2)}));
+        EXPECT_EQ(mIndex.find("Iron Dagger"), StackIndex::Stacks({at(1)}));
+    }
+
+    TEST_F(MWWorldStackIndexTest, update_should_keep_up_to_date_index)
+    {
+        update();
+        mItems.push_back("gold_001");
+        update();
+
+        EXPECT_EQ(mIndex.find("gold_001").size(), 2u);
+    }
+
+    TEST_F(MWWorldStackIndexTest, add_should_extend_up_to_date_index)
+    {
+        update();
+        mItems.push_back("Gold_001");
+        mIndex.add(mItems.back(), at(3));
+
+        EXPECT_EQ(mIndex.find("gold_001"), StackIndex::Stacks({at(0), at(2), at(3)}));
+    }
+
+    TEST_F(MWWorldStackIndexTest, add_should_be_ignored_before_update)
+    {
+        mItems.push_back("gold_001");
+        mIndex.add(mItems.back(), at(3));
+
+        EXPECT_FALSE(mIndex.isUpToDate());
+        EXPECT_TRUE(mIndex.find("gold_001").empty());
+
+        update();
+        EXPECT_EQ(mIndex.find("gold_001"), StackIndex::Stacks({at(0), at(2), at(3)}));
+    }
+
+    TEST_F(MWWorldStackIndexTest, invalidate_should_rebuild_index_on_next_update)
+    {
+        update();
+        mItems.push_front("gold_001");
+        mIndex.invalidate();
+
+        EXPECT_FALSE(mIndex.isUpToDate());
+        EXPECT_TRUE(mIndex.find("gold_001").empty());
+
+        update();
+        EXPECT_EQ(mIndex.find("gold_001"), StackIndex::Stacks({at(0), at(1), at(3)}));
+    }
+
+    TEST_F(MWWorldStackIndexTest, copy_should_not_be_up_to_date)
+    {
+        update();
+
+        const StackIndex copy (mIndex);
+        EXPECT_FALSE(copy.isUpToDate());
+        EXPECT_TRUE(copy.find("gold_001").empty());
+        EXPECT_TRUE(mIndex.isUpToDate());
+    }
+
+    TEST_F(MWWorldStackIndexTest, assignment_should_invalidate_index)
+    {
+        update();
+
+        StackIndex other;
+        other.update(mItems.begin(), mItems.end(), GetId());
+        other = mIndex;
+
+        EXPECT_FALSE(other.isUpToDate());
+        EXPECT_TRUE(other.find("gold_001").empty());
+        EXPECT_TRUE(mIndex.isUpToDate());
+    }
+}
@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "apps/opencs/model/tools/trigramindex.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    using CSMTools::TrigramIndex;
+
+    std::vector<TrigramIndex::Trigram> getTrigrams(const std::string& text)
+    {
+        std::vector<TrigramIndex::Trigram> trigrams;
+        TrigramIndex::getTrigrams(std::u16string(text.begin(), text.end()), trigrams);
+        return trigrams;
+    }
+
+    std::vector<int> find(const TrigramIndex& index, const std::string& text)
+    {
+        std::vector<int> records;
+        index.find(getTrigrams(text), records);
+        return records;
+    }
+
+    TEST(TrigramIndexTest, getTrigrams_should_be_sorted_and_unique)
+    {
+        EXPECT_EQ(getTrigrams("abcabc"), getTrigrams("bcabca"));
+        EXPECT_EQ(getTrigrams("abcabc").size(), 3u);
+        EXPECT_TRUE(getTrigrams("ab").empty());
+    }
+
+    TEST(TrigramIndexTest, find_should_return_records_containing_all_trigrams)
+    {
+        TrigramIndex index;
+        index.add(0, getTrigrams("iron dagger"));
+        index.add(1, getTrigrams("iron longsword"));
+        index.add(2, getTrigrams("steel dagger"));
+
+        EXPECT_EQ(find(index, "iron"), std::vector<int>({0, 1}));
+        EXPECT_EQ(find(index, "dagger"), std::vector<int>({0, 2}));
+        EXPECT_EQ(find(index, "n dag"), std::vector<int>({0}));
+        EXPECT_TRUE(find(index, "glass").empty());
+    }
+
+    TEST(TrigramIndexTest, add_should_replace_the_trigrams_of_a_record)
+    {
+        TrigramIndex index;
+        index.add(0, getTrigrams("iron dagger"));
+        index.add(0, getTrigrams("glass dagger"));
+
+        EXPECT_TRUE(find(index, "iron").empty());
+        EXPECT_EQ(find(index, "glass"), std::vector<int>({0}));
+        EXPECT_EQ(find(index, "dagger"), std::vector<int>({0}));
+    }
+
+    TEST(TrigramIndexTest, remove_should_drop_a_record)
+    {
+        TrigramIndex index;
+        index.add(0, getTrigrams("iron dagger"));
+        index.add(1, getTrigrams("steel dagger"));
+        index.remove(0);
+        index.remove(5);
+
+        EXPECT_TRUE(find(index, "iron").empty());
+        EXPECT_EQ(find(index, "dagger"), std::vector<int>({1}));
+
+        index.add(0, getTrigrams("iron dagger"));
+        EXPECT_EQ(find(index, "dagger"), std::vector<int>({0, 1}));
+    }
+
+    TEST(TrigramIndexTest, candidates_should_contain_all_records_found_by_a_linear_search)
+    {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> letter('a', 'e');
+        std::uniform_int_distribution<int> length(0, 12);
+
+        const auto randomText = [&] (int size)
+        {
+            std::string text;
+            for (int i = 0; i < size; ++i)
+                text += static_cast<char>(letter(random));
+            return text;
+        };
+
+        TrigramIndex index;
+        std::vector<std::string> records;
+        for (int i = 0; i < 300; ++i)
+        {
+            records.push_back(randomText(length(random)));
+            index.add(i, getTrigrams(records.back()));
+        }
+
+        // change and remove some records, as the editor does
+        for (int i = 0; i < 300; i += 7)
+        {
+            records[i] = randomText(length(random));
+            index.add(i, getTrigrams(records[i]));
+        }
+        for (int i = 0; i < 300; i += 11)
+        {
+            records[i].clear();
+            index.remove(i);
+        }
+
+        std::uniform_int_distribution<int> searchLength(3, 5);
+        for (int i = 0; i < 200; ++i)
+        {
+            const std::string search = randomText(searchLength(random));
+
+            std::vector<int> expected;
+            for (std::size_t record = 0; record < records.size(); ++record)
+                if (records[record].find(search) != std::string::npos)
+                    expected.push_back(static_cast<int>(record));
+
+            std::vector<int> found;
+            for (int record : find(index, search))
+                if (records[record].find(search) != std::string::npos)
+                    found.push_back(record);
+
+            EXPECT_EQ(found, expected) << search;
+        }
+    }
+}
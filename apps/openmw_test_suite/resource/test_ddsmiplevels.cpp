@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <sstream>
+#include <string>
+
+#include <osg/Texture>
+
+#include <components/resource/ddsmiplevels.hpp>
+
+namespace
+{
+    using namespace testing;
+    using Resource::DdsMipLevels;
+
+    void writeUint32(std::string& data, std::size_t offset, std::uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i)
+            data[offset + i] = static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+
+    std::string makeHeader(unsigned int width, unsigned int height, unsigned int numLevels)
+    {
+        std::string header(128, '\0');
+        header.replace(0, 4, "DDS ");
+        writeUint32(header, 4, 124);
+        writeUint32(header, 8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000);
+        writeUint32(header, 12, height);
+        writeUint32(header, 16, width);
+        writeUint32(header, 28, numLevels);
+        writeUint32(header, 76, 32);
+        return header;
+    }
+
+    // A8R8G8B8, every byte holds the level and row it belongs to
+    std::string makeRGBAFile(unsigned int size, unsigned int numLevels)
+    {
+        std::string file = makeHeader(size, size, numLevels);
+        writeUint32(file, 80, 0x40 | 0x1);
+        writeUint32(file, 88, 32);
+        writeUint32(file, 92, 0x00ff0000);
+        writeUint32(file, 96, 0x0000ff00);
+        writeUint32(file, 100, 0x000000ff);
+        writeUint32(file, 104, 0xff000000);
+
+        for (unsigned int level = 0; level < numLevels; ++level)
+        {
+            unsigned int levelSize = std::max(1u, size >> level);
+            for (unsigned int row = 0; row < levelSize; ++row)
+                file += std::string(levelSize * 4, static_cast<char>(level * 16 + row));
+        }
+        return file;
+    }
+
+    std::string makeDXT1File(unsigned int size, unsigned int numLevels, bool transparentLevel1)
+    {
+        std::string file = makeHeader(size, size, numLevels);
+        writeUint32(file, 80, 0x4);
+        file.replace(84, 4, "DXT1");
+
+        // color0 > color1 is the opaque 4 color mode
+        const std::string opaqueBlock ("\xff\xff\x00\x00\x00\x00\x00\x00", 8);
+        // color0 <= color1 with all texels using index 3, i.e. transparent
+        const std::string transparentBlock ("\x00\x00\xff\xff\xff\xff\xff\xff", 8);
+
+        for (unsigned int level = 0; level < numLevels; ++level)
+        {
+            unsigned int blocks = std::max(1u, (size >> level) / 4);
+            for (unsigned int i = 0; i < blocks * blocks; ++i)
+                file += (level == 1 && transparentLevel1) ? transparentBlock : opaqueBlock;
+        }
+        return file;
+    }
+
+    TEST(ResourceDdsMipLevelsTest, readHeader_should_read_the_size_and_number_of_levels)
+    {
+        std::istringstream stream (makeRGBAFile(8, 4));
+        DdsMipLevels dds;
+
+        ASSERT_TRUE(dds.readHeader(stream));
+        EXPECT_EQ(dds.getWidth(), 8u);
+        EXPECT_EQ(dds.getHeight(), 8u);
+        EXPECT_EQ(dds.getNumLevels(), 4u);
+    }
+
+    TEST(ResourceDdsMipLevelsTest, readHeader_should_reject_other_files)
+    {
+        std::istringstream stream (std::string(128, '\0'));
+        DdsMipLevels dds;
+
+        EXPECT_FALSE(dds.readHeader(stream));
+    }
+
+    TEST(ResourceDdsMipLevelsTest, readHeader_should_reject_unsupported_formats)
+    {
+        std::string file = makeDXT1File(8, 4, false);
+        file.replace(84, 4, "DX10");
+        std::istringstream stream (file);
+        DdsMipLevels dds;
+
+        EXPECT_FALSE(dds.readHeader(stream));
+    }
+
+    TEST(ResourceDdsMipLevelsTest, readLevels_should_only_return_the_levels_from_the_given_one)
+    {
+        std::istringstream stream (makeRGBAFile(8, 4));
+        DdsMipLevels dds;
+        ASSERT_TRUE(dds.readHeader(stream));
+
+        const osg::ref_ptr<osg::Image> image = dds.readLevels(stream, 1);
+
+        ASSERT_TRUE(image);
+        EXPECT_EQ(image->s(), 4);
+        EXPECT_EQ(image->t(), 4);
+        EXPECT_EQ(image->getNumMipmapLevels(), 3u);
+        EXPECT_EQ(image->getInternalTextureFormat(), GL_RGBA);
+        EXPECT_EQ(image->getPixelFormat(), static_cast<GLenum>(GL_BGRA));
+        EXPECT_EQ(image->getTotalSizeInBytesIncludingMipmaps(), (16u + 4u + 1u) * 4u);
+
+        // the rows are flipped
+        EXPECT_EQ(image->data()[0], 16 + 3);
+        EXPECT_EQ(image->data()[3 * 4 * 4], 16 + 0);
+        EXPECT_EQ(image->data()[image->getMipmapOffset(1)], 32 + 1);
+        EXPECT_EQ(image->data()[image->getMipmapOffset(2)], 48 + 0);
+    }
+
+    TEST(ResourceDdsMipLevelsTest, readLevels_should_detect_transparent_dxt1_blocks)
+    {
+        std::istringstream opaqueStream (makeDXT1File(8, 4, false));
+        DdsMipLevels opaque;
+        ASSERT_TRUE(opaque.readHeader(opaqueStream));
+
+        const osg::ref_ptr<osg::Image> opaqueImage = opaque.readLevels(opaqueStream, 1);
+        ASSERT_TRUE(opaqueImage);
+        EXPECT_EQ(opaqueImage->getPixelFormat(), static_cast<GLenum>(GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
+        EXPECT_EQ(opaqueImage->getTotalSizeInBytesIncludingMipmaps(), 3u * 8u);
+
+        std::istringstream transparentStream (makeDXT1File(8, 4, true));
+        DdsMipLevels transparent;
+        ASSERT_TRUE(transparent.readHeader(transparentStream));
+
+        const osg::ref_ptr<osg::Image> transparentImage = transparent.readLevels(transparentStream, 1);
+        ASSERT_TRUE(transparentImage);
+        EXPECT_EQ(transparentImage->getPixelFormat(), static_cast<GLenum>(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT));
+    }
+
+    TEST(ResourceDdsMipLevelsTest, readLevels_should_fail_for_truncated_file)
+    {
+        std::string file = makeRGBAFile(8, 4);
+        std::istringstream stream (file.substr(0, file.size() - 1));
+        DdsMipLevels dds;
+        ASSERT_TRUE(dds.readHeader(stream));
+
+        EXPECT_FALSE(dds.readLevels(stream, 2));
+    }
+}
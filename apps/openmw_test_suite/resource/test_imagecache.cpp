@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <osg/Image>
+
+#include <components/resource/imagecache.hpp>
+
+namespace
+{
+    using namespace testing;
+    using Resource::ImageCache;
+
+    osg::ref_ptr<osg::Image> makeImage(int s, int t, GLenum pixelFormat, int packing)
+    {
+        osg::ref_ptr<osg::Image> image (new osg::Image);
+        image->allocateImage(s, t, 1, pixelFormat, GL_UNSIGNED_BYTE, packing);
+        for (unsigned int i = 0; i < image->getTotalSizeInBytes(); ++i)
+            image->data()[i] = static_cast<unsigned char>(i * 7);
+        image->setInternalTextureFormat(pixelFormat);
+        image->setOrigin(osg::Image::TOP_LEFT);
+        return image;
+    }
+
+    struct ResourceImageCacheTest : Test
+    {
+        const boost::filesystem::path mPath = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("openmw-imagecache-%%%%%%%%");
+        const osg::ref_ptr<ImageCache> mCache { new ImageCache(mPath.string(), 1024 * 1024) };
+        const std::string mKey = ImageCache::getKey("encoded image");
+
+        ~ResourceImageCacheTest()
+        {
+            boost::system::error_code error;
+            boost::filesystem::remove_all(mPath, error);
+        }
+
+        boost::filesystem::path getFileName(const std::string& key) const
+        {
+            return mPath / (key + ".img");
+        }
+
+        boost::filesystem::path getFileName() const
+        {
+            return getFileName(mKey);
+        }
+
+        std::string readFile() const
+        {
+            boost::filesystem::ifstream stream (getFileName(), std::ios::binary);
+            return std::string((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        }
+
+        void writeFile(const std::string& contents) const
+        {
+            boost::filesystem::ofstream stream (getFileName(), std::ios::binary);
+            stream.write(contents.data(), contents.size());
+        }
+    };
+
+    TEST_F(ResourceImageCacheTest, load_should_return_the_saved_image)
+    {
+        // rows of 3 * 5 bytes are padded to 16
+        const osg::ref_ptr<osg::Image> image = makeImage(5, 3, GL_RGB, 4);
+
+        mCache->save(mKey, *image);
+        const osg::ref_ptr<osg::Image> loaded = mCache->load(mKey);
+
+        ASSERT_TRUE(loaded);
+        EXPECT_EQ(loaded->s(), image->s());
+        EXPECT_EQ(loaded->t(), image->t());
+        EXPECT_EQ(loaded->r(), image->r());
+        EXPECT_EQ(loaded->getInternalTextureFormat(), image->getInternalTextureFormat());
+        EXPECT_EQ(loaded->getPixelFormat(), image->getPixelFormat());
+        EXPECT_EQ(loaded->getDataType(), image->getDataType());
+        EXPECT_EQ(loaded->getPacking(), image->getPacking());
+        EXPECT_EQ(loaded->getOrigin(), image->getOrigin());
+        ASSERT_EQ(loaded->getTotalSizeInBytesIncludingMipmaps(), image->getTotalSizeInBytesIncludingMipmaps());
+        EXPECT_EQ(std::memcmp(loaded->data(), image->data(), image->getTotalSizeInBytesIncludingMipmaps()), 0);
+    }
+
+    TEST_F(ResourceImageCacheTest, load_should_return_the_mip_levels_of_the_saved_image)
+    {
+        osg::Image::MipmapDataType mipmaps { 64 * 4, 64 * 4 + 16 * 4, 64 * 4 + 16 * 4 + 4 * 4 };
+        unsigned int size = mipmaps.back() + 4;
+        unsigned char* data = new unsigned char[size];
+        for (unsigned int i = 0; i < size; ++i)
+            data[i] = static_cast<unsigned char>(i);
+
+        osg::ref_ptr<osg::Image> image (new osg::Image);
+        image->setImage(8, 8, 1, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, data, osg::Image::USE_NEW_DELETE);
+        image->setMipmapLevels(mipmaps);
+
+        mCache->save(mKey, *image);
+        const osg::ref_ptr<osg::Image> loaded = mCache->load(mKey);
+
+        ASSERT_TRUE(loaded);
+        EXPECT_EQ(loaded->getMipmapLevels(), mipmaps);
+        ASSERT_EQ(loaded->getTotalSizeInBytesIncludingMipmaps(), size);
+        EXPECT_EQ(std::memcmp(loaded->data(), image->data(), size), 0);
+    }
+
+    TEST_F(ResourceImageCacheTest, load_without_saved_image_should_return_nullptr)
+    {
+        EXPECT_FALSE(mCache->load(mKey));
+    }
+
+    TEST_F(ResourceImageCacheTest, load_should_reject_truncated_file)
+    {
+        mCache->save(mKey, *makeImage(16, 16, GL_RGBA, 1));
+        const std::string contents = readFile();
+        writeFile(contents.substr(0, contents.size() - 1));
+
+        EXPECT_FALSE(mCache->load(mKey));
+    }
+
+    TEST_F(ResourceImageCacheTest, load_should_reject_size_not_matching_the_dimensions)
+    {
+        mCache->save(mKey, *makeImage(16, 16, GL_RGBA, 1));
+        std::string contents = readFile();
+
+        // double the width in the header, the data still has the size of the original image
+        const std::size_t widthOffset = 4 + sizeof(std::uint32_t);
+        std::uint32_t width = 32;
+        std::memcpy(&contents[widthOffset], &width, sizeof(width));
+        writeFile(contents + std::string(16 * 16 * 4, '\0'));
+
+        EXPECT_FALSE(mCache->load(mKey));
+    }
+
+    TEST_F(ResourceImageCacheTest, save_should_remove_least_recently_used_images_over_max_size)
+    {
+        const osg::ref_ptr<osg::Image> image = makeImage(16, 16, GL_RGBA, 1);
+        const osg::ref_ptr<ImageCache> cache (new ImageCache(mPath.string(), 3 * (image->getTotalSizeInBytes() + 100)));
+
+        const std::vector<std::string> keys { ImageCache::getKey("a"), ImageCache::getKey("b"), ImageCache::getKey("c"), ImageCache::getKey("d") };
+        for (std::size_t i = 0; i < 3; ++i)
+        {
+            cache->save(keys[i], *image);
+            boost::filesystem::last_write_time(getFileName(keys[i]), static_cast<std::time_t>(1000 * (i + 1)));
+        }
+
+        // loading marks the oldest image as recently used
+        ASSERT_TRUE(cache->load(keys[0]));
+        cache->save(keys[3], *image);
+
+        EXPECT_TRUE(cache->load(keys[0]));
+        EXPECT_FALSE(cache->load(keys[1]));
+        EXPECT_FALSE(cache->load(keys[2]));
+        EXPECT_TRUE(cache->load(keys[3]));
+    }
+
+    TEST_F(ResourceImageCacheTest, getKey_should_depend_on_the_contents)
+    {
+        EXPECT_EQ(ImageCache::getKey("abc"), ImageCache::getKey("abc"));
+        EXPECT_NE(ImageCache::getKey("abc"), ImageCache::getKey("abd"));
+        EXPECT_NE(ImageCache::getKey("abc"), ImageCache::getKey("abcd"));
+    }
+}
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include <components/resource/texturestreamer.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+namespace
+{
+    using namespace testing;
+    using Resource::TextureStreamer;
+
+    const unsigned int baseSize = 256;
+
+    // a square RGBA image with all of its mip levels, the texels of each level filled with its index
+    osg::ref_ptr<osg::Image> makeImage(int size, const std::string& fileName)
+    {
+        osg::Image::MipmapDataType mipmaps;
+        unsigned int totalSize = 0;
+        for (int levelSize = size; levelSize > 0; levelSize /= 2)
+        {
+            if (levelSize != size)
+                mipmaps.push_back(totalSize);
+            totalSize += levelSize * levelSize * 4;
+        }
+
+        unsigned char* data = new unsigned char[totalSize];
+        for (unsigned int level = 0; level <= mipmaps.size(); ++level)
+        {
+            unsigned int begin = level == 0 ? 0 : mipmaps[level - 1];
+            unsigned int end = level < mipmaps.size() ? mipmaps[level] : totalSize;
+            std::memset(data + begin, static_cast<int>(level), end - begin);
+        }
+
+        osg::ref_ptr<osg::Image> image (new osg::Image);
+        image->setFileName(fileName);
+        image->setImage(size, size, 1, GL_RGBA, GL_RGBA, GL_UNSIGNED_BYTE, data, osg::Image::USE_NEW_DELETE);
+        image->setMipmapLevels(mipmaps);
+        return image;
+    }
+
+    struct ResourceTextureStreamerTest : Test
+    {
+        // without threads, loads are only started and have to be finished by the test
+        osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue { new SceneUtil::WorkQueue(0) };
+        osg::ref_ptr<osg::Image> mFullImage { makeImage(1024, "textures/a.dds") };
+
+        osg::ref_ptr<TextureStreamer> makeStreamer(std::size_t budget)
+        {
+            return new TextureStreamer(nullptr, mWorkQueue, nullptr, baseSize, budget);
+        }
+
+        void request(TextureStreamer& streamer, const std::string& fileName, float size, unsigned int frameNumber)
+        {
+            std::vector<osg::ref_ptr<TextureStreamer::StreamedImage> > images { streamer.getStreamedImage(fileName) };
+            streamer.request(images, size, frameNumber);
+        }
+
+        void finishLoading(TextureStreamer& streamer, const std::string& fileName)
+        {
+            osg::ref_ptr<TextureStreamer::StreamedImage> image = streamer.getStreamedImage(fileName);
+            ASSERT_TRUE(image->mLoading);
+            streamer.onLoaded(image, image->mRequestedLevel, TextureStreamer::getMipLevels(*mFullImage, image->mRequestedLevel));
+        }
+    };
+
+    TEST_F(ResourceTextureStreamerTest, getMipLevels_should_copy_the_levels_starting_at_the_given_one)
+    {
+        const osg::ref_ptr<osg::Image> levels = TextureStreamer::getMipLevels(*mFullImage, 2);
+
+        EXPECT_EQ(levels->s(), 256);
+        EXPECT_EQ(levels->t(), 256);
+        EXPECT_EQ(levels->getNumMipmapLevels(), mFullImage->getNumMipmapLevels() - 2);
+        EXPECT_EQ(levels->getFileName(), mFullImage->getFileName());
+        EXPECT_EQ(levels->getTotalSizeInBytesIncludingMipmaps(),
+                  mFullImage->getTotalSizeInBytesIncludingMipmaps() - mFullImage->getMipmapOffset(2));
+
+        for (unsigned int level = 0; level < levels->getNumMipmapLevels(); ++level)
+            EXPECT_EQ(levels->data()[levels->getMipmapOffset(level)], level + 2) << level;
+    }
+
+    TEST_F(ResourceTextureStreamerTest, addImage_should_keep_the_levels_up_to_the_base_size)
+    {
+        osg::ref_ptr<TextureStreamer> streamer = makeStreamer(64 * 1024 * 1024);
+        ASSERT_TRUE(streamer->canStream(*mFullImage));
+
+        const osg::ref_ptr<osg::Image> image = streamer->addImage("textures/a.dds", *mFullImage);
+
+        EXPECT_EQ(image->s(), 256);
+        EXPECT_EQ(streamer->getImage("textures/a.dds"), image);
+        EXPECT_EQ(streamer->getStreamedImage("textures/a.dds")->mBaseLevel, 2u);
+    }
+
+    TEST_F(ResourceTextureStreamerTest, getLevel_should_match_the_size_on_screen_down_to_the_base_level)
+    {
+        osg::ref_ptr<TextureStreamer> streamer = makeStreamer(64 * 1024 * 1024);
+        streamer->addImage("textures/a.dds", *mFullImage);
+        const TextureStreamer::StreamedImage& image = *streamer->getStreamedImage("textures/a.dds");
+
+        EXPECT_EQ(TextureStreamer::getLevel(image, 2000.f), 0u);
+        EXPECT_EQ(TextureStreamer::getLevel(image, 1024.f), 0u);
+        EXPECT_EQ(TextureStreamer::getLevel(image, 1000.f), 0u);
+        EXPECT_EQ(TextureStreamer::getLevel(image, 512.f), 1u);
+        EXPECT_EQ(TextureStreamer::getLevel(image, 300.f), 1u);
+        EXPECT_EQ(TextureStreamer::getLevel(image, 256.f), 2u);
+        EXPECT_EQ(TextureStreamer::getLevel(image, 1.f), 2u);
+    }
+
+    TEST_F(ResourceTextureStreamerTest, requested_level_should_be_loaded_and_applied)
+    {
+        osg::ref_ptr<TextureStreamer> streamer = makeStreamer(64 * 1024 * 1024);
+        streamer->addImage("textures/a.dds", *mFullImage);
+
+        request(*streamer, "textures/a.dds", 500.f, 1);
+        streamer->update(2);
+        EXPECT_EQ(mWorkQueue->getNumItems(), 1u);
+
+        finishLoading(*streamer, "textures/a.dds");
+        request(*streamer, "textures/a.dds", 500.f, 2);
+        streamer->update(3);
+
+        EXPECT_EQ(streamer->getStreamedImage("textures/a.dds")->mLevel, 1u);
+        EXPECT_EQ(streamer->getImage("textures/a.dds")->s(), 512);
+        EXPECT_FALSE(streamer->getStreamedImage("textures/a.dds")->mLoading);
+    }
+
+    TEST_F(ResourceTextureStreamerTest, upgrade_over_budget_should_wait_while_the_other_textures_are_visible)
+    {
+        // the base levels of both images and the full levels of one of them
+        const std::size_t budget = mFullImage->getTotalSizeInBytesIncludingMipmaps() + 2 * mFullImage->getTotalSizeInBytesIncludingMipmaps() / 8;
+        osg::ref_ptr<TextureStreamer> streamer = makeStreamer(budget);
+        streamer->addImage("textures/a.dds", *mFullImage);
+        streamer->addImage("textures/b.dds", *makeImage(1024, "textures/b.dds"));
+
+        request(*streamer, "textures/a.dds", 1024.f, 1);
+        streamer->update(2);
+        finishLoading(*streamer, "textures/a.dds");
+
+        request(*streamer, "textures/a.dds", 1024.f, 2);
+        request(*streamer, "textures/b.dds", 1024.f, 2);
+        streamer->update(3);
+
+        EXPECT_EQ(streamer->getStreamedImage("textures/a.dds")->mLevel, 0u);
+        EXPECT_FALSE(streamer->getStreamedImage("textures/b.dds")->mLoading);
+    }
+
+    TEST_F(ResourceTextureStreamerTest, upgrade_over_budget_should_reduce_textures_not_seen_anymore)
+    {
+        const std::size_t budget = mFullImage->getTotalSizeInBytesIncludingMipmaps() + 2 * mFullImage->getTotalSizeInBytesIncludingMipmaps() / 8;
+        osg::ref_ptr<TextureStreamer> streamer = makeStreamer(budget);
+        streamer->addImage("textures/a.dds", *mFullImage);
+        streamer->addImage("textures/b.dds", *makeImage(1024, "textures/b.dds"));
+
+        request(*streamer, "textures/a.dds", 1024.f, 1);
+        streamer->update(2);
+        finishLoading(*streamer, "textures/a.dds");
+        request(*streamer, "textures/a.dds", 1024.f, 2);
+        streamer->update(3);
+        ASSERT_EQ(streamer->getStreamedImage("textures/a.dds")->mLevel, 0u);
+
+        // only b is seen from now on
+        request(*streamer, "textures/b.dds", 1024.f, 3);
+        request(*streamer, "textures/b.dds", 1024.f, 4);
+        streamer->update(5);
+
+        EXPECT_EQ(streamer->getStreamedImage("textures/a.dds")->mLevel, 2u);
+        EXPECT_EQ(streamer->getImage("textures/a.dds")->s(), 256);
+        EXPECT_TRUE(streamer->getStreamedImage("textures/b.dds")->mLoading);
+    }
+
+    TEST_F(ResourceTextureStreamerTest, upgrade_larger_than_the_budget_should_not_be_loaded)
+    {
+        osg::ref_ptr<TextureStreamer> streamer = makeStreamer(mFullImage->getTotalSizeInBytesIncludingMipmaps() / 2);
+        streamer->addImage("textures/a.dds", *mFullImage);
+
+        request(*streamer, "textures/a.dds", 1024.f, 1);
+        streamer->update(2);
+
+        EXPECT_FALSE(streamer->getStreamedImage("textures/a.dds")->mLoading);
+        EXPECT_EQ(mWorkQueue->getNumItems(), 0u);
+    }
+}
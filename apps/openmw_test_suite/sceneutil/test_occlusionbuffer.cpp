@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <components/sceneutil/occlusionbuffer.hpp>
+
+namespace
+{
+    using namespace testing;
+    using namespace SceneUtil;
+
+    // a 1000x500 wall at y=0 facing towards -y
+    const std::vector<osg::Vec3f> wallVertices {
+        osg::Vec3f(-500, 0, 0), osg::Vec3f(500, 0, 0), osg::Vec3f(500, 0, 500), osg::Vec3f(-500, 0, 500)
+    };
+    const std::vector<unsigned int> wallIndices { 0, 1, 2, 0, 2, 3 };
+
+    osg::BoundingBox makeBox(const osg::Vec3f& center, float halfSize)
+    {
+        return osg::BoundingBox(center - osg::Vec3f(halfSize, halfSize, halfSize), center + osg::Vec3f(halfSize, halfSize, halfSize));
+    }
+
+    // whether the segment from the eye to the point passes through the wall
+    bool isBehindWall(const osg::Vec3f& eye, const osg::Vec3f& point)
+    {
+        if (eye.y() >= 0 || point.y() <= 0)
+            return false;
+        float t = -eye.y() / (point.y() - eye.y());
+        osg::Vec3f hit = eye + (point - eye) * t;
+        return hit.x() >= -500 && hit.x() <= 500 && hit.z() >= 0 && hit.z() <= 500;
+    }
+
+    struct SceneUtilOcclusionBufferTest : Test
+    {
+        OcclusionBuffer mBuffer;
+        std::vector<osg::BoundingBox> mBoxes;
+
+        SceneUtilOcclusionBufferTest()
+            : mBuffer(256, 128)
+            , mBoxes {
+                makeBox(osg::Vec3f(0, 500, 250), 50), // behind the wall
+                makeBox(osg::Vec3f(-200, 300, 100), 50), // behind the wall
+                makeBox(osg::Vec3f(200, 300, 400), 50), // behind the wall
+                makeBox(osg::Vec3f(0, 300, 700), 50), // above the wall
+                makeBox(osg::Vec3f(0, -300, 250), 50), // in front of the wall
+            }
+        {
+        }
+
+        void render(const osg::Vec3f& eye, const osg::Vec3f& center)
+        {
+            osg::Matrix view = osg::Matrix::lookAt(eye, center, osg::Vec3f(0, 0, 1));
+            osg::Matrix projection = osg::Matrix::perspective(60, 2, 1, 10000);
+            mBuffer.clear(view * projection);
+            mBuffer.addTriangles(wallVertices, wallIndices, osg::Matrix::identity());
+            mBuffer.finish();
+        }
+
+        std::size_t countOccluded() const
+        {
+            std::size_t result = 0;
+            for (const osg::BoundingBox& box : mBoxes)
+                if (mBuffer.isOccluded(box))
+                    ++result;
+            return result;
+        }
+    };
+
+    TEST_F(SceneUtilOcclusionBufferTest, empty_buffer_should_occlude_nothing)
+    {
+        mBuffer.clear(osg::Matrix::lookAt(osg::Vec3f(0, -1000, 250), osg::Vec3f(0, 0, 250), osg::Vec3f(0, 0, 1))
+                      * osg::Matrix::perspective(60, 2, 1, 10000));
+        mBuffer.finish();
+        EXPECT_EQ(countOccluded(), 0u);
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, should_occlude_only_boxes_behind_occluder)
+    {
+        render(osg::Vec3f(0, -1000, 250), osg::Vec3f(0, 0, 250));
+        EXPECT_TRUE(mBuffer.isOccluded(mBoxes[0]));
+        EXPECT_TRUE(mBuffer.isOccluded(mBoxes[1]));
+        EXPECT_TRUE(mBuffer.isOccluded(mBoxes[2]));
+        EXPECT_FALSE(mBuffer.isOccluded(mBoxes[3]));
+        EXPECT_FALSE(mBuffer.isOccluded(mBoxes[4]));
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, back_faces_should_not_occlude)
+    {
+        mBoxes = { makeBox(osg::Vec3f(0, -500, 250), 50) };
+        render(osg::Vec3f(0, 1000, 250), osg::Vec3f(0, 0, 250));
+        EXPECT_EQ(countOccluded(), 0u);
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, should_occlude_large_box_behind_occluder_covering_view)
+    {
+        mBoxes = { makeBox(osg::Vec3f(0, 2000, 250), 150) };
+        render(osg::Vec3f(0, -100, 250), osg::Vec3f(0, 0, 250));
+        EXPECT_EQ(countOccluded(), 1u);
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, occluder_crossing_near_plane_should_still_occlude)
+    {
+        mBoxes = { makeBox(osg::Vec3f(300, 300, 250), 50) };
+        // looking along the wall from close to its front face, so that a part of it is behind the camera
+        render(osg::Vec3f(0, -20, 250), osg::Vec3f(2000, 200, 250));
+        EXPECT_EQ(countOccluded(), 1u);
+    }
+
+    TEST_F(SceneUtilOcclusionBufferTest, culled_counts_on_camera_path_should_be_conservative)
+    {
+        const osg::Vec3f target(0, 300, 250);
+        std::vector<std::size_t> counts;
+        for (int x = 0; x <= 3000; x += 250)
+        {
+            const osg::Vec3f eye(static_cast<float>(x), -1000, 250);
+            render(eye, target);
+            counts.push_back(countOccluded());
+
+            for (const osg::BoundingBox& box : mBoxes)
+            {
+                if (!mBuffer.isOccluded(box))
+                    continue;
+                for (unsigned int i = 0; i < 8; ++i)
+                    EXPECT_TRUE(isBehindWall(eye, box.corner(i))) << "x=" << x << " corner=" << i;
+            }
+        }
+
+        EXPECT_EQ(counts.front(), 3u);
+        EXPECT_EQ(counts.back(), 0u);
+        for (std::size_t i = 1; i < counts.size(); ++i)
+            EXPECT_LE(counts[i], counts[i - 1]) << "step " << i;
+    }
+}
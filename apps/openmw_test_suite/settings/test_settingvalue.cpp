@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include "components/settings/settings.hpp"
+
+struct SettingValueTest : public ::testing::Test
+{
+  protected:
+    virtual void SetUp()
+    {
+        Settings::Manager().clear();
+        Settings::Manager::mDefaultSettings[std::make_pair("Game", "difficulty")] = "0";
+        Settings::Manager::mDefaultSettings[std::make_pair("Game", "range")] = "1.5";
+        Settings::Manager::mDefaultSettings[std::make_pair("Game", "enabled")] = "true";
+        ++Settings::Manager::mRevision;
+    }
+
+    virtual void TearDown()
+    {
+        Settings::Manager().clear();
+    }
+};
+
+TEST_F(SettingValueTest, reads_typed_values)
+{
+    EXPECT_EQ(Settings::SettingValue<int>("difficulty", "Game").get(), 0);
+    EXPECT_EQ(Settings::SettingValue<float>("range", "Game").get(), 1.5f);
+    EXPECT_EQ(Settings::SettingValue<bool>("enabled", "Game").get(), true);
+    EXPECT_EQ(Settings::SettingValue<std::string>("range", "Game").get(), "1.5");
+}
+
+TEST_F(SettingValueTest, follows_changes)
+{
+    Settings::SettingValue<int> difficulty("difficulty", "Game");
+    EXPECT_EQ(difficulty.get(), 0);
+
+    Settings::Manager::setInt("difficulty", "Game", 50);
+    EXPECT_EQ(difficulty.get(), 50);
+
+    Settings::Manager::setInt("difficulty", "Game", -20);
+    EXPECT_EQ(difficulty.get(), -20);
+}
+
+TEST_F(SettingValueTest, throws_for_missing_setting)
+{
+    Settings::SettingValue<float> missing("missing", "Game");
+    EXPECT_THROW(missing.get(), std::runtime_error);
+}
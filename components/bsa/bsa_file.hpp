@@ -136,6 +136,9 @@ public:
     /// @note Thread safe.
     const FileList &getList() const
     { return mFiles; }
+
+    const std::string& getFilename() const
+    { return mFilename; }
 };
 
 }
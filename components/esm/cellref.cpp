@@ -129,6 +129,45 @@ void ESM::CellRef::loadData(ESMReader &esm, bool &isDeleted)
         mLockLevel = UnbreakableLock;
 }
 
+void ESM::CellRef::skipData(ESMReader &esm, bool &isDeleted)
+{
+    isDeleted = false;
+
+    while (esm.hasMoreSubs())
+    {
+        esm.getSubName();
+        switch (esm.retSubName().intval)
+        {
+            case ESM::FourCC<'U','N','A','M'>::value:
+            case ESM::FourCC<'X','S','C','L'>::value:
+            case ESM::FourCC<'A','N','A','M'>::value:
+            case ESM::FourCC<'B','N','A','M'>::value:
+            case ESM::FourCC<'X','S','O','L'>::value:
+            case ESM::FourCC<'C','N','A','M'>::value:
+            case ESM::FourCC<'I','N','D','X'>::value:
+            case ESM::FourCC<'X','C','H','G'>::value:
+            case ESM::FourCC<'I','N','T','V'>::value:
+            case ESM::FourCC<'N','A','M','9'>::value:
+            case ESM::FourCC<'D','O','D','T'>::value:
+            case ESM::FourCC<'D','N','A','M'>::value:
+            case ESM::FourCC<'F','L','T','V'>::value:
+            case ESM::FourCC<'K','N','A','M'>::value:
+            case ESM::FourCC<'T','N','A','M'>::value:
+            case ESM::FourCC<'D','A','T','A'>::value:
+            case ESM::FourCC<'N','A','M','0'>::value:
+                esm.skipHSub();
+                break;
+            case ESM::SREC_DELE:
+                esm.skipHSub();
+                isDeleted = true;
+                break;
+            default:
+                esm.cacheSubName();
+                return;
+        }
+    }
+}
+
 void ESM::CellRef::save (ESMWriter &esm, bool wideRefNum, bool inInventory, bool isDeleted) const
 {
     mRefNum.save (esm, wideRefNum);
@@ -109,6 +109,9 @@ namespace ESM
             /// Implicitly called by load
             void loadData (ESMReader& esm, bool &isDeleted);
 
+            /// Skip the data loaded by loadData, only checking whether the reference is deleted.
+            static void skipData (ESMReader& esm, bool &isDeleted);
+
             void save (ESMWriter &esm, bool wideRefNum = false, bool inInventory = false, bool isDeleted = false) const;
 
             void blank();
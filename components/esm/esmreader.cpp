@@ -81,6 +81,15 @@ void ESMReader::openRaw(const std::string& filename)
     openRaw(Files::openConstrainedFileStream(filename.c_str()), filename);
 }
 
+void ESMReader::openCopy(const ESMReader& reader, const std::string& filename)
+{
+    openRaw(filename);
+
+    mHeader = reader.mHeader;
+    setIndex(reader.mIdx);
+    mGlobalReaderList = reader.mGlobalReaderList;
+}
+
 void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
 {
     openRaw(_esm, name);
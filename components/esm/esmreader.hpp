@@ -39,6 +39,7 @@ public:
   int getFormat() const;
   const NAME &retSubName() const { return mCtx.subName; }
   uint32_t getSubSize() const { return mCtx.leftSub; }
+  uint32_t getRecordSizeLeft() const { return mCtx.leftRec; }
   std::string getName() const;
 
   /*************************************************************************
@@ -72,6 +73,11 @@ public:
 
   void openRaw(const std::string &filename);
 
+  /// Open the file of another reader through a new stream, without parsing the header again.
+  /// The header, index and global reader list are taken from \a reader, the encoder is kept.
+  /// Allows reading the same file on another thread, as only the loaded header of \a reader is accessed.
+  void openCopy(const ESMReader &reader, const std::string &filename);
+
   /// Get the current position in the file. Make sure that the file has been opened!
   size_t getFileOffset();
 
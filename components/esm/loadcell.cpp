@@ -249,6 +249,51 @@ namespace ESM
         return false;
     }
 
+    bool Cell::getNextRefId(ESMReader &esm, CellRef &ref, bool &isDeleted, RefPosition *position)
+    {
+        isDeleted = false;
+
+        if (!esm.hasMoreSubs())
+            return false;
+
+        if (esm.isNextSub("MVRF"))
+        {
+            // skip rest of cell record (moved references), they are handled elsewhere
+            esm.skipRecord(); // skip MVRF, CNDT
+            return false;
+        }
+
+        if (esm.peekNextSub("FRMR"))
+        {
+            // the name of the FRMR subrecord has been read, see getRefAt
+            if (position)
+            {
+                position->mFilePos = esm.getFileOffset();
+                position->mLeftRec = esm.getRecordSizeLeft();
+            }
+
+            ref.loadId (esm);
+            CellRef::skipData (esm, isDeleted);
+
+            adjustRefNum (ref.mRefNum, esm);
+            return true;
+        }
+        return false;
+    }
+
+    bool Cell::getRefAt(ESMReader &esm, int iCtx, const RefPosition &position, CellRef &ref, bool &isDeleted) const
+    {
+        // The position is right after the name of the FRMR subrecord, as if it had been peeked at
+        ESM_Context context = mContextList.at (iCtx);
+        context.filePos = position.mFilePos;
+        context.leftRec = position.mLeftRec;
+        context.subName.assign ("FRMR");
+        context.subCached = true;
+        esm.restoreContext (context);
+
+        return getNextRef (esm, ref, isDeleted);
+    }
+
     bool Cell::getNextMVRF(ESMReader &esm, MovedCellRef &mref)
     {
         esm.getHT(mref.mRefNum.mIndex);
@@ -180,6 +180,22 @@ struct Cell
    */
   static bool getNextMVRF(ESMReader &esm, MovedCellRef &mref);
 
+  /// Position of a reference within the cell record of one of the contexts
+  struct RefPosition
+  {
+      size_t mFilePos;
+      uint32_t mLeftRec;
+  };
+
+  /// Like getNextRef, but only reads the reference number and ID and skips the rest of the
+  /// reference. The other fields of \a ref are left blank.
+  /// \param position If not nullptr, receives the position of the reference for getRefAt.
+  static bool getNextRefId(ESMReader &esm, CellRef &ref, bool &isDeleted, RefPosition *position = nullptr);
+
+  /// Read the reference at \a position of the context \a iCtx, as returned by getNextRefId,
+  /// without going through the references before it.
+  bool getRefAt(ESMReader &esm, int iCtx, const RefPosition &position, CellRef &ref, bool &isDeleted) const;
+
     void blank();
     ///< Set record to default state (does not touch the ID/index).
 
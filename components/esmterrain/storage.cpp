@@ -48,6 +48,16 @@ namespace ESMTerrain
 
     const float defaultHeight = ESM::Land::DEFAULT_HEIGHT;
 
+    inline void setBlendmapTexel(unsigned char* pData, int blendmapSize, int blendmapImageSize, int imageScaleFactor, int x, int y)
+    {
+        int realY = (blendmapSize - y - 1)*imageScaleFactor;
+        int realX = x*imageScaleFactor;
+        pData[((realY+0)*blendmapImageSize + realX + 0)] = 255;
+        pData[((realY+1)*blendmapImageSize + realX + 0)] = 255;
+        pData[((realY+0)*blendmapImageSize + realX + 1)] = 255;
+        pData[((realY+1)*blendmapImageSize + realX + 1)] = 255;
+    }
+
     Storage::Storage(const VFS::Manager *vfs, const std::string& normalMapPattern, const std::string& normalHeightMapPattern, bool autoUseNormalMaps, const std::string& specularMapPattern, bool autoUseSpecularMaps)
         : mVFS(vfs)
         , mNormalMapPattern(normalMapPattern)
@@ -389,11 +399,22 @@ namespace ESMTerrain
         LandCache cache;
         std::map<UniqueTextureId, unsigned int> textureIndicesMap;
 
+        // neighbouring texels mostly share their texture, so remember the last lookup
+        UniqueTextureId lastId;
+        unsigned int lastLayerIndex = 0;
+        bool hasLastId = false;
+
         for (int y=0; y<blendmapSize; y++)
         {
             for (int x=0; x<blendmapSize; x++)
             {
                 UniqueTextureId id = getVtexIndexAt(cellX, cellY, x+rowStart, y+colStart, cache);
+                if (hasLastId && id == lastId)
+                {
+                    setBlendmapTexel(blendmaps[lastLayerIndex]->data(), blendmapSize, blendmapImageSize, imageScaleFactor, x, y);
+                    continue;
+                }
+
                 std::map<UniqueTextureId, unsigned int>::iterator found = textureIndicesMap.find(id);
                 if (found == textureIndicesMap.end())
                 {
@@ -423,13 +444,11 @@ namespace ESMTerrain
                     }
                 }
                 unsigned int layerIndex = found->second;
-                unsigned char* pData = blendmaps[layerIndex]->data();
-                int realY = (blendmapSize - y - 1)*imageScaleFactor;
-                int realX = x*imageScaleFactor;
-                pData[((realY+0)*blendmapImageSize + realX + 0)] = 255;
-                pData[((realY+1)*blendmapImageSize + realX + 0)] = 255;
-                pData[((realY+0)*blendmapImageSize + realX + 1)] = 255;
-                pData[((realY+1)*blendmapImageSize + realX + 1)] = 255;
+                setBlendmapTexel(blendmaps[layerIndex]->data(), blendmapSize, blendmapImageSize, imageScaleFactor, x, y);
+
+                lastId = id;
+                lastLayerIndex = layerIndex;
+                hasLastId = true;
             }
         }
 
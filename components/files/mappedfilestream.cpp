@@ -0,0 +1,32 @@
+#include "mappedfilestream.hpp"
+
+#include <boost/iostreams/device/mapped_file.hpp>
+
+#include "memorystream.hpp"
+
+namespace
+{
+    class MappedFileStream : public std::istream
+    {
+    public:
+        MappedFileStream(const std::string& filename)
+            : std::istream(nullptr)
+            , mFile(filename)
+            , mBuf(mFile.data(), mFile.size())
+        {
+            rdbuf(&mBuf);
+        }
+
+    private:
+        boost::iostreams::mapped_file_source mFile;
+        Files::MemBuf mBuf;
+    };
+}
+
+namespace Files
+{
+    IStreamPtr openMappedFileStream(const std::string& filename)
+    {
+        return IStreamPtr(new MappedFileStream(filename));
+    }
+}
@@ -0,0 +1,17 @@
+#ifndef OPENMW_COMPONENTS_FILES_MAPPEDFILESTREAM_H
+#define OPENMW_COMPONENTS_FILES_MAPPEDFILESTREAM_H
+
+#include <string>
+
+#include "constrainedfilestream.hpp"
+
+namespace Files
+{
+    /// Open a read-only stream on a memory-mapped view of \a filename. Seeking does not discard
+    /// any buffered data and reads are plain copies, which suits the random access of on-demand
+    /// record loading (e.g. cell references).
+    /// @note Throws an exception if the file can not be mapped (e.g. because it is empty).
+    IStreamPtr openMappedFileStream(const std::string& filename);
+}
+
+#endif
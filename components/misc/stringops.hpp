@@ -171,6 +171,37 @@ public:
         }
     };
 
+    /// Case-insensitive hash (FNV-1a over the lower-cased characters), consistent with ciEqual
+    static std::size_t ciHash(const std::string &in)
+    {
+        std::size_t hash = sizeof(std::size_t) > 4 ? static_cast<std::size_t>(14695981039346656037ULL) : 2166136261U;
+        const std::size_t prime = sizeof(std::size_t) > 4 ? static_cast<std::size_t>(1099511628211ULL) : 16777619U;
+
+        for (std::string::const_iterator it = in.begin(); it != in.end(); ++it)
+        {
+            hash ^= static_cast<unsigned char>(toLower(*it));
+            hash *= prime;
+        }
+
+        return hash;
+    }
+
+    struct CiHash
+    {
+        std::size_t operator()(const std::string& in) const
+        {
+            return ciHash(in);
+        }
+    };
+
+    struct CiEqual
+    {
+        bool operator()(const std::string& left, const std::string& right) const
+        {
+            return ciEqual(left, right);
+        }
+    };
+
 
     /// Performs a binary search on a sorted container for a string that 'key' starts with
     template<typename Iterator, typename T>
@@ -1,5 +1,9 @@
 #include "myguirendermanager.hpp"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
 #include <MyGUI_Gui.h>
 #include <MyGUI_Timer.h>
 
@@ -7,6 +11,7 @@
 #include <osg/BlendFunc>
 #include <osg/Texture2D>
 #include <osg/TexMat>
+#include <osg/GLExtensions>
 
 #include <osgViewer/Viewer>
 
@@ -112,38 +117,49 @@ public:
 
         mReadFrom = (mReadFrom+1)%sNumBuffers;
         const std::vector<Batch>& vec = mBatchVector[mReadFrom];
-        for (std::vector<Batch>::const_iterator it = vec.begin(); it != vec.end(); ++it)
-        {
-            const Batch& batch = *it;
-            osg::VertexBufferObject *vbo = batch.mVertexBuffer;
+        const Stream& stream = mStreams[mReadFrom];
 
-            if (batch.mStateSet)
-            {
-                state->pushStateSet(batch.mStateSet);
-                state->apply();
-            }
-
-            osg::Texture2D* texture = batch.mTexture;
-            if(texture)
-                state->applyTextureAttribute(0, texture);
+        if (!vec.empty())
+        {
+            const char* data = reinterpret_cast<const char*>(stream.mArray->getDataPointer());
 
-            osg::GLBufferObject* bufferobject = state->isVertexBufferObjectSupported() ? vbo->getOrCreateGLBufferObject(state->getContextID()) : 0;
+            osg::GLBufferObject* bufferobject = state->isVertexBufferObjectSupported() ? stream.mBuffer->getOrCreateGLBufferObject(state->getContextID()) : 0;
             if (bufferobject)
             {
+                // uploads the whole buffer if it has been reallocated
                 state->bindVertexBufferObject(bufferobject);
 
+                if (stream.mDirtyBegin < stream.mDirtyEnd)
+                    state->get<osg::GLExtensions>()->glBufferSubData(GL_ARRAY_BUFFER_ARB, stream.mDirtyBegin,
+                        stream.mDirtyEnd - stream.mDirtyBegin, data + stream.mDirtyBegin);
+
                 glVertexPointer(3, GL_FLOAT, sizeof(MyGUI::Vertex), reinterpret_cast<char*>(0));
                 glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(MyGUI::Vertex), reinterpret_cast<char*>(12));
                 glTexCoordPointer(2, GL_FLOAT, sizeof(MyGUI::Vertex), reinterpret_cast<char*>(16));
             }
             else
             {
-                glVertexPointer(3, GL_FLOAT, sizeof(MyGUI::Vertex), (char*)vbo->getArray(0)->getDataPointer());
-                glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(MyGUI::Vertex), (char*)vbo->getArray(0)->getDataPointer() + 12);
-                glTexCoordPointer(2, GL_FLOAT, sizeof(MyGUI::Vertex), (char*)vbo->getArray(0)->getDataPointer() + 16);
+                glVertexPointer(3, GL_FLOAT, sizeof(MyGUI::Vertex), data);
+                glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(MyGUI::Vertex), data + 12);
+                glTexCoordPointer(2, GL_FLOAT, sizeof(MyGUI::Vertex), data + 16);
             }
+        }
 
-            glDrawArrays(GL_TRIANGLES, 0, batch.mVertexCount);
+        for (std::vector<Batch>::const_iterator it = vec.begin(); it != vec.end(); ++it)
+        {
+            const Batch& batch = *it;
+
+            if (batch.mStateSet)
+            {
+                state->pushStateSet(batch.mStateSet);
+                state->apply();
+            }
+
+            osg::Texture2D* texture = batch.mTexture;
+            if(texture)
+                state->applyTextureAttribute(0, texture);
+
+            glDrawArrays(GL_TRIANGLES, batch.mFirstVertex, batch.mVertexCount);
 
             if (batch.mStateSet)
             {
@@ -206,25 +222,83 @@ public:
         // May be empty
         osg::ref_ptr<osg::Texture2D> mTexture;
 
-        osg::ref_ptr<osg::VertexBufferObject> mVertexBuffer;
-        // need to hold on to this too as the mVertexBuffer does not hold a ref to its own array
-        osg::ref_ptr<osg::Array> mArray;
-
         // optional
         osg::ref_ptr<osg::StateSet> mStateSet;
 
+        // range in the vertex stream of the frame
+        size_t mFirstVertex;
         size_t mVertexCount;
     };
 
-    void addBatch(const Batch& batch)
+    /// Append the vertices of a render item to the vertex stream of the current frame. Consecutive render items
+    /// with the same texture and state are merged into one draw call.
+    void addBatch(const MyGUI::Vertex* vertices, size_t count, osg::Texture2D* texture, osg::StateSet* stateSet)
     {
-        mBatchVector[mWriteTo].push_back(batch);
+        if (count == 0)
+            return;
+
+        Stream& stream = mStreams[mWriteTo];
+
+        size_t offset = stream.mSize * sizeof(MyGUI::Vertex);
+        size_t size = count * sizeof(MyGUI::Vertex);
+
+        if (!stream.mArray)
+        {
+            stream.mArray = new osg::UByteArray;
+            stream.mBuffer = new osg::VertexBufferObject;
+            stream.mBuffer->setDataVariance(osg::Object::DYNAMIC);
+            stream.mBuffer->setUsage(GL_DYNAMIC_DRAW);
+            // NB mBuffer does not own the array
+            stream.mBuffer->setArray(0, stream.mArray.get());
+        }
+
+        if (stream.mArray->size() < offset + size)
+        {
+            // grow geometrically; the whole buffer is uploaded again after a reallocation
+            stream.mArray->resize(std::max(offset + size, 2 * stream.mArray->size()));
+            stream.mArray->dirty();
+        }
+
+        // the GUI rarely changes between frames, so only upload the part that actually differs from the last
+        // frame rendered from this stream
+        unsigned char* dest = &(*stream.mArray)[offset];
+        if (std::memcmp(dest, vertices, size) != 0)
+        {
+            std::memcpy(dest, vertices, size);
+            stream.mDirtyBegin = std::min(stream.mDirtyBegin, offset);
+            stream.mDirtyEnd = std::max(stream.mDirtyEnd, offset + size);
+        }
+
+        std::vector<Batch>& batches = mBatchVector[mWriteTo];
+        if (!batches.empty() && batches.back().mTexture == texture && batches.back().mStateSet == stateSet)
+            batches.back().mVertexCount += count;
+        else
+        {
+            Batch batch;
+            batch.mTexture = texture;
+            batch.mStateSet = stateSet;
+            batch.mFirstVertex = stream.mSize;
+            batch.mVertexCount = count;
+            batches.push_back(batch);
+        }
+
+        stream.mSize += count;
     }
 
     void clear()
     {
         mWriteTo = (mWriteTo+1)%sNumBuffers;
         mBatchVector[mWriteTo].clear();
+
+        Stream& stream = mStreams[mWriteTo];
+        stream.mSize = 0;
+        stream.mDirtyBegin = std::numeric_limits<size_t>::max();
+        stream.mDirtyEnd = 0;
+    }
+
+    size_t getNumBatches() const
+    {
+        return mBatchVector[mWriteTo].size();
     }
 
     META_Object(osgMyGUI, Drawable)
@@ -233,34 +307,43 @@ private:
     // 2 would be enough in most cases, use 4 to get stereo working
     static const int sNumBuffers = 4;
 
+    // Vertices of all render items of a frame, in drawing order
+    struct Stream
+    {
+        osg::ref_ptr<osg::UByteArray> mArray;
+        osg::ref_ptr<osg::VertexBufferObject> mBuffer;
+
+        // number of vertices used by the frame
+        size_t mSize;
+
+        // byte range that differs from the previous frame rendered from this stream
+        size_t mDirtyBegin;
+        size_t mDirtyEnd;
+
+        Stream() : mSize(0), mDirtyBegin(std::numeric_limits<size_t>::max()), mDirtyEnd(0) {}
+    };
+
     // double buffering approach, to avoid the need for synchronization with the draw thread
     std::vector<Batch> mBatchVector[sNumBuffers];
+    Stream mStreams[sNumBuffers];
 
     int mWriteTo;
     mutable int mReadFrom;
 };
 
+// The vertices are copied into the stream of the Drawable when rendering, so the buffer does not need to be
+// shared with the draw thread.
 class OSGVertexBuffer : public MyGUI::IVertexBuffer
 {
-    osg::ref_ptr<osg::VertexBufferObject> mBuffer[2];
-    osg::ref_ptr<osg::UByteArray> mVertexArray[2];
+    std::vector<MyGUI::Vertex> mVertices;
 
     size_t mNeedVertexCount;
 
-    unsigned int mCurrentBuffer;
-    bool mUsed; // has the mCurrentBuffer been submitted to the rendering thread
-
-    void destroy();
-    osg::UByteArray* create();
-
 public:
     OSGVertexBuffer();
     virtual ~OSGVertexBuffer() {}
 
-    void markUsed();
-
-    osg::Array* getVertexArray();
-    osg::VertexBufferObject* getVertexBuffer();
+    const MyGUI::Vertex* getVertices() const;
 
     virtual void setVertexCount(size_t count);
     virtual size_t getVertexCount();
@@ -272,21 +355,16 @@ public:
 
 OSGVertexBuffer::OSGVertexBuffer()
   : mNeedVertexCount(0)
-  , mCurrentBuffer(0)
-  , mUsed(false)
 {
 }
 
-void OSGVertexBuffer::markUsed()
+const MyGUI::Vertex* OSGVertexBuffer::getVertices() const
 {
-    mUsed = true;
+    return mVertices.data();
 }
 
 void OSGVertexBuffer::setVertexCount(size_t count)
 {
-    if(count == mNeedVertexCount)
-        return;
-
     mNeedVertexCount = count;
 }
 
@@ -297,51 +375,12 @@ size_t OSGVertexBuffer::getVertexCount()
 
 MyGUI::Vertex *OSGVertexBuffer::lock()
 {
-    if (mUsed)
-    {
-        mCurrentBuffer = (mCurrentBuffer+1)%2;
-        mUsed = false;
-    }
-    osg::UByteArray* array = mVertexArray[mCurrentBuffer];
-    if (!array)
-    {
-        array = create();
-    }
-    else if (array->size() != mNeedVertexCount * sizeof(MyGUI::Vertex))
-    {
-        array->resize(mNeedVertexCount * sizeof(MyGUI::Vertex));
-    }
-
-    return (MyGUI::Vertex*)&(*array)[0];
+    mVertices.resize(mNeedVertexCount);
+    return mVertices.data();
 }
 
 void OSGVertexBuffer::unlock()
 {
-    mVertexArray[mCurrentBuffer]->dirty();
-    mBuffer[mCurrentBuffer]->dirty();
-}
-
-osg::UByteArray* OSGVertexBuffer::create()
-{
-    mVertexArray[mCurrentBuffer] = new osg::UByteArray(mNeedVertexCount*sizeof(MyGUI::Vertex));
-
-    mBuffer[mCurrentBuffer] = new osg::VertexBufferObject;
-    mBuffer[mCurrentBuffer]->setDataVariance(osg::Object::DYNAMIC);
-    mBuffer[mCurrentBuffer]->setUsage(GL_DYNAMIC_DRAW);
-    // NB mBuffer does not own the array
-    mBuffer[mCurrentBuffer]->setArray(0, mVertexArray[mCurrentBuffer].get());
-
-    return mVertexArray[mCurrentBuffer];
-}
-
-osg::Array* OSGVertexBuffer::getVertexArray()
-{
-    return mVertexArray[mCurrentBuffer];
-}
-
-osg::VertexBufferObject* OSGVertexBuffer::getVertexBuffer()
-{
-    return mBuffer[mCurrentBuffer];
 }
 
 // ---------------------------------------------------------------------------
@@ -354,6 +393,7 @@ RenderManager::RenderManager(osgViewer::Viewer *viewer, osg::Group *sceneroot, R
   , mIsInitialise(false)
   , mInvScalingFactor(1.f)
   , mInjectState(nullptr)
+  , mRenderItems(0)
 {
     if (scalingFactor != 0.f)
         mInvScalingFactor = 1.f / scalingFactor;
@@ -427,27 +467,23 @@ void RenderManager::destroyVertexBuffer(MyGUI::IVertexBuffer *buffer)
 void RenderManager::begin()
 {
     mDrawable->clear();
+    mRenderItems = 0;
     // variance will be recomputed based on textures being rendered in this frame
     mDrawable->setDataVariance(osg::Object::STATIC);
 }
 
 void RenderManager::doRender(MyGUI::IVertexBuffer *buffer, MyGUI::ITexture *texture, size_t count)
 {
-    Drawable::Batch batch;
-    batch.mVertexCount = count;
-    batch.mVertexBuffer = static_cast<OSGVertexBuffer*>(buffer)->getVertexBuffer();
-    batch.mArray = static_cast<OSGVertexBuffer*>(buffer)->getVertexArray();
-    static_cast<OSGVertexBuffer*>(buffer)->markUsed();
+    osg::Texture2D* tex = nullptr;
     if (texture)
     {
-        batch.mTexture = static_cast<OSGTexture*>(texture)->getTexture();
-        if (batch.mTexture->getDataVariance() == osg::Object::DYNAMIC)
+        tex = static_cast<OSGTexture*>(texture)->getTexture();
+        if (tex->getDataVariance() == osg::Object::DYNAMIC)
             mDrawable->setDataVariance(osg::Object::DYNAMIC); // only for this frame, reset in begin()
     }
-    if (mInjectState)
-        batch.mStateSet = mInjectState;
 
-    mDrawable->addBatch(batch);
+    mDrawable->addBatch(static_cast<OSGVertexBuffer*>(buffer)->getVertices(), count, tex, mInjectState);
+    ++mRenderItems;
 }
 
 void RenderManager::setInjectState(osg::StateSet* stateSet)
@@ -457,6 +493,13 @@ void RenderManager::setInjectState(osg::StateSet* stateSet)
 
 void RenderManager::end()
 {
+    osg::Stats* stats = mViewer->getViewerStats();
+    if (stats->collectStats("resource"))
+    {
+        unsigned int frameNumber = mViewer->getFrameStamp()->getFrameNumber();
+        stats->setAttribute(frameNumber, "GUI Render Items", mRenderItems);
+        stats->setAttribute(frameNumber, "GUI Draw Calls", mDrawable->getNumBatches());
+    }
 }
 
 void RenderManager::update()
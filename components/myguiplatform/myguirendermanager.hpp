@@ -51,6 +51,9 @@ class RenderManager : public MyGUI::RenderManager, public MyGUI::IRenderTarget
 
     osg::StateSet* mInjectState;
 
+    // number of doRender calls in the current frame, before merging them into draw calls
+    unsigned int mRenderItems;
+
     void destroyAllResources();
 
 public:
@@ -357,7 +357,7 @@ namespace NifOsg
             else
             {
                 std::string filename = Misc::ResourceHelpers::correctTexturePath(st->filename, imageManager->getVFS());
-                image = imageManager->getImage(filename);
+                image = imageManager->getStreamedImage(filename);
             }
             return image;
         }
@@ -0,0 +1,230 @@
+#include "ddsmiplevels.hpp"
+
+#include <algorithm>
+#include <cstdint>
+
+#include <osg/Texture>
+
+namespace
+{
+
+    const std::size_t sHeaderSize = 128;
+
+    // DDS_HEADER::dwFlags
+    const std::uint32_t DDSD_MIPMAPCOUNT = 0x20000;
+
+    // DDS_PIXELFORMAT::dwFlags
+    const std::uint32_t DDPF_ALPHAPIXELS = 0x1;
+    const std::uint32_t DDPF_FOURCC = 0x4;
+    const std::uint32_t DDPF_RGB = 0x40;
+
+    // DDS_HEADER::dwCaps2
+    const std::uint32_t DDSCAPS2_CUBEMAP = 0x200;
+    const std::uint32_t DDSCAPS2_VOLUME = 0x200000;
+
+    std::uint32_t readUint32(const unsigned char* data)
+    {
+        return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+    }
+
+    std::uint32_t makeFourCC(char a, char b, char c, char d)
+    {
+        return static_cast<std::uint32_t>(a) | (static_cast<std::uint32_t>(b) << 8)
+            | (static_cast<std::uint32_t>(c) << 16) | (static_cast<std::uint32_t>(d) << 24);
+    }
+
+    struct RGBFormat
+    {
+        std::uint32_t mBitCount;
+        std::uint32_t mRedMask;
+        std::uint32_t mGreenMask;
+        std::uint32_t mBlueMask;
+        std::uint32_t mAlphaMask;
+        GLint mInternalFormat;
+        GLenum mPixelFormat;
+    };
+
+    // the 8 bit per channel formats of the osgDB plugin
+    const RGBFormat sRGBFormats[] = {
+        { 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000, GL_RGB, GL_BGRA },
+        { 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0x00000000, GL_RGB, GL_RGBA },
+        { 24, 0x00ff0000, 0x0000ff00, 0x000000ff, 0x00000000, GL_RGB, GL_BGR },
+        { 24, 0x000000ff, 0x0000ff00, 0x00ff0000, 0x00000000, GL_RGB, GL_RGB },
+    };
+
+    const RGBFormat sRGBAFormats[] = {
+        { 32, 0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000, GL_RGBA, GL_BGRA },
+        { 32, 0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000, GL_RGBA, GL_RGBA },
+    };
+
+    template <std::size_t size>
+    const RGBFormat* findFormat(const RGBFormat (&formats)[size], const unsigned char* pixelFormat)
+    {
+        for (const RGBFormat& format : formats)
+        {
+            if (readUint32(pixelFormat + 12) == format.mBitCount
+                    && readUint32(pixelFormat + 16) == format.mRedMask
+                    && readUint32(pixelFormat + 20) == format.mGreenMask
+                    && readUint32(pixelFormat + 24) == format.mBlueMask
+                    && readUint32(pixelFormat + 28) == format.mAlphaMask)
+                return &format;
+        }
+        return nullptr;
+    }
+
+    // Whether a DXT1 block uses the 3 color mode and one of its texels the transparent index
+    bool isTransparentDXT1(const unsigned char* data, std::size_t size)
+    {
+        for (std::size_t block = 0; block + 8 <= size; block += 8)
+        {
+            unsigned int color0 = data[block] | (data[block + 1] << 8);
+            unsigned int color1 = data[block + 2] | (data[block + 3] << 8);
+            if (color0 > color1)
+                continue;
+
+            std::uint32_t indices = readUint32(data + block + 4);
+            for (int texel = 0; texel < 16; ++texel)
+            {
+                if (((indices >> (2 * texel)) & 3) == 3)
+                    return true;
+            }
+        }
+        return false;
+    }
+
+}
+
+namespace Resource
+{
+
+    DdsMipLevels::DdsMipLevels()
+        : mWidth(0)
+        , mHeight(0)
+        , mNumLevels(0)
+        , mInternalFormat(0)
+        , mPixelFormat(0)
+        , mBlockSize(0)
+        , mTexelSize(0)
+    {
+    }
+
+    bool DdsMipLevels::readHeader(std::istream& stream)
+    {
+        unsigned char header[sHeaderSize];
+        if (!stream.read(reinterpret_cast<char*>(header), sHeaderSize))
+            return false;
+
+        if (readUint32(header) != makeFourCC('D', 'D', 'S', ' ') || readUint32(header + 4) != 124)
+            return false;
+
+        std::uint32_t flags = readUint32(header + 8);
+        mHeight = readUint32(header + 12);
+        mWidth = readUint32(header + 16);
+        std::uint32_t depth = readUint32(header + 24);
+        std::uint32_t mipMapCount = readUint32(header + 28);
+        const unsigned char* pixelFormat = header + 76;
+        std::uint32_t caps2 = readUint32(header + 112);
+
+        if (mWidth == 0 || mHeight == 0 || depth > 1 || (caps2 & (DDSCAPS2_CUBEMAP|DDSCAPS2_VOLUME)))
+            return false;
+
+        unsigned int maxLevels = 1;
+        while ((std::max(mWidth, mHeight) >> maxLevels) > 0)
+            ++maxLevels;
+        mNumLevels = (flags & DDSD_MIPMAPCOUNT) && mipMapCount > 0 ? std::min(mipMapCount, maxLevels) : 1;
+
+        std::uint32_t pixelFlags = readUint32(pixelFormat + 4);
+        if (pixelFlags & DDPF_FOURCC)
+        {
+            std::uint32_t fourCC = readUint32(pixelFormat + 8);
+            if (fourCC == makeFourCC('D', 'X', 'T', '1'))
+            {
+                mPixelFormat = (pixelFlags & DDPF_ALPHAPIXELS) ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+                mBlockSize = 8;
+            }
+            else if (fourCC == makeFourCC('D', 'X', 'T', '3'))
+            {
+                mPixelFormat = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+                mBlockSize = 16;
+            }
+            else if (fourCC == makeFourCC('D', 'X', 'T', '5'))
+            {
+                mPixelFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+                mBlockSize = 16;
+            }
+            else
+                return false;
+
+            mInternalFormat = mPixelFormat;
+            return true;
+        }
+
+        if (!(pixelFlags & DDPF_RGB))
+            return false;
+
+        const RGBFormat* format = (pixelFlags & DDPF_ALPHAPIXELS) ? findFormat(sRGBAFormats, pixelFormat) : findFormat(sRGBFormats, pixelFormat);
+        if (!format)
+            return false;
+
+        mInternalFormat = format->mInternalFormat;
+        mPixelFormat = format->mPixelFormat;
+        mTexelSize = format->mBitCount / 8;
+        return true;
+    }
+
+    std::size_t DdsMipLevels::getLevelSize(unsigned int level) const
+    {
+        std::size_t width = std::max(1u, mWidth >> level);
+        std::size_t height = std::max(1u, mHeight >> level);
+        if (mBlockSize)
+            return ((width + 3) / 4) * ((height + 3) / 4) * mBlockSize;
+        return width * height * mTexelSize;
+    }
+
+    osg::ref_ptr<osg::Image> DdsMipLevels::readLevels(std::istream& stream, unsigned int level) const
+    {
+        if (level >= mNumLevels)
+            return nullptr;
+
+        // the levels are stored from the largest to the smallest one
+        std::size_t offset = sHeaderSize;
+        for (unsigned int i = 0; i < level; ++i)
+            offset += getLevelSize(i);
+
+        osg::Image::MipmapDataType mipmaps;
+        std::size_t size = 0;
+        for (unsigned int i = level; i < mNumLevels; ++i)
+        {
+            if (i != level)
+                mipmaps.push_back(size);
+            size += getLevelSize(i);
+        }
+
+        stream.clear();
+        if (!stream.seekg(offset))
+            return nullptr;
+
+        unsigned char* data = new unsigned char[size];
+        if (!stream.read(reinterpret_cast<char*>(data), size))
+        {
+            delete[] data;
+            return nullptr;
+        }
+
+        GLint internalFormat = mInternalFormat;
+        GLenum pixelFormat = mPixelFormat;
+        if (pixelFormat == GL_COMPRESSED_RGB_S3TC_DXT1_EXT && isTransparentDXT1(data, getLevelSize(level)))
+        {
+            internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            pixelFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        }
+
+        osg::ref_ptr<osg::Image> image (new osg::Image);
+        image->setImage(std::max(1u, mWidth >> level), std::max(1u, mHeight >> level), 1, internalFormat, pixelFormat,
+                        GL_UNSIGNED_BYTE, data, osg::Image::USE_NEW_DELETE, 1);
+        image->setMipmapLevels(mipmaps);
+        image->flipVertical();
+        return image;
+    }
+
+}
@@ -0,0 +1,50 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_DDSMIPLEVELS_H
+#define OPENMW_COMPONENTS_RESOURCE_DDSMIPLEVELS_H
+
+#include <cstddef>
+#include <istream>
+
+#include <osg/ref_ptr>
+#include <osg/Image>
+
+namespace Resource
+{
+
+    /// @brief Reads a range of the mip levels of a DDS file, without reading the larger levels stored before it.
+    /// @par Supports DXT1, DXT3, DXT5 and uncompressed 24 and 32 bit RGB(A) textures. The images match the ones the osgDB
+    /// plugin reads with the "dds_flip dds_dxt1_detect_rgba" options, except that DXT1 alpha is detected on the first
+    /// level that is read rather than on the full size level.
+    class DdsMipLevels
+    {
+    public:
+        DdsMipLevels();
+
+        /// Read the header of a DDS file.
+        /// @return false if the stream does not contain a 2D DDS texture of a supported format.
+        bool readHeader(std::istream& stream);
+
+        unsigned int getWidth() const { return mWidth; }
+        unsigned int getHeight() const { return mHeight; }
+        unsigned int getNumLevels() const { return mNumLevels; }
+
+        /// Read the levels starting at \a level from the stream passed to readHeader.
+        /// @return nullptr if the file is truncated.
+        osg::ref_ptr<osg::Image> readLevels(std::istream& stream, unsigned int level) const;
+
+    private:
+        std::size_t getLevelSize(unsigned int level) const;
+
+        unsigned int mWidth;
+        unsigned int mHeight;
+        unsigned int mNumLevels;
+        GLint mInternalFormat;
+        GLenum mPixelFormat;
+        // bytes per 4x4 block of compressed formats, 0 for uncompressed ones
+        unsigned int mBlockSize;
+        // bytes per texel of uncompressed formats
+        unsigned int mTexelSize;
+    };
+
+}
+
+#endif
@@ -0,0 +1,263 @@
+#include "imagecache.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+#include <OpenThreads/ScopedLock>
+
+#include <osg/Image>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <components/debug/debuglog.hpp>
+
+namespace
+{
+
+    const char sMagic[4] = { 'O', 'M', 'W', 'I' };
+
+    // increase when the layout of the files changes
+    const std::uint32_t sVersion = 1;
+
+    // limits of images that can be stored, to keep the sizes of corrupted files from overflowing
+    const std::uint64_t sMaxTexels = 1 << 26;
+    const std::uint32_t sMaxMipmaps = 32;
+
+    void write(std::ostream& stream, std::uint32_t value)
+    {
+        stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    bool read(std::istream& stream, std::uint32_t& value)
+    {
+        return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+}
+
+namespace Resource
+{
+
+ImageCache::ImageCache(const std::string& path, std::uint64_t maxSize)
+    : mPath(path)
+    , mMaxSize(maxSize)
+    , mSize(0)
+    , mSizeKnown(false)
+{
+}
+
+std::string ImageCache::getKey(const std::string& stamp)
+{
+    // FNV-1a
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::string::const_iterator it = stamp.begin(); it != stamp.end(); ++it)
+    {
+        hash ^= static_cast<unsigned char>(*it);
+        hash *= 1099511628211ull;
+    }
+
+    std::ostringstream stream;
+    stream << std::hex << std::setfill('0') << std::setw(16) << hash;
+    return stream.str();
+}
+
+std::string ImageCache::getFileName(const std::string& key) const
+{
+    return (boost::filesystem::path(mPath) / (key + ".img")).string();
+}
+
+osg::ref_ptr<osg::Image> ImageCache::load(const std::string& key) const
+{
+    std::string fileName = getFileName(key);
+
+    boost::system::error_code error;
+    if (!boost::filesystem::exists(fileName, error))
+        return nullptr;
+
+    boost::filesystem::ifstream stream (fileName, std::ios::binary);
+
+    char magic[4];
+    std::uint32_t version = 0;
+    if (!stream.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), sMagic) || !read(stream, version) || version != sVersion)
+        return nullptr;
+
+    std::uint32_t s, t, r, internalFormat, pixelFormat, dataType, packing, origin, numMipmaps;
+    if (!read(stream, s) || !read(stream, t) || !read(stream, r) || !read(stream, internalFormat) || !read(stream, pixelFormat)
+            || !read(stream, dataType) || !read(stream, packing) || !read(stream, origin) || !read(stream, numMipmaps))
+    {
+        Log(Debug::Warning) << "Warning: Can't read cached image " << fileName << ": truncated header";
+        return nullptr;
+    }
+
+    if (s == 0 || t == 0 || r == 0 || static_cast<std::uint64_t>(s) * t * r > sMaxTexels || numMipmaps > sMaxMipmaps
+            || (packing != 1 && packing != 2 && packing != 4 && packing != 8))
+    {
+        Log(Debug::Warning) << "Warning: Can't read cached image " << fileName << ": invalid header";
+        return nullptr;
+    }
+
+    osg::Image::MipmapDataType mipmaps (numMipmaps);
+    for (std::uint32_t i=0; i<numMipmaps; ++i)
+    {
+        std::uint32_t offset;
+        if (!read(stream, offset))
+        {
+            Log(Debug::Warning) << "Warning: Can't read cached image " << fileName << ": truncated header";
+            return nullptr;
+        }
+        mipmaps[i] = offset;
+    }
+
+    // the mip levels have to follow each other with the sizes osg::Image computes for them
+    std::uint64_t expectedSize = 0;
+    for (std::uint32_t level=0; level<=numMipmaps; ++level)
+    {
+        if (level > 0 && mipmaps[level-1] != expectedSize)
+        {
+            Log(Debug::Warning) << "Warning: Can't read cached image " << fileName << ": invalid mipmap offset";
+            return nullptr;
+        }
+
+        unsigned int levelSize = osg::Image::computeImageSizeInBytes(std::max(1u, s >> level), std::max(1u, t >> level), std::max(1u, r >> level),
+                                                                     static_cast<GLenum>(pixelFormat), static_cast<GLenum>(dataType), static_cast<int>(packing));
+        if (levelSize == 0)
+        {
+            Log(Debug::Warning) << "Warning: Can't read cached image " << fileName << ": invalid format";
+            return nullptr;
+        }
+        expectedSize += levelSize;
+    }
+
+    std::uint32_t size = 0;
+    if (!read(stream, size) || size != expectedSize || size > boost::filesystem::file_size(fileName, error))
+    {
+        Log(Debug::Warning) << "Warning: Can't read cached image " << fileName << ": invalid size";
+        return nullptr;
+    }
+
+    std::unique_ptr<unsigned char[]> data (new unsigned char[size]);
+    if (!stream.read(reinterpret_cast<char*>(data.get()), size))
+    {
+        Log(Debug::Warning) << "Warning: Can't read cached image " << fileName << ": truncated data";
+        return nullptr;
+    }
+
+    // the modification time tells which images were used least recently
+    boost::filesystem::last_write_time(fileName, std::time(nullptr), error);
+
+    osg::ref_ptr<osg::Image> image (new osg::Image);
+    image->setImage(static_cast<int>(s), static_cast<int>(t), static_cast<int>(r), static_cast<GLint>(internalFormat),
+                    static_cast<GLenum>(pixelFormat), static_cast<GLenum>(dataType), data.release(), osg::Image::USE_NEW_DELETE, static_cast<int>(packing));
+    image->setMipmapLevels(mipmaps);
+    image->setOrigin(static_cast<osg::Image::Origin>(origin));
+    return image;
+}
+
+void ImageCache::save(const std::string& key, const osg::Image& image)
+{
+    if (!image.data() || !image.isDataContiguous())
+        return;
+
+    try
+    {
+        boost::filesystem::create_directories(mPath);
+
+        // write to a temporary file first, so that an interrupted write never leaves a truncated image behind
+        boost::filesystem::path fileName = getFileName(key);
+        boost::filesystem::path tempName = boost::filesystem::path(mPath) / boost::filesystem::unique_path(key + "-%%%%%%%%.tmp");
+        {
+            boost::filesystem::ofstream stream (tempName, std::ios::binary);
+            stream.write(sMagic, sizeof(sMagic));
+            write(stream, sVersion);
+            write(stream, static_cast<std::uint32_t>(image.s()));
+            write(stream, static_cast<std::uint32_t>(image.t()));
+            write(stream, static_cast<std::uint32_t>(image.r()));
+            write(stream, static_cast<std::uint32_t>(image.getInternalTextureFormat()));
+            write(stream, static_cast<std::uint32_t>(image.getPixelFormat()));
+            write(stream, static_cast<std::uint32_t>(image.getDataType()));
+            write(stream, static_cast<std::uint32_t>(image.getPacking()));
+            write(stream, static_cast<std::uint32_t>(image.getOrigin()));
+            write(stream, static_cast<std::uint32_t>(image.getMipmapLevels().size()));
+            for (osg::Image::MipmapDataType::const_iterator it = image.getMipmapLevels().begin(); it != image.getMipmapLevels().end(); ++it)
+                write(stream, static_cast<std::uint32_t>(*it));
+
+            std::uint32_t size = image.getTotalSizeInBytesIncludingMipmaps();
+            write(stream, size);
+            stream.write(reinterpret_cast<const char*>(image.data()), size);
+
+            if (stream.fail())
+            {
+                Log(Debug::Warning) << "Warning: Can't write cached image " << fileName.string();
+                stream.close();
+                boost::filesystem::remove(tempName);
+                return;
+            }
+        }
+        boost::filesystem::rename(tempName, fileName);
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        if (mSizeKnown)
+            mSize += boost::filesystem::file_size(fileName);
+        if (!mSizeKnown || mSize > mMaxSize)
+            evict();
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Warning) << "Warning: Can't write cached image to " << mPath << ": " << e.what();
+    }
+}
+
+void ImageCache::evict()
+{
+    struct StoredImage
+    {
+        std::time_t mLastUsed;
+        std::uint64_t mSize;
+        boost::filesystem::path mPath;
+
+        bool operator<(const StoredImage& other) const { return mLastUsed < other.mLastUsed; }
+    };
+
+    std::vector<StoredImage> images;
+    std::uint64_t size = 0;
+    boost::system::error_code error;
+    for (boost::filesystem::directory_iterator it (mPath, error), end; !error && it != end; it.increment(error))
+    {
+        if (it->path().extension() != ".img")
+            continue;
+
+        StoredImage image;
+        image.mPath = it->path();
+        image.mSize = boost::filesystem::file_size(image.mPath, error);
+        image.mLastUsed = boost::filesystem::last_write_time(image.mPath, error);
+        if (error)
+        {
+            error.clear();
+            continue;
+        }
+        size += image.mSize;
+        images.push_back(image);
+    }
+
+    if (size > mMaxSize)
+    {
+        std::sort(images.begin(), images.end());
+        for (std::vector<StoredImage>::const_iterator it = images.begin(); it != images.end() && size > mMaxSize / 4 * 3; ++it)
+        {
+            boost::filesystem::remove(it->mPath, error);
+            if (!error)
+                size -= it->mSize;
+        }
+    }
+
+    mSize = size;
+    mSizeKnown = true;
+}
+
+}
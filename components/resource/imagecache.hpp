@@ -0,0 +1,62 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_IMAGECACHE_H
+#define OPENMW_COMPONENTS_RESOURCE_IMAGECACHE_H
+
+#include <OpenThreads/Mutex>
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+
+#include <cstdint>
+#include <string>
+
+namespace osg
+{
+    class Image;
+}
+
+namespace Resource
+{
+
+    /// @brief Stores decoded images on disk, so that later sessions do not have to decode them again.
+    /// @par The images are stored in the layout they are uploaded to the GPU with, i.e. loading one is a single read.
+    /// The cache is keyed by where the encoded file is stored, including its size and modification time, so a changed
+    /// file results in a new key. When the stored images exceed the maximum size, the least recently used ones are
+    /// removed. The cache directory may be deleted at any time.
+    class ImageCache : public osg::Referenced
+    {
+    public:
+        /// @param path Directory to store the images in, is created when the first image is saved.
+        /// @param maxSize Maximum total size of the stored images in bytes.
+        ImageCache(const std::string& path, std::uint64_t maxSize);
+
+        /// @return The key of an encoded image file.
+        /// @param stamp Describes the file, see VFS::Manager::getStamp.
+        static std::string getKey(const std::string& stamp);
+
+        /// @return The stored image, or nullptr if there is none for this key.
+        /// @note Thread safe.
+        osg::ref_ptr<osg::Image> load(const std::string& key) const;
+
+        /// @note Thread safe.
+        void save(const std::string& key, const osg::Image& image);
+
+    private:
+        std::string getFileName(const std::string& key) const;
+
+        /// Remove the least recently used images until they take at most 3/4 of the maximum size, so that the directory
+        /// is not scanned again on every save.
+        /// @note Call with mMutex locked.
+        void evict();
+
+        std::string mPath;
+        std::uint64_t mMaxSize;
+
+        OpenThreads::Mutex mMutex;
+        // total size of the stored images, only known after the directory was scanned on the first save
+        std::uint64_t mSize;
+        bool mSizeKnown;
+    };
+
+}
+
+#endif
@@ -1,12 +1,18 @@
 #include "imagemanager.hpp"
 
 #include <cassert>
+#include <atomic>
+#include <memory>
+
 #include <osgDB/Registry>
 
 #include <components/debug/debuglog.hpp>
 #include <components/vfs/manager.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include "objectcache.hpp"
+#include "imagecache.hpp"
+#include "texturestreamer.hpp"
 
 #ifdef OSG_LIBRARY_STATIC
 // This list of plugins should match with the list in the top-level CMakelists.txt.
@@ -39,6 +45,90 @@ namespace
         return warningImage;
     }
 
+    // formats whose decoding takes noticeably longer than reading a decoded image
+    bool isSlowToDecode(const std::string& ext)
+    {
+        return ext == "png" || ext == "jpg" || ext == "jpeg";
+    }
+
+    std::string getExtension(const std::string& normalized)
+    {
+        size_t extPos = normalized.find_last_of('.');
+        if (extPos != std::string::npos && extPos+1 < normalized.size())
+            return normalized.substr(extPos+1);
+        return std::string();
+    }
+
+    /// Marks an image as being decoded for the lifetime of the guard, see ImageManager::getImage.
+    class DecodingGuard
+    {
+    public:
+        DecodingGuard(std::set<std::string>& decoding, OpenThreads::Mutex& mutex, OpenThreads::Condition& condition, const std::string& normalized)
+            : mDecoding(decoding)
+            , mMutex(mutex)
+            , mCondition(condition)
+            , mNormalized(normalized)
+        {
+            // the caller holds the mutex
+            mDecoding.insert(mNormalized);
+        }
+
+        ~DecodingGuard()
+        {
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+                mDecoding.erase(mNormalized);
+            }
+            mCondition.broadcast();
+        }
+
+    private:
+        std::set<std::string>& mDecoding;
+        OpenThreads::Mutex& mMutex;
+        OpenThreads::Condition& mCondition;
+        std::string mNormalized;
+    };
+
+    // the number of images decoded by one work item
+    const std::size_t sDecodeBatchSize = 8;
+
+    class DecodeImagesWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        DecodeImagesWorkItem(Resource::ImageManager* imageManager, const std::vector<std::string>& filenames)
+            : mImageManager(imageManager)
+            , mFilenames(filenames)
+            , mAbort(false)
+        {
+        }
+
+        virtual void doWork()
+        {
+            for (std::vector<std::string>::const_iterator it = mFilenames.begin(); it != mFilenames.end() && !mAbort; ++it)
+            {
+                try
+                {
+                    mImages.push_back(mImageManager->getImage(*it));
+                }
+                catch (const std::exception& e)
+                {
+                    Log(Debug::Error) << "Failed to decode image " << *it << ": " << e.what();
+                }
+            }
+        }
+
+        virtual void abort()
+        {
+            mAbort = true;
+        }
+
+    private:
+        Resource::ImageManager* mImageManager;
+        std::vector<std::string> mFilenames;
+        std::atomic<bool> mAbort;
+        std::vector<osg::ref_ptr<osg::Image> > mImages;
+    };
+
 }
 
 namespace Resource
@@ -53,7 +143,8 @@ namespace Resource
 
     ImageManager::~ImageManager()
     {
-
+        // let the decoding threads finish before anything else is destroyed
+        mDecodeWorkQueue = nullptr;
     }
 
     bool checkSupported(osg::Image* image, const std::string& filename)
@@ -91,68 +182,174 @@ namespace Resource
             return osg::ref_ptr<osg::Image>(static_cast<osg::Image*>(obj.get()));
         else
         {
-            Files::IStreamPtr stream;
-            try
-            {
-                stream = mVFS->get(normalized.c_str());
-            }
-            catch (std::exception& e)
+            std::unique_ptr<DecodingGuard> decoding;
             {
-                Log(Debug::Error) << "Failed to open image: " << e.what();
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
-                return mWarningImage;
-            }
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mDecodingMutex);
+                while (mDecoding.count(normalized))
+                    mDecodingCondition.wait(&mDecodingMutex);
 
-            size_t extPos = normalized.find_last_of('.');
-            std::string ext;
-            if (extPos != std::string::npos && extPos+1 < normalized.size())
-                ext = normalized.substr(extPos+1);
-            osgDB::ReaderWriter* reader = osgDB::Registry::instance()->getReaderWriterForExtension(ext);
-            if (!reader)
-            {
-                Log(Debug::Error) << "Error loading " << filename << ": no readerwriter for '" << ext << "' found";
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
-                return mWarningImage;
+                obj = mCache->getRefFromObjectCache(normalized);
+                if (obj)
+                    return osg::ref_ptr<osg::Image>(static_cast<osg::Image*>(obj.get()));
+
+                // wakes up the waiting threads even if loading throws
+                decoding.reset(new DecodingGuard(mDecoding, mDecodingMutex, mDecodingCondition, normalized));
             }
 
-            osgDB::ReaderWriter::ReadResult result = reader->readImage(*stream, mOptions);
-            if (!result.success())
+            osg::ref_ptr<osg::Image> image = loadImage(normalized);
+            if (!image)
+                image = mWarningImage;
+
+            mCache->addEntryToObjectCache(normalized, image);
+            return image;
+        }
+    }
+
+    std::vector<osg::ref_ptr<SceneUtil::WorkItem> > ImageManager::decodeImages(const std::vector<std::string>& filenames)
+    {
+        std::vector<osg::ref_ptr<SceneUtil::WorkItem> > workItems;
+        if (!mDecodeWorkQueue)
+            return workItems;
+
+        // other formats are about as fast to load on use, and DDS files would be cached in full instead of being streamed
+        std::set<std::string> pending;
+        for (std::vector<std::string>::const_iterator it = filenames.begin(); it != filenames.end(); ++it)
+        {
+            std::string normalized = *it;
+            mVFS->normalizeFilename(normalized);
+            if (isSlowToDecode(getExtension(normalized)) && !mCache->getRefFromObjectCache(normalized))
+                pending.insert(normalized);
+        }
+
+        std::vector<std::string> batch;
+        for (std::set<std::string>::const_iterator it = pending.begin(); it != pending.end(); ++it)
+        {
+            batch.push_back(*it);
+            if (batch.size() == sDecodeBatchSize || std::next(it) == pending.end())
             {
-                Log(Debug::Error) << "Error loading " << filename << ": " << result.message() << " code " << result.status();
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
-                return mWarningImage;
+                osg::ref_ptr<SceneUtil::WorkItem> workItem (new DecodeImagesWorkItem(this, batch));
+                mDecodeWorkQueue->addWorkItem(workItem);
+                workItems.push_back(workItem);
+                batch.clear();
             }
+        }
+        return workItems;
+    }
 
-            osg::ref_ptr<osg::Image> image = result.getImage();
+    osg::ref_ptr<osg::Image> ImageManager::getStreamedImage(const std::string &filename)
+    {
+        osg::ref_ptr<TextureStreamer> textureStreamer = mTextureStreamer;
+        if (!textureStreamer)
+            return getImage(filename);
 
-            image->setFileName(normalized);
-            if (!checkSupported(image, filename))
+        std::string normalized = filename;
+        mVFS->normalizeFilename(normalized);
+
+        osg::ref_ptr<osg::Image> image = textureStreamer->getImage(normalized);
+        if (image)
+            return image;
+
+        // images that are already loaded in full, or are not suitable for streaming
+        osg::ref_ptr<osg::Object> obj = mCache->getRefFromObjectCache(normalized);
+        if (obj)
+            return osg::ref_ptr<osg::Image>(static_cast<osg::Image*>(obj.get()));
+
+        // only read the levels up to the base size of DDS files
+        if (getExtension(normalized) == "dds")
+        {
+            image = textureStreamer->loadImage(normalized);
+            if (image)
+                return image;
+        }
+
+        image = loadImage(normalized);
+        if (image && textureStreamer->canStream(*image))
+            return textureStreamer->addImage(normalized, *image);
+
+        if (!image)
+            image = mWarningImage;
+        mCache->addEntryToObjectCache(normalized, image);
+        return image;
+    }
+
+    osg::ref_ptr<osg::Image> ImageManager::loadImage(const std::string &normalized)
+    {
+        std::string ext = getExtension(normalized);
+
+        // decoded images of formats that are slow to decode are stored on disk, keyed by where the encoded file is stored
+        osg::ref_ptr<ImageCache> imageCache = mImageCache;
+        std::string cacheKey;
+        if (imageCache && isSlowToDecode(ext))
+        {
+            std::string stamp = mVFS->getStamp(normalized);
+            if (!stamp.empty())
             {
-                static bool uncompress = (getenv("OPENMW_DECOMPRESS_TEXTURES") != 0);
-                if (!uncompress)
-                {
-                    Log(Debug::Error) << "Error loading " << filename << ": no S3TC texture compression support installed";
-                    mCache->addEntryToObjectCache(normalized, mWarningImage);
-                    return mWarningImage;
-                }
-                else
+                cacheKey = ImageCache::getKey(stamp);
+
+                osg::ref_ptr<osg::Image> cached = imageCache->load(cacheKey);
+                if (cached)
                 {
-                    // decompress texture in software if not supported by GPU
-                    // requires update to getColor() to be released with OSG 3.6
-                    osg::ref_ptr<osg::Image> newImage = new osg::Image;
-                    newImage->setFileName(image->getFileName());
-                    newImage->allocateImage(image->s(), image->t(), image->r(), image->isImageTranslucent() ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE);
-                    for (int s=0; s<image->s(); ++s)
-                        for (int t=0; t<image->t(); ++t)
-                            for (int r=0; r<image->r(); ++r)
-                                newImage->setColor(image->getColor(s,t,r), s,t,r);
-                    image = newImage;
+                    cached->setFileName(normalized);
+                    return cached;
                 }
             }
+        }
 
-            mCache->addEntryToObjectCache(normalized, image);
-            return image;
+        Files::IStreamPtr stream;
+        try
+        {
+            stream = mVFS->get(normalized.c_str());
         }
+        catch (std::exception& e)
+        {
+            Log(Debug::Error) << "Failed to open image: " << e.what();
+            return nullptr;
+        }
+
+        osgDB::ReaderWriter* reader = osgDB::Registry::instance()->getReaderWriterForExtension(ext);
+        if (!reader)
+        {
+            Log(Debug::Error) << "Error loading " << normalized << ": no readerwriter for '" << ext << "' found";
+            return nullptr;
+        }
+
+        osgDB::ReaderWriter::ReadResult result = reader->readImage(*stream, mOptions);
+        if (!result.success())
+        {
+            Log(Debug::Error) << "Error loading " << normalized << ": " << result.message() << " code " << result.status();
+            return nullptr;
+        }
+
+        osg::ref_ptr<osg::Image> image = result.getImage();
+
+        image->setFileName(normalized);
+        if (!checkSupported(image, normalized))
+        {
+            static bool uncompress = (getenv("OPENMW_DECOMPRESS_TEXTURES") != 0);
+            if (!uncompress)
+            {
+                Log(Debug::Error) << "Error loading " << normalized << ": no S3TC texture compression support installed";
+                return nullptr;
+            }
+            else
+            {
+                // decompress texture in software if not supported by GPU
+                // requires update to getColor() to be released with OSG 3.6
+                osg::ref_ptr<osg::Image> newImage = new osg::Image;
+                newImage->setFileName(image->getFileName());
+                newImage->allocateImage(image->s(), image->t(), image->r(), image->isImageTranslucent() ? GL_RGBA : GL_RGB, GL_UNSIGNED_BYTE);
+                for (int s=0; s<image->s(); ++s)
+                    for (int t=0; t<image->t(); ++t)
+                        for (int r=0; r<image->r(); ++r)
+                            newImage->setColor(image->getColor(s,t,r), s,t,r);
+                image = newImage;
+            }
+        }
+
+        if (!cacheKey.empty())
+            imageCache->save(cacheKey, *image);
+
+        return image;
     }
 
     osg::Image *ImageManager::getWarningImage()
@@ -160,6 +357,26 @@ namespace Resource
         return mWarningImage;
     }
 
+    void ImageManager::setTextureStreamer(TextureStreamer *textureStreamer)
+    {
+        mTextureStreamer = textureStreamer;
+    }
+
+    TextureStreamer *ImageManager::getTextureStreamer()
+    {
+        return mTextureStreamer.get();
+    }
+
+    void ImageManager::setImageCache(ImageCache *imageCache)
+    {
+        mImageCache = imageCache;
+    }
+
+    void ImageManager::setDecodeWorkQueue(SceneUtil::WorkQueue *workQueue)
+    {
+        mDecodeWorkQueue = workQueue;
+    }
+
     void ImageManager::reportStats(unsigned int frameNumber, osg::Stats *stats) const
     {
         stats->setAttribute(frameNumber, "Image", mCache->getCacheSize());
@@ -3,6 +3,11 @@
 
 #include <string>
 #include <map>
+#include <set>
+#include <vector>
+
+#include <OpenThreads/Mutex>
+#include <OpenThreads/Condition>
 
 #include <osg/ref_ptr>
 #include <osg/Image>
@@ -15,8 +20,19 @@ namespace osgDB
     class Options;
 }
 
+namespace SceneUtil
+{
+    class WorkItem;
+    class WorkQueue;
+}
+
 namespace Resource
 {
+    class ImageCache;
+    class TextureStreamer;
+
+    /// @return Whether the graphics driver supports the pixel format of the image.
+    bool checkSupported(osg::Image* image, const std::string& filename);
 
     /// @brief Handles loading/caching of Images.
     /// @note May be used from any thread.
@@ -28,15 +44,53 @@ namespace Resource
 
         /// Create or retrieve an Image
         /// Returns the dummy image if the given image is not found.
+        /// @note If another thread is decoding the same image, waits for it instead of decoding it again.
         osg::ref_ptr<osg::Image> getImage(const std::string& filename);
 
+        /// Decode the images of formats that are slow to decode in batches on the decode work queue, so that getImage
+        /// finds them in the cache later on. Other images are left to be loaded when they are used.
+        /// @return The work items, they keep the decoded images referenced until they are destroyed. Empty if there is no
+        /// decode work queue.
+        std::vector<osg::ref_ptr<SceneUtil::WorkItem> > decodeImages(const std::vector<std::string>& filenames);
+
+        /// Create or retrieve an Image for a texture whose mip levels may be streamed, see TextureStreamer.
+        /// Behaves like getImage if texture streaming is disabled or the image is not suitable for it.
+        osg::ref_ptr<osg::Image> getStreamedImage(const std::string& filename);
+
+        /// Load an Image without caching it.
+        /// @param normalized The normalized filename.
+        /// @return nullptr if the image could not be loaded.
+        osg::ref_ptr<osg::Image> loadImage(const std::string& normalized);
+
         osg::Image* getWarningImage();
 
+        /// @param textureStreamer nullptr to disable texture streaming.
+        void setTextureStreamer(TextureStreamer* textureStreamer);
+        TextureStreamer* getTextureStreamer();
+
+        /// Store decoded images of formats that are slow to decode on disk.
+        /// @param imageCache nullptr to disable the cache.
+        void setImageCache(ImageCache* imageCache);
+
+        /// @param workQueue The threads used by decodeImages, nullptr to disable it.
+        /// @note Not thread safe.
+        void setDecodeWorkQueue(SceneUtil::WorkQueue* workQueue);
+
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const;
 
     private:
         osg::ref_ptr<osg::Image> mWarningImage;
         osg::ref_ptr<osgDB::Options> mOptions;
+        osg::ref_ptr<TextureStreamer> mTextureStreamer;
+        osg::ref_ptr<ImageCache> mImageCache;
+
+        // the images that are being decoded right now
+        std::set<std::string> mDecoding;
+        OpenThreads::Mutex mDecodingMutex;
+        OpenThreads::Condition mDecodingCondition;
+
+        // declared last, so that its threads are finished before anything they use is destroyed
+        osg::ref_ptr<SceneUtil::WorkQueue> mDecodeWorkQueue;
 
         ImageManager(const ImageManager&);
         void operator = (const ImageManager&);
@@ -111,6 +111,25 @@ class GenericObjectCache : public osg::Referenced
             if (itr!=_objectCache.end()) _objectCache.erase(itr);
         }
 
+        /** Remove all Objects whose key matches the predicate, return the number of removed Objects.*/
+        template <class Predicate>
+        unsigned int removeFromObjectCacheIf(Predicate predicate)
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
+            unsigned int removed = 0;
+            for (typename ObjectCacheMap::iterator itr = _objectCache.begin(); itr != _objectCache.end(); )
+            {
+                if (predicate(itr->first))
+                {
+                    _objectCache.erase(itr++);
+                    ++removed;
+                }
+                else
+                    ++itr;
+            }
+            return removed;
+        }
+
         /** Get an ref_ptr<Object> from the object cache*/
         osg::ref_ptr<osg::Object> getRefFromObjectCache(const KeyType& key)
         {
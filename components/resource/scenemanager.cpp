@@ -16,6 +16,9 @@
 
 #include <components/nifosg/nifloader.hpp>
 #include <components/nif/niffile.hpp>
+#include <components/nif/controlled.hpp>
+
+#include <components/misc/resourcehelpers.hpp>
 
 #include <components/misc/stringops.hpp>
 
@@ -33,6 +36,7 @@
 #include "niffilemanager.hpp"
 #include "objectcache.hpp"
 #include "multiobjectcache.hpp"
+#include "texturestreamer.hpp"
 
 namespace
 {
@@ -529,6 +533,10 @@ namespace Resource
                 optimizer.optimize(loaded, options);
             }
 
+            TextureStreamer* textureStreamer = mImageManager->getTextureStreamer();
+            if (textureStreamer)
+                textureStreamer->addCullCallback(loaded);
+
             if (mIncrementalCompileOperation)
                 mIncrementalCompileOperation->add(loaded);
             else
@@ -539,6 +547,35 @@ namespace Resource
         }
     }
 
+    void SceneManager::getTextures(const std::string &name, std::vector<std::string> &out)
+    {
+        std::string normalized = name;
+        mVFS->normalizeFilename(normalized);
+
+        size_t extPos = normalized.find_last_of('.');
+        if (extPos == std::string::npos || normalized.compare(extPos+1, std::string::npos, "nif") != 0)
+            return;
+
+        try
+        {
+            Nif::NIFFilePtr file = mNifFileManager->get(normalized);
+            for (size_t i=0; i<file->numRecords(); ++i)
+            {
+                const Nif::Record* record = file->getRecord(i);
+                if (!record || record->recType != Nif::RC_NiSourceTexture)
+                    continue;
+
+                // same as NifOsg::Loader, which only uses the file name if the texture has no internal data
+                const Nif::NiSourceTexture* sourceTexture = static_cast<const Nif::NiSourceTexture*>(record);
+                if ((sourceTexture->external || sourceTexture->data.empty()) && !sourceTexture->filename.empty())
+                    out.push_back(Misc::ResourceHelpers::correctTexturePath(sourceTexture->filename, mVFS));
+            }
+        }
+        catch (std::exception&)
+        {
+        }
+    }
+
     osg::ref_ptr<osg::Node> SceneManager::cacheInstance(const std::string &name)
     {
         std::string normalized = name;
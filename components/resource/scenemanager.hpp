@@ -4,6 +4,7 @@
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
 
 #include <osg/ref_ptr>
 #include <osg/Node>
@@ -83,6 +84,11 @@ namespace Resource
         /// @note Thread safe.
         osg::ref_ptr<const osg::Node> getTemplate(const std::string& name);
 
+        /// List the external textures of a NIF file, e.g. to decode them before the file is loaded.
+        /// @note Errors are ignored here, they are reported when the file is loaded.
+        /// @note Thread safe.
+        void getTextures(const std::string& name, std::vector<std::string>& out);
+
         /// Create an instance of the given scene template and cache it for later use, so that future calls to getInstance() can simply
         /// return this cached object instead of creating a new one.
         /// @note The returned ref_ptr may be kept around by the caller to ensure that the object stays in cache for as long as needed.
@@ -286,12 +286,27 @@ void StatsHandler::setUpScene(osgViewer::ViewerBase *viewer)
             "Keyframe",
             "",
             "Terrain Chunk",
+            "Object Chunk",
             "Terrain Texture",
             "Land",
             "Composite",
             "",
+            "Occluder",
+            "Occluded",
+            "",
+            "Streamed Image",
+            "Streamed Upgraded",
+            "Streamed MB",
+            "",
             "UnrefQueue",
             "",
+            "Local Scripts",
+            "Deferred Scripts",
+            "Slow Scripts",
+            "",
+            "GUI Render Items",
+            "GUI Draw Calls",
+            "",
             "NavMesh UpdateJobs",
             "NavMesh CacheSize",
             "NavMesh UsedTiles",
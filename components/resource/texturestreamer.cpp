@@ -0,0 +1,517 @@
+#include "texturestreamer.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <osg/NodeCallback>
+#include <osg/NodeVisitor>
+#include <osg/Stats>
+
+#include <osgUtil/CullVisitor>
+
+#include <components/debug/debuglog.hpp>
+#include <components/sceneutil/workqueue.hpp>
+#include <components/vfs/manager.hpp>
+
+#include "ddsmiplevels.hpp"
+#include "imagemanager.hpp"
+
+namespace
+{
+
+    // the draw traversals that may still use a replaced image
+    const unsigned int sRetireFrames = 3;
+
+    const unsigned int sMaxLoading = 4;
+
+    const unsigned int sPruneInterval = 300;
+
+    unsigned int getLargestDimension(const osg::Image& image)
+    {
+        return static_cast<unsigned int>(std::max(image.s(), image.t()));
+    }
+
+    class CollectTexturesVisitor : public osg::NodeVisitor
+    {
+    public:
+        CollectTexturesVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+        {
+        }
+
+        virtual void apply(osg::Node& node)
+        {
+            osg::StateSet* stateset = node.getStateSet();
+            if (stateset)
+                applyStateSet(stateset);
+
+            traverse(node);
+        }
+
+        void applyStateSet(osg::StateSet* stateset)
+        {
+            const osg::StateSet::TextureAttributeList& texAttributes = stateset->getTextureAttributeList();
+            for(unsigned int unit=0;unit<texAttributes.size();++unit)
+            {
+                osg::Texture2D* texture = dynamic_cast<osg::Texture2D*>(stateset->getTextureAttribute(unit, osg::StateAttribute::TEXTURE));
+                if (texture && texture->getImage())
+                    mTextures.push_back(std::make_pair(stateset, texture));
+            }
+        }
+
+        std::vector<std::pair<osg::StateSet*, osg::Texture2D*> > mTextures;
+    };
+
+    class StreamingCullCallback : public osg::NodeCallback
+    {
+    public:
+        StreamingCullCallback(Resource::TextureStreamer* textureStreamer, osg::Camera* camera,
+                              const std::vector<osg::ref_ptr<Resource::TextureStreamer::StreamedImage> >& images)
+            : mTextureStreamer(textureStreamer)
+            , mCamera(camera)
+            , mImages(images)
+        {
+        }
+
+        virtual void operator()(osg::Node* node, osg::NodeVisitor* nv)
+        {
+            osgUtil::CullVisitor* cv = static_cast<osgUtil::CullVisitor*>(nv);
+            if (cv->getCurrentCamera() == mCamera && nv->getFrameStamp())
+            {
+                // the textures are assumed to cover the object about once
+                float size = 2.f * cv->clampedPixelSize(node->getBound());
+                mTextureStreamer->request(mImages, size, nv->getFrameStamp()->getFrameNumber());
+            }
+
+            traverse(node, nv);
+        }
+
+    private:
+        osg::ref_ptr<Resource::TextureStreamer> mTextureStreamer;
+        osg::Camera* mCamera;
+        std::vector<osg::ref_ptr<Resource::TextureStreamer::StreamedImage> > mImages;
+    };
+
+    class LoadMipLevelsWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        LoadMipLevelsWorkItem(Resource::TextureStreamer* textureStreamer, Resource::TextureStreamer::StreamedImage* image, unsigned int level)
+            : mTextureStreamer(textureStreamer)
+            , mImage(image)
+            , mLevel(level)
+        {
+        }
+
+        virtual void doWork()
+        {
+            mTextureStreamer->onLoaded(mImage, mLevel, mTextureStreamer->loadMipLevels(*mImage, mLevel));
+        }
+
+    private:
+        osg::ref_ptr<Resource::TextureStreamer> mTextureStreamer;
+        osg::ref_ptr<Resource::TextureStreamer::StreamedImage> mImage;
+        unsigned int mLevel;
+    };
+
+}
+
+namespace Resource
+{
+
+    TextureStreamer::TextureStreamer(ImageManager* imageManager, SceneUtil::WorkQueue* workQueue, osg::Camera* camera, unsigned int baseSize, std::size_t budget)
+        : mImageManager(imageManager)
+        , mWorkQueue(workQueue)
+        , mCamera(camera)
+        , mBaseSize(std::max(baseSize, 1u))
+        , mBudget(budget)
+        , mResidentSize(0)
+        , mReservedSize(0)
+        , mNumLoading(0)
+        , mNumUpgraded(0)
+        , mFrameNumber(0)
+    {
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+    }
+
+    bool TextureStreamer::canStream(const osg::Image& image) const
+    {
+        if (image.r() != 1 || !image.data() || !image.isMipmap())
+            return false;
+
+        return canStream(image.s(), image.t(), image.getNumMipmapLevels());
+    }
+
+    bool TextureStreamer::canStream(unsigned int width, unsigned int height, unsigned int numLevels) const
+    {
+        unsigned int size = std::max(width, height);
+        if (size <= mBaseSize)
+            return false;
+
+        return getBaseLevel(size) < numLevels;
+    }
+
+    unsigned int TextureStreamer::getBaseLevel(unsigned int fullSize) const
+    {
+        unsigned int baseLevel = 0;
+        while ((fullSize >> baseLevel) > mBaseSize)
+            ++baseLevel;
+        return baseLevel;
+    }
+
+    osg::ref_ptr<osg::Image> TextureStreamer::addImage(const std::string& normalized, const osg::Image& image)
+    {
+        unsigned int fullSize = getLargestDimension(image);
+        unsigned int baseLevel = getBaseLevel(fullSize);
+        return addLevels(normalized, fullSize, baseLevel, getMipLevels(image, baseLevel));
+    }
+
+    osg::ref_ptr<osg::Image> TextureStreamer::loadImage(const std::string& normalized)
+    {
+        DdsMipLevels dds;
+        osg::ref_ptr<osg::Image> data;
+        try
+        {
+            Files::IStreamPtr stream = mImageManager->getVFS()->get(normalized);
+            if (!dds.readHeader(*stream) || !canStream(dds.getWidth(), dds.getHeight(), dds.getNumLevels()))
+                return nullptr;
+
+            data = dds.readLevels(*stream, getBaseLevel(std::max(dds.getWidth(), dds.getHeight())));
+        }
+        catch (std::exception&)
+        {
+            // the caller reports the error when loading the file in full
+            return nullptr;
+        }
+
+        if (!data || !checkSupported(data, normalized))
+            return nullptr;
+
+        data->setFileName(normalized);
+        unsigned int fullSize = std::max(dds.getWidth(), dds.getHeight());
+        return addLevels(normalized, fullSize, getBaseLevel(fullSize), data);
+    }
+
+    osg::ref_ptr<osg::Image> TextureStreamer::loadMipLevels(const StreamedImage& image, unsigned int level)
+    {
+        try
+        {
+            Files::IStreamPtr stream = mImageManager->getVFS()->get(image.mFileName);
+            DdsMipLevels dds;
+            if (dds.readHeader(*stream))
+            {
+                // the file may have been replaced by a different one since
+                if (std::max(dds.getWidth(), dds.getHeight()) != image.mFullSize)
+                    return nullptr;
+
+                osg::ref_ptr<osg::Image> data = dds.readLevels(*stream, level);
+                if (data)
+                    data->setFileName(image.mFileName);
+                return data;
+            }
+        }
+        catch (std::exception& e)
+        {
+            Log(Debug::Error) << "Failed to load the mip levels of " << image.mFileName << ": " << e.what();
+            return nullptr;
+        }
+
+        // other files are loaded in full
+        osg::ref_ptr<osg::Image> full = mImageManager->loadImage(image.mFileName);
+        if (!full || getLargestDimension(*full) != image.mFullSize || level >= full->getNumMipmapLevels())
+            return nullptr;
+        return getMipLevels(*full, level);
+    }
+
+    osg::ref_ptr<osg::Image> TextureStreamer::addLevels(const std::string& normalized, unsigned int fullSize, unsigned int baseLevel,
+                                                        osg::ref_ptr<osg::Image> data)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+
+        // another thread may have loaded the same file in the meantime
+        std::map<std::string, osg::ref_ptr<StreamedImage> >::const_iterator found = mImages.find(normalized);
+        if (found != mImages.end())
+            return found->second->mImage;
+
+        osg::ref_ptr<StreamedImage> streamedImage (new StreamedImage);
+        streamedImage->mFileName = normalized;
+        streamedImage->mFullSize = fullSize;
+        streamedImage->mBaseLevel = baseLevel;
+        streamedImage->mImage = data;
+        streamedImage->mLevel = baseLevel;
+        streamedImage->mRequestedLevel = baseLevel;
+        streamedImage->mRequestedSize = 0.f;
+        streamedImage->mLastRequested = 0;
+        streamedImage->mLoading = false;
+        streamedImage->mReservedSize = 0;
+
+        mImages[normalized] = streamedImage;
+        mResidentSize += data->getTotalSizeInBytesIncludingMipmaps();
+        return data;
+    }
+
+    osg::ref_ptr<osg::Image> TextureStreamer::getImage(const std::string& normalized)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        std::map<std::string, osg::ref_ptr<StreamedImage> >::const_iterator found = mImages.find(normalized);
+        if (found == mImages.end())
+            return nullptr;
+        return found->second->mImage;
+    }
+
+    osg::ref_ptr<TextureStreamer::StreamedImage> TextureStreamer::getStreamedImage(const std::string& normalized)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        std::map<std::string, osg::ref_ptr<StreamedImage> >::const_iterator found = mImages.find(normalized);
+        if (found == mImages.end())
+            return nullptr;
+        return found->second;
+    }
+
+    void TextureStreamer::addCullCallback(osg::Node* node)
+    {
+        CollectTexturesVisitor visitor;
+        node->accept(visitor);
+
+        std::vector<osg::ref_ptr<StreamedImage> > images;
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            for (std::vector<std::pair<osg::StateSet*, osg::Texture2D*> >::const_iterator it = visitor.mTextures.begin(); it != visitor.mTextures.end(); ++it)
+            {
+                osg::Texture2D* texture = it->second;
+                std::map<std::string, osg::ref_ptr<StreamedImage> >::const_iterator found = mImages.find(texture->getImage()->getFileName());
+                if (found == mImages.end())
+                    continue;
+
+                // update() replaces the image of the texture, so the viewer has to finish drawing the StateSet first.
+                // Shared StateSets that are in use already were made DYNAMIC when they were added.
+                if (it->first->getDataVariance() != osg::Object::DYNAMIC)
+                    it->first->setDataVariance(osg::Object::DYNAMIC);
+
+                StreamedImage* image = found->second;
+                bool registered = false;
+                for (std::vector<osg::observer_ptr<osg::Texture2D> >::const_iterator registeredTexture = image->mTextures.begin();
+                     registeredTexture != image->mTextures.end(); ++registeredTexture)
+                    registered |= (*registeredTexture == texture);
+                if (!registered)
+                {
+                    // the level may have changed since the texture was created, the subgraph is not in use yet
+                    if (texture->getImage() != image->mImage)
+                    {
+                        texture->setImage(image->mImage);
+                        texture->setTextureSize(image->mImage->s(), image->mImage->t());
+                    }
+                    image->mTextures.push_back(texture);
+                }
+
+                if (std::find(images.begin(), images.end(), image) == images.end())
+                    images.push_back(image);
+            }
+        }
+
+        if (!images.empty())
+            node->addCullCallback(new StreamingCullCallback(this, mCamera, images));
+    }
+
+    unsigned int TextureStreamer::getLevel(const StreamedImage& image, float size)
+    {
+        // the smallest level that still has as many texels as the size on screen
+        unsigned int level = 0;
+        while (level < image.mBaseLevel && static_cast<float>(image.mFullSize >> (level+1)) >= size)
+            ++level;
+        return level;
+    }
+
+    void TextureStreamer::request(const std::vector<osg::ref_ptr<StreamedImage> >& images, float size, unsigned int frameNumber)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        for (std::vector<osg::ref_ptr<StreamedImage> >::const_iterator it = images.begin(); it != images.end(); ++it)
+        {
+            StreamedImage& image = **it;
+            unsigned int level = getLevel(image, size);
+            if (image.mLastRequested != frameNumber)
+            {
+                image.mLastRequested = frameNumber;
+                image.mRequestedLevel = level;
+                image.mRequestedSize = size;
+            }
+            else
+            {
+                image.mRequestedLevel = std::min(image.mRequestedLevel, level);
+                image.mRequestedSize = std::max(image.mRequestedSize, size);
+            }
+        }
+    }
+
+    void TextureStreamer::onLoaded(StreamedImage* image, unsigned int level, osg::ref_ptr<osg::Image> data)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        LoadedLevel loaded;
+        loaded.mImage = image;
+        loaded.mLevel = level;
+        loaded.mData = data;
+        mLoaded.push_back(loaded);
+    }
+
+    std::size_t TextureStreamer::getSize(const StreamedImage& image, unsigned int level) const
+    {
+        // every level has a quarter of the texels of the one above
+        std::size_t size = image.mImage->getTotalSizeInBytesIncludingMipmaps();
+        if (level < image.mLevel)
+            return size << (2 * (image.mLevel - level));
+        return size >> (2 * (level - image.mLevel));
+    }
+
+    void TextureStreamer::setLevel(StreamedImage& image, unsigned int level, osg::ref_ptr<osg::Image> data)
+    {
+        mResidentSize -= image.mImage->getTotalSizeInBytesIncludingMipmaps();
+        mResidentSize += data->getTotalSizeInBytesIncludingMipmaps();
+        mRetired.push_back(std::make_pair(mFrameNumber, image.mImage));
+
+        // the textures only upload a new image if its modified count differs from the one they last uploaded
+        data->dirty();
+
+        image.mImage = data;
+        image.mLevel = level;
+
+        for (std::vector<osg::observer_ptr<osg::Texture2D> >::iterator it = image.mTextures.begin(); it != image.mTextures.end();)
+        {
+            osg::ref_ptr<osg::Texture2D> texture;
+            if (!it->lock(texture))
+            {
+                it = image.mTextures.erase(it);
+                continue;
+            }
+            texture->setImage(data);
+            texture->setTextureSize(data->s(), data->t());
+            ++it;
+        }
+    }
+
+    void TextureStreamer::reduce(StreamedImage& image)
+    {
+        bool visible = image.mLastRequested + 1 >= mFrameNumber;
+        unsigned int level = visible ? image.mRequestedLevel : image.mBaseLevel;
+        if (level <= image.mLevel)
+            return;
+
+        // the coarser levels are already in memory
+        setLevel(image, level, getMipLevels(*image.mImage, level - image.mLevel));
+    }
+
+    void TextureStreamer::update(unsigned int frameNumber)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        mFrameNumber = frameNumber;
+
+        for (std::vector<std::pair<unsigned int, osg::ref_ptr<osg::Image> > >::iterator it = mRetired.begin(); it != mRetired.end();)
+        {
+            if (it->first + sRetireFrames < frameNumber)
+                it = mRetired.erase(it);
+            else
+                ++it;
+        }
+
+        for (std::vector<LoadedLevel>::const_iterator it = mLoaded.begin(); it != mLoaded.end(); ++it)
+        {
+            StreamedImage& image = *it->mImage;
+            image.mLoading = false;
+            mReservedSize -= image.mReservedSize;
+            image.mReservedSize = 0;
+            --mNumLoading;
+
+            if (it->mData && it->mLevel < image.mLevel)
+                setLevel(image, it->mLevel, it->mData);
+        }
+        mLoaded.clear();
+
+        bool prune = frameNumber % sPruneInterval == 0;
+
+        // the requests were made by the cull traversal of the previous frame
+        std::vector<StreamedImage*> upgrades;
+        std::vector<StreamedImage*> reducible;
+        mNumUpgraded = 0;
+        for (std::map<std::string, osg::ref_ptr<StreamedImage> >::iterator it = mImages.begin(); it != mImages.end();)
+        {
+            StreamedImage& image = *it->second;
+
+            if (prune && !image.mLoading && image.mImage->referenceCount() == 1 && it->second->referenceCount() == 1)
+            {
+                mResidentSize -= image.mImage->getTotalSizeInBytesIncludingMipmaps();
+                it = mImages.erase(it);
+                continue;
+            }
+
+            bool visible = image.mLastRequested + 1 >= frameNumber;
+            unsigned int level = visible ? image.mRequestedLevel : image.mBaseLevel;
+            if (level < image.mLevel && !image.mLoading)
+                upgrades.push_back(&image);
+            else if (level > image.mLevel)
+                reducible.push_back(&image);
+
+            if (image.mLevel < image.mBaseLevel)
+                ++mNumUpgraded;
+            ++it;
+        }
+
+        if (upgrades.empty())
+            return;
+
+        std::sort(upgrades.begin(), upgrades.end(), [] (const StreamedImage* left, const StreamedImage* right) {
+            return left->mRequestedSize > right->mRequestedSize;
+        });
+        std::sort(reducible.begin(), reducible.end(), [] (const StreamedImage* left, const StreamedImage* right) {
+            return left->mLastRequested < right->mLastRequested;
+        });
+
+        std::vector<StreamedImage*>::iterator nextReducible = reducible.begin();
+        for (std::vector<StreamedImage*>::iterator it = upgrades.begin(); it != upgrades.end() && mNumLoading < sMaxLoading; ++it)
+        {
+            StreamedImage& image = **it;
+            std::size_t cost = getSize(image, image.mRequestedLevel) - getSize(image, image.mLevel);
+            while (mResidentSize + mReservedSize + cost > mBudget && nextReducible != reducible.end())
+                reduce(**nextReducible++);
+            if (mResidentSize + mReservedSize + cost > mBudget)
+                break;
+
+            image.mLoading = true;
+            image.mReservedSize = cost;
+            mReservedSize += cost;
+            ++mNumLoading;
+            mWorkQueue->addWorkItem(new LoadMipLevelsWorkItem(this, &image, image.mRequestedLevel));
+        }
+    }
+
+    void TextureStreamer::reportStats(unsigned int frameNumber, osg::Stats* stats) const
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        stats->setAttribute(frameNumber, "Streamed Image", mImages.size());
+        stats->setAttribute(frameNumber, "Streamed Upgraded", mNumUpgraded);
+        stats->setAttribute(frameNumber, "Streamed MB", mResidentSize / (1024 * 1024));
+    }
+
+    osg::ref_ptr<osg::Image> TextureStreamer::getMipLevels(const osg::Image& image, unsigned int level)
+    {
+        unsigned int numLevels = image.getNumMipmapLevels();
+        unsigned int offset = image.getMipmapOffset(level);
+        unsigned int size = image.getTotalSizeInBytesIncludingMipmaps() - offset;
+
+        unsigned char* data = new unsigned char[size];
+        std::memcpy(data, image.data() + offset, size);
+
+        osg::Image::MipmapDataType mipmaps;
+        for (unsigned int i=level+1; i<numLevels; ++i)
+            mipmaps.push_back(image.getMipmapOffset(i) - offset);
+
+        osg::ref_ptr<osg::Image> result (new osg::Image);
+        result->setFileName(image.getFileName());
+        result->setImage(std::max(1, image.s() >> level), std::max(1, image.t() >> level), 1, image.getInternalTextureFormat(),
+                         image.getPixelFormat(), image.getDataType(), data, osg::Image::USE_NEW_DELETE, image.getPacking());
+        result->setMipmapLevels(mipmaps);
+        result->setOrigin(image.getOrigin());
+        return result;
+    }
+
+}
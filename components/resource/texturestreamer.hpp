@@ -0,0 +1,170 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_TEXTURESTREAMER_H
+#define OPENMW_COMPONENTS_RESOURCE_TEXTURESTREAMER_H
+
+#include <string>
+#include <map>
+#include <vector>
+
+#include <OpenThreads/Mutex>
+
+#include <osg/ref_ptr>
+#include <osg/observer_ptr>
+#include <osg/Referenced>
+#include <osg/Image>
+#include <osg/Texture2D>
+
+namespace osg
+{
+    class Camera;
+    class Node;
+    class Stats;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
+namespace Resource
+{
+    class ImageManager;
+
+    /// @brief Streams the mip levels of large textures, based on how large the objects using them appear on screen.
+    /// @par Streamed images only keep their mip levels up to a base size when they are first loaded. Cull callbacks report
+    /// the screen space size of the objects using them, and the larger levels are loaded in the background when needed.
+    /// @par The total size of the streamed images is limited by a budget. When an upgrade would exceed it, the textures that
+    /// were not seen for the longest time are reduced to their base levels, and the visible ones to the levels they need.
+    /// @par The statesets using streamed textures are made DYNAMIC, so that the viewer has finished drawing them when the
+    /// rendering traversals return. update() changes the textures and must be called outside of the rendering traversals.
+    /// @note May be used from any thread, except for update().
+    class TextureStreamer : public osg::Referenced
+    {
+    public:
+        /// @brief The state of a streamed file, shared by the textures using it.
+        struct StreamedImage : public osg::Referenced
+        {
+            std::string mFileName;
+            // the largest dimension of the full image
+            unsigned int mFullSize;
+            unsigned int mBaseLevel;
+
+            osg::ref_ptr<osg::Image> mImage;
+            unsigned int mLevel;
+
+            // the finest level and largest size requested in the frame mLastRequested
+            unsigned int mRequestedLevel;
+            float mRequestedSize;
+            unsigned int mLastRequested;
+
+            bool mLoading;
+            // the size a level that is being loaded will add to the resident size
+            std::size_t mReservedSize;
+
+            std::vector<osg::observer_ptr<osg::Texture2D> > mTextures;
+        };
+
+        /// @param workQueue Used to load the levels. Must outlive the calls to update().
+        /// @param camera Only the cull traversals of this camera request levels.
+        /// @param baseSize Largest dimension of the mip levels that are loaded up front.
+        /// @param budget Maximum total size of the streamed images in bytes.
+        TextureStreamer(ImageManager* imageManager, SceneUtil::WorkQueue* workQueue, osg::Camera* camera, unsigned int baseSize, std::size_t budget);
+        ~TextureStreamer();
+
+        /// @return Whether the mip levels of the image can be streamed, i.e. it is a 2D image larger than the base size
+        /// with mip levels down to it.
+        bool canStream(const osg::Image& image) const;
+
+        /// @return Whether the mip levels of a 2D image of this size can be streamed.
+        bool canStream(unsigned int width, unsigned int height, unsigned int numLevels) const;
+
+        /// Start streaming an image.
+        /// @param normalized The normalized filename.
+        /// @param image The image with all of its mip levels.
+        /// @return The image to create textures with.
+        osg::ref_ptr<osg::Image> addImage(const std::string& normalized, const osg::Image& image);
+
+        /// Start streaming a DDS file, only reading its levels up to the base size.
+        /// @param normalized The normalized filename.
+        /// @return The image to create textures with, nullptr if the file is not a DDS file that can be streamed this way.
+        osg::ref_ptr<osg::Image> loadImage(const std::string& normalized);
+
+        /// Load the levels of a streamed image starting at \a level. Only these levels are read from DDS files.
+        /// @return nullptr if the levels could not be loaded.
+        /// @note Called by the work items that load levels.
+        osg::ref_ptr<osg::Image> loadMipLevels(const StreamedImage& image, unsigned int level);
+
+        /// @param normalized The normalized filename.
+        /// @return The current image of a streamed file, nullptr if the file is not streamed.
+        osg::ref_ptr<osg::Image> getImage(const std::string& normalized);
+
+        /// @param normalized The normalized filename.
+        /// @return The state of a streamed file, nullptr if the file is not streamed.
+        osg::ref_ptr<StreamedImage> getStreamedImage(const std::string& normalized);
+
+        /// Find the textures with streamed images in a subgraph, and add a cull callback to \a node that requests their levels.
+        void addCullCallback(osg::Node* node);
+
+        /// Apply the loaded levels, reduce textures if over budget, and start loading the requested levels.
+        /// @note Call from the main thread, once per frame, outside of the rendering traversals.
+        void update(unsigned int frameNumber);
+
+        void reportStats(unsigned int frameNumber, osg::Stats* stats) const;
+
+        /// Request the mip level of a streamed image needed for a size on screen.
+        /// @param size The size in pixels.
+        void request(const std::vector<osg::ref_ptr<StreamedImage> >& images, float size, unsigned int frameNumber);
+
+        /// @note Called by the work items that load levels.
+        void onLoaded(StreamedImage* image, unsigned int level, osg::ref_ptr<osg::Image> data);
+
+        ImageManager* getImageManager() { return mImageManager; }
+
+        /// @return A copy of the mip levels of \a image starting at \a level.
+        static osg::ref_ptr<osg::Image> getMipLevels(const osg::Image& image, unsigned int level);
+
+        /// @return The coarsest level of \a image that has at least as many texels as \a size, but no coarser than its base level.
+        static unsigned int getLevel(const StreamedImage& image, float size);
+
+    private:
+        unsigned int getBaseLevel(unsigned int fullSize) const;
+
+        osg::ref_ptr<osg::Image> addLevels(const std::string& normalized, unsigned int fullSize, unsigned int baseLevel,
+                                           osg::ref_ptr<osg::Image> data);
+
+        void setLevel(StreamedImage& image, unsigned int level, osg::ref_ptr<osg::Image> data);
+
+        /// Reduce an image that is not needed at its current level.
+        void reduce(StreamedImage& image);
+
+        std::size_t getSize(const StreamedImage& image, unsigned int level) const;
+
+        ImageManager* mImageManager;
+        SceneUtil::WorkQueue* mWorkQueue;
+        osg::Camera* mCamera;
+        unsigned int mBaseSize;
+        std::size_t mBudget;
+
+        mutable OpenThreads::Mutex mMutex;
+        std::map<std::string, osg::ref_ptr<StreamedImage> > mImages;
+
+        struct LoadedLevel
+        {
+            osg::ref_ptr<StreamedImage> mImage;
+            unsigned int mLevel;
+            osg::ref_ptr<osg::Image> mData;
+        };
+        std::vector<LoadedLevel> mLoaded;
+
+        // replaced images stay referenced for a few frames, as the draw traversal of the previous frame may still use them
+        std::vector<std::pair<unsigned int, osg::ref_ptr<osg::Image> > > mRetired;
+
+        std::size_t mResidentSize;
+        std::size_t mReservedSize;
+        unsigned int mNumLoading;
+        unsigned int mNumUpgraded;
+        unsigned int mFrameNumber;
+    };
+
+}
+
+#endif
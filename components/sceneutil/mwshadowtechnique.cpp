@@ -19,11 +19,17 @@
 #include "mwshadowtechnique.hpp"
 
 #include <osgShadow/ShadowedScene>
+#include <osg/ComputeBoundsVisitor>
 #include <osg/CullFace>
 #include <osg/Geometry>
 #include <osg/io_utils>
 
+#include <algorithm>
 #include <sstream>
+#include <typeinfo>
+
+#include "lightmanager.hpp"
+#include "util.hpp"
 
 namespace {
 
@@ -32,6 +38,9 @@ using namespace SceneUtil;
 
 #define dbl_max std::numeric_limits<double>::max()
 
+// how much larger than the volume of a shadow camera the region of its cached static casters is, relative to its width
+const double sStaticCasterRegionMargin = 0.25;
+
 //////////////////////////////////////////////////////////////////
 // fragment shader
 //
@@ -233,7 +242,7 @@ class VDSMCameraCullCallback : public osg::NodeCallback
 {
     public:
 
-        VDSMCameraCullCallback(MWShadowTechnique* vdsm, osg::Polytope& polytope);
+        VDSMCameraCullCallback(MWShadowTechnique* vdsm, osg::Polytope& polytope, MWShadowTechnique::StaticCasterCache* staticCasterCache = nullptr);
 
         virtual void operator()(osg::Node*, osg::NodeVisitor* nv);
 
@@ -246,11 +255,13 @@ class VDSMCameraCullCallback : public osg::NodeCallback
         osg::ref_ptr<osg::RefMatrix>            _projectionMatrix;
         osg::ref_ptr<osgUtil::RenderStage>      _renderStage;
         osg::Polytope                           _polytope;
+        MWShadowTechnique::StaticCasterCache*   _staticCasterCache;
 };
 
-VDSMCameraCullCallback::VDSMCameraCullCallback(MWShadowTechnique* vdsm, osg::Polytope& polytope):
+VDSMCameraCullCallback::VDSMCameraCullCallback(MWShadowTechnique* vdsm, osg::Polytope& polytope, MWShadowTechnique::StaticCasterCache* staticCasterCache):
     _vdsm(vdsm),
-    _polytope(polytope)
+    _polytope(polytope),
+    _staticCasterCache(staticCasterCache)
 {
 }
 
@@ -274,7 +285,10 @@ void VDSMCameraCullCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
 #endif
     if (_vdsm->getShadowedScene())
     {
-        _vdsm->getShadowedScene()->osg::Group::traverse(*nv);
+        if (_staticCasterCache)
+            _vdsm->cullCachedShadowCastingScene(cv, *_staticCasterCache);
+        else
+            _vdsm->getShadowedScene()->osg::Group::traverse(*nv);
     }
 #if 1
     if (!_polytope.empty())
@@ -335,6 +349,58 @@ void VDSMCameraCullCallback::operator()(osg::Node* node, osg::NodeVisitor* nv)
     _projectionMatrix = cv->getProjectionMatrix();
 }
 
+bool isCacheableShadowCaster(const osg::Node& node)
+{
+    // animated nodes would keep the pose they had when the cache was built
+    if (node.getUpdateCallback() || node.getNumChildrenRequiringUpdateTraversal() > 0)
+        return false;
+
+    // light lists are not used by shadow cameras, other callbacks may e.g. hide the node
+    for (const osg::Callback* callback = node.getCullCallback(); callback; callback = callback->getNestedCallback())
+    {
+        if (!dynamic_cast<const LightListCallback*>(callback))
+            return false;
+    }
+    return true;
+}
+
+void addCachedLeaves(const osgUtil::RenderBin* renderBin, const osgUtil::StateGraph* root, const osg::Matrixd& inverseViewMatrix, MWShadowTechnique::StaticCasterCache& cache)
+{
+    const osgUtil::RenderBin::RenderBinList& rbl = renderBin->getRenderBinList();
+    for (osgUtil::RenderBin::RenderBinList::const_iterator itr = rbl.begin(); itr != rbl.end(); ++itr)
+        addCachedLeaves(itr->second.get(), root, inverseViewMatrix, cache);
+
+    const osgUtil::RenderBin::StateGraphList& rgl = renderBin->getStateGraphList();
+    for (osgUtil::RenderBin::StateGraphList::const_iterator itr = rgl.begin(); itr != rgl.end(); ++itr)
+    {
+        const osgUtil::StateGraph* stateGraph = *itr;
+        if (stateGraph->_leaves.empty())
+            continue;
+
+        cache._stateGraphs.push_back(MWShadowTechnique::StaticCasterCache::StateGraph());
+        MWShadowTechnique::StaticCasterCache::StateGraph& cached = cache._stateGraphs.back();
+
+        for (const osgUtil::StateGraph* parent = stateGraph; parent && parent != root; parent = parent->_parent)
+        {
+            if (parent->getStateSet())
+                cached._stateSets.push_back(parent->getStateSet());
+        }
+        std::reverse(cached._stateSets.begin(), cached._stateSets.end());
+
+        for (osgUtil::StateGraph::LeafList::const_iterator leafItr = stateGraph->_leaves.begin(); leafItr != stateGraph->_leaves.end(); ++leafItr)
+        {
+            const osgUtil::RenderLeaf* renderLeaf = leafItr->get();
+
+            MWShadowTechnique::StaticCasterCache::Leaf leaf;
+            leaf._drawable = renderLeaf->_drawable;
+            leaf._matrix = *renderLeaf->_modelview * inverseViewMatrix;
+            leaf._bound = leaf._drawable->getBound();
+            transformBoundingSphere(osg::Matrixf(leaf._matrix), leaf._bound);
+            cached._leaves.push_back(leaf);
+        }
+    }
+}
+
 } // namespace
 
 MWShadowTechnique::ComputeLightSpaceBounds::ComputeLightSpaceBounds(osg::Viewport* viewport, const osg::Matrixd& projectionMatrix, osg::Matrixd& viewMatrix) :
@@ -508,6 +574,16 @@ void MWShadowTechnique::LightData::setLightData(osg::RefMatrix* lm, const osg::L
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////
+//
+// StaticCasterCache
+//
+MWShadowTechnique::StaticCasterCache::StaticCasterCache():
+    _revision(0),
+    _valid(false)
+{
+}
+
 ///////////////////////////////////////////////////////////////////////////////////////////////
 //
 // ShadowData
@@ -869,6 +945,19 @@ void SceneUtil::MWShadowTechnique::setupCastingShader(Shader::ShaderManager & sh
     _castingProgram->addShader(shaderManager.getShader("shadowcasting_fragment.glsl", Shader::ShaderManager::DefineMap(), osg::Shader::FRAGMENT));
 }
 
+void SceneUtil::MWShadowTechnique::setStaticShadowCasterMask(unsigned int mask)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_staticShadowCastersMutex);
+    _staticShadowCasterMask = mask;
+    _staticShadowCastersDirty = true;
+}
+
+void SceneUtil::MWShadowTechnique::dirtyStaticShadowCasters()
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_staticShadowCastersMutex);
+    _staticShadowCastersDirty = true;
+}
+
 MWShadowTechnique::ViewDependentData* MWShadowTechnique::createViewDependentData(osgUtil::CullVisitor* /*cv*/)
 {
     return new ViewDependentData(this);
@@ -919,6 +1008,10 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
 
     ShadowSettings* settings = getShadowedScene()->getShadowSettings();
 
+    const bool cacheStaticShadowCasters = _staticShadowCasterMask != 0;
+    if (cacheStaticShadowCasters)
+        updateStaticShadowCasters(_shadowedScene->getCastsShadowTraversalMask());
+
     OSG_INFO<<"cv->getProjectionMatrix()="<<*cv.getProjectionMatrix()<<std::endl;
 
     osg::CullSettings::ComputeNearFarMode cachedNearFarMode = cv.getComputeNearFarMode();
@@ -1071,7 +1164,23 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
             cs.setFrustum(local_polytope);
             clsb.pushCullingSet();
 
-            _shadowedScene->accept(clsb);
+            if (cacheStaticShadowCasters)
+            {
+                // the static casters are not traversed, their bounds are known
+                clsb.setTraversalMask(_shadowedScene->getCastsShadowTraversalMask() & ~_staticShadowCasterMask);
+                _shadowedScene->accept(clsb);
+                clsb.setTraversalMask(_shadowedScene->getCastsShadowTraversalMask());
+
+                for (const StaticCaster& caster : _staticShadowCasters)
+                {
+                    if (!caster._cacheable)
+                        caster._node->accept(clsb);
+                    else if (!clsb.isCulled(caster._bound))
+                        clsb.updateBound(caster._bound);
+                }
+            }
+            else
+                _shadowedScene->accept(clsb);
 
             // OSG_NOTICE<<"Extents of LightSpace "<<clsb._bb.xMin()<<", "<<clsb._bb.xMax()<<", "<<clsb._bb.yMin()<<", "<<clsb._bb.yMax()<<", "<<clsb._bb.zMin()<<", "<<clsb._bb.zMax()<<std::endl;
             // OSG_NOTICE<<"  time "<<timer.elapsedTime_m()<<"ms, mask = "<<std::hex<<_shadowedScene->getCastsShadowTraversalMask()<<std::endl;
@@ -1308,7 +1417,7 @@ void MWShadowTechnique::cull(osgUtil::CullVisitor& cv)
             else
                 cropShadowCameraToMainFrustum(frustum, camera, reducedNear, reducedFar, extraPlanes);
 
-            osg::ref_ptr<VDSMCameraCullCallback> vdsmCallback = new VDSMCameraCullCallback(this, local_polytope);
+            osg::ref_ptr<VDSMCameraCullCallback> vdsmCallback = new VDSMCameraCullCallback(this, local_polytope, cacheStaticShadowCasters ? &sd->_staticCasterCache : nullptr);
             camera->setCullCallback(vdsmCallback.get());
 
             // 4.3 traverse RTT camera
@@ -2953,6 +3062,209 @@ void MWShadowTechnique::cullShadowCastingScene(osgUtil::CullVisitor* cv, osg::Ca
     return;
 }
 
+void MWShadowTechnique::cullCachedShadowCastingScene(osgUtil::CullVisitor* cv, StaticCasterCache& cache) const
+{
+    OSG_INFO<<"cullCachedShadowCastingScene()"<<std::endl;
+
+    osg::Camera* camera = cv->getCurrentCamera();
+    const osg::Matrixd& viewMatrix = camera->getViewMatrix();
+    const osg::Matrixd& projectionMatrix = camera->getProjectionMatrix();
+
+    // the region checks below assume the parallel projection of a directional light
+    bool orthographic = projectionMatrix(0,3)==0.0 && projectionMatrix(1,3)==0.0 && projectionMatrix(2,3)==0.0;
+    if (!orthographic)
+    {
+        _shadowedScene->osg::Group::traverse(*cv);
+        return;
+    }
+
+    // the culling polytope in world space
+    osg::Polytope polytope = cv->getCurrentCullingSet().getFrustum();
+
+    osg::Matrixd inverseViewMatrix = osg::Matrixd::inverse(viewMatrix);
+    osg::Matrixd inverseViewProjectionMatrix = osg::Matrixd::inverse(viewMatrix * projectionMatrix);
+    osg::Vec3d towardsLight = osg::Matrixd::transform3x3(osg::Vec3d(0.0, 0.0, 1.0), inverseViewMatrix);
+    towardsLight.normalize();
+
+    // Depth clamping lets casters between the light and the near plane cast shadows, so the volume of the camera is extended
+    // towards the light until it has passed all static casters. It has to lie within the region the cache was built for.
+    std::vector<osg::Vec3d> corners;
+    for (unsigned int i = 0; i < 8; ++i)
+        corners.push_back(osg::Vec3d(i & 1 ? 1.0 : -1.0, i & 2 ? 1.0 : -1.0, i & 4 ? 1.0 : -1.0) * inverseViewProjectionMatrix);
+
+    double extrusion = 0.0;
+    if (_staticShadowCastersBound.valid())
+    {
+        for (unsigned int i = 0; i < 8; ++i)
+            extrusion = std::max(extrusion, (corners[i] - osg::Vec3d(_staticShadowCastersBound.center())).length() + _staticShadowCastersBound.radius());
+    }
+    for (unsigned int i = 0; i < 8; ++i)
+        corners.push_back(corners[i] + towardsLight * extrusion);
+
+    bool valid = cache._valid && cache._revision == _staticShadowCastersRevision;
+    for (std::vector<osg::Vec3d>::const_iterator it = corners.begin(); valid && it != corners.end(); ++it)
+        valid = cache._region.contains(osg::Vec3(*it));
+
+    osgUtil::RenderStage* renderStage = cv->getCurrentRenderStage();
+    osgUtil::StateGraph* stateGraph = cv->getCurrentStateGraph();
+
+    if (!valid)
+    {
+        OSG_INFO<<"Rebuilding static shadow caster cache"<<std::endl;
+
+        // cull with a larger box in light space, so that the cache stays valid while the shadow camera moves a bit
+        osg::BoundingBox region;
+        for (const osg::Vec3d& corner : corners)
+            region.expandBy(corner * viewMatrix);
+        float margin = std::max(region.xMax() - region.xMin(), region.yMax() - region.yMin()) * sStaticCasterRegionMargin;
+        region._min -= osg::Vec3f(margin, margin, margin);
+        region._max += osg::Vec3f(margin, margin, margin);
+
+        osg::Polytope localRegion;
+        localRegion.setToBoundingBox(region);
+        cache._region = localRegion;
+        cache._region.transformProvidingInverse(viewMatrix);
+
+        // nested transforms build their culling sets from the projection culling set, so it has to be restored afterwards
+        osg::CullingSet& cs = cv->getProjectionCullingStack().back();
+        osg::Polytope previousFrustum = cs.getFrustum();
+        cs.setFrustum(localRegion);
+        cv->pushCullingSet();
+
+        for (const StaticCaster& caster : _staticShadowCasters)
+        {
+            if (!caster._cacheable)
+                continue;
+
+            for (const osg::ref_ptr<const osg::StateSet>& stateSet : caster._stateSets)
+                cv->pushStateSet(stateSet.get());
+            caster._node->accept(*cv);
+            for (std::size_t i = 0; i < caster._stateSets.size(); ++i)
+                cv->popStateSet();
+        }
+
+        cv->popCullingSet();
+        cs.setFrustum(previousFrustum);
+
+        // the render stage of the shadow camera only holds the static casters at this point
+        cache._stateGraphs.clear();
+        addCachedLeaves(renderStage, stateGraph, inverseViewMatrix, cache);
+        cache._revision = _staticShadowCastersRevision;
+        cache._valid = true;
+    }
+    else
+    {
+        bool computeNearFar = cv->getComputeNearFarMode() != osg::CullSettings::DO_NOT_COMPUTE_NEAR_FAR;
+
+        for (const StaticCasterCache::StateGraph& cached : cache._stateGraphs)
+        {
+            bool pushed = false;
+            for (const StaticCasterCache::Leaf& leaf : cached._leaves)
+            {
+                if (!polytope.contains(leaf._bound))
+                    continue;
+
+                osg::RefMatrix* matrix = cv->createOrReuseMatrix(leaf._matrix * viewMatrix);
+                if (computeNearFar && !cv->updateCalculatedNearFar(*matrix, *leaf._drawable, false))
+                    continue;
+
+                const osg::BoundingBox& bb = leaf._drawable->getBoundingBox();
+                float depth = bb.valid() ? -(bb.center() * *matrix).z() : 0.0f;
+                if (osg::isNaN(depth))
+                    continue;
+
+                if (!pushed)
+                {
+                    for (const osg::ref_ptr<const osg::StateSet>& stateSet : cached._stateSets)
+                        cv->pushStateSet(stateSet.get());
+                    pushed = true;
+                }
+
+                cv->addDrawableAndDepth(leaf._drawable.get(), matrix, depth);
+            }
+
+            if (pushed)
+            {
+                for (std::size_t i = 0; i < cached._stateSets.size(); ++i)
+                    cv->popStateSet();
+            }
+        }
+    }
+
+    for (const StaticCaster& caster : _staticShadowCasters)
+    {
+        if (caster._cacheable)
+            continue;
+
+        for (const osg::ref_ptr<const osg::StateSet>& stateSet : caster._stateSets)
+            cv->pushStateSet(stateSet.get());
+        caster._node->accept(*cv);
+        for (std::size_t i = 0; i < caster._stateSets.size(); ++i)
+            cv->popStateSet();
+    }
+
+    // the dynamic casters
+    unsigned int traversalMask = cv->getTraversalMask();
+    cv->setTraversalMask(traversalMask & ~_staticShadowCasterMask);
+    _shadowedScene->osg::Group::traverse(*cv);
+    cv->setTraversalMask(traversalMask);
+}
+
+void MWShadowTechnique::updateStaticShadowCasters(unsigned int castsShadowMask)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_staticShadowCastersMutex);
+
+    if (!_staticShadowCastersDirty && castsShadowMask == _staticShadowCastersCastsShadowMask)
+        return;
+
+    _staticShadowCasters.clear();
+    _staticShadowCastersBound.init();
+
+    std::vector< osg::ref_ptr<const osg::StateSet> > stateSets;
+    collectStaticShadowCasters(*_shadowedScene, stateSets, castsShadowMask);
+
+    _staticShadowCastersCastsShadowMask = castsShadowMask;
+    _staticShadowCastersDirty = false;
+    ++_staticShadowCastersRevision;
+}
+
+void MWShadowTechnique::collectStaticShadowCasters(osg::Group& group, std::vector< osg::ref_ptr<const osg::StateSet> >& stateSets, unsigned int castsShadowMask)
+{
+    for (unsigned int i = 0; i < group.getNumChildren(); ++i)
+    {
+        osg::Node* child = group.getChild(i);
+        if (!(child->getNodeMask() & castsShadowMask))
+            continue;
+
+        // Plain groups are searched for casters, without running their cull callbacks for the cached casters.
+        // The static casters have to be found above any transforms or other nodes that change how their subgraph is culled.
+        if (typeid(*child) == typeid(osg::Group) || typeid(*child) == typeid(LightManager))
+        {
+            if (child->getStateSet())
+                stateSets.push_back(child->getStateSet());
+            collectStaticShadowCasters(*child->asGroup(), stateSets, castsShadowMask);
+            if (child->getStateSet())
+                stateSets.pop_back();
+        }
+        else if (child->getNodeMask() & _staticShadowCasterMask)
+        {
+            StaticCaster caster;
+            caster._node = child;
+            caster._stateSets = stateSets;
+            caster._cacheable = isCacheableShadowCaster(*child);
+            if (caster._cacheable)
+            {
+                osg::ComputeBoundsVisitor computeBounds;
+                computeBounds.setTraversalMask(castsShadowMask);
+                child->accept(computeBounds);
+                caster._bound = computeBounds.getBoundingBox();
+                _staticShadowCastersBound.expandBy(caster._bound);
+            }
+            _staticShadowCasters.push_back(caster);
+        }
+    }
+}
+
 osg::StateSet* MWShadowTechnique::selectStateSetForRenderingShadow(ViewDependentData& vdd) const
 {
     OSG_INFO<<"   selectStateSetForRenderingShadow() "<<vdd.getStateSet()<<std::endl;
@@ -24,6 +24,7 @@
 #include <osg/MatrixTransform>
 #include <osg/LightSource>
 #include <osg/PolygonOffset>
+#include <osg/Polytope>
 
 #include <osgShadow/ShadowTechnique>
 
@@ -82,6 +83,15 @@ namespace SceneUtil {
 
         virtual void setupCastingShader(Shader::ShaderManager &shaderManager);
 
+        /** Reuse the render lists of static shadow casters across frames, only dynamic casters are culled every frame.
+          * The lists of a shadow map are culled again once its shadow camera leaves the region they were built for,
+          * e.g. when the view or the light direction changed enough.
+          * @param mask Node mask of the static casters, 0 disables the cache. */
+        virtual void setStaticShadowCasterMask(unsigned int mask);
+
+        /** Rebuild the static shadow caster lists, call after static casters were added, removed or moved. */
+        virtual void dirtyStaticShadowCasters();
+
         class ComputeLightSpaceBounds : public osg::NodeVisitor, public osg::CullStack
         {
         public:
@@ -159,6 +169,33 @@ namespace SceneUtil {
 
         typedef std::list< osg::ref_ptr<LightData> > LightDataList;
 
+        /** The render leaves of the static casters of a shadow map, with their matrices in world space.*/
+        struct StaticCasterCache
+        {
+            StaticCasterCache();
+
+            struct Leaf
+            {
+                osg::ref_ptr<osg::Drawable>         _drawable;
+                osg::Matrixd                        _matrix;
+                osg::BoundingSphere                 _bound;
+            };
+
+            struct StateGraph
+            {
+                std::vector< osg::ref_ptr<const osg::StateSet> > _stateSets;
+                std::vector<Leaf>                   _leaves;
+            };
+
+            std::vector<StateGraph>                 _stateGraphs;
+
+            // the light space box the leaves were culled with, in world space
+            osg::Polytope                           _region;
+
+            unsigned int                            _revision;
+            bool                                    _valid;
+        };
+
         struct ShadowData : public osg::Referenced
         {
             ShadowData(ViewDependentData* vdd);
@@ -171,6 +208,8 @@ namespace SceneUtil {
             osg::ref_ptr<osg::Texture2D>        _texture;
             osg::ref_ptr<osg::TexGen>           _texgen;
             osg::ref_ptr<osg::Camera>           _camera;
+
+            StaticCasterCache                   _staticCasterCache;
         };
 
         typedef std::list< osg::ref_ptr<ShadowData> > ShadowDataList;
@@ -226,6 +265,9 @@ namespace SceneUtil {
 
         virtual void cullShadowCastingScene(osgUtil::CullVisitor* cv, osg::Camera* camera) const;
 
+        /** Cull the shadow casting scene of a shadow camera, with the static casters taken from the cache if it is still valid.*/
+        virtual void cullCachedShadowCastingScene(osgUtil::CullVisitor* cv, StaticCasterCache& cache) const;
+
         virtual osg::StateSet* selectStateSetForRenderingShadow(ViewDependentData& vdd) const;
 
     protected:
@@ -257,6 +299,28 @@ namespace SceneUtil {
 
         bool                                    _useFrontFaceCulling = true;
 
+        struct StaticCaster
+        {
+            osg::ref_ptr<osg::Node>             _node;
+            // of the parent groups
+            std::vector< osg::ref_ptr<const osg::StateSet> > _stateSets;
+            osg::BoundingBox                    _bound;
+            // animated casters and those with cull callbacks are culled every frame
+            bool                                _cacheable;
+        };
+
+        void updateStaticShadowCasters(unsigned int castsShadowMask);
+
+        void collectStaticShadowCasters(osg::Group& group, std::vector< osg::ref_ptr<const osg::StateSet> >& stateSets, unsigned int castsShadowMask);
+
+        mutable OpenThreads::Mutex              _staticShadowCastersMutex;
+        std::vector<StaticCaster>               _staticShadowCasters;
+        osg::BoundingBox                        _staticShadowCastersBound;
+        unsigned int                            _staticShadowCasterMask = 0;
+        unsigned int                            _staticShadowCastersCastsShadowMask = 0;
+        unsigned int                            _staticShadowCastersRevision = 0;
+        bool                                    _staticShadowCastersDirty = false;
+
         class DebugHUD : public osg::Referenced
         {
         public:
@@ -0,0 +1,257 @@
+#include "occlusionbuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+
+    // nearer than this the reciprocal depth gets too large to interpolate reliably
+    const float sMinDepth = 1e-4f;
+
+    bool isInFrontOfNearPlane(const osg::Vec4f& vertex)
+    {
+        return vertex.z() >= -vertex.w() && vertex.w() > sMinDepth;
+    }
+
+    osg::Vec4f intersectNearPlane(const osg::Vec4f& inside, const osg::Vec4f& outside)
+    {
+        float distanceInside = inside.z() + inside.w();
+        float distanceOutside = outside.z() + outside.w();
+        float t = distanceInside / (distanceInside - distanceOutside);
+        return inside + (outside - inside) * t;
+    }
+
+}
+
+namespace SceneUtil
+{
+
+OcclusionBuffer::OcclusionBuffer(unsigned int width, unsigned int height)
+    : mWidth(std::max(width, 1u))
+    , mHeight(std::max(height, 1u))
+{
+    unsigned int levelWidth = mWidth;
+    unsigned int levelHeight = mHeight;
+    while (true)
+    {
+        mLevels.push_back(std::vector<float>(levelWidth * levelHeight, 0.f));
+        mLevelSizes.push_back(std::make_pair(levelWidth, levelHeight));
+        if (levelWidth == 1 && levelHeight == 1)
+            break;
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+}
+
+void OcclusionBuffer::clear(const osg::Matrix& viewProjection)
+{
+    mViewProjection = viewProjection;
+    for (std::vector<std::vector<float> >::iterator level = mLevels.begin(); level != mLevels.end(); ++level)
+        std::fill(level->begin(), level->end(), 0.f);
+}
+
+void OcclusionBuffer::addTriangles(const std::vector<osg::Vec3f>& vertices, const std::vector<unsigned int>& indices, const osg::Matrix& transform)
+{
+    osg::Matrix matrix = transform * mViewProjection;
+
+    // a mirroring transform turns front faces into back faces
+    float determinant = transform(0,0) * (transform(1,1) * transform(2,2) - transform(1,2) * transform(2,1))
+                      - transform(0,1) * (transform(1,0) * transform(2,2) - transform(1,2) * transform(2,0))
+                      + transform(0,2) * (transform(1,0) * transform(2,1) - transform(1,1) * transform(2,0));
+    bool flip = determinant < 0;
+
+    std::vector<osg::Vec4f> clipVertices;
+    clipVertices.reserve(vertices.size());
+    for (std::vector<osg::Vec3f>::const_iterator it = vertices.begin(); it != vertices.end(); ++it)
+        clipVertices.push_back(osg::Vec4f(*it, 1.f) * matrix);
+
+    for (std::size_t i=0; i+2<indices.size(); i+=3)
+        rasterizeTriangle(clipVertices[indices[i]], clipVertices[indices[i+1]], clipVertices[indices[i+2]], flip);
+}
+
+void OcclusionBuffer::rasterizeTriangle(const osg::Vec4f& v0, const osg::Vec4f& v1, const osg::Vec4f& v2, bool flip)
+{
+    const osg::Vec4f* triangle[3] = { &v0, &v1, &v2 };
+
+    // clip against the near plane, which leaves at most 4 vertices
+    osg::Vec4f polygon[4];
+    unsigned int numVertices = 0;
+    for (unsigned int i=0; i<3; ++i)
+    {
+        const osg::Vec4f& current = *triangle[i];
+        const osg::Vec4f& next = *triangle[(i+1)%3];
+        bool currentInside = isInFrontOfNearPlane(current);
+        bool nextInside = isInFrontOfNearPlane(next);
+        if (currentInside)
+            polygon[numVertices++] = current;
+        if (currentInside != nextInside && numVertices < 4)
+        {
+            osg::Vec4f intersection = currentInside ? intersectNearPlane(current, next) : intersectNearPlane(next, current);
+            if (intersection.w() > sMinDepth)
+                polygon[numVertices++] = intersection;
+        }
+    }
+    if (numVertices < 3)
+        return;
+
+    // x, y in pixels and the reciprocal depth
+    osg::Vec3f screen[4];
+    for (unsigned int i=0; i<numVertices; ++i)
+    {
+        float invW = 1.f / polygon[i].w();
+        screen[i] = osg::Vec3f((polygon[i].x() * invW * 0.5f + 0.5f) * mWidth, (polygon[i].y() * invW * 0.5f + 0.5f) * mHeight, invW);
+    }
+
+    float area = (screen[1].x() - screen[0].x()) * (screen[2].y() - screen[0].y())
+               - (screen[1].y() - screen[0].y()) * (screen[2].x() - screen[0].x());
+    if ((area <= 0) != flip)
+        return;
+
+    for (unsigned int i=1; i+1<numVertices; ++i)
+    {
+        if (flip)
+            rasterizeClippedTriangle(screen[0], screen[i+1], screen[i]);
+        else
+            rasterizeClippedTriangle(screen[0], screen[i], screen[i+1]);
+    }
+}
+
+void OcclusionBuffer::rasterizeClippedTriangle(const osg::Vec3f& a, const osg::Vec3f& b, const osg::Vec3f& c)
+{
+    float area = (b.x() - a.x()) * (c.y() - a.y()) - (b.y() - a.y()) * (c.x() - a.x());
+    if (area <= 0)
+        return;
+
+    int minX = std::max(0, static_cast<int>(std::floor(std::min(std::min(a.x(), b.x()), c.x()))));
+    int minY = std::max(0, static_cast<int>(std::floor(std::min(std::min(a.y(), b.y()), c.y()))));
+    int maxX = std::min(static_cast<int>(mWidth) - 1, static_cast<int>(std::ceil(std::max(std::max(a.x(), b.x()), c.x()))));
+    int maxY = std::min(static_cast<int>(mHeight) - 1, static_cast<int>(std::ceil(std::max(std::max(a.y(), b.y()), c.y()))));
+    if (minX > maxX || minY > maxY)
+        return;
+
+    // edge functions, positive on the inside of the counter-clockwise triangle, stepped per pixel
+    float stepXA = b.y() - c.y(), stepYA = c.x() - b.x();
+    float stepXB = c.y() - a.y(), stepYB = a.x() - c.x();
+    float stepXC = a.y() - b.y(), stepYC = b.x() - a.x();
+
+    float startX = minX + 0.5f;
+    float startY = minY + 0.5f;
+    float rowA = (startX - b.x()) * stepXA + (startY - b.y()) * stepYA;
+    float rowB = (startX - c.x()) * stepXB + (startY - c.y()) * stepYB;
+    float rowC = (startX - a.x()) * stepXC + (startY - a.y()) * stepYC;
+
+    float invArea = 1.f / area;
+    std::vector<float>& buffer = mLevels[0];
+
+    for (int y=minY; y<=maxY; ++y)
+    {
+        float edgeA = rowA, edgeB = rowB, edgeC = rowC;
+        float* row = &buffer[y * mWidth];
+        for (int x=minX; x<=maxX; ++x)
+        {
+            if (edgeA >= 0 && edgeB >= 0 && edgeC >= 0)
+            {
+                float depth = (edgeA * a.z() + edgeB * b.z() + edgeC * c.z()) * invArea;
+                row[x] = std::max(row[x], depth);
+            }
+            edgeA += stepXA;
+            edgeB += stepXB;
+            edgeC += stepXC;
+        }
+        rowA += stepYA;
+        rowB += stepYB;
+        rowC += stepYC;
+    }
+}
+
+void OcclusionBuffer::finish()
+{
+    for (std::size_t level=1; level<mLevels.size(); ++level)
+    {
+        const std::vector<float>& source = mLevels[level-1];
+        unsigned int sourceWidth = mLevelSizes[level-1].first;
+        unsigned int sourceHeight = mLevelSizes[level-1].second;
+        std::vector<float>& target = mLevels[level];
+        unsigned int targetWidth = mLevelSizes[level].first;
+        unsigned int targetHeight = mLevelSizes[level].second;
+
+        for (unsigned int y=0; y<targetHeight; ++y)
+        {
+            unsigned int y0 = y*2;
+            unsigned int y1 = std::min(y0+1, sourceHeight-1);
+            for (unsigned int x=0; x<targetWidth; ++x)
+            {
+                unsigned int x0 = x*2;
+                unsigned int x1 = std::min(x0+1, sourceWidth-1);
+                target[y * targetWidth + x] = std::min(std::min(source[y0 * sourceWidth + x0], source[y0 * sourceWidth + x1]),
+                                                       std::min(source[y1 * sourceWidth + x0], source[y1 * sourceWidth + x1]));
+            }
+        }
+    }
+}
+
+bool OcclusionBuffer::isOccluded(const osg::BoundingBox& box) const
+{
+    if (!box.valid())
+        return false;
+
+    float minX = std::numeric_limits<float>::max(), minY = std::numeric_limits<float>::max();
+    float maxX = -std::numeric_limits<float>::max(), maxY = -std::numeric_limits<float>::max();
+    float depth = 0.f;
+    for (unsigned int i=0; i<8; ++i)
+    {
+        osg::Vec4f corner = osg::Vec4f(box.corner(i), 1.f) * mViewProjection;
+        // a box crossing the near plane covers the whole view
+        if (!isInFrontOfNearPlane(corner))
+            return false;
+
+        float invW = 1.f / corner.w();
+        float x = (corner.x() * invW * 0.5f + 0.5f) * mWidth;
+        float y = (corner.y() * invW * 0.5f + 0.5f) * mHeight;
+        minX = std::min(minX, x);
+        minY = std::min(minY, y);
+        maxX = std::max(maxX, x);
+        maxY = std::max(maxY, y);
+        // the nearest point of a box is one of its corners
+        depth = std::max(depth, invW);
+    }
+
+    // occluders only cover the pixels whose center they cover, so they may end up to one pixel away from their actual edge
+    int pixelMinX = std::max(0, static_cast<int>(std::floor(minX)) - 1);
+    int pixelMinY = std::max(0, static_cast<int>(std::floor(minY)) - 1);
+    int pixelMaxX = std::min(static_cast<int>(mWidth) - 1, static_cast<int>(std::floor(maxX)) + 1);
+    int pixelMaxY = std::min(static_cast<int>(mHeight) - 1, static_cast<int>(std::floor(maxY)) + 1);
+    if (pixelMinX > pixelMaxX || pixelMinY > pixelMaxY)
+        return false;
+
+    // test the coarsest level on which the box covers at most 4x4 texels first, which settles most occluded boxes
+    unsigned int level = 0;
+    while (level+1 < mLevels.size()
+           && ((pixelMaxX >> level) - (pixelMinX >> level) > 3 || (pixelMaxY >> level) - (pixelMinY >> level) > 3))
+        ++level;
+
+    if (level > 0 && isOccluded(level, pixelMinX, pixelMinY, pixelMaxX, pixelMaxY, depth))
+        return true;
+
+    return isOccluded(0, pixelMinX, pixelMinY, pixelMaxX, pixelMaxY, depth);
+}
+
+bool OcclusionBuffer::isOccluded(unsigned int level, int minX, int minY, int maxX, int maxY, float depth) const
+{
+    const std::vector<float>& buffer = mLevels[level];
+    unsigned int width = mLevelSizes[level].first;
+    for (int y = (minY >> level); y <= (maxY >> level); ++y)
+    {
+        const float* row = &buffer[y * width];
+        for (int x = (minX >> level); x <= (maxX >> level); ++x)
+        {
+            if (row[x] <= depth)
+                return false;
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_OCCLUSIONBUFFER_H
+#define OPENMW_COMPONENTS_SCENEUTIL_OCCLUSIONBUFFER_H
+
+#include <vector>
+
+#include <osg/BoundingBox>
+#include <osg/Matrix>
+#include <osg/Vec3f>
+#include <osg/Vec4f>
+
+namespace SceneUtil
+{
+
+    /// @brief A small depth buffer rasterized on the CPU, to find objects that are hidden behind occluders.
+    /// @par The buffer stores the reciprocal of the view space depth, which is linear in screen space and does not depend on the
+    /// near and far planes. Larger values are nearer, 0 means empty. On top of the buffer a hierarchy of the farthest depth of
+    /// 2x2 blocks is built, so that large boxes can be rejected without testing every pixel they cover.
+    /// @par Occluders must not cover more than the geometry they stand for. Only back faces are skipped, i.e. the occluders
+    /// should only be made of geometry that is rendered opaque and with back face culling.
+    /// @note Does not depend on a graphics context, so it can be used on any thread.
+    class OcclusionBuffer
+    {
+    public:
+        OcclusionBuffer(unsigned int width, unsigned int height);
+
+        /// Clear the buffer and set the transformation from world space to clip space that occluders and boxes are seen with.
+        void clear(const osg::Matrix& viewProjection);
+
+        /// Rasterize an indexed triangle list with counter-clockwise front faces.
+        /// @param transform Transformation of the vertices to world space.
+        void addTriangles(const std::vector<osg::Vec3f>& vertices, const std::vector<unsigned int>& indices, const osg::Matrix& transform);
+
+        /// Build the depth hierarchy. Must be called after the occluders were added and before boxes are tested.
+        void finish();
+
+        /// @return true if the world space \a box is certainly hidden behind the occluders.
+        bool isOccluded(const osg::BoundingBox& box) const;
+
+        unsigned int getWidth() const { return mWidth; }
+        unsigned int getHeight() const { return mHeight; }
+
+        /// @return The reciprocal depth of the nearest occluder at a pixel, 0 if there is none.
+        float getDepth(unsigned int x, unsigned int y) const { return mLevels[0][y * mWidth + x]; }
+
+    private:
+        void rasterizeTriangle(const osg::Vec4f& v0, const osg::Vec4f& v1, const osg::Vec4f& v2, bool flip);
+
+        void rasterizeClippedTriangle(const osg::Vec3f& v0, const osg::Vec3f& v1, const osg::Vec3f& v2);
+
+        bool isOccluded(unsigned int level, int minX, int minY, int maxX, int maxY, float depth) const;
+
+        unsigned int mWidth;
+        unsigned int mHeight;
+
+        osg::Matrix mViewProjection;
+
+        // level 0 holds the nearest occluder of each pixel, the other levels the farthest value of 2x2 texels of the level below
+        std::vector<std::vector<float> > mLevels;
+        std::vector<std::pair<unsigned int, unsigned int> > mLevelSizes;
+    };
+
+}
+
+#endif
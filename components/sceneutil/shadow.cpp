@@ -155,4 +155,14 @@ namespace SceneUtil
             mShadowTechnique->enableShadows();
         mShadowSettings->setCastsShadowTraversalMask(mOutdoorShadowCastingMask);
     }
+
+    void ShadowManager::setStaticShadowCasterMask(unsigned int mask)
+    {
+        mShadowTechnique->setStaticShadowCasterMask(mask);
+    }
+
+    void ShadowManager::dirtyStaticShadowCasters()
+    {
+        mShadowTechnique->dirtyStaticShadowCasters();
+    }
 }
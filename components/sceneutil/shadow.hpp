@@ -28,6 +28,12 @@ namespace SceneUtil
         virtual void enableIndoorMode();
 
         virtual void enableOutdoorMode();
+
+        /// Cache the shadow casting render lists of the nodes matching \a mask, e.g. statics.
+        virtual void setStaticShadowCasterMask(unsigned int mask);
+
+        /// Call when nodes matching the static shadow caster mask were added, removed or moved.
+        virtual void dirtyStaticShadowCasters();
     protected:
         bool mEnableShadows;
 
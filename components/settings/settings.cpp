@@ -15,6 +15,7 @@ namespace Settings
 CategorySettingValueMap Manager::mDefaultSettings = CategorySettingValueMap();
 CategorySettingValueMap Manager::mUserSettings = CategorySettingValueMap();
 CategorySettingVector Manager::mChangedSettings = CategorySettingVector();
+unsigned int Manager::mRevision = 1;
 
 typedef std::map< CategorySetting, bool > CategorySettingStatusMap;
 
@@ -315,18 +316,21 @@ void Manager::clear()
     mDefaultSettings.clear();
     mUserSettings.clear();
     mChangedSettings.clear();
+    ++mRevision;
 }
 
 void Manager::loadDefault(const std::string &file)
 {
     SettingsFileParser parser;
     parser.loadSettingsFile(file, mDefaultSettings);
+    ++mRevision;
 }
 
 void Manager::loadUser(const std::string &file)
 {
     SettingsFileParser parser;
     parser.loadSettingsFile(file, mUserSettings);
+    ++mRevision;
 }
 
 void Manager::saveUser(const std::string &file)
@@ -400,6 +404,7 @@ void Manager::setString(const std::string &setting, const std::string &category,
     mUserSettings[key] = value;
 
     mChangedSettings.insert(key);
+    ++mRevision;
 }
 
 void Manager::setInt (const std::string& setting, const std::string& category, const int value)
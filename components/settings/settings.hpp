@@ -23,6 +23,9 @@ namespace Settings
         static CategorySettingVector mChangedSettings;
         ///< tracks all the settings that were changed since the last apply() call
 
+        static unsigned int mRevision;
+        ///< incremented whenever settings are loaded, cleared or changed via one of the set functions
+
         void clear();
         ///< clears all settings and default settings
 
@@ -53,6 +56,66 @@ namespace Settings
         static void setBool (const std::string& setting, const std::string& category, const bool value);
     };
 
+    ///
+    /// \brief Typed handle for a setting that is read frequently
+    ///
+    /// The value is parsed on the first call of get() and then only again after the settings have been changed,
+    /// so reading it is a single comparison instead of two map lookups and a conversion.
+    ///
+    /// Only covers settings.cfg. Game settings can not change once the content files are loaded, so hot code keeps
+    /// them in function-local statics. Fallback values are only read while objects are constructed.
+    ///
+    template <class T>
+    class SettingValue
+    {
+            std::string mSetting;
+            std::string mCategory;
+            mutable T mValue;
+            mutable unsigned int mRevision;
+
+            T read() const;
+
+        public:
+
+            SettingValue (const std::string& setting, const std::string& category)
+            : mSetting (setting), mCategory (category), mValue(), mRevision (0)
+            {}
+
+            const T& get() const
+            {
+                if (mRevision != Manager::mRevision)
+                {
+                    mValue = read();
+                    mRevision = Manager::mRevision;
+                }
+
+                return mValue;
+            }
+    };
+
+    template <>
+    inline int SettingValue<int>::read() const
+    {
+        return Manager::getInt (mSetting, mCategory);
+    }
+
+    template <>
+    inline float SettingValue<float>::read() const
+    {
+        return Manager::getFloat (mSetting, mCategory);
+    }
+
+    template <>
+    inline bool SettingValue<bool>::read() const
+    {
+        return Manager::getBool (mSetting, mCategory);
+    }
+
+    template <>
+    inline std::string SettingValue<std::string>::read() const
+    {
+        return Manager::getString (mSetting, mCategory);
+    }
 }
 
 #endif // _COMPONENTS_SETTINGS_H
@@ -8,13 +8,72 @@
 
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 #include <boost/algorithm/string.hpp>
 
 #include <components/debug/debuglog.hpp>
 
+namespace
+{
+
+    /* similar to the boost::hash_combine */
+    template <class T>
+    inline void hashCombine(std::size_t& seed, const T& v)
+    {
+        std::hash<T> hasher;
+        seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
+    }
+
+    std::size_t hashDefines(std::size_t seed, const Shader::ShaderManager::DefineMap& defines)
+    {
+        for (Shader::ShaderManager::DefineMap::const_iterator it = defines.begin(); it != defines.end(); ++it)
+        {
+            hashCombine(seed, it->first);
+            hashCombine(seed, it->second);
+        }
+        return seed;
+    }
+
+    bool isManifestToken(const std::string& token)
+    {
+        return token.find_first_of(" \t\r\n=") == std::string::npos;
+    }
+
+    bool isManifestValue(const std::string& value)
+    {
+        return value.find_first_of(" \t\r\n") == std::string::npos;
+    }
+
+}
+
 namespace Shader
 {
 
+    ShaderManager::ShaderKey::ShaderKey(const std::string& shaderTemplate, const DefineMap& defines)
+        : mTemplate(shaderTemplate)
+        , mDefines(defines)
+        , mHash(hashDefines(std::hash<std::string>()(shaderTemplate), defines))
+    {
+    }
+
+    bool ShaderManager::ShaderKey::operator==(const ShaderKey& other) const
+    {
+        return mHash == other.mHash && mTemplate == other.mTemplate && mDefines == other.mDefines;
+    }
+
+    bool ShaderManager::ProgramVariant::operator==(const ProgramVariant& other) const
+    {
+        return mVertexTemplate == other.mVertexTemplate && mFragmentTemplate == other.mFragmentTemplate && mDefines == other.mDefines;
+    }
+
+    std::size_t ShaderManager::ProgramVariantHash::operator()(const ProgramVariant& variant) const
+    {
+        std::size_t seed = 0;
+        hashCombine(seed, variant.mVertexTemplate);
+        hashCombine(seed, variant.mFragmentTemplate);
+        return hashDefines(seed, variant.mDefines);
+    }
+
     void ShaderManager::setShaderPath(const std::string &path)
     {
         mPath = path;
@@ -297,14 +356,15 @@ namespace Shader
             templateIt = mShaderTemplates.insert(std::make_pair(shaderTemplate, source)).first;
         }
 
-        ShaderMap::iterator shaderIt = mShaders.find(std::make_pair(shaderTemplate, defines));
+        ShaderKey key (shaderTemplate, defines);
+        ShaderMap::iterator shaderIt = mShaders.find(key);
         if (shaderIt == mShaders.end())
         {
             std::string shaderSource = templateIt->second;
             if (!parseDefines(shaderSource, defines, mGlobalDefines) || !parseFors(shaderSource))
             {
                 // Add to the cache anyway to avoid logging the same error over and over.
-                mShaders.insert(std::make_pair(std::make_pair(shaderTemplate, defines), nullptr));
+                mShaders.insert(std::make_pair(key, nullptr));
                 return nullptr;
             }
 
@@ -314,7 +374,8 @@ namespace Shader
             static unsigned int counter = 0;
             shader->setName(std::to_string(counter++));
 
-            shaderIt = mShaders.insert(std::make_pair(std::make_pair(shaderTemplate, defines), shader)).first;
+            mShaderKeys.insert(std::make_pair(shader.get(), key));
+            shaderIt = mShaders.insert(std::make_pair(key, shader)).first;
         }
         return shaderIt->second;
     }
@@ -322,6 +383,24 @@ namespace Shader
     osg::ref_ptr<osg::Program> ShaderManager::getProgram(osg::ref_ptr<osg::Shader> vertexShader, osg::ref_ptr<osg::Shader> fragmentShader)
     {
         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+
+        std::map<const osg::Shader*, ShaderKey>::const_iterator vertexKey = mShaderKeys.find(vertexShader.get());
+        std::map<const osg::Shader*, ShaderKey>::const_iterator fragmentKey = mShaderKeys.find(fragmentShader.get());
+        // programs whose shaders differ in their defines can't be described by the manifest
+        if (vertexKey != mShaderKeys.end() && fragmentKey != mShaderKeys.end() && vertexKey->second.mDefines == fragmentKey->second.mDefines)
+        {
+            ProgramVariant variant;
+            variant.mVertexTemplate = vertexKey->second.mTemplate;
+            variant.mFragmentTemplate = fragmentKey->second.mTemplate;
+            variant.mDefines = vertexKey->second.mDefines;
+            mUsedPrograms.insert(variant);
+        }
+
+        return getProgramImpl(vertexShader, fragmentShader);
+    }
+
+    osg::ref_ptr<osg::Program> ShaderManager::getProgramImpl(osg::ref_ptr<osg::Shader> vertexShader, osg::ref_ptr<osg::Shader> fragmentShader)
+    {
         ProgramMap::iterator found = mPrograms.find(std::make_pair(vertexShader, fragmentShader));
         if (found == mPrograms.end())
         {
@@ -333,6 +412,98 @@ namespace Shader
         return found->second;
     }
 
+    osg::ref_ptr<osg::Program> ShaderManager::buildProgram(const ProgramVariant& variant)
+    {
+        // templates may have been removed since the manifest was written, don't log errors for them
+        boost::system::error_code error;
+        if (!boost::filesystem::exists(boost::filesystem::path(mPath) / variant.mVertexTemplate, error)
+                || !boost::filesystem::exists(boost::filesystem::path(mPath) / variant.mFragmentTemplate, error))
+            return nullptr;
+
+        osg::ref_ptr<osg::Shader> vertexShader = getShader(variant.mVertexTemplate, variant.mDefines, osg::Shader::VERTEX);
+        osg::ref_ptr<osg::Shader> fragmentShader = getShader(variant.mFragmentTemplate, variant.mDefines, osg::Shader::FRAGMENT);
+        if (!vertexShader || !fragmentShader)
+            return nullptr;
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        return getProgramImpl(vertexShader, fragmentShader);
+    }
+
+    std::vector<ShaderManager::ProgramVariant> ShaderManager::readManifest(const std::string& path) const
+    {
+        std::vector<ProgramVariant> variants;
+
+        boost::filesystem::ifstream stream (path);
+        if (!stream.is_open())
+            return variants;
+
+        std::string line;
+        while (std::getline(stream, line))
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            std::istringstream lineStream (line);
+            ProgramVariant variant;
+            if (!(lineStream >> variant.mVertexTemplate >> variant.mFragmentTemplate))
+            {
+                Log(Debug::Warning) << "Warning: Invalid line in shader manifest " << path << ": " << line;
+                continue;
+            }
+
+            std::string define;
+            while (lineStream >> define)
+            {
+                size_t separator = define.find('=');
+                if (separator == std::string::npos)
+                    break;
+                variant.mDefines[define.substr(0, separator)] = define.substr(separator + 1);
+            }
+
+            variants.push_back(variant);
+        }
+
+        return variants;
+    }
+
+    void ShaderManager::writeManifest(const std::string& path)
+    {
+        std::ostringstream manifest;
+        manifest << "# Shader programs used in the last session: <vertex template> <fragment template> <define>=<value>...\n";
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            for (std::unordered_set<ProgramVariant, ProgramVariantHash>::const_iterator variant = mUsedPrograms.begin(); variant != mUsedPrograms.end(); ++variant)
+            {
+                bool valid = isManifestToken(variant->mVertexTemplate) && isManifestToken(variant->mFragmentTemplate);
+                for (DefineMap::const_iterator define = variant->mDefines.begin(); valid && define != variant->mDefines.end(); ++define)
+                    valid = isManifestToken(define->first) && isManifestValue(define->second);
+                if (!valid)
+                    continue;
+
+                manifest << variant->mVertexTemplate << ' ' << variant->mFragmentTemplate;
+                for (DefineMap::const_iterator define = variant->mDefines.begin(); define != variant->mDefines.end(); ++define)
+                    manifest << ' ' << define->first << '=' << define->second;
+                manifest << '\n';
+            }
+        }
+
+        try
+        {
+            boost::filesystem::path file (path);
+            if (file.has_parent_path())
+                boost::filesystem::create_directories(file.parent_path());
+
+            boost::filesystem::ofstream stream (file);
+            stream << manifest.str();
+            if (stream.fail())
+                Log(Debug::Warning) << "Warning: Failed to write shader manifest " << path;
+        }
+        catch (const std::exception& e)
+        {
+            Log(Debug::Warning) << "Warning: Failed to write shader manifest " << path << ": " << e.what();
+        }
+    }
+
     ShaderManager::DefineMap ShaderManager::getGlobalDefines()
     {
         return DefineMap(mGlobalDefines);
@@ -343,8 +514,8 @@ namespace Shader
         mGlobalDefines = globalDefines;
         for (auto shaderMapElement: mShaders)
         {
-            std::string templateId = shaderMapElement.first.first;
-            ShaderManager::DefineMap defines = shaderMapElement.first.second;
+            std::string templateId = shaderMapElement.first.mTemplate;
+            ShaderManager::DefineMap defines = shaderMapElement.first.mDefines;
             osg::ref_ptr<osg::Shader> shader = shaderMapElement.second;
             if (shader == nullptr)
                 // I'm not sure how to handle a shader that was already broken as there's no way to get a potential replacement to the nodes that need it.
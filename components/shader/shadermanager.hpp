@@ -3,6 +3,9 @@
 
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <osg/ref_ptr>
 
@@ -17,6 +20,8 @@ namespace Shader
 
     /// @brief Reads shader template files and turns them into a concrete shader, based on a list of define's.
     /// @par Shader templates can get the value of a define with the syntax @define.
+    /// @par The programs requested in a session can be written to a manifest, so that the next session can build them
+    /// in advance instead of when a material using them first appears.
     class ShaderManager
     {
     public:
@@ -24,6 +29,16 @@ namespace Shader
 
         typedef std::map<std::string, std::string> DefineMap;
 
+        /// @brief A program made of a vertex and a fragment shader template with the same defines.
+        struct ProgramVariant
+        {
+            std::string mVertexTemplate;
+            std::string mFragmentTemplate;
+            DefineMap mDefines;
+
+            bool operator==(const ProgramVariant& other) const;
+        };
+
         /// Create or retrieve a shader instance.
         /// @param shaderTemplate The filename of the shader template.
         /// @param defines Define values that can be retrieved by the shader template.
@@ -32,8 +47,22 @@ namespace Shader
         /// @note Thread safe.
         osg::ref_ptr<osg::Shader> getShader(const std::string& shaderTemplate, const DefineMap& defines, osg::Shader::Type shaderType);
 
+        /// @note Thread safe.
         osg::ref_ptr<osg::Program> getProgram(osg::ref_ptr<osg::Shader> vertexShader, osg::ref_ptr<osg::Shader> fragmentShader);
 
+        /// Build the program of a variant read from a manifest, without counting it as used in this session.
+        /// @return nullptr if a template is missing or fails to parse.
+        /// @note Thread safe.
+        osg::ref_ptr<osg::Program> buildProgram(const ProgramVariant& variant);
+
+        /// Read the program variants of a manifest written by writeManifest.
+        /// @note Thread safe.
+        std::vector<ProgramVariant> readManifest(const std::string& path) const;
+
+        /// Write the program variants requested through getProgram so far to a manifest.
+        /// @note Thread safe.
+        void writeManifest(const std::string& path);
+
         /// Get (a copy of) the DefineMap used to construct all shaders
         DefineMap getGlobalDefines();
 
@@ -53,13 +82,42 @@ namespace Shader
         typedef std::map<std::string, std::string> TemplateMap;
         TemplateMap mShaderTemplates;
 
-        typedef std::pair<std::string, DefineMap> MapKey;
-        typedef std::map<MapKey, osg::ref_ptr<osg::Shader> > ShaderMap;
+        /// @brief Identifies a shader variant. The hash is computed once, so that lookups only compare the whole
+        /// define map on a hash match.
+        struct ShaderKey
+        {
+            ShaderKey(const std::string& shaderTemplate, const DefineMap& defines);
+
+            bool operator==(const ShaderKey& other) const;
+
+            std::string mTemplate;
+            DefineMap mDefines;
+            std::size_t mHash;
+        };
+
+        struct ShaderKeyHash
+        {
+            std::size_t operator()(const ShaderKey& key) const { return key.mHash; }
+        };
+
+        struct ProgramVariantHash
+        {
+            std::size_t operator()(const ProgramVariant& variant) const;
+        };
+
+        typedef std::unordered_map<ShaderKey, osg::ref_ptr<osg::Shader>, ShaderKeyHash> ShaderMap;
         ShaderMap mShaders;
 
+        // the key each shader was created for, to find out the variant of a program
+        std::map<const osg::Shader*, ShaderKey> mShaderKeys;
+
         typedef std::map<std::pair<osg::ref_ptr<osg::Shader>, osg::ref_ptr<osg::Shader> >, osg::ref_ptr<osg::Program> > ProgramMap;
         ProgramMap mPrograms;
 
+        std::unordered_set<ProgramVariant, ProgramVariantHash> mUsedPrograms;
+
+        osg::ref_ptr<osg::Program> getProgramImpl(osg::ref_ptr<osg::Shader> vertexShader, osg::ref_ptr<osg::Shader> fragmentShader);
+
         OpenThreads::Mutex mMutex;
     };
 
@@ -148,7 +148,7 @@ namespace Shader
                 boost::replace_last(normalHeightMap, ".", mNormalHeightMapPattern + ".");
                 if (mImageManager.getVFS()->exists(normalHeightMap))
                 {
-                    image = mImageManager.getImage(normalHeightMap);
+                    image = mImageManager.getStreamedImage(normalHeightMap);
                     normalHeight = true;
                 }
                 else
@@ -156,7 +156,7 @@ namespace Shader
                     boost::replace_last(normalMapFileName, ".", mNormalMapPattern + ".");
                     if (mImageManager.getVFS()->exists(normalMapFileName))
                     {
-                        image = mImageManager.getImage(normalMapFileName);
+                        image = mImageManager.getStreamedImage(normalMapFileName);
                     }
                 }
 
@@ -187,7 +187,7 @@ namespace Shader
                 boost::replace_last(specularMapFileName, ".", mSpecularMapPattern + ".");
                 if (mImageManager.getVFS()->exists(specularMapFileName))
                 {
-                    osg::ref_ptr<osg::Image> image (mImageManager.getImage(specularMapFileName));
+                    osg::ref_ptr<osg::Image> image (mImageManager.getStreamedImage(specularMapFileName));
                     osg::ref_ptr<osg::Texture2D> specularMapTex (new osg::Texture2D(image));
                     specularMapTex->setTextureSize(image->s(), image->t());
                     specularMapTex->setWrap(osg::Texture::WRAP_S, diffuseMap->getWrap(osg::Texture::WRAP_S));
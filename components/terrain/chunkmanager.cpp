@@ -1,7 +1,9 @@
 #include "chunkmanager.hpp"
 
+#include <iomanip>
 #include <sstream>
 
+#include <osg/Image>
 #include <osg/Texture2D>
 
 #include <osgUtil/IncrementalCompileOperation>
@@ -12,11 +14,58 @@
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/lightmanager.hpp>
 
+#include <components/vfs/manager.hpp>
+
 #include "terraindrawable.hpp"
 #include "material.hpp"
 #include "storage.hpp"
 #include "texturemanager.hpp"
 #include "compositemaprenderer.hpp"
+#include "compositemapcache.hpp"
+
+namespace
+{
+
+    /// 64 bit FNV-1a, unlike std::hash the result is the same on every platform and build.
+    class Hash
+    {
+    public:
+        Hash()
+            : mValue(14695981039346656037ull)
+        {
+        }
+
+        void add(const void* data, std::size_t size)
+        {
+            const unsigned char* bytes = static_cast<const unsigned char*>(data);
+            for (std::size_t i=0; i<size; ++i)
+            {
+                mValue ^= bytes[i];
+                mValue *= 1099511628211ull;
+            }
+        }
+
+        template <class T>
+        void add(const T& value)
+        {
+            add(&value, sizeof(T));
+        }
+
+        void add(const std::string& value)
+        {
+            add(value.c_str(), value.size()+1);
+        }
+
+        unsigned long long getValue() const { return mValue; }
+
+    private:
+        unsigned long long mValue;
+    };
+
+    /// Increase when the way composite maps are rendered changes, to invalidate existing caches.
+    const int sCompositeMapCacheVersion = 1;
+
+}
 
 namespace Terrain
 {
@@ -48,6 +97,11 @@ osg::ref_ptr<osg::Node> ChunkManager::getChunk(float size, const osg::Vec2f &cen
     }
 }
 
+void ChunkManager::setCompositeMapCache(CompositeMapCache* cache)
+{
+    mCompositeMapCache = cache;
+}
+
 void ChunkManager::reportStats(unsigned int frameNumber, osg::Stats *stats) const
 {
     stats->setAttribute(frameNumber, "Terrain Chunk", mCache->getCacheSize());
@@ -80,35 +134,79 @@ osg::ref_ptr<osg::Texture2D> ChunkManager::createCompositeMapRTT()
     return texture;
 }
 
-void ChunkManager::createCompositeMapGeometry(float chunkSize, const osg::Vec2f& chunkCenter, const osg::Vec4f& texCoords, CompositeMap& compositeMap)
+void ChunkManager::getCompositeMapParts(float chunkSize, const osg::Vec2f& chunkCenter, const osg::Vec4f& texCoords, std::vector<CompositeMapPart>& parts)
 {
     if (chunkSize > mMaxCompGeometrySize)
     {
-        createCompositeMapGeometry(chunkSize/2.f, chunkCenter + osg::Vec2f(chunkSize/4.f, chunkSize/4.f), osg::Vec4f(texCoords.x() + texCoords.z()/2.f, texCoords.y(), texCoords.z()/2.f, texCoords.w()/2.f), compositeMap);
-        createCompositeMapGeometry(chunkSize/2.f, chunkCenter + osg::Vec2f(-chunkSize/4.f, chunkSize/4.f), osg::Vec4f(texCoords.x(), texCoords.y(), texCoords.z()/2.f, texCoords.w()/2.f), compositeMap);
-        createCompositeMapGeometry(chunkSize/2.f, chunkCenter + osg::Vec2f(chunkSize/4.f, -chunkSize/4.f), osg::Vec4f(texCoords.x() + texCoords.z()/2.f, texCoords.y()+texCoords.w()/2.f, texCoords.z()/2.f, texCoords.w()/2.f), compositeMap);
-        createCompositeMapGeometry(chunkSize/2.f, chunkCenter + osg::Vec2f(-chunkSize/4.f, -chunkSize/4.f), osg::Vec4f(texCoords.x(), texCoords.y()+texCoords.w()/2.f, texCoords.z()/2.f, texCoords.w()/2.f), compositeMap);
+        getCompositeMapParts(chunkSize/2.f, chunkCenter + osg::Vec2f(chunkSize/4.f, chunkSize/4.f), osg::Vec4f(texCoords.x() + texCoords.z()/2.f, texCoords.y(), texCoords.z()/2.f, texCoords.w()/2.f), parts);
+        getCompositeMapParts(chunkSize/2.f, chunkCenter + osg::Vec2f(-chunkSize/4.f, chunkSize/4.f), osg::Vec4f(texCoords.x(), texCoords.y(), texCoords.z()/2.f, texCoords.w()/2.f), parts);
+        getCompositeMapParts(chunkSize/2.f, chunkCenter + osg::Vec2f(chunkSize/4.f, -chunkSize/4.f), osg::Vec4f(texCoords.x() + texCoords.z()/2.f, texCoords.y()+texCoords.w()/2.f, texCoords.z()/2.f, texCoords.w()/2.f), parts);
+        getCompositeMapParts(chunkSize/2.f, chunkCenter + osg::Vec2f(-chunkSize/4.f, -chunkSize/4.f), osg::Vec4f(texCoords.x(), texCoords.y()+texCoords.w()/2.f, texCoords.z()/2.f, texCoords.w()/2.f), parts);
     }
     else
     {
-        float left = texCoords.x()*2.f-1;
-        float top = texCoords.y()*2.f-1;
-        float width = texCoords.z()*2.f;
-        float height = texCoords.w()*2.f;
+        CompositeMapPart part;
+        part.mSize = chunkSize;
+        part.mCenter = chunkCenter;
+        part.mTexCoords = texCoords;
+        mStorage->getBlendmaps(chunkSize, chunkCenter, part.mBlendmaps, part.mLayerList);
+        parts.push_back(part);
+    }
+}
 
-        std::vector<osg::ref_ptr<osg::StateSet> > passes = createPasses(chunkSize, chunkCenter, true);
-        for (std::vector<osg::ref_ptr<osg::StateSet> >::iterator it = passes.begin(); it != passes.end(); ++it)
-        {
-            osg::ref_ptr<osg::Geometry> geom = osg::createTexturedQuadGeometry(osg::Vec3(left,top,0), osg::Vec3(width,0,0), osg::Vec3(0,height,0));
-            geom->setUseDisplayList(false); // don't bother making a display list for an object that is just rendered once.
-            geom->setUseVertexBufferObjects(false);
-            geom->setTexCoordArray(1, geom->getTexCoordArray(0), osg::Array::BIND_PER_VERTEX);
+void ChunkManager::createCompositeMapGeometry(const CompositeMapPart& part, CompositeMap& compositeMap)
+{
+    float left = part.mTexCoords.x()*2.f-1;
+    float top = part.mTexCoords.y()*2.f-1;
+    float width = part.mTexCoords.z()*2.f;
+    float height = part.mTexCoords.w()*2.f;
+
+    std::vector<osg::ref_ptr<osg::StateSet> > passes = createPasses(part.mSize, part.mLayerList, part.mBlendmaps, true);
+    for (std::vector<osg::ref_ptr<osg::StateSet> >::iterator it = passes.begin(); it != passes.end(); ++it)
+    {
+        osg::ref_ptr<osg::Geometry> geom = osg::createTexturedQuadGeometry(osg::Vec3(left,top,0), osg::Vec3(width,0,0), osg::Vec3(0,height,0));
+        geom->setUseDisplayList(false); // don't bother making a display list for an object that is just rendered once.
+        geom->setUseVertexBufferObjects(false);
+        geom->setTexCoordArray(1, geom->getTexCoordArray(0), osg::Array::BIND_PER_VERTEX);
 
-            geom->setStateSet(*it);
+        geom->setStateSet(*it);
 
-            compositeMap.mDrawables.push_back(geom);
+        compositeMap.mDrawables.push_back(geom);
+    }
+}
+
+std::string ChunkManager::getCompositeMapKey(float chunkSize, const osg::Vec2f& chunkCenter, const std::vector<CompositeMapPart>& parts) const
+{
+    const VFS::Manager* vfs = mSceneManager->getVFS();
+
+    Hash hash;
+    hash.add(sCompositeMapCacheVersion);
+    hash.add(mCompositeMapSize);
+    hash.add(chunkSize);
+    hash.add(chunkCenter);
+
+    for (std::vector<CompositeMapPart>::const_iterator part = parts.begin(); part != parts.end(); ++part)
+    {
+        hash.add(part->mTexCoords);
+        for (std::vector<LayerInfo>::const_iterator layer = part->mLayerList.begin(); layer != part->mLayerList.end(); ++layer)
+        {
+            hash.add(layer->mDiffuseMap);
+            // the file the texture resolves to, so that a texture replacer invalidates the cached maps
+            std::string normalized = layer->mDiffuseMap;
+            vfs->normalizeFilename(normalized);
+            hash.add(vfs->getStamp(normalized));
+        }
+        for (std::vector<osg::ref_ptr<osg::Image> >::const_iterator blendmap = part->mBlendmaps.begin(); blendmap != part->mBlendmaps.end(); ++blendmap)
+        {
+            hash.add((*blendmap)->s());
+            hash.add((*blendmap)->t());
+            hash.add((*blendmap)->data(), (*blendmap)->getTotalDataSize());
         }
     }
+
+    std::ostringstream stream;
+    stream << std::hex << std::setfill('0') << std::setw(16) << hash.getValue();
+    return stream.str();
 }
 
 std::vector<osg::ref_ptr<osg::StateSet> > ChunkManager::createPasses(float chunkSize, const osg::Vec2f &chunkCenter, bool forCompositeMap)
@@ -117,6 +215,13 @@ std::vector<osg::ref_ptr<osg::StateSet> > ChunkManager::createPasses(float chunk
     std::vector<osg::ref_ptr<osg::Image> > blendmaps;
     mStorage->getBlendmaps(chunkSize, chunkCenter, blendmaps, layerList);
 
+    return createPasses(chunkSize, layerList, blendmaps, forCompositeMap);
+}
+
+std::vector<osg::ref_ptr<osg::StateSet> > ChunkManager::createPasses(float chunkSize, const std::vector<LayerInfo>& layerList,
+                                                                     const std::vector<osg::ref_ptr<osg::Image> >& blendmaps, bool forCompositeMap)
+{
+
     bool useShaders = mSceneManager->getForceShaders();
     if (!mSceneManager->getClampLighting())
         useShaders = true; // always use shaders when lighting is unclamped, this is to avoid lighting seams between a terrain chunk with normal maps and one without normal maps
@@ -200,18 +305,41 @@ osg::ref_ptr<osg::Node> ChunkManager::createChunk(float chunkSize, const osg::Ve
 
     if (useCompositeMap)
     {
-        osg::ref_ptr<CompositeMap> compositeMap = new CompositeMap;
-        compositeMap->mTexture = createCompositeMapRTT();
+        std::vector<CompositeMapPart> parts;
+        getCompositeMapParts(chunkSize, chunkCenter, osg::Vec4f(0,0,1,1), parts);
 
-        createCompositeMapGeometry(chunkSize, chunkCenter, osg::Vec4f(0,0,1,1), *compositeMap);
+        std::string cacheKey;
+        osg::ref_ptr<osg::Image> cachedImage;
+        if (mCompositeMapCache)
+        {
+            cacheKey = getCompositeMapKey(chunkSize, chunkCenter, parts);
+            cachedImage = mCompositeMapCache->load(cacheKey);
+        }
 
-        mCompositeMapRenderer->addCompositeMap(compositeMap.get(), false);
+        osg::ref_ptr<osg::Texture2D> texture = createCompositeMapRTT();
+        if (cachedImage && cachedImage->s() == static_cast<int>(mCompositeMapSize) && cachedImage->t() == static_cast<int>(mCompositeMapSize))
+        {
+            texture->setImage(cachedImage);
+            texture->setUnRefImageDataAfterApply(true);
+        }
+        else
+        {
+            osg::ref_ptr<CompositeMap> compositeMap = new CompositeMap;
+            compositeMap->mTexture = texture;
+            compositeMap->mCache = mCompositeMapCache;
+            compositeMap->mCacheKey = cacheKey;
 
-        geometry->setCompositeMap(compositeMap);
-        geometry->setCompositeMapRenderer(mCompositeMapRenderer);
+            for (std::vector<CompositeMapPart>::const_iterator part = parts.begin(); part != parts.end(); ++part)
+                createCompositeMapGeometry(*part, *compositeMap);
+
+            mCompositeMapRenderer->addCompositeMap(compositeMap.get(), false);
+
+            geometry->setCompositeMap(compositeMap);
+            geometry->setCompositeMapRenderer(mCompositeMapRenderer);
+        }
 
         TextureLayer layer;
-        layer.mDiffuseMap = compositeMap->mTexture;
+        layer.mDiffuseMap = texture;
         layer.mParallax = false;
         layer.mSpecular = false;
         geometry->setPasses(::Terrain::createPasses(mSceneManager->getForceShaders() || !mSceneManager->getClampLighting(), &mSceneManager->getShaderManager(), std::vector<TextureLayer>(1, layer), std::vector<osg::ref_ptr<osg::Texture2D> >(), 1.f, 1.f));
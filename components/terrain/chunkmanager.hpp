@@ -1,15 +1,19 @@
 #ifndef OPENMW_COMPONENTS_TERRAIN_CHUNKMANAGER_H
 #define OPENMW_COMPONENTS_TERRAIN_CHUNKMANAGER_H
 
+#include <string>
 #include <tuple>
 
 #include <components/resource/resourcemanager.hpp>
 
 #include "buffercache.hpp"
+#include "defs.hpp"
+#include "quadtreeworld.hpp"
 
 namespace osg
 {
     class Group;
+    class Image;
     class Texture2D;
 }
 
@@ -23,24 +27,34 @@ namespace Terrain
 
     class TextureManager;
     class CompositeMapRenderer;
+    class CompositeMapCache;
     class Storage;
     class CompositeMap;
 
     typedef std::tuple<osg::Vec2f, unsigned char, unsigned int> ChunkId; // Center, Lod, Lod Flags
 
     /// @brief Handles loading and caching of terrain chunks
-    class ChunkManager : public Resource::GenericResourceManager<ChunkId>
+    class ChunkManager : public Resource::GenericResourceManager<ChunkId>, public QuadTreeWorld::ChunkManager
     {
     public:
         ChunkManager(Storage* storage, Resource::SceneManager* sceneMgr, TextureManager* textureManager, CompositeMapRenderer* renderer);
 
         osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags);
 
+        osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags, const osg::Vec4i& activeGrid) override
+        {
+            return getChunk(size, center, lod, lodFlags);
+        }
+
         void setCullingActive(bool active) { mCullingActive = active; }
         void setCompositeMapSize(unsigned int size) { mCompositeMapSize = size; }
         void setCompositeMapLevel(float level) { mCompositeMapLevel = level; }
         void setMaxCompositeGeometrySize(float maxCompGeometrySize) { mMaxCompGeometrySize = maxCompGeometrySize; }
 
+        /// Load composite maps from and store them in \a cache instead of always rendering them.
+        /// @note Not thread safe.
+        void setCompositeMapCache(CompositeMapCache* cache);
+
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
 
         void clearCache() override;
@@ -52,14 +66,33 @@ namespace Terrain
 
         osg::ref_ptr<osg::Texture2D> createCompositeMapRTT();
 
-        void createCompositeMapGeometry(float chunkSize, const osg::Vec2f& chunkCenter, const osg::Vec4f& texCoords, CompositeMap& map);
+        /// @brief A region of a composite map that is rendered in one go.
+        struct CompositeMapPart
+        {
+            float mSize;
+            osg::Vec2f mCenter;
+            osg::Vec4f mTexCoords;
+            std::vector<LayerInfo> mLayerList;
+            std::vector<osg::ref_ptr<osg::Image> > mBlendmaps;
+        };
+
+        void getCompositeMapParts(float chunkSize, const osg::Vec2f& chunkCenter, const osg::Vec4f& texCoords, std::vector<CompositeMapPart>& parts);
+
+        void createCompositeMapGeometry(const CompositeMapPart& part, CompositeMap& map);
+
+        /// Hash everything the composite map is rendered from.
+        std::string getCompositeMapKey(float chunkSize, const osg::Vec2f& chunkCenter, const std::vector<CompositeMapPart>& parts) const;
 
         std::vector<osg::ref_ptr<osg::StateSet> > createPasses(float chunkSize, const osg::Vec2f& chunkCenter, bool forCompositeMap);
 
+        std::vector<osg::ref_ptr<osg::StateSet> > createPasses(float chunkSize, const std::vector<LayerInfo>& layerList,
+                                                               const std::vector<osg::ref_ptr<osg::Image> >& blendmaps, bool forCompositeMap);
+
         Terrain::Storage* mStorage;
         Resource::SceneManager* mSceneManager;
         TextureManager* mTextureManager;
         CompositeMapRenderer* mCompositeMapRenderer;
+        osg::ref_ptr<CompositeMapCache> mCompositeMapCache;
         BufferCache mBufferCache;
 
         unsigned int mCompositeMapSize;
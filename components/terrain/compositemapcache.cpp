@@ -0,0 +1,87 @@
+#include "compositemapcache.hpp"
+
+#include <osg/Image>
+
+#include <osgDB/ReaderWriter>
+#include <osgDB/Registry>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <components/debug/debuglog.hpp>
+
+namespace Terrain
+{
+
+CompositeMapCache::CompositeMapCache(const std::string& path)
+    : mPath(path)
+{
+}
+
+std::string CompositeMapCache::getFileName(const std::string& key) const
+{
+    return (boost::filesystem::path(mPath) / (key + ".png")).string();
+}
+
+osg::ref_ptr<osg::Image> CompositeMapCache::load(const std::string& key) const
+{
+    std::string fileName = getFileName(key);
+
+    boost::system::error_code error;
+    if (!boost::filesystem::exists(fileName, error))
+        return nullptr;
+
+    osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("png");
+    if (!readerwriter)
+    {
+        Log(Debug::Error) << "Error: Can't read composite map: no png readerwriter found";
+        return nullptr;
+    }
+
+    boost::filesystem::ifstream stream (fileName, std::ios::binary);
+    osgDB::ReaderWriter::ReadResult result = readerwriter->readImage(stream);
+    if (!result.success())
+    {
+        Log(Debug::Warning) << "Warning: Can't read composite map " << fileName << ": " << result.message() << " code " << result.status();
+        return nullptr;
+    }
+
+    return result.getImage();
+}
+
+void CompositeMapCache::save(const std::string& key, const osg::Image& image) const
+{
+    osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("png");
+    if (!readerwriter)
+    {
+        Log(Debug::Error) << "Error: Can't write composite map: no png readerwriter found";
+        return;
+    }
+
+    try
+    {
+        boost::filesystem::create_directories(mPath);
+
+        // write to a temporary file first, so that an interrupted write never leaves a truncated map behind
+        boost::filesystem::path fileName = getFileName(key);
+        boost::filesystem::path tempName = boost::filesystem::path(mPath) / boost::filesystem::unique_path(key + "-%%%%%%%%.tmp");
+        {
+            boost::filesystem::ofstream stream (tempName, std::ios::binary);
+            osgDB::ReaderWriter::WriteResult result = readerwriter->writeImage(image, stream);
+            if (!result.success())
+            {
+                Log(Debug::Warning) << "Warning: Can't write composite map " << fileName.string() << ": " << result.message() << " code " << result.status();
+                stream.close();
+                boost::filesystem::remove(tempName);
+                return;
+            }
+        }
+        boost::filesystem::rename(tempName, fileName);
+    }
+    catch (const std::exception& e)
+    {
+        Log(Debug::Warning) << "Warning: Can't write composite map to " << mPath << ": " << e.what();
+    }
+}
+
+}
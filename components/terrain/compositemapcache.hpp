@@ -0,0 +1,41 @@
+#ifndef OPENMW_COMPONENTS_TERRAIN_COMPOSITEMAPCACHE_H
+#define OPENMW_COMPONENTS_TERRAIN_COMPOSITEMAPCACHE_H
+
+#include <osg/Referenced>
+#include <osg/ref_ptr>
+
+#include <string>
+
+namespace osg
+{
+    class Image;
+}
+
+namespace Terrain
+{
+
+    /// @brief Stores rendered composite maps on disk, so that they do not have to be rendered again in the next session.
+    /// @par The cache is keyed by a hash of everything the composite map is rendered from, i.e. a changed land or land texture
+    /// record results in a new key. Outdated files are never removed, the cache directory may be deleted at any time.
+    class CompositeMapCache : public osg::Referenced
+    {
+    public:
+        /// @param path Directory to store the composite maps in, is created when the first map is saved.
+        CompositeMapCache(const std::string& path);
+
+        /// @return The stored composite map, or nullptr if there is none for this key.
+        /// @note Thread safe.
+        osg::ref_ptr<osg::Image> load(const std::string& key) const;
+
+        /// @note Thread safe.
+        void save(const std::string& key, const osg::Image& image) const;
+
+    private:
+        std::string getFileName(const std::string& key) const;
+
+        std::string mPath;
+    };
+
+}
+
+#endif
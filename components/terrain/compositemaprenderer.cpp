@@ -3,6 +3,7 @@
 #include <OpenThreads/ScopedLock>
 
 #include <osg/FrameBufferObject>
+#include <osg/Image>
 #include <osg/Texture2D>
 #include <osg/RenderInfo>
 
@@ -11,6 +12,34 @@
 
 #include <algorithm>
 
+#include "compositemapcache.hpp"
+
+namespace
+{
+
+    class SaveCompositeMapWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        SaveCompositeMapWorkItem(Terrain::CompositeMapCache* cache, const std::string& key, osg::Image* image)
+            : mCache(cache)
+            , mKey(key)
+            , mImage(image)
+        {
+        }
+
+        virtual void doWork()
+        {
+            mCache->save(mKey, *mImage);
+        }
+
+    private:
+        osg::ref_ptr<Terrain::CompositeMapCache> mCache;
+        std::string mKey;
+        osg::ref_ptr<osg::Image> mImage;
+    };
+
+}
+
 namespace Terrain
 {
 
@@ -107,7 +136,8 @@ void CompositeMapRenderer::compile(CompositeMap &compositeMap, osg::RenderInfo &
 
     osg::FrameBufferAttachment attach (compositeMap.mTexture);
     mFBO->setAttachment(osg::Camera::COLOR_BUFFER, attach);
-    mFBO->apply(state, osg::FrameBufferObject::DRAW_FRAMEBUFFER);
+    // also bound for reading, so that finished maps can be read back for the cache
+    mFBO->apply(state, osg::FrameBufferObject::READ_DRAW_FRAMEBUFFER);
 
     GLenum status = ext->glCheckFramebufferStatus(GL_FRAMEBUFFER_EXT);
 
@@ -157,8 +187,19 @@ void CompositeMapRenderer::compile(CompositeMap &compositeMap, osg::RenderInfo &
         }
     }
     if (compositeMap.mCompiled == compositeMap.mDrawables.size())
+    {
         compositeMap.mDrawables = std::vector<osg::ref_ptr<osg::Drawable>>();
 
+        if (compositeMap.mCache && mWorkQueue)
+        {
+            // stalls until the map is rendered, but only once per map and installation
+            osg::ref_ptr<osg::Image> image (new osg::Image);
+            image->readPixels(0, 0, compositeMap.mTexture->getTextureWidth(), compositeMap.mTexture->getTextureHeight(), GL_RGB, GL_UNSIGNED_BYTE);
+            mWorkQueue->addWorkItem(new SaveCompositeMapWorkItem(compositeMap.mCache, compositeMap.mCacheKey, image));
+        }
+        compositeMap.mCache = nullptr;
+    }
+
     state.haveAppliedAttribute(osg::StateAttribute::VIEWPORT);
 
     GLuint fboId = state.getGraphicsContext() ? state.getGraphicsContext()->getDefaultFboId() : 0;
@@ -6,6 +6,7 @@
 #include <OpenThreads/Mutex>
 
 #include <set>
+#include <string>
 
 namespace osg
 {
@@ -23,6 +24,8 @@ namespace SceneUtil
 namespace Terrain
 {
 
+    class CompositeMapCache;
+
     class CompositeMap : public osg::Referenced
     {
     public:
@@ -31,6 +34,10 @@ namespace Terrain
         std::vector<osg::ref_ptr<osg::Drawable> > mDrawables;
         osg::ref_ptr<osg::Texture2D> mTexture;
         unsigned int mCompiled;
+
+        /// If set, the map is read back once it is fully rendered and stored in the cache under mCacheKey.
+        osg::ref_ptr<CompositeMapCache> mCache;
+        std::string mCacheKey;
     };
 
     /**
@@ -2,10 +2,13 @@
 
 #include <osgUtil/CullVisitor>
 
+#include <algorithm>
 #include <sstream>
 
+#include <components/debug/debuglog.hpp>
 #include <components/misc/constants.hpp>
 #include <components/sceneutil/mwshadowtechnique.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include "quadtreenode.hpp"
 #include "storage.hpp"
@@ -225,7 +228,11 @@ QuadTreeWorld::QuadTreeWorld(osg::Group *parent, osg::Group *compileRoot, Resour
     , mLodFactor(lodFactor)
     , mVertexLodMod(vertexLodMod)
     , mViewDistance(std::numeric_limits<float>::max())
+    , mNumPreloadThreads(1)
+    , mRevision(0)
 {
+    mChunkManagers.push_back(mChunkManager.get());
+
     mChunkManager->setCompositeMapSize(compMapResolution);
     mChunkManager->setCompositeMapLevel(compMapLevel);
     mChunkManager->setMaxCompositeGeometrySize(maxCompGeometrySize);
@@ -287,7 +294,25 @@ unsigned int getLodFlags(QuadTreeNode* node, int ourLod, int vertexLodMod, ViewD
     return lodFlags;
 }
 
-void loadRenderingNode(ViewData::Entry& entry, ViewData* vd, int vertexLodMod, ChunkManager* chunkManager)
+bool intersects(QuadTreeNode* node, const osg::Vec4i& grid)
+{
+    float halfSize = node->getSize()/2.f;
+    const osg::Vec2f& center = node->getCenter();
+    return center.x() - halfSize < grid.z() && center.x() + halfSize > grid.x()
+        && center.y() - halfSize < grid.w() && center.y() + halfSize > grid.y();
+}
+
+/// discard the rendering nodes of a view that was loaded before the chunk state of the world changed
+void updateRevision(ViewData* vd, unsigned int revision)
+{
+    if (vd->getRevision() != revision)
+    {
+        vd->clearRenderingNodes();
+        vd->setRevision(revision);
+    }
+}
+
+void loadRenderingNode(ViewData::Entry& entry, ViewData* vd, int vertexLodMod, const std::vector<QuadTreeWorld::ChunkManager*>& chunkManagers, const osg::Vec4i& activeGrid)
 {
     if (!vd->hasChanged() && entry.mRenderingNode)
         return;
@@ -306,9 +331,145 @@ void loadRenderingNode(ViewData::Entry& entry, ViewData* vd, int vertexLodMod, C
     }
 
     if (!entry.mRenderingNode)
-        entry.mRenderingNode = chunkManager->getChunk(entry.mNode->getSize(), entry.mNode->getCenter(), ourLod, entry.mLodFlags);
+    {
+        float size = entry.mNode->getSize();
+        const osg::Vec2f& center = entry.mNode->getCenter();
+        osg::Vec4i chunkGrid = intersects(entry.mNode, activeGrid) ? activeGrid : osg::Vec4i();
+
+        if (chunkManagers.size() == 1)
+            entry.mRenderingNode = chunkManagers[0]->getChunk(size, center, ourLod, entry.mLodFlags, chunkGrid);
+        else
+        {
+            osg::ref_ptr<osg::Group> group (new osg::Group);
+            for (std::vector<QuadTreeWorld::ChunkManager*>::const_iterator it = chunkManagers.begin(); it != chunkManagers.end(); ++it)
+            {
+                osg::ref_ptr<osg::Node> node = (*it)->getChunk(size, center, ourLod, entry.mLodFlags, chunkGrid);
+                if (node)
+                    group->addChild(node);
+            }
+            entry.mRenderingNode = group;
+        }
+    }
 }
 
+/// Builds the chunks of a view for a new revision, so that the cull thread finds them in the chunk caches.
+class RebuildViewWorkItem : public SceneUtil::WorkItem
+{
+public:
+    RebuildViewWorkItem(ViewData* view, int vertexLodMod, const std::vector<QuadTreeWorld::ChunkManager*>& chunkManagers, const osg::Vec4i& activeGrid)
+        : mVertexLodMod(vertexLodMod)
+        , mChunkManagers(chunkManagers)
+        , mActiveGrid(activeGrid)
+    {
+        mView.copyFrom(*view);
+        mView.clearRenderingNodes();
+    }
+
+    void doWork() override
+    {
+        // the rendering nodes are kept until the work item is released, so that the caches can not expire them in between
+        for (unsigned int i=0; i<mView.getNumEntries(); ++i)
+        {
+            try
+            {
+                loadRenderingNode(mView.getEntry(i), &mView, mVertexLodMod, mChunkManagers, mActiveGrid);
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Error) << "Failed to rebuild terrain chunk: " << e.what();
+            }
+        }
+    }
+
+private:
+    ViewData mView;
+    int mVertexLodMod;
+    std::vector<QuadTreeWorld::ChunkManager*> mChunkManagers;
+    osg::Vec4i mActiveGrid;
+};
+
+/// State shared by the threads building the chunks of a preloaded view.
+/// @note Helper work items may start after QuadTreeWorld::preload has returned, so they only touch the view while entries are left.
+class PreloadState : public osg::Referenced
+{
+public:
+    PreloadState(ViewData* view, int vertexLodMod, const std::vector<QuadTreeWorld::ChunkManager*>& chunkManagers, const osg::Vec4i& activeGrid, std::atomic<bool>& abort)
+        : mView(view)
+        , mNumEntries(view->getNumEntries())
+        , mVertexLodMod(vertexLodMod)
+        , mChunkManagers(chunkManagers)
+        , mActiveGrid(activeGrid)
+        , mAbort(abort)
+        , mNextEntry(0)
+        , mNumActive(0)
+    {
+    }
+
+    void loadEntries()
+    {
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            ++mNumActive;
+        }
+
+        for (unsigned int i = mNextEntry++; i<mNumEntries && !mAbort; i = mNextEntry++)
+        {
+            try
+            {
+                loadRenderingNode(mView->getEntry(i), mView, mVertexLodMod, mChunkManagers, mActiveGrid);
+            }
+            catch (const std::exception& e)
+            {
+                Log(Debug::Error) << "Failed to preload terrain chunk: " << e.what();
+            }
+        }
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        if (--mNumActive == 0)
+            mCondition.broadcast();
+    }
+
+    /// Hand out no more entries and wait for the threads still building one.
+    void finish()
+    {
+        mNextEntry = mNumEntries;
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        while (mNumActive > 0)
+            mCondition.wait(&mMutex);
+    }
+
+private:
+    ViewData* mView;
+    unsigned int mNumEntries;
+    int mVertexLodMod;
+    std::vector<QuadTreeWorld::ChunkManager*> mChunkManagers;
+    osg::Vec4i mActiveGrid;
+    std::atomic<bool>& mAbort;
+
+    std::atomic<unsigned int> mNextEntry;
+    OpenThreads::Mutex mMutex;
+    OpenThreads::Condition mCondition;
+    unsigned int mNumActive;
+};
+
+class PreloadHelperWorkItem : public SceneUtil::WorkItem
+{
+public:
+    PreloadHelperWorkItem(PreloadState* state)
+        : mState(state)
+    {
+    }
+
+    void doWork() override
+    {
+        mState->loadEntries();
+    }
+
+private:
+    osg::ref_ptr<PreloadState> mState;
+};
+
 void QuadTreeWorld::accept(osg::NodeVisitor &nv)
 {
     bool isCullVisitor = nv.getVisitorType() == osg::NodeVisitor::CULL_VISITOR;
@@ -371,11 +532,41 @@ void QuadTreeWorld::accept(osg::NodeVisitor &nv)
         }
     }
 
+    osg::Vec4i activeGrid;
+    unsigned int revision;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mActiveGridMutex);
+        activeGrid = mActiveGrid;
+        revision = mRevision;
+    }
+
+    if (vd->getRevision() != revision && isCullVisitor && mWorkQueue)
+    {
+        // keep rendering the stale chunks until the new ones are built in the background
+        SceneUtil::WorkItem* pending = vd->getPendingRebuild();
+        if (pending && pending->isDone())
+        {
+            if (vd->getPendingRevision() == revision)
+                updateRevision(vd, revision);
+            vd->setPendingRebuild(nullptr, 0);
+            pending = nullptr;
+        }
+
+        if (!pending && vd->getRevision() != revision)
+        {
+            osg::ref_ptr<SceneUtil::WorkItem> item (new RebuildViewWorkItem(vd, mVertexLodMod, mChunkManagers, activeGrid));
+            mWorkQueue->addWorkItem(item);
+            vd->setPendingRebuild(item, revision);
+        }
+    }
+    else
+        updateRevision(vd, revision);
+
     for (unsigned int i=0; i<vd->getNumEntries(); ++i)
     {
         ViewData::Entry& entry = vd->getEntry(i);
 
-        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get());
+        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManagers, activeGrid);
 
         entry.mRenderingNode->accept(nv);
     }
@@ -429,10 +620,19 @@ void QuadTreeWorld::cacheCell(View *view, int x, int y)
     ViewData* vd = static_cast<ViewData*>(view);
     mRootNode->traverseTo(vd, 1, osg::Vec2f(x+0.5f,y+0.5f));
 
+    osg::Vec4i activeGrid;
+    unsigned int revision;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mActiveGridMutex);
+        activeGrid = mActiveGrid;
+        revision = mRevision;
+    }
+    updateRevision(vd, revision);
+
     for (unsigned int i=0; i<vd->getNumEntries(); ++i)
     {
         ViewData::Entry& entry = vd->getEntry(i);
-        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get());
+        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManagers, activeGrid);
     }
 }
 
@@ -449,11 +649,28 @@ void QuadTreeWorld::preload(View *view, const osg::Vec3f &viewPoint, std::atomic
     vd->setViewPoint(viewPoint);
     mRootNode->traverse(vd, viewPoint, mLodCallback, mViewDistance);
 
-    for (unsigned int i=0; i<vd->getNumEntries() && !abort; ++i)
+    osg::Vec4i activeGrid;
+    unsigned int revision;
     {
-        ViewData::Entry& entry = vd->getEntry(i);
-        loadRenderingNode(entry, vd, mVertexLodMod, mChunkManager.get());
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mActiveGridMutex);
+        activeGrid = mActiveGrid;
+        revision = mRevision;
     }
+    updateRevision(vd, revision);
+
+    // the chunks do not depend on each other, so they are handed out one at a time to all threads
+    osg::ref_ptr<PreloadState> state (new PreloadState(vd, mVertexLodMod, mChunkManagers, activeGrid, abort));
+
+    if (mPreloadWorkQueue)
+    {
+        unsigned int numThreads = std::min(mNumPreloadThreads, vd->getNumEntries());
+        for (unsigned int i=1; i<numThreads; ++i)
+            mPreloadWorkQueue->addWorkItem(new PreloadHelperWorkItem(state));
+    }
+
+    state->loadEntries();
+    state->finish();
+
     vd->markUnchanged();
 }
 
@@ -472,6 +689,35 @@ void QuadTreeWorld::reportStats(unsigned int frameNumber, osg::Stats *stats)
     stats->setAttribute(frameNumber, "Composite", mCompositeMapRenderer->getCompileSetSize());
 }
 
+void QuadTreeWorld::setActiveGrid(const osg::Vec4i &grid)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mActiveGridMutex);
+    if (grid == mActiveGrid)
+        return;
+
+    mActiveGrid = grid;
+    ++mRevision;
+}
+
+void QuadTreeWorld::rebuildViews()
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mActiveGridMutex);
+    ++mRevision;
+}
+
+void QuadTreeWorld::setNumPreloadThreads(unsigned int numThreads)
+{
+    mNumPreloadThreads = std::max(1u, numThreads);
+
+    // the thread calling preload() builds chunks as well
+    mPreloadWorkQueue = mNumPreloadThreads > 1 ? new SceneUtil::WorkQueue(mNumPreloadThreads - 1) : nullptr;
+}
+
+void QuadTreeWorld::addChunkManager(QuadTreeWorld::ChunkManager* chunkManager)
+{
+    mChunkManagers.push_back(chunkManager);
+}
+
 void QuadTreeWorld::loadCell(int x, int y)
 {
     // fallback behavior only for undefined cells (every other is already handled in quadtree)
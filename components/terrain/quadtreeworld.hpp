@@ -6,6 +6,8 @@
 
 #include <OpenThreads/Mutex>
 
+#include <vector>
+
 namespace osg
 {
     class NodeVisitor;
@@ -14,6 +16,7 @@ namespace osg
 namespace Terrain
 {
     class RootNode;
+    class ViewData;
     class ViewDataMap;
     class LodCallback;
 
@@ -38,11 +41,37 @@ namespace Terrain
         virtual void unloadCell(int x, int y);
 
         View* createView();
+        /// @note The chunks of the view are built on up to getNumPreloadThreads() threads, including the calling one.
         void preload(View* view, const osg::Vec3f& eyePoint, std::atomic<bool>& abort);
         void storeView(const View* view, double referenceTime);
 
         void reportStats(unsigned int frameNumber, osg::Stats* stats);
 
+        virtual void setActiveGrid(const osg::Vec4i& grid);
+
+        virtual void rebuildViews();
+
+        /// Build the chunks of preloaded views on \a numThreads threads, including the one calling preload(). The other
+        /// threads are kept in a WorkQueue of their own.
+        /// @note Not thread safe.
+        void setNumPreloadThreads(unsigned int numThreads);
+        unsigned int getNumPreloadThreads() const { return mNumPreloadThreads; }
+
+        /// @brief Provides the nodes rendered for each quad tree node.
+        class ChunkManager
+        {
+        public:
+            virtual ~ChunkManager() {}
+
+            /// @param activeGrid The cells loaded into the scene if the chunk overlaps them, otherwise an empty grid.
+            /// @note Thread safe.
+            virtual osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, unsigned char lod, unsigned int lodFlags, const osg::Vec4i& activeGrid) = 0;
+        };
+
+        /// Render the chunks of \a chunkManager along with the terrain. Does not take ownership.
+        /// @note Not thread safe.
+        void addChunkManager(ChunkManager* chunkManager);
+
     private:
         void ensureQuadTreeBuilt();
 
@@ -56,6 +85,14 @@ namespace Terrain
         float mLodFactor;
         int mVertexLodMod;
         float mViewDistance;
+        unsigned int mNumPreloadThreads;
+        osg::ref_ptr<SceneUtil::WorkQueue> mPreloadWorkQueue;
+
+        std::vector<ChunkManager*> mChunkManagers;
+
+        OpenThreads::Mutex mActiveGridMutex;
+        osg::Vec4i mActiveGrid;
+        unsigned int mRevision;
     };
 
 }
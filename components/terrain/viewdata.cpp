@@ -8,6 +8,8 @@ ViewData::ViewData()
     , mLastUsageTimeStamp(0.0)
     , mChanged(false)
     , mHasViewPoint(false)
+    , mRevision(0)
+    , mPendingRevision(0)
 {
 
 }
@@ -24,6 +26,13 @@ void ViewData::copyFrom(const ViewData& other)
     mChanged = other.mChanged;
     mHasViewPoint = other.mHasViewPoint;
     mViewPoint = other.mViewPoint;
+    mRevision = other.mRevision;
+}
+
+void ViewData::clearRenderingNodes()
+{
+    for (unsigned int i=0; i<mEntries.size(); ++i)
+        mEntries[i].mRenderingNode = nullptr;
 }
 
 void ViewData::add(QuadTreeNode *node)
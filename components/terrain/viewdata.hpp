@@ -6,6 +6,8 @@
 
 #include <osg/Node>
 
+#include <components/sceneutil/workqueue.hpp>
+
 #include "world.hpp"
 
 namespace Terrain
@@ -29,6 +31,9 @@ namespace Terrain
 
         void copyFrom(const ViewData& other);
 
+        /// Drop the rendering nodes of all entries, but keep the entries themselves.
+        void clearRenderingNodes();
+
         struct Entry
         {
             Entry();
@@ -57,6 +62,16 @@ namespace Terrain
         void setViewPoint(const osg::Vec3f& viewPoint);
         const osg::Vec3f& getViewPoint() const;
 
+        /// Revision of the world's chunk state that the rendering nodes were loaded for.
+        unsigned int getRevision() const { return mRevision; }
+        void setRevision(unsigned int revision) { mRevision = revision; }
+
+        /// Work item building the chunks of a newer revision in the background, see QuadTreeWorld::accept.
+        /// @note Not copied by copyFrom.
+        SceneUtil::WorkItem* getPendingRebuild() const { return mPendingRebuild.get(); }
+        unsigned int getPendingRevision() const { return mPendingRevision; }
+        void setPendingRebuild(SceneUtil::WorkItem* item, unsigned int revision) { mPendingRebuild = item; mPendingRevision = revision; }
+
     private:
         std::vector<Entry> mEntries;
         unsigned int mNumEntries;
@@ -64,6 +79,9 @@ namespace Terrain
         bool mChanged;
         osg::Vec3f mViewPoint;
         bool mHasViewPoint;
+        unsigned int mRevision;
+        osg::ref_ptr<SceneUtil::WorkItem> mPendingRebuild;
+        unsigned int mPendingRevision;
     };
 
     class ViewDataMap : public osg::Referenced
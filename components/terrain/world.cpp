@@ -5,11 +5,13 @@
 #include <osg/Camera>
 
 #include <components/resource/resourcesystem.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include "storage.hpp"
 #include "texturemanager.hpp"
 #include "chunkmanager.hpp"
 #include "compositemaprenderer.hpp"
+#include "compositemapcache.hpp"
 
 namespace Terrain
 {
@@ -68,9 +70,15 @@ World::~World()
 
 void World::setWorkQueue(SceneUtil::WorkQueue* workQueue)
 {
+    mWorkQueue = workQueue;
     mCompositeMapRenderer->setWorkQueue(workQueue);
 }
 
+void World::setCompositeMapCache(const std::string& path)
+{
+    mChunkManager->setCompositeMapCache(new CompositeMapCache(path));
+}
+
 void World::setBordersVisible(bool visible)
 {
     mBorderVisible = visible;
@@ -4,10 +4,12 @@
 #include <osg/ref_ptr>
 #include <osg/Referenced>
 #include <osg/Vec3f>
+#include <osg/Vec4i>
 
 #include <atomic>
 #include <memory>
 #include <set>
+#include <string>
 #include <atomic>
 
 #include "defs.hpp"
@@ -66,12 +68,16 @@ namespace Terrain
         World(osg::Group* parent, osg::Group* compileRoot, Resource::ResourceSystem* resourceSystem, Storage* storage, int nodeMask, int preCompileMask, int borderMask);
         virtual ~World();
 
-        /// Set a WorkQueue to delete objects in the background thread.
+        /// Set a WorkQueue to delete objects and rebuild chunks in the background thread.
         void setWorkQueue(SceneUtil::WorkQueue* workQueue);
 
         /// See CompositeMapRenderer::setTargetFrameRate
         void setTargetFrameRate(float rate);
 
+        /// Keep rendered composite maps in the directory \a path, so that later sessions can load them instead.
+        /// @note Saving requires a WorkQueue, see setWorkQueue.
+        void setCompositeMapCache(const std::string& path);
+
         /// Apply the scene manager's texture filtering settings to all cached textures.
         /// @note Thread safe.
         void updateTextureFiltering();
@@ -114,6 +120,15 @@ namespace Terrain
 
         virtual void setViewDistance(float distance) {}
 
+        /// Set the cells that are currently loaded into the scene, in cell units (minX, minY, maxX, maxY) with exclusive maximums.
+        /// @note Not thread safe.
+        virtual void setActiveGrid(const osg::Vec4i& grid) {}
+
+        /// Rebuild the rendering nodes held by all views, so that chunks removed from a cache are requested again.
+        /// @note With a WorkQueue, views keep their old rendering nodes until the new ones are built in the background.
+        /// @note Thread safe.
+        virtual void rebuildViews() {}
+
         Storage* getStorage() { return mStorage; }
 
     protected:
@@ -125,6 +140,8 @@ namespace Terrain
         osg::ref_ptr<osg::Group> mCompositeMapCamera;
         osg::ref_ptr<CompositeMapRenderer> mCompositeMapRenderer;
 
+        osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
+
         Resource::ResourceSystem* mResourceSystem;
 
         std::unique_ptr<TextureManager> mTextureManager;
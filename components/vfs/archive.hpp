@@ -2,6 +2,7 @@
 #define OPENMW_COMPONENTS_RESOURCE_ARCHIVE_H
 
 #include <map>
+#include <string>
 
 #include <components/files/constrainedfilestream.hpp>
 
@@ -14,6 +15,10 @@ namespace VFS
         virtual ~File() {}
 
         virtual Files::IStreamPtr open() = 0;
+
+        /// @return A description of where the file is stored, including its size and modification time as far as they
+        /// are known. Changes when the file is replaced by another one.
+        virtual std::string getStamp() = 0;
     };
 
     class Archive
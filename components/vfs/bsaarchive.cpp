@@ -1,6 +1,9 @@
 #include "bsaarchive.hpp"
 #include <components/bsa/compressedbsafile.hpp>
 #include <memory>
+#include <sstream>
+
+#include <boost/filesystem.hpp>
 
 namespace VFS
 {
@@ -53,4 +56,16 @@ Files::IStreamPtr BsaArchiveFile::open()
     return mFile->getFile(mInfo);
 }
 
+std::string BsaArchiveFile::getStamp()
+{
+    std::ostringstream stream;
+    stream << mFile->getFilename() << ':' << mInfo->offset << ':' << mInfo->fileSize;
+
+    boost::system::error_code error;
+    std::time_t lastWriteTime = boost::filesystem::last_write_time(mFile->getFilename(), error);
+    if (!error)
+        stream << ':' << lastWriteTime;
+    return stream.str();
+}
+
 }
@@ -1,5 +1,7 @@
 #include "filesystemarchive.hpp"
 
+#include <sstream>
+
 #include <boost/filesystem.hpp>
 
 #include <components/debug/debuglog.hpp>
@@ -65,4 +67,19 @@ namespace VFS
         return Files::openConstrainedFileStream(mPath.c_str());
     }
 
+    std::string FileSystemArchiveFile::getStamp()
+    {
+        std::ostringstream stream;
+        stream << mPath;
+
+        boost::system::error_code error;
+        boost::uintmax_t size = boost::filesystem::file_size(mPath, error);
+        if (!error)
+            stream << ':' << size;
+        std::time_t lastWriteTime = boost::filesystem::last_write_time(mPath, error);
+        if (!error)
+            stream << ':' << lastWriteTime;
+        return stream.str();
+    }
+
 }
@@ -13,6 +13,8 @@ namespace VFS
 
         virtual Files::IStreamPtr open();
 
+        virtual std::string getStamp();
+
     private:
         std::string mPath;
 
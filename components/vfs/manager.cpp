@@ -78,6 +78,14 @@ namespace VFS
         return found->second->open();
     }
 
+    std::string Manager::getStamp(const std::string &normalizedName) const
+    {
+        std::map<std::string, File*>::const_iterator found = mIndex.find(normalizedName);
+        if (found == mIndex.end())
+            return std::string();
+        return found->second->getStamp();
+    }
+
     bool Manager::exists(const std::string &name) const
     {
         std::string normalized = name;